@@ -191,6 +191,7 @@ BINS    =   $(addprefix $(BIN)/,    \
 			)
 
 OBJS    =   $(addprefix $(OBJ)/,    \
+            bench.o                 \
             cdcnet.o                \
             channel.o               \
             charset.o               \
@@ -207,17 +208,22 @@ OBJS    =   $(addprefix $(OBJ)/,    \
             ddp.o                   \
             deadstart.o             \
             device.o                \
+            devlog.o                \
+            diskio.o                \
             dsa311.o                \
             dump.o                  \
             float.o                 \
             fsmon.o                 \
             init.o                  \
             interlock_channel.o     \
+            latency.o               \
             log.o                   \
             lp1612.o                \
             lp3000.o                \
+            lpspool.o               \
             main.o                  \
             maintenance_channel.o   \
+            metrics.o               \
             msufrend.o              \
             mdi.o                   \
             mt362x.o                \
@@ -0,0 +1,221 @@
+#!/usr/bin/env node
+/*
+ * loadgen.js
+ *
+ * Multi-session terminal load generator for NAM/NPU and CDCNet regression
+ * testing. It opens a configurable number of concurrent Telnet sessions to a
+ * DtCyber terminal port, logs each one into IAF, and replays a scripted
+ * interaction with think times. While sessions are running, the time between
+ * each keystroke sent and its echo from the host is measured, as is the time
+ * between the end of each command line and the next prompt. A summary of
+ * latency percentiles and aggregate throughput is reported at the end.
+ *
+ * Usage:
+ *   node loadgen [config-file]
+ *
+ * The configuration file defaults to "loadgen.json". See README.md for a
+ * description of its contents.
+ */
+
+const fs       = require("fs");
+const Terminal = require("./Terminal");
+
+const configFile = (process.argv.length > 2) ? process.argv[2] : "loadgen.json";
+
+const config = JSON.parse(fs.readFileSync(configFile));
+
+const commands     = config.commands     || ["catlist", "status,f"];
+const duration     = (config.duration    || 60) * 1000;
+const echoTimeout  = config.echoTimeout  || 5000;
+const family       = config.family       || "";
+const host         = config.host         || "127.0.0.1";
+const keyInterval  = config.keyInterval  || 100;
+const password     = config.password     || "guest";
+const port         = config.port         || 23;
+const prompt       = new RegExp(config.prompt || "\\/");
+const rampUp       = config.rampUp       || 250;
+const respTimeout  = config.responseTimeout || 60;
+const sessionCount = config.sessions     || 10;
+const thinkTime    = config.thinkTime    || [1000, 3000];
+const user         = config.user         || "guest";
+
+const stats = {
+  bytesReceived: 0,
+  bytesSent:     0,
+  commands:      0,
+  echoLatencies: [],
+  echoesLost:    0,
+  failures:      0,
+  keystrokes:    0,
+  loggedIn:      0,
+  responseTimes: []
+};
+
+const now = () => {
+  const t = process.hrtime();
+  return t[0] * 1000 + t[1] / 1000000;
+};
+
+const percentile = (list, p) => {
+  if (list.length < 1) return 0;
+  let i = Math.ceil((p / 100) * list.length) - 1;
+  if (i < 0) i = 0;
+  return list[i];
+};
+
+const report = (label, list) => {
+  list.sort((a, b) => a - b);
+  let sum = 0;
+  for (const v of list) sum += v;
+  const mean = list.length > 0 ? sum / list.length : 0;
+  console.log(`  ${label.padEnd(16)} n=${String(list.length).padStart(7)}`
+    + `  mean ${mean.toFixed(1).padStart(8)}`
+    + `  p50 ${percentile(list, 50).toFixed(1).padStart(8)}`
+    + `  p90 ${percentile(list, 90).toFixed(1).padStart(8)}`
+    + `  p99 ${percentile(list, 99).toFixed(1).padStart(8)}`
+    + `  max ${(list.length > 0 ? list[list.length - 1] : 0).toFixed(1).padStart(8)} ms`);
+};
+
+/*
+ * Session
+ *
+ * One emulated interactive user. Keystrokes are time-stamped as they are written
+ * to the socket, and matched in order against characters received from the host,
+ * so that the echo latency of each keystroke can be measured. Characters that are
+ * not echoed within the echo timeout are counted as lost.
+ */
+class Session {
+
+  constructor(id) {
+    this.id = id;
+    this.pending = [];
+    this.isMeasuring = false;
+    this.term = new Terminal.AnsiTerminal();
+    this.term.setKeyInterval(keyInterval);
+    this.term.setDefaultTimeout(respTimeout, () => "Timeout waiting for host response");
+    this.term.setTracer((direction, data) => {
+      if (direction === "S") {
+        this.traceSent(data);
+      }
+      else {
+        this.traceReceived(data);
+      }
+    });
+  }
+
+  static byteAt(data, i) {
+    return (typeof data === "string") ? data.charCodeAt(i) & 0x7f : data[i] & 0x7f;
+  }
+
+  traceSent(data) {
+    stats.bytesSent += data.length;
+    if (!this.isMeasuring) return;
+    const t = now();
+    for (let i = 0; i < data.length; i++) {
+      this.pending.push({ ch: Session.byteAt(data, i), t: t });
+      stats.keystrokes += 1;
+    }
+  }
+
+  traceReceived(data) {
+    stats.bytesReceived += data.length;
+    if (this.pending.length < 1) return;
+    const t = now();
+    while (this.pending.length > 0 && t - this.pending[0].t > echoTimeout) {
+      this.pending.shift();
+      stats.echoesLost += 1;
+    }
+    for (let i = 0; i < data.length && this.pending.length > 0; i++) {
+      const b = Session.byteAt(data, i);
+      if (b === this.pending[0].ch
+          || (b >= 0x61 && b <= 0x7a && b - 0x20 === this.pending[0].ch)
+          || (b >= 0x41 && b <= 0x5a && b + 0x20 === this.pending[0].ch)) {
+        stats.echoLatencies.push(t - this.pending.shift().t);
+      }
+    }
+  }
+
+  think() {
+    const min = thinkTime[0];
+    const max = thinkTime.length > 1 ? thinkTime[1] : min;
+    return this.term.sleep(min + Math.floor(Math.random() * (max - min + 1)));
+  }
+
+  runCommand(cmd) {
+    let start = 0;
+    this.isMeasuring = true;
+    return this.term.send(cmd)
+    .then(() => {
+      this.isMeasuring = false;
+      start = now();
+      return this.term.send("\r");
+    })
+    .then(() => this.term.expect([{ re: prompt }]))
+    .then(() => {
+      stats.responseTimes.push(now() - start);
+      stats.commands += 1;
+    });
+  }
+
+  runScript(deadline) {
+    let i = 0;
+    const next = () => {
+      if (Date.now() >= deadline) return Promise.resolve();
+      const cmd = commands[i++ % commands.length];
+      return this.runCommand(cmd)
+      .then(() => this.think())
+      .then(() => next());
+    };
+    return next();
+  }
+
+  run(deadline) {
+    return this.term.connect(`${host}:${port}`)
+    .then(() => {
+      this.term.isExitOnClose = false;
+      return this.term.loginNOS2(family, user, password);
+    })
+    .then(() => {
+      stats.loggedIn += 1;
+      return this.think();
+    })
+    .then(() => this.runScript(deadline))
+    .then(() => this.term.send("logout\r"))
+    .then(() => this.term.expect([{ re: /LOGGED OUT/ }]))
+    .then(() => this.term.disconnect())
+    .catch(err => {
+      console.log(`${new Date().toLocaleTimeString()} session ${this.id}: ${err}`);
+      stats.failures += 1;
+      if (this.term.isConnected) this.term.disconnect().catch(() => {});
+    });
+  }
+}
+
+const startTime = now();
+const deadline = Date.now() + (sessionCount * rampUp) + duration;
+const sessions = [];
+
+console.log(`${new Date().toLocaleTimeString()} starting ${sessionCount} sessions to ${host}:${port}`);
+for (let i = 0; i < sessionCount; i++) {
+  const session = new Session(i + 1);
+  sessions.push(new Promise(resolve => {
+    setTimeout(() => {
+      session.run(deadline).then(() => resolve());
+    }, i * rampUp);
+  }));
+}
+
+Promise.all(sessions)
+.then(() => {
+  const elapsed = (now() - startTime) / 1000;
+  console.log(`${new Date().toLocaleTimeString()} load generation complete`);
+  console.log(`  sessions         ${sessionCount} started, ${stats.loggedIn} logged in, ${stats.failures} failed`);
+  console.log(`  elapsed          ${elapsed.toFixed(1)} s`);
+  console.log(`  commands         ${stats.commands} (${(stats.commands / elapsed).toFixed(2)}/s)`);
+  console.log(`  keystrokes       ${stats.keystrokes} (${(stats.keystrokes / elapsed).toFixed(2)}/s), ${stats.echoesLost} echoes lost`);
+  console.log(`  bytes sent       ${stats.bytesSent} (${(stats.bytesSent / elapsed).toFixed(0)}/s)`);
+  console.log(`  bytes received   ${stats.bytesReceived} (${(stats.bytesReceived / elapsed).toFixed(0)}/s)`);
+  report("echo latency", stats.echoLatencies);
+  report("response time", stats.responseTimes);
+  process.exit(stats.failures > 0 ? 1 : 0);
+});
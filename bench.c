@@ -0,0 +1,571 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: bench.c
+**
+**  Description:
+**      Deterministic headless benchmark mode.
+**
+**      When 'benchmark=<script>' is configured the emulator runs without
+**      a console window or operator thread, the real-time clock advances
+**      by a fixed increment per major cycle and the operator input comes
+**      from the script, which is executed by the main emulation thread at
+**      fixed points in emulated time. The same configuration and script
+**      therefore produce the same instruction stream on every run and
+**      host, and the report printed at the end (instructions, major
+**      cycles, wall time and MIPS) can be compared between builds.
+**
+**      Script lines are executed in order:
+**
+**        # text              comment
+**        wait <msec>         run for <msec> milliseconds of emulated time
+**        idle <msec>         run until CPU 0 has been in its idle loop and
+**                            no PP has been busy for <msec> milliseconds
+**                            of emulated time (needs 'ostype')
+**        limit <sec>         fail the run if it takes longer than <sec>
+**                            seconds of emulated time
+**        mark <label>        report the segment since the previous mark
+**                            and start a new one
+**        end                 finish the run and print the report
+**        enter_keys <keys>   type keys on the console, as the operator
+**                            command, with #msec# pauses in emulated time
+**        <command>           any other operator command, e.g. load_cards
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define BenchLineSize    256
+
+/*
+**  What the script is waiting for before its next line is executed.
+*/
+#define BenchRun         0
+#define BenchWait        1
+#define BenchIdle        2
+#define BenchKeys        3
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+
+/*
+**  Counter snapshot taken at the start of a segment.
+*/
+typedef struct benchSnapshot
+    {
+    u64 cycles;
+    u64 cpuInstructions;
+    u64 ppInstructions;
+    u64 emulatedUsec;
+    u64 wallMsec;
+    } BenchSnapshot;
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static void benchExecute(char *line);
+static void benchFeedKeys(void);
+static void benchReport(char *label, BenchSnapshot *from);
+static void benchTakeSnapshot(BenchSnapshot *sp);
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+bool benchActive = FALSE;
+bool benchFailed = FALSE;
+char benchScript[MaxFSPath];
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static FILE          *benchFile;
+static int           benchLineNo;
+static int           benchState = BenchRun;
+static bool          benchReported = FALSE;
+
+static u32           benchLastClock;
+static u64           benchEmulatedUsec;
+static u64           benchTarget;
+static u64           benchIdleUsec;
+static u64           benchIdleSince;
+static u64           benchLimitUsec;
+
+static char          benchKeyBuf[BenchLineSize];
+static char          *benchKeyPtr;
+
+static BenchSnapshot benchStart;
+static BenchSnapshot benchMark;
+static char          benchMarkLabel[BenchLineSize];
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Open the benchmark script and take the starting
+**                  snapshot. Called just before the emulation loop.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void benchInit(void)
+    {
+    benchFile = fopen(benchScript, "r");
+    if (benchFile == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to open benchmark script %s\n", benchScript);
+        exit(1);
+        }
+
+    benchLastClock = rtcClock;
+    benchTakeSnapshot(&benchStart);
+    benchMark = benchStart;
+    strcpy(benchMarkLabel, "start");
+
+    printf("(bench  ) Running benchmark script %s\n", benchScript);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Advance the benchmark script. Called once per major
+**                  cycle by the main emulation thread.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void benchStep(void)
+    {
+    char line[BenchLineSize];
+    char *cp;
+
+    /*
+    **  Keep a 64 bit emulated microsecond count, rtcClock wraps after
+    **  a little over an hour.
+    */
+    benchEmulatedUsec += (u32)(rtcClock - benchLastClock);
+    benchLastClock     = rtcClock;
+
+    if ((benchLimitUsec != 0) && (benchEmulatedUsec - benchStart.emulatedUsec > benchLimitUsec))
+        {
+        printf("(bench  ) Emulated time limit exceeded at line %d of %s\n", benchLineNo, benchScript);
+        benchFailed     = TRUE;
+        emulationActive = FALSE;
+
+        return;
+        }
+
+    switch (benchState)
+        {
+    case BenchWait:
+        if (benchEmulatedUsec < benchTarget)
+            {
+            return;
+            }
+        if (benchKeyPtr != NULL)
+            {
+            /*
+            **  A #msec# pause within a key sequence has ended.
+            */
+            benchState = BenchKeys;
+
+            return;
+            }
+        break;
+
+    case BenchIdle:
+        if (!(*idleDetector)(cpus) || idleCheckBusy())
+            {
+            benchIdleSince = benchEmulatedUsec;
+
+            return;
+            }
+        if (benchEmulatedUsec - benchIdleSince < benchIdleUsec)
+            {
+            return;
+            }
+        break;
+
+    case BenchKeys:
+        benchFeedKeys();
+
+        return;
+        }
+
+    benchState = BenchRun;
+
+    /*
+    **  Execute script lines until one of them has to wait.
+    */
+    while (benchState == BenchRun && emulationActive)
+        {
+        if (fgets(line, sizeof(line), benchFile) == NULL)
+            {
+            emulationActive = FALSE;
+            break;
+            }
+
+        benchLineNo += 1;
+        cp           = line + strlen(line);
+        while (cp > line && (cp[-1] == '\n' || cp[-1] == '\r' || cp[-1] == ' ' || cp[-1] == '\t'))
+            {
+            *--cp = '\0';
+            }
+
+        cp = line;
+        while (*cp == ' ' || *cp == '\t')
+            {
+            cp += 1;
+            }
+
+        if ((*cp == '\0') || (*cp == '#'))
+            {
+            continue;
+            }
+
+        benchExecute(cp);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Print the final benchmark report. Called when the
+**                  emulation loop has ended for any reason.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void benchTerminate(void)
+    {
+    if (benchReported)
+        {
+        return;
+        }
+
+    benchReported = TRUE;
+
+    if (benchMark.cycles != benchStart.cycles)
+        {
+        benchReport(benchMarkLabel, &benchMark);
+        }
+
+    benchReport("total", &benchStart);
+
+    if (benchFile != NULL)
+        {
+        fclose(benchFile);
+        benchFile = NULL;
+        }
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Execute one script line.
+**
+**  Parameters:     Name        Description.
+**                  line        script line without leading blanks
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void benchExecute(char *line)
+    {
+    char *params;
+    long value;
+
+    params = line;
+    while (*params != '\0' && *params != ' ' && *params != '\t')
+        {
+        params += 1;
+        }
+    if (*params != '\0')
+        {
+        *params++ = '\0';
+        while (*params == ' ' || *params == '\t')
+            {
+            params += 1;
+            }
+        }
+
+    if ((strcasecmp(line, "wait") == 0) || (strcasecmp(line, "idle") == 0) || (strcasecmp(line, "limit") == 0))
+        {
+        value = strtol(params, NULL, 10);
+        if (value <= 0)
+            {
+            logDtError(LogErrorLocation, "%s line %d: '%s' needs a positive value\n", benchScript, benchLineNo, line);
+            exit(1);
+            }
+
+        if (strcasecmp(line, "wait") == 0)
+            {
+            benchTarget = benchEmulatedUsec + (u64)value * 1000;
+            benchState  = BenchWait;
+            }
+        else if (strcasecmp(line, "idle") == 0)
+            {
+            if (idleDetector == &idleDetectorNone)
+                {
+                logDtError(LogErrorLocation, "%s line %d: 'idle' needs an 'ostype' to detect the idle loop\n", benchScript, benchLineNo);
+                exit(1);
+                }
+            benchIdleUsec  = (u64)value * 1000;
+            benchIdleSince = benchEmulatedUsec;
+            benchState     = BenchIdle;
+            }
+        else
+            {
+            benchLimitUsec = (u64)value * 1000000;
+            }
+        }
+    else if (strcasecmp(line, "mark") == 0)
+        {
+        benchReport(benchMarkLabel, &benchMark);
+        benchTakeSnapshot(&benchMark);
+        strcpy(benchMarkLabel, *params != '\0' ? params : "mark");
+        }
+    else if (strcasecmp(line, "end") == 0)
+        {
+        emulationActive = FALSE;
+        }
+    else if ((strcasecmp(line, "e") == 0) || (strcasecmp(line, "ek") == 0) || (strcasecmp(line, "enter_keys") == 0))
+        {
+        if (!opExpandKeys(params, benchKeyBuf, sizeof(benchKeyBuf)))
+            {
+            logDtError(LogErrorLocation, "%s line %d: invalid key sequence\n", benchScript, benchLineNo);
+            exit(1);
+            }
+        benchKeyPtr = benchKeyBuf;
+        benchState  = BenchKeys;
+        }
+    else
+        {
+        if (*params != '\0')
+            {
+            params[-1] = ' ';
+            }
+        if (!opExecute(line))
+            {
+            logDtError(LogErrorLocation, "%s line %d: unknown command '%s'\n", benchScript, benchLineNo, line);
+            exit(1);
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Type the next key of an enter_keys sequence once the
+**                  console has read the previous one. Special characters
+**                  are handled as by the enter_keys operator command.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void benchFeedKeys(void)
+    {
+    long msec;
+
+    if (opKeysPending())
+        {
+        return;
+        }
+
+    if (benchKeyPtr == NULL)
+        {
+        /*
+        **  Sequence complete and consumed.
+        */
+        benchState = BenchRun;
+
+        return;
+        }
+
+    switch (*benchKeyPtr)
+        {
+    case '\0':
+        opPutKey('\r');
+        benchKeyPtr = NULL;
+
+        return;
+
+    case '!':
+        benchKeyPtr = NULL;
+
+        return;
+
+    case ';':
+        opPutKey('\r');
+        break;
+
+    case '_':
+        opPutKey(' ');
+        break;
+
+    case '^':
+        opPutKey('\b');
+        break;
+
+    case '#':
+        msec = 0;
+        while (*++benchKeyPtr >= '0' && *benchKeyPtr <= '9')
+            {
+            msec = (msec * 10) + (*benchKeyPtr - '0');
+            }
+        if (*benchKeyPtr != '#')
+            {
+            benchKeyPtr -= 1;
+            }
+        benchKeyPtr += 1;
+
+        /*
+        **  Pause in emulated time, then resume the sequence.
+        */
+        benchTarget = benchEmulatedUsec + (u64)msec * 1000;
+        benchState  = BenchWait;
+
+        return;
+
+    default:
+        opPutKey(*benchKeyPtr);
+        break;
+        }
+
+    benchKeyPtr += 1;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Print the counters accumulated since a snapshot.
+**
+**  Parameters:     Name        Description.
+**                  label       segment name
+**                  from        snapshot taken at the start of the segment
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void benchReport(char *label, BenchSnapshot *from)
+    {
+    BenchSnapshot now;
+    double        cpuMips;
+    double        ppMips;
+    double        wallSecs;
+
+    benchTakeSnapshot(&now);
+
+    wallSecs = (double)(i64)(now.wallMsec - from->wallMsec) / 1000.0;
+    if (wallSecs > 0.0)
+        {
+        cpuMips = (double)(i64)(now.cpuInstructions - from->cpuInstructions) / wallSecs / 1000000.0;
+        ppMips  = (double)(i64)(now.ppInstructions - from->ppInstructions) / wallSecs / 1000000.0;
+        }
+    else
+        {
+        cpuMips = 0.0;
+        ppMips  = 0.0;
+        }
+
+    printf("\n(bench  ) Segment '%s'%s\n", label, benchFailed ? " (FAILED)" : "");
+    printf("(bench  )     Major cycles         %16llu\n", (unsigned long long)(now.cycles - from->cycles));
+    printf("(bench  )     CPU instructions     %16llu\n", (unsigned long long)(now.cpuInstructions - from->cpuInstructions));
+    printf("(bench  )     PP instructions      %16llu\n", (unsigned long long)(now.ppInstructions - from->ppInstructions));
+    printf("(bench  )     Emulated time        %16.3f s\n", (double)(i64)(now.emulatedUsec - from->emulatedUsec) / 1000000.0);
+    printf("(bench  )     Wall time            %16.3f s\n", wallSecs);
+    printf("(bench  )     CPU MIPS             %16.3f\n", cpuMips);
+    printf("(bench  )     PP MIPS              %16.3f\n", ppMips);
+    if (wallSecs > 0.0)
+        {
+        printf("(bench  )     Major cycles/sec     %16.0f\n", (double)(i64)(now.cycles - from->cycles) / wallSecs);
+        }
+    fflush(stdout);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Take a snapshot of the benchmark counters.
+**
+**  Parameters:     Name        Description.
+**                  sp          snapshot to fill in
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void benchTakeSnapshot(BenchSnapshot *sp)
+    {
+    int i;
+
+    sp->cycles          = metrics.cycles;
+    sp->cpuInstructions = 0;
+    sp->ppInstructions  = 0;
+    sp->emulatedUsec    = benchEmulatedUsec;
+    sp->wallMsec        = getMilliseconds();
+
+    for (i = 0; i < cpuCount; i++)
+        {
+        sp->cpuInstructions += cpus[i].instructions;
+        }
+
+    for (i = 0; i < ppuCount; i++)
+        {
+        sp->ppInstructions += metrics.ppInstructions[i];
+        }
+    }
+
+/*---------------------------  End Of File  ------------------------------*/
@@ -24,11 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-/*
-** Note: if DEBUG is enabled here, it must also be activated in npu_async.c
-*/
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -86,7 +81,7 @@
 **  Public Variables
 **  ----------------
 */
-extern FILE *npuAsyncLog;
+extern DevLogModule *npuAsyncLog;
 
 /*
 **  -----------------
@@ -186,14 +181,10 @@ void cciAsyncProcessDownlineData(Tcb *tp, NpuBuffer *bp, bool last)
         {
         len--;
         }
-#if DEBUG
-    fprintf(npuAsyncLog, "Send to terminal : ");
-    for (int i = 0; i < len ; i++)
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
         {
-        fprintf(npuAsyncLog, "%c", blk[i]);
+        devLogText(npuAsyncLog, "Send to terminal : %.*s\n", len, blk);
         }
-    fprintf(npuAsyncLog, "\n");
-#endif
 
     /*
     **  Process data.
@@ -279,10 +270,11 @@ void cciAsyncProcessUplineNormal(Tcb *tp)
             **  EOL entered - send the input upline.
             */
             cciTipSendMsg(tp, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                }
             cciTipInputReset(tp);
             tp->lastOpWasInput = TRUE;
 
@@ -353,10 +345,11 @@ void cciAsyncProcessUplineNormal(Tcb *tp)
             **  Send long lines.
             */
             cciTipSendMsg(tp, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline long normal data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline long normal data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                }
             cciTipInputReset(tp);
             }
         }
@@ -817,7 +817,7 @@ void cciSvmProcessBuffer(NpuBuffer *bp)
             break;
             }
 
-        if (tp->state == StTermIdle)
+        if ((tp == NULL) || (tp->state == StTermIdle))
             {
             rc  = rcDelTermNotConfigured;
             err = TRUE;
@@ -849,7 +849,7 @@ void cciSvmProcessBuffer(NpuBuffer *bp)
             break;
             }
 
-        if (tp->state == StTermIdle)
+        if ((tp == NULL) || (tp->state == StTermIdle))
             {
             rc  = rcDelTermNotConfigured;
             err = TRUE;
@@ -1206,7 +1206,7 @@ static Tcb *cciSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp, cciLcb *lp)
     */
     cn = block[11];
     tp = cciTipFindTcbForCN(cn);
-    if (tp->state != StTermIdle)
+    if ((tp == NULL) || (tp->state != StTermIdle))
         {
 #if DEBUG
         fprintf(cciLog, "TCB for port 0x%02x not available\n", claPort);
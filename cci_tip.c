@@ -177,7 +177,8 @@ void cciTipInit(void)
     /*
     **  Initialise TCBs.
     */
-    for (i = 0; i < MaxTcbs; i++)
+    npuTipAllocTcbs();
+    for (i = 0; i < npuTcbCount; i++)
         {
         tp = &npuTcbs[i];
         memset(tp, 0, sizeof(Tcb));
@@ -208,7 +209,7 @@ void cciTipReset(void)
     /*
     **  Initialise TCBs.
     */
-    for (i = 0; i < MaxTcbs; i++)
+    for (i = 0; i < npuTcbCount; i++)
         {
         tp = &npuTcbs[i];
         memset(tp, 0, sizeof(Tcb));
@@ -557,6 +558,11 @@ void cciTipConfigureTerminal(Tcb *tp)
 **------------------------------------------------------------------------*/
 Tcb *cciTipFindTcbForCN(u8 cn)
     {
+    if (cn >= npuTcbCount)
+        {
+        return NULL;
+        }
+
     return &npuTcbs[cn];
     }
 
@@ -122,170 +122,150 @@ void channelInit(u8 count)
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Display Channel Information.
+**  Purpose:        Return the name of a device type.
 **
 **  Parameters:     Name        Description.
+**                  devType     Device type.
 **
-**  Returns:        List of All Devices Attached to All Channels.
+**  Returns:        Pointer to device type name.
 **
 **------------------------------------------------------------------------*/
-void channelDisplayContext()
+char *channelDeviceTypeName(u8 devType)
     {
-    u8      ch;
-    char    *devTypeName;
-    u8      devNum;
-    u8      devFCB;
-    DevSlot *dp;
-    u8      i;
-    char    outBuf[64];
+    switch (devType)
+        {
+    case DtNone:
+        return ("None");
 
-    //             >   00 Deadstart Panel                (01)     1           
-    opDisplay("    >   Ch First Device Type              (DT) # Devices # Files\n");
-    opDisplay("    >   -- ------------------------------ ---- --------- -------\n");
+    case DtDeadStartPanel:
+        return ("Deadstart Panel");
 
-    for (ch = 0; ch < channelCount; ch++)
-        {
-        for (dp = channel[ch].firstDevice; dp != NULL; dp = dp->next)
-            {
-            //                                                               0....+....1....+....2....+....3..
-            switch (dp->devType)
-                {
-            case DtNone:
-                devTypeName = "None";
-                break;
+    case DtMt607:
+        return ("Magnetic Tape 607");
 
-            case DtDeadStartPanel:
-                devTypeName = "Deadstart Panel";
-                break;
+    case DtMt669:
+        return ("Magnetic Tape 669");
 
-            case DtMt607:
-                devTypeName = "Magnetic Tape 607";
-                break;
+    case DtMt5744:
+        return ("Cartridge Tape 5744");
 
-            case DtMt669:
-                devTypeName = "Magnetic Tape 669";
-                break;
+    case DtDd6603:
+        return ("Disk Device 6603");
 
-            case DtMt5744:
-                devTypeName = "Cartridge Tape 5744";
-                break;
+    case DtDd8xx:
+        return ("Disk Device 8xx");
 
-            case DtDd6603:
-                devTypeName = "Disk Device 6603";
-                break;
+    case DtDd885_42:
+        return ("Disk Device 885-42");
 
-            case DtDd8xx:
-                devTypeName = "Disk Device 8xx";
-                break;
+    case DtCr405:
+        return ("Card Reader 405");
 
-            case DtDd885_42:
-                devTypeName = "Disk Device 885-42";
-                break;
+    case DtLp1612:
+        return ("Line Printer 1612");
 
-            case DtCr405:
-                devTypeName = "Card Reader 405";
-                break;
+    case DtLp5xx:
+        return ("Line Printer 5xx");
 
-            case DtLp1612:
-                devTypeName = "Line Printer 1612";
-                break;
+    case DtRtc:
+        return ("Realtime Clock");
 
-            case DtLp5xx:
-                devTypeName = "Line Printer 5xx";
-                break;
+    case DtConsole:
+        return ("Console");
 
-            case DtRtc:
-                devTypeName = "Realtime Clock";
-                break;
+    case DtMux6671:
+        return ("Multiplexer 6671");
 
-            case DtConsole:
-                devTypeName = "Console";
-                break;
+    case DtMux6676:
+        return ("Multiplexer 6676");
 
-            case DtMux6671:
-                devTypeName = "Multiplexer 6671";
-                break;
+    case DtDsa311:
+        return ("Digital Serial Adapter 311");
 
-            case DtMux6676:
-                devTypeName = "Multiplexer 6676";
-                break;
+    case DtCp3446:
+        return ("Card Punch 3446");
 
-            case DtDsa311:
-                devTypeName = "Digital Serial Adapter 311";
-                break;
+    case DtCr3447:
+        return ("Card Reader 3447");
 
-            case DtCp3446:
-                devTypeName = "Card Punch 3446";
-                break;
+    case DtDcc6681:
+        return ("Data Channel Converter 6681");
 
-            case DtCr3447:
-                devTypeName = "Card Reader 3447";
-                break;
+    case DtTpm:
+        return ("Two Port Multiplexer");
 
-            case DtDcc6681:
-                devTypeName = "Data Channel Converter 6681";
-                break;
+    case DtDdp:
+        return ("Distributive Data Path");
 
-            case DtTpm:
-                devTypeName = "Two Port Multiplexer";
-                break;
+    case DtNiu:
+        return ("Network Interface Unit");
 
-            case DtDdp:
-                devTypeName = "Distributive Data Path";
-                break;
+    case DtMt679:
+        return ("Magnetic Tape 679");
 
-            case DtNiu:
-                devTypeName = "Network Interface Unit";
-                break;
+    case DtMdi:
+        return ("Mainframe Device Interface");
 
-            case DtMt679:
-                devTypeName = "Magnetic Tape 679";
-                break;
+    case DtNpu:
+        return ("Network Processor Unit");
 
-            case DtMdi:
-                devTypeName = "Mainframe Device Interface";
-                break;
+    case DtMSUFrend:
+        return ("MSU Front End");
 
-            case DtNpu:
-                devTypeName = "Network Processor Unit";
-                break;
+    case DtMt362x:
+        return ("Magnetic Tape 362x");
 
-            case DtMSUFrend:
-                devTypeName = "MSU Front End";
-                break;
+    case DtMch:
+        return ("Maintenance Channel");
 
-            case DtMt362x:
-                devTypeName = "Magnetic Tape 362x";
-                break;
+    case DtStatusControlRegister:
+        return ("Status Control Register");
 
-            case DtMch:
-                devTypeName = "Maintenance Channel";
-                break;
+    case DtInterlockRegister:
+        return ("Interlock Register");
 
-            case DtStatusControlRegister:
-                devTypeName = "Status Control Register";
-                break;
+    case DtPciChannel:
+        return ("PCI Channel");
 
-            case DtInterlockRegister:
-                devTypeName = "Interlock Register";
-                break;
+    case DtCsFei:
+        return ("Cray Station FEI");
 
-            case DtPciChannel:
-                devTypeName = "PCI Channel";
-                break;
+    case DtHcp:
+        return ("CCI HCP Unit");
 
-            case DtCsFei:
-                devTypeName = "Cray Station FEI";
-                break;
+    default:
+        return ("Unknown Device");
+        }
+    }
 
-            case DtHcp:
-                devTypeName = "CCI HCP Unit";
-                break;
+/*--------------------------------------------------------------------------
+**  Purpose:        Display Channel Information.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        List of All Devices Attached to All Channels.
+**
+**------------------------------------------------------------------------*/
+void channelDisplayContext()
+    {
+    u8      ch;
+    char    *devTypeName;
+    u8      devNum;
+    u8      devFCB;
+    DevSlot *dp;
+    u8      i;
+    char    outBuf[64];
 
-            default:
-                devTypeName = "Unknown Device";
-                break;
-                }
+    //             >   00 Deadstart Panel                (01)     1           
+    opDisplay("    >   Ch First Device Type              (DT) # Devices # Files\n");
+    opDisplay("    >   -- ------------------------------ ---- --------- -------\n");
+
+    for (ch = 0; ch < channelCount; ch++)
+        {
+        for (dp = channel[ch].firstDevice; dp != NULL; dp = dp->next)
+            {
+            //                                                               0....+....1....+....2....+....3..
+            devTypeName = channelDeviceTypeName(dp->devType);
             sprintf(outBuf, "    >   %02o %-30s (%02o)",
                     channel[ch].id,
                     devTypeName,
@@ -507,6 +487,7 @@ void channelFunction(PpWord funcCode)
     {
     FcStatus status = FcDeclined;
 
+    metrics.channelFunctions[activeChannel->id] += 1;
     activeChannel->full = FALSE;
     for (activeDevice = activeChannel->firstDevice; activeDevice != NULL; activeDevice = activeDevice->next)
         {
@@ -601,7 +582,16 @@ void channelIo(void)
         && (activeChannel->ioDevice != NULL))
         {
         activeDevice = activeChannel->ioDevice;
-        activeDevice->io();
+        if (latencyActive)
+            {
+            latencyEnter();
+            activeDevice->io();
+            latencyLeave(LatPhaseIo, activeChannel->id);
+            }
+        else
+            {
+            activeDevice->io();
+            }
         }
     }
 
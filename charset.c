@@ -403,6 +403,44 @@ const u8 ebcdicToAscii[256] =
     /* f8-ff */ 0x38, 0x39, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a, 0x1a
     };
 
+/* EBCDIC to display code, the composite of ebcdicToAscii and asciiToCdc */
+const u8 ebcdicToCdc[256] =
+    {
+    /* 00-07 */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 08-0f */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 10-17 */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 18-1f */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 20-27 */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 28-2f */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 30-37 */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 38-3f */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 40-47 */ 055, 000, 000, 000, 000, 000, 000, 000,
+    /* 48-4f */ 000, 000, 000, 057, 072, 051, 045, 000,
+    /* 50-57 */ 067, 000, 000, 000, 000, 000, 000, 000,
+    /* 58-5f */ 000, 000, 066, 053, 047, 052, 077, 076,
+    /* 60-67 */ 046, 050, 000, 000, 000, 000, 000, 000,
+    /* 68-6f */ 000, 000, 000, 056, 063, 065, 073, 071,
+    /* 70-77 */ 000, 000, 000, 000, 000, 000, 000, 000,
+    /* 78-7f */ 000, 000, 000, 060, 074, 070, 054, 064,
+
+    /* 80-87 */ 000, 001, 002, 003, 004, 005, 006, 007,
+    /* 88-8f */ 010, 011, 000, 000, 000, 000, 000, 000,
+    /* 90-97 */ 000, 012, 013, 014, 015, 016, 017, 020,
+    /* 98-9f */ 021, 022, 000, 000, 000, 000, 000, 000,
+    /* a0-a7 */ 000, 000, 023, 024, 025, 026, 027, 030,
+    /* a8-af */ 031, 032, 000, 000, 000, 061, 000, 000,
+    /* b0-b7 */ 076, 000, 000, 000, 000, 000, 000, 000,
+    /* b8-bf */ 000, 000, 061, 062, 000, 062, 000, 000,
+    /* c0-c7 */ 061, 001, 002, 003, 004, 005, 006, 007,
+    /* c8-cf */ 010, 011, 000, 000, 000, 000, 000, 000,
+    /* d0-d7 */ 000, 012, 013, 014, 015, 016, 017, 020,
+    /* d8-df */ 021, 022, 000, 000, 000, 000, 000, 000,
+    /* e0-e7 */ 075, 000, 023, 024, 025, 026, 027, 030,
+    /* e8-ef */ 031, 032, 000, 000, 000, 000, 000, 000,
+    /* f0-f7 */ 033, 034, 035, 036, 037, 040, 041, 042,
+    /* f8-ff */ 043, 044, 000, 000, 000, 000, 000, 000
+    };
+
 /* This translates ASCII codes to PLATO text string codes.  0 means end of line,
  * which is encoded as 0000 at end of word. 76 and/or 70 are prefix codes (access
  * and shift respectively).
@@ -491,4 +529,59 @@ const unsigned char platoStringToAscii[4][65] =
     "\001\001\001\xa9\001\001\xc6\xd8|\xc5\xc4\001\001\001\001\001\001\001\001\001\001\001\001\001\xd6\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001\001"
     };
 
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Translate a buffer of characters through a 256 entry
+**                  conversion table such as ebcdicToAscii. The loop is
+**                  unrolled so that eight independent table lookups are
+**                  in flight at a time.
+**
+**  Parameters:     Name        Description.
+**                  dst         pointer to output area (may equal src)
+**                  src         pointer to characters to translate
+**                  len         number of characters
+**                  table       conversion table
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void charsetTranslate(u8 *dst, const u8 *src, int len, const u8 *table)
+    {
+    u8 c0, c1, c2, c3, c4, c5, c6, c7;
+
+    while (len >= 8)
+        {
+        c0     = table[src[0]];
+        c1     = table[src[1]];
+        c2     = table[src[2]];
+        c3     = table[src[3]];
+        c4     = table[src[4]];
+        c5     = table[src[5]];
+        c6     = table[src[6]];
+        c7     = table[src[7]];
+        dst[0] = c0;
+        dst[1] = c1;
+        dst[2] = c2;
+        dst[3] = c3;
+        dst[4] = c4;
+        dst[5] = c5;
+        dst[6] = c6;
+        dst[7] = c7;
+        src   += 8;
+        dst   += 8;
+        len   -= 8;
+        }
+    while (len-- > 0)
+        {
+        *dst++ = table[*src++];
+        }
+    }
+
 /*---------------------------  End Of File  ------------------------------*/
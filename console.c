@@ -59,6 +59,22 @@
 **             0 = left screen, 1 = right screen
 **      0x85 : Set font type. One parameter byte follows:
 **             0 = dot mode, 1 = small font, 2 = medium font, 3 = large font
+**      0x86 : Stream options accepted. One parameter byte follows, holding
+**             the options requested by the client which DtCyber will use
+**             (see control code 0x82 below).
+**      0x87 : Delta frame. Sent instead of the plain frame data when delta
+**             encoding is in effect. A sequence of the following delta
+**             operations follows, which rebuild the frame from the frame
+**             rebuilt previously (initially empty):
+**               0x88 : Copy. Four parameter bytes follow, the 16 bit offset
+**                      and the 16 bit length (most significant byte first)
+**                      of a sequence of bytes in the previous frame to be
+**                      appended to the new frame.
+**               0x89 : Literal. Two parameter bytes follow, the 16 bit length
+**                      of the bytes which follow them and are appended to
+**                      the new frame.
+**               0xFF : End of delta frame. The new frame is complete and is
+**                      processed as if it had been received as plain data.
 **      0xFF : End of frame. Data between occurrences of this control code
 **             represent one console display refresh cycle.
 **
@@ -72,17 +88,36 @@
 **             Thereafter, frames are sent according to the current refresh interval.
 **             This control code can be used to poll for frames (e.g., when refresh
 **             interval set to 0) or to force frames to be sent at any time.
+**      0x82 : Set stream options. One parameter byte follows. Bit 0 requests
+**             delta encoding of frames. DtCyber answers with control code 0x86,
+**             and frames following the answer are encoded accordingly.
 **
 **    Note that when a remote console connection is first established, the default
 **    refresh interval is 0. Consequently, no frames will be sent until a non-0
 **    refresh interval is set by sending the 0x80 control code, or the 0x81 control
 **    code is sent to poll for a frame explicitly.
 **
+**    Most refresh cycles differ from the previous one in a few characters only
+**    (a changing clock, a job status), so a client which requests delta encoding
+**    receives little more than the changed bytes of each frame.
+**
+**  Multiple remote consoles:
+**    Up to MaxViewers remote consoles may be connected at the same time. The
+**    first one to connect controls the keyboard, the others are view-only;
+**    keystrokes received from them are discarded, but their control codes
+**    are honoured. When the controlling console disconnects, the longest
+**    connected view-only console takes over. Each refresh cycle is copied
+**    once into a reference counted frame and handed to every console whose
+**    refresh interval has expired. Consoles send from their own position in
+**    their own frame, so a slow console only ever has the latest frame
+**    waiting and never holds up the emulator or the other consoles. Each
+**    console keeps the last frame it was sent and receives the delta against
+**    it; a frame caches its encodings by base frame, so consoles which have
+**    the same base share one encoding.
+**
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -98,6 +133,7 @@
 #else
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -127,7 +163,7 @@
 #define CycleDataBufSize           16384
 #define CycleDataLimit             (CycleDataBufSize - 1)
 #define InBufSize                  1024
-#define OutBufSize                 16384
+#define MaxViewers                 8
 
 #define CmdSetXLow                 0x80
 #define CmdSetYLow                 0x81
@@ -135,8 +171,15 @@
 #define CmdSetYHigh                0x83
 #define CmdSetScreen               0x84
 #define CmdSetFontType             0x85
+#define CmdOptionsAccepted         0x86
+#define CmdDeltaFrame              0x87
+#define CmdDeltaCopy               0x88
+#define CmdDeltaLiteral            0x89
 #define CmdEndFrame                0xFF
 
+#define OptDelta                   0x01
+#define MinDeltaCopy               8
+
 #define FontTypeDot                0
 #define FontTypeSmall              1
 #define FontTypeMedium             2
@@ -155,12 +198,6 @@
 #define SOCKET            int
 #endif
 
-#if DEBUG
-#define HexColumn(x)      (3 * (x) + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
-
 /*
 **  -----------------------------------------
 **  Private Typedef and Structure Definitions
@@ -174,6 +211,44 @@ typedef struct cycleData
     int limit;                  /* Index of last + 1 accumulated byte in sequence */
     } CycleData;
 
+typedef struct frameDelta
+    {
+    u32 baseSeqNo;              /* Sequence number of base frame, 0 if empty */
+    u8  *data;                  /* Delta against base frame */
+    int len;
+    } FrameDelta;
+
+typedef struct consoleFrame
+    {
+    int        refCount;            /* Number of holders of the frame */
+    u32        seqNo;               /* Frame sequence number */
+    u8         *plain;              /* Frame data */
+    int        plainLen;
+    FrameDelta deltas[MaxViewers];  /* Encodings built on demand */
+    int        deltaCount;
+    } ConsoleFrame;
+
+typedef struct consoleViewer
+    {
+    SOCKET       fd;                    /* Connection, INVALID_SOCKET if unused */
+    u32          connSeqNo;             /* Order of connection */
+    bool         isDeltaEnabled;        /* Client requested delta frames */
+    u64          minRefreshInterval;    /* Client refresh interval in ms */
+    u64          earliestCycleFlush;    /* Time at which next frame is due */
+    ConsoleFrame *sending;              /* Frame being sent, NULL if none */
+    u8           *sendData;             /* Encoding of frame being sent */
+    int          sendLen;
+    int          sendOffset;
+    ConsoleFrame *pending;              /* Latest frame waiting to be sent */
+    ConsoleFrame *lastSent;             /* Base of next delta, NULL if none */
+    u32          framesDropped;         /* Frames replaced before being sent */
+    u8           ctlBuf[4];             /* Control codes waiting to be sent */
+    int          ctlLen;
+    u8           inBuf[InBufSize];
+    int          inBufIn;
+    int          inBufOut;
+    } ConsoleViewer;
+
 /*
 **  ---------------------------
 **  Private Function Prototypes
@@ -183,7 +258,17 @@ static void     consoleAcceptConnection(void);
 static void     consoleActivate(void);
 static void     consoleCheckDisplayCycle(void);
 static FcStatus consoleFunc(PpWord funcCode);
+static u8       *consoleDeltaCopy(u8 *dp, int offset, int count);
+static u8       *consoleDeltaLiteral(u8 *dp, u8 *src, int count);
 static void     consoleDisconnect(void);
+static int      consoleEncodeDelta(u8 *dst, u8 *src, int len, u8 *base, int baseLen);
+static FrameDelta *consoleFrameDelta(ConsoleFrame *fp, ConsoleFrame *base);
+static ConsoleFrame *consolePublishFrame(int first, int limit);
+static void     consoleReleaseFrame(ConsoleFrame *fp);
+static void     consoleViewerClose(ConsoleViewer *vp);
+static void     consoleViewerInput(ConsoleViewer *vp);
+static void     consoleViewerOffer(ConsoleViewer *vp, ConsoleFrame *fp);
+static void     consoleViewerSend(ConsoleViewer *vp);
 static void     consoleFlushCycleData(int first, int limit);
 static void     consoleInitCycleData(void);
 static void     consoleIo(void);
@@ -196,13 +281,7 @@ static void     consoleQueueChar(u8 ch);
 static void     consoleQueueCmd(u8 cmd, u8 parm);
 static void     consoleQueueCurState(void);
 static void     consoleUpdateChecksum(u16 datum);
-
-#if DEBUG
-static char *consoleCmdToString(u8 cmd);
-static void consoleLogBytes(u8 *bytes, int len);
-static void consoleLogFlush(void);
-
-#endif
+static char     *consoleCmdToString(u8 cmd);
 
 /*
 **  ----------------
@@ -245,8 +324,6 @@ static u8        consoleEqNo;
 static CycleData *currentCycleData;
 static int       currentCycleDataIndex = 0;
 static CycleData cycleDataSequences[MaxCycleDataEntries];
-static u64       minRefreshInterval;
-static u64       earliestCycleFlush;
 
 static u8        currentFontType       = FontTypeSmall;
 static u16       currentIncrement      = 8;
@@ -256,26 +333,20 @@ static u16       currentY              = 0;
 static u8        fontSizes[4]          = { FontDot, FontSmall, FontMedium, FontLarge };
 static u16       xOffsets[2]           = { OffLeftScreen, OffRightScreen };
 
-static SOCKET    connFd                = INVALID_SOCKET;
 static SOCKET    listenFd              = INVALID_SOCKET;
 
 static u8        cycleDataBuf[CycleDataBufSize];
 static int       cycleDataIn           = 0;
 static int       cycleDataOut          = 0;
 
-static u8        inBuf[InBufSize];
-static int       inBufIn               = 0;
-static int       inBufOut              = 0;
-
-static u8        outBuf[OutBufSize];
-static int       outBufIn              = 0;
+static ConsoleViewer viewers[MaxViewers];
+static int           viewerCount       = 0;
+static u32           viewerConnSeqNo   = 0;
+static ConsoleViewer *controller       = NULL;
+static u32           frameSeqNo        = 0;
 
-#if DEBUG
-static FILE *consoleLog   = NULL;
-static char consoleLogBuf[LogLineLength + 1];
-static int  consoleLogBytesCol = 0;
-static bool queueCharLast = FALSE;
-#endif
+static DevLogModule *consoleLog;
+static bool         queueCharLast = FALSE;
 
 /*
  **--------------------------------------------------------------------------
@@ -301,15 +372,11 @@ void consoleInit(u8 eqNo, u8 unitNo, u8 channelNo, char *params)
     {
     int     consolePort;
     DevSlot *dp;
+    int     i;
     int     n;
     char    str[40];
 
-#if DEBUG
-    if (consoleLog == NULL)
-        {
-        consoleLog = fopen("consolelog.txt", "wt");
-        }
-#endif
+    consoleLog = devLogRegister("console");
 
     consoleChannelNo = channelNo;
     consoleEqNo      = eqNo;
@@ -322,6 +389,11 @@ void consoleInit(u8 eqNo, u8 unitNo, u8 channelNo, char *params)
     dp->func         = consoleFunc;
     dp->io           = consoleIo;
 
+    for (i = 0; i < MaxViewers; i++)
+        {
+        viewers[i].fd = INVALID_SOCKET;
+        }
+
     if (params != NULL)
         {
         n = sscanf(params, "%d,%s", &consolePort, str);
@@ -359,9 +431,9 @@ void consoleInit(u8 eqNo, u8 unitNo, u8 channelNo, char *params)
     consoleInitCycleData();
 
     /*
-    **  Open console window, if enabled.
+    **  Open console window, if enabled. Benchmark runs are headless.
     */
-    if (doOpenConsoleWindow)
+    if (doOpenConsoleWindow && !benchActive)
         {
         windowInit();
         isConsoleWindowOpen = TRUE;
@@ -385,14 +457,16 @@ void consoleInit(u8 eqNo, u8 unitNo, u8 channelNo, char *params)
 **------------------------------------------------------------------------*/
 void consoleCloseRemote(void)
     {
-    if (connFd != INVALID_SOCKET)
+    int i;
+
+    for (i = 0; i < MaxViewers; i++)
         {
-        netCloseConnection(connFd);
-        connFd      = INVALID_SOCKET;
-        cycleDataIn = cycleDataOut = 0;
-        inBufIn     = inBufOut     = 0;
-        outBufIn    = 0;
+        if (viewers[i].fd != INVALID_SOCKET)
+            {
+            consoleViewerClose(&viewers[i]);
+            }
         }
+    cycleDataIn = cycleDataOut = 0;
     }
 
 /*--------------------------------------------------------------------------
@@ -439,7 +513,7 @@ void consoleOpenWindow(void)
 **------------------------------------------------------------------------*/
 bool consoleIsRemoteActive(void)
     {
-    return connFd != INVALID_SOCKET;
+    return viewerCount > 0;
     }
 
 /*--------------------------------------------------------------------------
@@ -452,7 +526,9 @@ bool consoleIsRemoteActive(void)
 **------------------------------------------------------------------------*/
 void consoleShowStatus(void)
     {
-    char outBuf[200];
+    int           i;
+    char          outBuf[200];
+    ConsoleViewer *vp;
 
     if (listenFd != INVALID_SOCKET)
         {
@@ -460,12 +536,23 @@ void consoleShowStatus(void)
         opDisplay(outBuf);
         sprintf(outBuf, FMTNETSTATUS "\n", netGetLocalTcpAddress(listenFd), "", "console", "listening");
         opDisplay(outBuf);
-        if (connFd != INVALID_SOCKET)
+        for (i = 0; i < MaxViewers; i++)
             {
+            vp = &viewers[i];
+            if (vp->fd == INVALID_SOCKET)
+                {
+                continue;
+                }
             sprintf(outBuf, "    >   %-8s             ", "6612");
             opDisplay(outBuf);
-            sprintf(outBuf, FMTNETSTATUS "\n", netGetLocalTcpAddress(connFd), netGetPeerTcpAddress(connFd), "console", "connected");
+            sprintf(outBuf, FMTNETSTATUS "\n", netGetLocalTcpAddress(vp->fd), netGetPeerTcpAddress(vp->fd), "console",
+                    (vp == controller) ? "controlling" : "viewing");
             opDisplay(outBuf);
+            if (vp->framesDropped > 0)
+                {
+                sprintf(outBuf, "    >   %-8s             %u frames skipped for slow connection\n", "", vp->framesDropped);
+                opDisplay(outBuf);
+                }
             }
         }
     }
@@ -489,7 +576,7 @@ void consoleShowStatus(void)
 **------------------------------------------------------------------------*/
 static FcStatus consoleFunc(PpWord funcCode)
     {
-    if ((listenFd != INVALID_SOCKET) && (connFd == INVALID_SOCKET))
+    if ((listenFd != INVALID_SOCKET) && (viewerCount < MaxViewers))
         {
         consoleAcceptConnection();
         }
@@ -645,15 +732,14 @@ static void consoleIo(void)
             activeChannel->data = asciiToConsole[ppKeyIn];
             ppKeyIn             = 0;
             }
-        else if (opKeyIn != 0)
+        else if ((ch = (u8)opGetKey()) != 0)
             {
-            activeChannel->data = asciiToConsole[opKeyIn];
-            opKeyIn             = 0;
+            activeChannel->data = asciiToConsole[ch];
             }
         break;
         }
 
-    if (connFd != INVALID_SOCKET)
+    if (viewerCount > 0)
         {
         consoleNetIo();
         }
@@ -669,9 +755,15 @@ static void consoleIo(void)
 **------------------------------------------------------------------------*/
 static void consoleAcceptConnection(void)
     {
+#if defined(_WIN32)
+    u_long         blockEnable = 1;
+#endif
+    SOCKET         fd;
+    int            i;
     int            n;
     fd_set         readFds;
     struct timeval timeout;
+    ConsoleViewer  *vp;
 
     FD_ZERO(&readFds);
     FD_SET(listenFd, &readFds);
@@ -680,11 +772,43 @@ static void consoleAcceptConnection(void)
     n = select((int)(listenFd + 1), &readFds, NULL, NULL, &timeout);
     if (n > 0)
         {
-        connFd = netAcceptConnection(listenFd);
-        consoleInitCycleData();
-        consoleQueueCurState();
-        minRefreshInterval = InfiniteRefreshInterval;
-        earliestCycleFlush = getMilliseconds() + minRefreshInterval;
+        fd = netAcceptConnection(listenFd);
+        if (fd == INVALID_SOCKET)
+            {
+            return;
+            }
+
+        /*
+        **  Viewers must never block the emulator.
+        */
+#if defined(_WIN32)
+        ioctlsocket(fd, FIONBIO, &blockEnable);
+#else
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+#endif
+        for (i = 0; i < MaxViewers; i++)
+            {
+            if (viewers[i].fd == INVALID_SOCKET)
+                {
+                break;
+                }
+            }
+        vp = &viewers[i];
+        memset(vp, 0, sizeof(ConsoleViewer));
+        vp->fd                 = fd;
+        vp->connSeqNo          = ++viewerConnSeqNo;
+        vp->minRefreshInterval = InfiniteRefreshInterval;
+        vp->earliestCycleFlush = getMilliseconds() + vp->minRefreshInterval;
+        viewerCount           += 1;
+        if (controller == NULL)
+            {
+            controller = vp;
+            }
+        if (viewerCount == 1)
+            {
+            consoleInitCycleData();
+            consoleQueueCurState();
+            }
         }
     }
 
@@ -713,7 +837,7 @@ static void consoleCheckDisplayCycle(void)
     CycleData *cdp;
     int       i;
 
-    if (connFd == INVALID_SOCKET)
+    if (viewerCount < 1)
         {
         return;
         }
@@ -727,14 +851,12 @@ static void consoleCheckDisplayCycle(void)
         cdp = &cycleDataSequences[i];
         if ((cdp->sum1 == currentCycleData->sum1) && (cdp->sum2 == currentCycleData->sum2))
             {
-#if DEBUG
-            if (queueCharLast)
+            if (DevLogEnabled(consoleLog, DevLogDebug))
                 {
-                fputs("\n", consoleLog);
+                devLogText(consoleLog, "%scycle detected\n", queueCharLast ? "\n" : "");
+                queueCharLast = FALSE;
                 }
-            fputs("cycle detected\n", consoleLog);
-            queueCharLast = FALSE;
-#endif
+
             cycleDataBuf[cycleDataIn++] = CmdEndFrame;
             currentCycleData->limit     = cycleDataIn;
             consoleFlushCycleData(cdp->limit, currentCycleData->limit);
@@ -752,6 +874,53 @@ static void consoleCheckDisplayCycle(void)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Append a copy operation to a delta frame.
+**
+**  Parameters:     Name        Description.
+**                  dp          pointer to next byte of delta frame
+**                  offset      offset of bytes to copy in previous frame
+**                  count       number of bytes to copy
+**
+**  Returns:        Pointer to next byte of delta frame.
+**
+**------------------------------------------------------------------------*/
+static u8 *consoleDeltaCopy(u8 *dp, int offset, int count)
+    {
+    *dp++ = CmdDeltaCopy;
+    *dp++ = (u8)(offset >> 8);
+    *dp++ = (u8)(offset & 0xff);
+    *dp++ = (u8)(count >> 8);
+    *dp++ = (u8)(count & 0xff);
+
+    return (dp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Append a literal operation to a delta frame.
+**
+**  Parameters:     Name        Description.
+**                  dp          pointer to next byte of delta frame
+**                  src         pointer to literal bytes
+**                  count       number of literal bytes
+**
+**  Returns:        Pointer to next byte of delta frame.
+**
+**------------------------------------------------------------------------*/
+static u8 *consoleDeltaLiteral(u8 *dp, u8 *src, int count)
+    {
+    if (count > 0)
+        {
+        *dp++ = CmdDeltaLiteral;
+        *dp++ = (u8)(count >> 8);
+        *dp++ = (u8)(count & 0xff);
+        memcpy(dp, src, count);
+        dp += count;
+        }
+
+    return (dp);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Handle disconnecting of channel.
 **
@@ -765,92 +934,157 @@ static void consoleDisconnect(void)
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Flush remote console output buffer.
+**  Purpose:        Encode a frame as delta against a base frame.
+**
+**                  The common head and tail of both frames are copied. When
+**                  the part in between has the same length in both frames,
+**                  which is the case when characters change in place, runs
+**                  of unchanged bytes within it are copied as well. All
+**                  other bytes are sent literally.
 **
 **  Parameters:     Name        Description.
-**                  first       index of first character to flush from
-**                              output buffer
-**                  limit       index+1 of last character to flush from
-**                              output buffer
+**                  dst         pointer to delta frame buffer
+**                  src         pointer to frame data
+**                  len         length of frame data
+**                  base        pointer to base frame data
+**                  baseLen     length of base frame data
 **
-**  Returns:        Nothing.
+**  Returns:        Length of delta frame.
 **
 **------------------------------------------------------------------------*/
-static void consoleFlushCycleData(int first, int limit)
+static int consoleEncodeDelta(u8 *dst, u8 *src, int len, u8 *base, int baseLen)
     {
-    u64 currentTime;
-    int len;
-    int n;
+    u8  *dp;
+    int i;
+    int j;
+    int litStart;
+    int midEnd;
+    int prefix;
+    int suffix;
+
+    dp    = dst;
+    *dp++ = CmdDeltaFrame;
+
+    prefix = 0;
+    while ((prefix < len) && (prefix < baseLen) && (src[prefix] == base[prefix]))
+        {
+        prefix += 1;
+        }
 
-    if (connFd != INVALID_SOCKET)
+    suffix = 0;
+    while ((suffix < len - prefix) && (suffix < baseLen - prefix)
+           && (src[len - 1 - suffix] == base[baseLen - 1 - suffix]))
         {
-        currentTime = getMilliseconds();
-#if DEBUG
-        if (queueCharLast)
-            {
-            fputs("\n", consoleLog);
-            }
-        fprintf(consoleLog, "flush: first %d, limit %d, outBufIn %d, currentTime %lu, earliestCycleFlush %lu\n",
-                first, limit, outBufIn, currentTime, earliestCycleFlush);
-        queueCharLast = FALSE;
-#endif
-        if (outBufIn > 0)
+        suffix += 1;
+        }
+
+    litStart = 0;
+    if (prefix >= MinDeltaCopy)
+        {
+        dp       = consoleDeltaCopy(dp, 0, prefix);
+        litStart = prefix;
+        }
+
+    midEnd = len - suffix;
+    if (midEnd == baseLen - suffix)
+        {
+        i = prefix;
+        while (i < midEnd)
             {
-            if ((limit > first) && (currentTime >= earliestCycleFlush))
+            if (src[i] != base[i])
                 {
-                n = limit - first;
-                if (outBufIn + n <= OutBufSize)
-                    {
-                    memcpy(&outBuf[outBufIn], &cycleDataBuf[first], n);
-                    outBufIn += n;
-                    }
-                else // output buffer overflow -- replace contents with latest cycle data
-                    {
-                    memcpy(outBuf, &cycleDataBuf[first], n);
-                    outBufIn = n;
-                    }
-                earliestCycleFlush = currentTime + minRefreshInterval;
-                consoleInitCycleData();
-                consoleQueueCurState();
+                i += 1;
+                continue;
                 }
-            n = send(connFd, outBuf, outBufIn, 0);
-            if (n > 0)
+            for (j = i; (j < midEnd) && (src[j] == base[j]); j++)
                 {
-#if DEBUG
-                consoleLogBytes(outBuf, n);
-#endif
-                if (n < outBufIn)
-                    {
-                    memcpy(outBuf, &outBuf[n], outBufIn - n);
-                    }
-                outBufIn -= n;
                 }
+            if (j - i >= MinDeltaCopy)
+                {
+                dp       = consoleDeltaLiteral(dp, src + litStart, i - litStart);
+                dp       = consoleDeltaCopy(dp, i, j - i);
+                litStart = j;
+                }
+            i = j;
             }
-        else if (limit > first)
+        }
+
+    if (suffix >= MinDeltaCopy)
+        {
+        dp       = consoleDeltaLiteral(dp, src + litStart, midEnd - litStart);
+        dp       = consoleDeltaCopy(dp, baseLen - suffix, suffix);
+        litStart = len;
+        }
+
+    dp    = consoleDeltaLiteral(dp, src + litStart, len - litStart);
+    *dp++ = CmdEndFrame;
+
+    return ((int)(dp - dst));
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Hand a completed display cycle to the remote consoles
+**                  whose refresh interval has expired, and send pending
+**                  output to all remote consoles.
+**
+**  Parameters:     Name        Description.
+**                  first       index of first character of the cycle in
+**                              the cycle data buffer
+**                  limit       index+1 of last character of the cycle in
+**                              the cycle data buffer
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleFlushCycleData(int first, int limit)
+    {
+    u64           currentTime;
+    ConsoleFrame  *fp;
+    int           i;
+    ConsoleViewer *vp;
+
+    if (viewerCount < 1)
+        {
+        return;
+        }
+
+    currentTime = getMilliseconds();
+    if (DevLogEnabled(consoleLog, DevLogDebug))
+        {
+        devLogText(consoleLog, "%sflush: first %d, limit %d, viewers %d, currentTime %lu\n",
+                   queueCharLast ? "\n" : "", first, limit, viewerCount, currentTime);
+        queueCharLast = FALSE;
+        }
+
+    if (limit > first)
+        {
+        /*
+        **  The cycle is copied and encoded once, however many consoles
+        **  take it.
+        */
+        fp = NULL;
+        for (i = 0; i < MaxViewers; i++)
             {
-            if (currentTime >= earliestCycleFlush)
+            vp = &viewers[i];
+            if ((vp->fd != INVALID_SOCKET) && (currentTime >= vp->earliestCycleFlush))
                 {
-                len = limit - first;
-                n   = send(connFd, &cycleDataBuf[first], len, 0);
-#if DEBUG
-                if (n > 0)
+                if (fp == NULL)
                     {
-                    consoleLogBytes(&cycleDataBuf[first], n);
+                    fp = consolePublishFrame(first, limit);
                     }
-#endif
-                if (n < len)
-                    {
-                    if (n > 0)
-                        {
-                        len -= n;
-                        memcpy(outBuf, &cycleDataBuf[first + n], len);
-                        outBufIn = len;
-                        }
-                    }
-                earliestCycleFlush = currentTime + minRefreshInterval;
+                consoleViewerOffer(vp, fp);
+                vp->earliestCycleFlush = currentTime + vp->minRefreshInterval;
                 }
-            consoleInitCycleData();
-            consoleQueueCurState();
+            }
+        consoleInitCycleData();
+        consoleQueueCurState();
+        }
+
+    for (i = 0; i < MaxViewers; i++)
+        {
+        if (viewers[i].fd != INVALID_SOCKET)
+            {
+            consoleViewerSend(&viewers[i]);
             }
         }
     }
@@ -881,65 +1115,172 @@ static void consoleInitCycleData(void)
 **------------------------------------------------------------------------*/
 static void consoleNetIo(void)
     {
-    u8             ch;
+    int            i;
+    SOCKET         maxFd;
     int            n;
     fd_set         readFds;
     struct timeval timeout;
+    ConsoleViewer  *vp;
 
     FD_ZERO(&readFds);
-    FD_SET(connFd, &readFds);
-    timeout.tv_sec  = 0;
-    timeout.tv_usec = 0;
-    n = select((int)(connFd + 1), &readFds, NULL, NULL, &timeout);
-
-    if ((ppKeyIn == 0) && (inBufOut < inBufIn))
+    maxFd = 0;
+    for (i = 0; i < MaxViewers; i++)
         {
-        ch = inBuf[inBufOut++];
-        if (ch == 0x80) // set minimum refresh interval
+        vp = &viewers[i];
+        if ((vp->fd != INVALID_SOCKET) && (vp->inBufIn < InBufSize))
             {
-            if (inBufOut < inBufIn)
-                {
-                minRefreshInterval = inBuf[inBufOut++] * 10;
-                if (minRefreshInterval == 0)
-                    {
-                    minRefreshInterval = InfiniteRefreshInterval;
-                    }
-                earliestCycleFlush = getMilliseconds() + minRefreshInterval;
-                }
-            else
+            FD_SET(vp->fd, &readFds);
+            if (vp->fd > maxFd)
                 {
-                inBufOut -= 1;
+                maxFd = vp->fd;
                 }
-
-            return;
             }
-        else if (ch == 0x81)
-            {
-            earliestCycleFlush = 0;
+        }
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = 0;
+    n = select((int)(maxFd + 1), &readFds, NULL, NULL, &timeout);
 
-            return;
+    for (i = 0; i < MaxViewers; i++)
+        {
+        vp = &viewers[i];
+        if (vp->fd == INVALID_SOCKET)
+            {
+            continue;
             }
-        ppKeyIn = ch;
-        if (inBufOut >= inBufIn)
+        consoleViewerInput(vp);
+        if ((n > 0) && (vp->inBufIn < InBufSize) && FD_ISSET(vp->fd, &readFds))
             {
-            inBufIn = inBufOut = 0;
+            n = recv(vp->fd, &vp->inBuf[vp->inBufIn], InBufSize - vp->inBufIn, 0);
+            if (n <= 0)
+                {
+                consoleViewerClose(vp);
+                n = 1;
+                continue;
+                }
+            vp->inBufIn += n;
             }
+        consoleViewerSend(vp);
         }
-    if ((n > 0) && (inBufIn < InBufSize) && FD_ISSET(connFd, &readFds))
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Copy a display cycle into a new shared frame.
+**
+**  Parameters:     Name        Description.
+**                  first       index of first character of the cycle in
+**                              the cycle data buffer
+**                  limit       index+1 of last character of the cycle in
+**                              the cycle data buffer
+**
+**  Returns:        Pointer to frame. The caller is responsible for
+**                  adding its own reference.
+**
+**------------------------------------------------------------------------*/
+static ConsoleFrame *consolePublishFrame(int first, int limit)
+    {
+    ConsoleFrame *fp;
+    int          len;
+
+    len = limit - first;
+    fp  = (ConsoleFrame *)calloc(1, sizeof(ConsoleFrame) + len);
+    if (fp == NULL)
         {
-        n = recv(connFd, &inBuf[inBufIn], InBufSize - inBufIn, 0);
-        if (n <= 0)
-            {
-            consoleCloseRemote();
-            }
-        else
+        fputs("(console) Failed to allocate remote console frame\n", stderr);
+        exit(1);
+        }
+    fp->seqNo    = ++frameSeqNo;
+    fp->plain    = (u8 *)(fp + 1);
+    fp->plainLen = len;
+    memcpy(fp->plain, &cycleDataBuf[first], len);
+
+    return (fp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Get the delta encoding of a frame against a base frame.
+**                  The encoding is built on first use and cached in the
+**                  frame, so consoles which have the same base frame share
+**                  it.
+**
+**  Parameters:     Name        Description.
+**                  fp          pointer to frame
+**                  base        pointer to base frame, NULL to encode
+**                              against an empty frame
+**
+**  Returns:        Pointer to encoding.
+**
+**------------------------------------------------------------------------*/
+static FrameDelta *consoleFrameDelta(ConsoleFrame *fp, ConsoleFrame *base)
+    {
+    u32        baseSeqNo;
+    FrameDelta *dp;
+    int        i;
+
+    baseSeqNo = (base != NULL) ? base->seqNo : 0;
+    for (i = 0; i < fp->deltaCount; i++)
+        {
+        if (fp->deltas[i].baseSeqNo == baseSeqNo)
             {
-            inBufIn += n;
+            return (&fp->deltas[i]);
             }
         }
-    if (outBufIn > 0)
+
+    /*
+    **  Each console is sent a frame only once, so there are never more
+    **  distinct base frames than consoles. Should that change, the oldest
+    **  encoding is replaced.
+    */
+    if (fp->deltaCount < MaxViewers)
+        {
+        dp = &fp->deltas[fp->deltaCount++];
+        }
+    else
+        {
+        dp = &fp->deltas[0];
+        free(dp->data);
+        }
+
+    dp->baseSeqNo = baseSeqNo;
+    dp->data      = (u8 *)malloc(fp->plainLen + 5);
+    if (dp->data == NULL)
+        {
+        fputs("(console) Failed to allocate remote console frame\n", stderr);
+        exit(1);
+        }
+    if (base != NULL)
+        {
+        dp->len = consoleEncodeDelta(dp->data, fp->plain, fp->plainLen, base->plain, base->plainLen);
+        }
+    else
+        {
+        dp->len = consoleEncodeDelta(dp->data, fp->plain, fp->plainLen, NULL, 0);
+        }
+
+    return (dp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Drop a reference to a frame and free it when it was
+**                  the last one.
+**
+**  Parameters:     Name        Description.
+**                  fp          pointer to frame
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleReleaseFrame(ConsoleFrame *fp)
+    {
+    int i;
+
+    fp->refCount -= 1;
+    if (fp->refCount < 1)
         {
-        consoleFlushCycleData(0, 0);
+        for (i = 0; i < fp->deltaCount; i++)
+            {
+            free(fp->deltas[i].data);
+            }
+        free(fp);
         }
     }
 
@@ -954,7 +1295,7 @@ static void consoleNetIo(void)
 **------------------------------------------------------------------------*/
 static void consoleQueueChar(u8 ch)
     {
-    if (connFd == INVALID_SOCKET)
+    if (viewerCount < 1)
         {
         if (isConsoleWindowOpen)
             {
@@ -973,10 +1314,11 @@ static void consoleQueueChar(u8 ch)
             cycleDataBuf[cycleDataIn++] = ch;
             currentCycleData->limit     = cycleDataIn;
             }
-#if DEBUG
-        fprintf(consoleLog, "%02x ", ch);
-        queueCharLast = TRUE;
-#endif
+        if (DevLogEnabled(consoleLog, DevLogDebug))
+            {
+            devLogText(consoleLog, "%02x ", ch);
+            queueCharLast = TRUE;
+            }
         }
     currentX += currentIncrement;
     }
@@ -993,7 +1335,7 @@ static void consoleQueueChar(u8 ch)
 **------------------------------------------------------------------------*/
 static void consoleQueueCmd(u8 cmd, u8 parm)
     {
-    if (connFd != INVALID_SOCKET)
+    if (viewerCount > 0)
         {
         if (cycleDataIn + 1 >= CycleDataLimit)
             {
@@ -1003,14 +1345,12 @@ static void consoleQueueCmd(u8 cmd, u8 parm)
         cycleDataBuf[cycleDataIn++] = cmd;
         cycleDataBuf[cycleDataIn++] = parm;
         currentCycleData->limit     = cycleDataIn;
-#if DEBUG
-        if (queueCharLast)
+        if (DevLogEnabled(consoleLog, DevLogDebug))
             {
-            fputs("\n", consoleLog);
+            devLogText(consoleLog, "%squeueCmd: %s %02x\n", queueCharLast ? "\n" : "",
+                       consoleCmdToString(cmd), parm);
+            queueCharLast = FALSE;
             }
-        fprintf(consoleLog, "queueCmd: %s %02x\n", consoleCmdToString(cmd), parm);
-        queueCharLast = FALSE;
-#endif
         }
     }
 
@@ -1057,7 +1397,7 @@ static void consoleQueueCurState(void)
 **------------------------------------------------------------------------*/
 static void consoleSetFontType(u8 fontType)
     {
-    if (connFd == INVALID_SOCKET)
+    if (viewerCount < 1)
         {
         if (isConsoleWindowOpen)
             {
@@ -1123,7 +1463,7 @@ static void consoleSetScreen(u8 screen)
 static void consoleSetX(u16 x)
     {
     consoleUpdateChecksum(x);
-    if (connFd == INVALID_SOCKET)
+    if (viewerCount < 1)
         {
         if (isConsoleWindowOpen)
             {
@@ -1153,7 +1493,7 @@ static void consoleSetX(u16 x)
 static void consoleSetY(u16 y)
     {
     consoleUpdateChecksum(y);
-    if (connFd == INVALID_SOCKET)
+    if (viewerCount < 1)
         {
         if (isConsoleWindowOpen)
             {
@@ -1186,7 +1526,254 @@ static void consoleUpdateChecksum(u16 datum)
     currentCycleData->sum2 += currentCycleData->sum1;
     }
 
-#if DEBUG
+/*--------------------------------------------------------------------------
+**  Purpose:        Close a remote console connection.
+**
+**  Parameters:     Name        Description.
+**                  vp          pointer to viewer
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleViewerClose(ConsoleViewer *vp)
+    {
+    ConsoleViewer *next;
+    int           i;
+
+    netCloseConnection(vp->fd);
+    vp->fd       = INVALID_SOCKET;
+    viewerCount -= 1;
+    if (vp->sending != NULL)
+        {
+        consoleReleaseFrame(vp->sending);
+        vp->sending = NULL;
+        }
+    if (vp->pending != NULL)
+        {
+        consoleReleaseFrame(vp->pending);
+        vp->pending = NULL;
+        }
+    if (vp->lastSent != NULL)
+        {
+        consoleReleaseFrame(vp->lastSent);
+        vp->lastSent = NULL;
+        }
+
+    /*
+    **  Hand the keyboard to the longest connected remaining console.
+    */
+    if (controller == vp)
+        {
+        next = NULL;
+        for (i = 0; i < MaxViewers; i++)
+            {
+            if ((viewers[i].fd != INVALID_SOCKET)
+                && ((next == NULL) || (viewers[i].connSeqNo < next->connSeqNo)))
+                {
+                next = &viewers[i];
+                }
+            }
+        controller = next;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Process the next command or keystroke received from a
+**                  remote console.
+**
+**  Parameters:     Name        Description.
+**                  vp          pointer to viewer
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleViewerInput(ConsoleViewer *vp)
+    {
+    u8 ch;
+
+    /*
+    **  Keystrokes of the controlling console wait until the PP has taken
+    **  the previous one.
+    */
+    if ((vp->inBufOut >= vp->inBufIn) || ((vp == controller) && (ppKeyIn != 0)))
+        {
+        return;
+        }
+
+    ch = vp->inBuf[vp->inBufOut++];
+    if (ch == 0x80) // set minimum refresh interval
+        {
+        if (vp->inBufOut < vp->inBufIn)
+            {
+            vp->minRefreshInterval = vp->inBuf[vp->inBufOut++] * 10;
+            if (vp->minRefreshInterval == 0)
+                {
+                vp->minRefreshInterval = InfiniteRefreshInterval;
+                }
+            vp->earliestCycleFlush = getMilliseconds() + vp->minRefreshInterval;
+            }
+        else
+            {
+            vp->inBufOut -= 1;
+            }
+        }
+    else if (ch == 0x81)
+        {
+        vp->earliestCycleFlush = 0;
+        }
+    else if (ch == 0x82) // set stream options
+        {
+        if (vp->inBufOut < vp->inBufIn)
+            {
+            /*
+            **  The answer is sent between frames. The next frame is
+            **  then encoded against an empty frame.
+            */
+            vp->isDeltaEnabled = (vp->inBuf[vp->inBufOut++] & OptDelta) != 0;
+            vp->ctlBuf[0]      = CmdOptionsAccepted;
+            vp->ctlBuf[1]      = vp->isDeltaEnabled ? OptDelta : 0;
+            vp->ctlLen         = 2;
+            if (vp->lastSent != NULL)
+                {
+                consoleReleaseFrame(vp->lastSent);
+                vp->lastSent = NULL;
+                }
+            }
+        else
+            {
+            vp->inBufOut -= 1;
+            }
+        }
+    else if (vp == controller)
+        {
+        ppKeyIn = ch;
+        }
+
+    if (vp->inBufOut >= vp->inBufIn)
+        {
+        vp->inBufIn = vp->inBufOut = 0;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Hand a frame to a remote console. A frame still waiting
+**                  from an earlier cycle is replaced.
+**
+**  Parameters:     Name        Description.
+**                  vp          pointer to viewer
+**                  fp          pointer to frame
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleViewerOffer(ConsoleViewer *vp, ConsoleFrame *fp)
+    {
+    if (vp->pending != NULL)
+        {
+        consoleReleaseFrame(vp->pending);
+        vp->framesDropped += 1;
+        }
+    fp->refCount += 1;
+    vp->pending   = fp;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Send as much pending output to a remote console as its
+**                  connection takes without blocking.
+**
+**  Parameters:     Name        Description.
+**                  vp          pointer to viewer
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void consoleViewerSend(ConsoleViewer *vp)
+    {
+    FrameDelta   *dp;
+    ConsoleFrame *fp;
+    int          n;
+
+    for (;;)
+        {
+        if (vp->sending == NULL)
+            {
+            if (vp->ctlLen > 0)
+                {
+                n = send(vp->fd, vp->ctlBuf, vp->ctlLen, 0);
+                if (n <= 0)
+                    {
+                    return;
+                    }
+                vp->ctlLen -= n;
+                if (vp->ctlLen > 0)
+                    {
+                    memmove(vp->ctlBuf, &vp->ctlBuf[n], vp->ctlLen);
+
+                    return;
+                    }
+                }
+            if (vp->pending == NULL)
+                {
+                return;
+                }
+
+            /*
+            **  Start the next frame. The delta is encoded against the last
+            **  frame the console was sent, however many frames it skipped
+            **  since, and that frame is then replaced by this one.
+            */
+            fp          = vp->pending;
+            vp->pending = NULL;
+            vp->sending = fp;
+            if (!vp->isDeltaEnabled)
+                {
+                vp->sendData = fp->plain;
+                vp->sendLen  = fp->plainLen;
+                }
+            else
+                {
+                dp           = consoleFrameDelta(fp, vp->lastSent);
+                vp->sendData = dp->data;
+                vp->sendLen  = dp->len;
+                if (vp->lastSent != NULL)
+                    {
+                    consoleReleaseFrame(vp->lastSent);
+                    }
+                fp->refCount += 1;
+                vp->lastSent  = fp;
+                }
+            vp->sendOffset = 0;
+            }
+
+        n = send(vp->fd, vp->sendData + vp->sendOffset, vp->sendLen - vp->sendOffset, 0);
+        if (n <= 0)
+            {
+            return;
+            }
+        if (DevLogEnabled(consoleLog, DevLogInfo))
+            {
+            devLogBytes(consoleLog, vp->sendData + vp->sendOffset, n);
+            }
+
+        vp->sendOffset += n;
+        if (vp->sendOffset < vp->sendLen)
+            {
+            return;
+            }
+        consoleReleaseFrame(vp->sending);
+        vp->sending = NULL;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Convert console command to string.
+**
+**  Parameters:     Name        Description.
+**                  cmd         command
+**
+**  Returns:        String equivalent of command.
+**
+**------------------------------------------------------------------------*/
 static char *consoleCmdToString(u8 cmd)
     {
     static char buf[8];
@@ -1221,53 +1808,4 @@ static char *consoleCmdToString(u8 cmd)
         }
     }
 
-static void consoleLogFlush(void)
-    {
-    if (consoleLogBytesCol > 0)
-        {
-        fprintf(consoleLog, "%s\n", consoleLogBuf);
-        fflush(consoleLog);
-        }
-    consoleLogBytesCol = 0;
-    memset(consoleLogBuf, ' ', LogLineLength);
-    consoleLogBuf[LogLineLength] = '\0';
-    }
-
-static void consoleLogBytes(u8 *bytes, int len)
-    {
-    int  ascCol;
-    u8   b;
-    u8   c;
-    char hex[3];
-    int  hexCol;
-    int  i;
-
-    consoleLogBytesCol = 0;
-    consoleLogFlush(); // initialize the log buffer
-    ascCol = AsciiColumn(consoleLogBytesCol);
-    hexCol = HexColumn(consoleLogBytesCol);
-
-    for (i = 0; i < len; i++)
-        {
-        b = c = bytes[i];
-        if ((b < 0x20) || (b >= 0x7f))
-            {
-            c = '.';
-            }
-        sprintf(hex, "%02x", b);
-        memcpy(consoleLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        consoleLogBuf[ascCol++] = c;
-        if (++consoleLogBytesCol >= 16)
-            {
-            consoleLogFlush();
-            ascCol = AsciiColumn(consoleLogBytesCol);
-            hexCol = HexColumn(consoleLogBytesCol);
-            }
-        }
-    consoleLogFlush();
-    }
-
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -134,6 +134,7 @@
 #define PpMemSize                  010000
 
 #define MaxCpus                    2
+#define MaxPps                     024
 #define MaxUnits                   010
 #define MaxUnits2                  020
 #define MaxEquipment               010
@@ -141,6 +142,9 @@
 #define MaxChannels                040
 
 #define MaxIwStack                 12
+#define MaxIdleSlots               8
+
+#define MaxDiskIoBlock             4096
 
 #define OneMegabyte                (1024 * 1024)
 
@@ -265,12 +269,43 @@
 #define MaskActive                 0x4000
 #define MaskFull                   0x2000
 
+/*
+**  Events a PP parked in a spin loop may wait for.
+*/
+#define PpParkNone                 0
+#define PpParkActive               1
+#define PpParkFull                 2
+#define PpParkCm                   3
+#define PpNoSpin                   0xFFFF
+
+/*
+**  Major cycle phases timed by the cycle latency histogram.
+*/
+#define LatPhaseOpRequest          0
+#define LatPhaseRtc                1
+#define LatPhasePp                 2
+#define LatPhaseCpu                3
+#define LatPhaseChannel            4
+#define LatPhaseIo                 5
+#define LatPhaseNetCheck           6
+#define LatPhaseIdle               7
+#define LatPhaseCount              8
+
+/*
+**  Device log levels.
+*/
+#define DevLogOff                  0
+#define DevLogError                1
+#define DevLogInfo                 2
+#define DevLogDebug                3
+
 /*
 **  ----------------------
 **  Public Macro Functions
 **  ----------------------
 */
 #define LogErrorLocation           __FILE__, __LINE__
+#define DevLogEnabled(mp, lvl)     ((mp)->level >= (lvl))
 #if defined (__GNUC__) || defined(__SunOS)
 #define stricmp                    strcasecmp
 #endif
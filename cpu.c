@@ -117,10 +117,16 @@ static bool cpuCmuPutByte(CpuContext *activeCpu, u32 address, u32 pos, u8 byte);
 static void cpuEcsTransfer(CpuContext *activeCpu, bool writeToEcs);
 static void cpuEcsWord(CpuContext *activeCpu, bool writeToEcs);
 static void cpuExchangeJump(CpuContext *activeCpu, u32 address, bool doChangeMode);
-static void cpuFetchOpWord(CpuContext *activeCpu);
+static void cpuFetchOpWordPlain(CpuContext *activeCpu);
+static void cpuFetchOpWordStack(CpuContext *activeCpu);
+static void cpuFetchOpWordStackNoWrap(CpuContext *activeCpu);
 static void cpuFloatCheck(CpuContext *activeCpu, CpWord value);
 static void cpuFloatExceptionHandler(CpuContext *activeCpu);
 static void cpuOpIllegal(CpuContext *activeCpu);
+static void cpuPpReadMemNoWrap(u32 address, CpWord *data);
+static void cpuPpReadMemWrap(u32 address, CpWord *data);
+static void cpuPpWriteMemNoWrap(u32 address, CpWord data);
+static void cpuPpWriteMemWrap(u32 address, CpWord data);
 static bool cpuReadMem(CpuContext *activeCpu, u32 address, CpWord *data);
 static void cpuRegASemantics(CpuContext *activeCpu);
 static u32  cpuSubtract18(u32 op1, u32 op2);
@@ -207,6 +213,9 @@ u32        extMaxMemory;
 CpWord     *extMem;
 ExtMemory  extMemType = ECS;
 
+void (*cpuPpReadMem)(u32 address, CpWord *data);
+void (*cpuPpWriteMem)(u32 address, CpWord data);
+
 /*
 **  -----------------
 **  Private Variables
@@ -215,6 +224,11 @@ ExtMemory  extMemType = ECS;
 static FILE *cmHandle;
 static FILE *ecsHandle;
 
+/*
+**  Instruction fetch variant selected by cpuInit for the configured model.
+*/
+static void (*cpuFetchOpWord)(CpuContext *activeCpu);
+
 static volatile u32 ecsFlagRegister = 0;
 static volatile u8  ecs16Kx4bitFlagRegisters[16384];
 
@@ -353,6 +367,31 @@ void cpuInit(char *model, u32 memory, u32 emBanks, ExtMemory emType)
 
     cpuMaxMemory = memory;
 
+    /*
+    **  Select the PP memory access and instruction fetch variants for this
+    **  model once, so the hot paths do not test feature flags. All models
+    **  with an instruction stack also have stack prefetch.
+    */
+    if ((features & HasNoCmWrap) != 0)
+        {
+        cpuPpReadMem   = cpuPpReadMemNoWrap;
+        cpuPpWriteMem  = cpuPpWriteMemNoWrap;
+        cpuFetchOpWord = cpuFetchOpWordStackNoWrap;
+        }
+    else
+        {
+        cpuPpReadMem  = cpuPpReadMemWrap;
+        cpuPpWriteMem = cpuPpWriteMemWrap;
+        if ((features & HasInstructionStack) != 0)
+            {
+            cpuFetchOpWord = cpuFetchOpWordStack;
+            }
+        else
+            {
+            cpuFetchOpWord = cpuFetchOpWordPlain;
+            }
+        }
+
     switch (emType)
         {
     case ECS:
@@ -606,64 +645,6 @@ void cpuTerminate(void)
         }
     }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Read CPU memory from PP and verify that address is
-**                  within limits.
-**
-**  Parameters:     Name        Description.
-**                  address     Absolute CM address to read.
-**                  data        Pointer to 60 bit word which gets the data.
-**
-**  Returns:        Nothing
-**
-**------------------------------------------------------------------------*/
-void cpuPpReadMem(u32 address, CpWord *data)
-    {
-    if ((features & HasNoCmWrap) != 0)
-        {
-        if (address < cpuMaxMemory)
-            {
-            *data = cpMem[address] & Mask60;
-            }
-        else
-            {
-            *data = (~((CpWord)0)) & Mask60;
-            }
-        }
-    else
-        {
-        address %= cpuMaxMemory;
-        *data    = cpMem[address] & Mask60;
-        }
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Write CPU memory from PP and verify that address is
-**                  within limits.
-**
-**  Parameters:     Name        Description.
-**                  address     Absolute CM address
-**                  data        60 bit word which holds the data to be written.
-**
-**  Returns:        Nothing
-**
-**------------------------------------------------------------------------*/
-void cpuPpWriteMem(u32 address, CpWord data)
-    {
-    if ((features & HasNoCmWrap) != 0)
-        {
-        if (address < cpuMaxMemory)
-            {
-            cpMem[address] = data & Mask60;
-            }
-        }
-    else
-        {
-        address       %= cpuMaxMemory;
-        cpMem[address] = data & Mask60;
-        }
-    }
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Execute next instruction in the CPU.
 **
@@ -763,6 +744,7 @@ void cpuStep(CpuContext *activeCpu)
         **  Execute instruction.
         */
         decodeCpuOpcode[activeCpu->opFm].execute(activeCpu);
+        activeCpu->instructions += 1;
 
         /*
         **  Force B0 to 0.
@@ -1465,18 +1447,20 @@ static void cpuOpIllegal(CpuContext *activeCpu)
 **                  activeCpu   Pointer to CPU context
 **                  address     RA relative address to read.
 **                  location    Pointer to u32 which will contain absolute address.
+**                  noCmWrap    TRUE if the model does not wrap CM addresses
+**                              (compile time constant in each fetch variant).
 **
 **  Returns:        TRUE if validation failed, FALSE otherwise;
 **
 **------------------------------------------------------------------------*/
-static bool cpuCheckOpAddress(CpuContext *activeCpu, u32 address, u32 *location)
+static inline bool cpuCheckOpAddress(CpuContext *activeCpu, u32 address, u32 *location, bool noCmWrap)
     {
     /*
     **  Calculate absolute address.
     */
     *location = cpuAddRa(activeCpu, address);
 
-    if ((address >= activeCpu->regFlCm) || ((*location >= cpuMaxMemory) && ((features & HasNoCmWrap) != 0)))
+    if ((address >= activeCpu->regFlCm) || (noCmWrap && (*location >= cpuMaxMemory)))
         {
         /*
         **  Exit mode is always selected for RNI or branch.
@@ -1505,7 +1489,10 @@ static bool cpuCheckOpAddress(CpuContext *activeCpu, u32 address, u32 *location)
     /*
     **  Calculate absolute address with wraparound.
     */
-    *location %= cpuMaxMemory;
+    if (*location >= cpuMaxMemory)
+        {
+        *location %= cpuMaxMemory;
+        }
 
     return (FALSE);
     }
@@ -1514,22 +1501,29 @@ static bool cpuCheckOpAddress(CpuContext *activeCpu, u32 address, u32 *location)
 **  Purpose:        Read CPU instruction word and verify that address is
 **                  within limits.
 **
+**                  This is the common body of the per-model fetch
+**                  variants below; the feature flags are constants in
+**                  each caller so the compiler drops the unused paths.
+**
 **  Parameters:     Name        Description.
 **                  activeCpu   Pointer to CPU context
+**                  noCmWrap    TRUE if the model does not wrap CM addresses.
+**                  hasStack    TRUE if the model has an instruction stack.
+**                  hasPrefetch TRUE if the instruction stack prefetches.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void cpuFetchOpWord(CpuContext *activeCpu)
+static inline void cpuFetchOpWordModel(CpuContext *activeCpu, bool noCmWrap, bool hasStack, bool hasPrefetch)
     {
     u32 location;
 
-    if (cpuCheckOpAddress(activeCpu, activeCpu->regP, &location))
+    if (cpuCheckOpAddress(activeCpu, activeCpu->regP, &location, noCmWrap))
         {
         return;
         }
 
-    if ((features & HasInstructionStack) != 0)
+    if (hasStack)
         {
         int i;
 
@@ -1558,7 +1552,7 @@ static void cpuFetchOpWord(CpuContext *activeCpu)
             activeCpu->opWord = activeCpu->iwStack[activeCpu->iwRank];
             }
 
-        if (((features & HasIStackPrefetch) != 0) && ((i == MaxIwStack) || (i == activeCpu->iwRank)))
+        if (hasPrefetch && ((i == MaxIwStack) || (i == activeCpu->iwRank)))
             {
 #if 0
             /*
@@ -1567,7 +1561,7 @@ static void cpuFetchOpWord(CpuContext *activeCpu)
             for (i = 2; i > 0; i--)
                 {
                 address += 1;
-                if (cpuCheckOpAddress(activeCpu, address, &location))
+                if (cpuCheckOpAddress(activeCpu, address, &location, noCmWrap))
                     {
                     return;
                     }
@@ -1581,7 +1575,7 @@ static void cpuFetchOpWord(CpuContext *activeCpu)
             /*
             **  Prefetch one instruction word.
             */
-            if (cpuCheckOpAddress(activeCpu, activeCpu->regP + 1, &location))
+            if (cpuCheckOpAddress(activeCpu, activeCpu->regP + 1, &location, noCmWrap))
                 {
                 return;
                 }
@@ -1604,6 +1598,51 @@ static void cpuFetchOpWord(CpuContext *activeCpu)
     activeCpu->opOffset = 60;
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Read CPU instruction word on models without instruction
+**                  stack (6400, Cyber 73, Cyber 173).
+**
+**  Parameters:     Name        Description.
+**                  activeCpu   Pointer to CPU context
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void cpuFetchOpWordPlain(CpuContext *activeCpu)
+    {
+    cpuFetchOpWordModel(activeCpu, FALSE, FALSE, FALSE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read CPU instruction word on models with instruction
+**                  stack and CM wraparound (Cyber 175).
+**
+**  Parameters:     Name        Description.
+**                  activeCpu   Pointer to CPU context
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void cpuFetchOpWordStack(CpuContext *activeCpu)
+    {
+    cpuFetchOpWordModel(activeCpu, FALSE, TRUE, TRUE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read CPU instruction word on models with instruction
+**                  stack and no CM wraparound (Cyber 800 series).
+**
+**  Parameters:     Name        Description.
+**                  activeCpu   Pointer to CPU context
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void cpuFetchOpWordStackNoWrap(CpuContext *activeCpu)
+    {
+    cpuFetchOpWordModel(activeCpu, TRUE, TRUE, TRUE);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Void the instruction stack unless branch target is
 **                  within stack (or unconditionally if address is ~0).
@@ -1648,6 +1687,88 @@ static void cpuVoidIwStack(CpuContext *activeCpu, u32 branchAddr)
     activeCpu->iwRank = 0;
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Read CPU memory from PP on models without CM wraparound
+**                  (Cyber 800 series). Out of range reads return all ones.
+**
+**  Parameters:     Name        Description.
+**                  address     Absolute CM address to read.
+**                  data        Pointer to 60 bit word which gets the data.
+**
+**  Returns:        Nothing
+**
+**------------------------------------------------------------------------*/
+static void cpuPpReadMemNoWrap(u32 address, CpWord *data)
+    {
+    if (address < cpuMaxMemory)
+        {
+        *data = cpMem[address] & Mask60;
+        }
+    else
+        {
+        *data = (~((CpWord)0)) & Mask60;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read CPU memory from PP on models with CM wraparound.
+**
+**  Parameters:     Name        Description.
+**                  address     Absolute CM address to read.
+**                  data        Pointer to 60 bit word which gets the data.
+**
+**  Returns:        Nothing
+**
+**------------------------------------------------------------------------*/
+static void cpuPpReadMemWrap(u32 address, CpWord *data)
+    {
+    if (address >= cpuMaxMemory)
+        {
+        address %= cpuMaxMemory;
+        }
+
+    *data = cpMem[address] & Mask60;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write CPU memory from PP on models without CM wraparound
+**                  (Cyber 800 series). Out of range writes are ignored.
+**
+**  Parameters:     Name        Description.
+**                  address     Absolute CM address
+**                  data        60 bit word which holds the data to be written.
+**
+**  Returns:        Nothing
+**
+**------------------------------------------------------------------------*/
+static void cpuPpWriteMemNoWrap(u32 address, CpWord data)
+    {
+    if (address < cpuMaxMemory)
+        {
+        cpMem[address] = data & Mask60;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write CPU memory from PP on models with CM wraparound.
+**
+**  Parameters:     Name        Description.
+**                  address     Absolute CM address
+**                  data        60 bit word which holds the data to be written.
+**
+**  Returns:        Nothing
+**
+**------------------------------------------------------------------------*/
+static void cpuPpWriteMemWrap(u32 address, CpWord data)
+    {
+    if (address >= cpuMaxMemory)
+        {
+        address %= cpuMaxMemory;
+        }
+
+    cpMem[address] = data & Mask60;
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Read CPU memory and verify that address is within limits.
 **
@@ -292,9 +292,11 @@ static FcStatus dcc6681Func(PpWord funcCode)
     i8         e;
 
     /*
-    **  Clear old function code.
+    **  Clear old function code. Block I/O is only possible while a data
+    **  transfer to or from a 3000 series device which supports it is active.
     */
-    activeDevice->fcode = 0;
+    activeDevice->fcode   = 0;
+    activeDevice->blockIo = FALSE;
 
     /*
     **  If not selected, we recognize only a select.
@@ -378,6 +380,8 @@ static FcStatus dcc6681Func(PpWord funcCode)
         mp->status          = StFc6681Ready;
         funcCode           &= Fc6681IoModeMask;
 
+        activeDevice->blockIo = active3000Device->blockIo;
+
         return ((active3000Device->func)(funcCode));
         }
 
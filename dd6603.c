@@ -118,6 +118,15 @@ typedef struct diskParam
     i32              sector;
     i32              track;
     i32              head;
+
+    /*
+    **  Sector buffer staged through the disk I/O engine.
+    */
+    DiskIoUnit       *ioUnit;
+    i32              filePos;
+    int              bufIndex;
+    bool             bufDirty;
+    PpWord           buffer[SectorSize];
     } DiskParam;
 
 /*
@@ -128,6 +137,8 @@ typedef struct diskParam
 static FcStatus dd6603Func(PpWord funcCode);
 static void dd6603Io(void);
 static void dd6603Activate(void);
+static void dd6603Fill(DiskParam *dp);
+static void dd6603Flush(DiskParam *dp);
 static void dd6603Disconnect(void);
 static i32 dd6603Seek(i32 track, i32 head, i32 sector);
 static char *dd6603Func2String(PpWord funcCode);
@@ -261,6 +272,7 @@ void dd6603Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     dp->disconnect   = dd6603Disconnect;
     dp->func         = dd6603Func;
     dp->io           = dd6603Io;
+    dp->blockIo      = TRUE;
     dp->selectedUnit = unitNo;
 
     dp->context[unitNo] = calloc(1, sizeof(DiskParam));
@@ -304,6 +316,7 @@ void dd6603Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     diskP->unitNo    = unitNo;
 
     dp->fcb[unitNo] = fcb;
+    diskP->ioUnit   = diskIoOpen(fcb);
 
     /*
     **  Link into list of disk units.
@@ -337,8 +350,7 @@ void dd6603Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
 **------------------------------------------------------------------------*/
 static FcStatus dd6603Func(PpWord funcCode)
     {
-    FILE      *fcb = activeDevice->fcb[activeDevice->selectedUnit];
-    DiskParam *dp  = (DiskParam *)activeDevice->context[activeDevice->selectedUnit];
+    DiskParam *dp = (DiskParam *)activeDevice->context[activeDevice->selectedUnit];
     i32       pos;
 
 #if DEBUG
@@ -364,7 +376,9 @@ static FcStatus dd6603Func(PpWord funcCode)
             {
             return (FcDeclined);
             }
-        fseek(fcb, pos, SEEK_SET);
+        dd6603Flush(dp);
+        dp->filePos = pos;
+        dd6603Fill(dp);
         logColumn = 0;
         break;
 
@@ -376,7 +390,9 @@ static FcStatus dd6603Func(PpWord funcCode)
             {
             return (FcDeclined);
             }
-        fseek(fcb, pos, SEEK_SET);
+        dd6603Flush(dp);
+        dp->filePos  = pos;
+        dp->bufIndex = 0;
         logColumn = 0;
         break;
 
@@ -423,10 +439,7 @@ static FcStatus dd6603Func(PpWord funcCode)
 **------------------------------------------------------------------------*/
 static void dd6603Io(void)
     {
-    int ignore;
-
-    FILE      *fcb = activeDevice->fcb[activeDevice->selectedUnit];
-    DiskParam *dp  = (DiskParam *)activeDevice->context[activeDevice->selectedUnit];
+    DiskParam *dp = (DiskParam *)activeDevice->context[activeDevice->selectedUnit];
 
     switch (activeDevice->fcode & Fc6603CodeMask)
         {
@@ -440,7 +453,12 @@ static void dd6603Io(void)
     case Fc6603ReadSector:
         if (!activeChannel->full)
             {
-            ignore = (int)fread(&activeChannel->data, 2, 1, fcb);
+            if (dp->bufIndex >= SectorSize)
+                {
+                dd6603Fill(dp);
+                }
+
+            activeChannel->data = dp->buffer[dp->bufIndex++];
             activeChannel->full = TRUE;
 
 #if DEBUG
@@ -452,7 +470,13 @@ static void dd6603Io(void)
     case Fc6603WriteSector:
         if (activeChannel->full)
             {
-            fwrite(&activeChannel->data, 2, 1, fcb);
+            dp->buffer[dp->bufIndex++] = activeChannel->data;
+            dp->bufDirty               = TRUE;
+            if (dp->bufIndex >= SectorSize)
+                {
+                dd6603Flush(dp);
+                }
+
             activeChannel->full = FALSE;
 
 #if DEBUG
@@ -508,6 +532,53 @@ static void dd6603Activate(void)
 **------------------------------------------------------------------------*/
 static void dd6603Disconnect(void)
     {
+    DiskParam *dp = (DiskParam *)activeDevice->context[activeDevice->selectedUnit];
+
+    if (dp != NULL)
+        {
+        dd6603Flush(dp);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Load the sector at the current file position into
+**                  the sector buffer and start reading ahead the next.
+**
+**  Parameters:     Name        Description.
+**                  dp          Disk parameters (context).
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void dd6603Fill(DiskParam *dp)
+    {
+    (void)diskIoRead(dp->ioUnit, dp->filePos, dp->buffer, sizeof dp->buffer);
+    dp->filePos += sizeof dp->buffer;
+    dp->bufIndex = 0;
+    diskIoPrefetch(dp->ioUnit, dp->filePos, sizeof dp->buffer);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write back the words accumulated in the sector
+**                  buffer, if any.
+**
+**  Parameters:     Name        Description.
+**                  dp          Disk parameters (context).
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void dd6603Flush(DiskParam *dp)
+    {
+    if (!dp->bufDirty)
+        {
+        return;
+        }
+
+    diskIoWrite(dp->ioUnit, dp->filePos, dp->buffer, dp->bufIndex * 2);
+    dp->filePos += dp->bufIndex * 2;
+    dp->bufIndex = 0;
+    dp->bufDirty = FALSE;
     }
 
 /*--------------------------------------------------------------------------
@@ -137,6 +137,8 @@ typedef struct diskParam
     PpWord           emAddress[2];
     PpWord           writeParams[4];
     Sector           buffer;
+    DiskIoUnit       *ioUnit;
+    i32              filePos;
     } DiskParam;
 
 /*
@@ -150,8 +152,8 @@ static void dd885_42Activate(void);
 static void dd885_42Disconnect(void);
 static i32 dd885_42Seek(DiskParam *dp);
 static i32 dd885_42SeekNext(DiskParam *dp);
-static bool dd885_42Read(DiskParam *dp, FILE *fcb);
-static bool dd885_42Write(DiskParam *dp, FILE *fcb);
+static bool dd885_42Read(DiskParam *dp);
+static bool dd885_42Write(DiskParam *dp);
 static char * dd885_42Func2String(PpWord funcCode);
 
 /*
@@ -296,6 +298,7 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     ds->disconnect = dd885_42Disconnect;
     ds->func       = dd885_42Func;
     ds->io         = dd885_42Io;
+    ds->blockIo    = TRUE;
 
     /*
     **  Save disk parameters.
@@ -402,6 +405,8 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
             exit(1);
             }
 
+        dp->ioUnit = diskIoOpen(fcb);
+
         /*
         **  Write last disk sector to reserve the space.
         */
@@ -409,8 +414,7 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
         dp->cylinder = MaxCylinders - 1;
         dp->track    = MaxTracks - 1;
         dp->sector   = MaxSectors - 1;
-        fseek(fcb, dd885_42Seek(dp), SEEK_SET);
-        fwrite(&dp->buffer, sizeof dp->buffer, 1, fcb);
+        diskIoWrite(dp->ioUnit, dd885_42Seek(dp), &dp->buffer, sizeof dp->buffer);
 
         /*
         **  Position to cylinder with the disk's factory and utility
@@ -426,8 +430,7 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
             {
             for (dp->sector = 0; dp->sector < MaxSectors; dp->sector++)
                 {
-                fseek(fcb, dd885_42Seek(dp), SEEK_SET);
-                fwrite(&dp->buffer, sizeof dp->buffer, 1, fcb);
+                diskIoWrite(dp->ioUnit, dd885_42Seek(dp), &dp->buffer, sizeof dp->buffer);
                 }
             }
 
@@ -452,8 +455,11 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
 
         dp->track  = 0;
         dp->sector = 0;
-        fseek(fcb, dd885_42Seek(dp), SEEK_SET);
-        fwrite(&dp->buffer, sizeof dp->buffer, 1, fcb);
+        diskIoWrite(dp->ioUnit, dd885_42Seek(dp), &dp->buffer, sizeof dp->buffer);
+        }
+    else
+        {
+        dp->ioUnit = diskIoOpen(fcb);
         }
 
     ds->fcb[unitNo] = fcb;
@@ -472,7 +478,7 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     dp->cylinder = 0;
     dp->track    = 0;
     dp->sector   = 0;
-    fseek(fcb, dd885_42Seek(dp), SEEK_SET);
+    dp->filePos  = dd885_42Seek(dp);
 
     /*
     **  Print a friendly message.
@@ -501,20 +507,16 @@ void dd885_42Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
 static FcStatus dd885_42Func(PpWord funcCode)
     {
     i8        unitNo;
-    FILE      *fcb;
-    int       ignore;
     DiskParam *dp;
 
     unitNo = activeDevice->selectedUnit;
     if (unitNo != -1)
         {
-        dp  = (DiskParam *)activeDevice->context[unitNo];
-        fcb = activeDevice->fcb[unitNo];
+        dp = (DiskParam *)activeDevice->context[unitNo];
         }
     else
         {
-        dp  = NULL;
-        fcb = NULL;
+        dp = NULL;
         }
 
 #if DEBUG
@@ -654,7 +656,8 @@ static FcStatus dd885_42Func(PpWord funcCode)
     case Fc885_42ReadFactoryData:
     case Fc885_42ReadUtilityMap:
     case Fc885_42ReadProtectedSector:
-        ignore = (int)fread(&dp->buffer, sizeof dp->buffer, 1, fcb);
+        (void)diskIoRead(dp->ioUnit, dp->filePos, &dp->buffer, sizeof dp->buffer);
+        dp->filePos += sizeof dp->buffer;
         activeDevice->recordLength = ShortSectorSize * 5 + 2;
         break;
         }
@@ -749,7 +752,8 @@ static void dd885_42Io(void)
                     pos        = dd885_42Seek(dp);
                     if ((pos >= 0) && (fcb != NULL))
                         {
-                        fseek(fcb, pos, SEEK_SET);
+                        dp->filePos = pos;
+                        diskIoPrefetch(dp->ioUnit, pos, sizeof dp->buffer);
                         }
                     }
                 else
@@ -784,12 +788,13 @@ static void dd885_42Io(void)
 
                 case 1:
                     dp->emAddress[1] = activeChannel->data;
-                    if (dd885_42Read(dp, fcb))
+                    if (dd885_42Read(dp))
                         {
                         pos = dd885_42SeekNext(dp);
                         if ((pos >= 0) && (fcb != NULL))
                             {
-                            fseek(fcb, pos, SEEK_SET);
+                            dp->filePos = pos;
+                            diskIoPrefetch(dp->ioUnit, pos, sizeof dp->buffer);
                             }
                         }
                     break;
@@ -836,12 +841,12 @@ static void dd885_42Io(void)
 
                 case 1:
                     dp->writeParams[3] = activeChannel->data;
-                    if (dd885_42Write(dp, fcb))
+                    if (dd885_42Write(dp))
                         {
                         pos = dd885_42SeekNext(dp);
                         if ((pos >= 0) && (fcb != NULL))
                             {
-                            fseek(fcb, pos, SEEK_SET);
+                            dp->filePos = pos;
                             }
                         }
                     break;
@@ -1120,22 +1125,21 @@ static i32 dd885_42SeekNext(DiskParam *dp)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **
 **  Returns:        TRUE if successful
 **
 **------------------------------------------------------------------------*/
-static bool dd885_42Read(DiskParam *dp, FILE *fcb)
+static bool dd885_42Read(DiskParam *dp)
     {
     CpWord *data;
     u32    emAddress;
     int    i;
-    int    ignore;
 
     activeDevice->status  = 0;
     dp->detailedStatus[2] = Fc885_42Read << 4;
 
-    ignore = (int)fread(&dp->buffer, sizeof dp->buffer, 1, fcb);
+    (void)diskIoRead(dp->ioUnit, dp->filePos, &dp->buffer, sizeof dp->buffer);
+    dp->filePos         += sizeof dp->buffer;
     activeDevice->status = 0;
     dp->generalStatus[3] = dp->buffer.control[0];
     dp->generalStatus[4] = dp->buffer.control[1];
@@ -1179,12 +1183,11 @@ static bool dd885_42Read(DiskParam *dp, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **
 **  Returns:        TRUE if successful
 **
 **------------------------------------------------------------------------*/
-static bool dd885_42Write(DiskParam *dp, FILE *fcb)
+static bool dd885_42Write(DiskParam *dp)
     {
     CpWord *data;
     u32    emAddress;
@@ -1230,7 +1233,8 @@ static bool dd885_42Write(DiskParam *dp, FILE *fcb)
         return FALSE;
         }
 
-    fwrite(&dp->buffer, sizeof dp->buffer, 1, fcb);
+    diskIoWrite(dp->ioUnit, dp->filePos, &dp->buffer, sizeof dp->buffer);
+    dp->filePos += sizeof dp->buffer;
 
     return TRUE;
     }
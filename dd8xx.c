@@ -27,8 +27,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -208,8 +206,10 @@ typedef struct diskParam
     /*
     **  Parameter Table
     */
-    PpWord (*read)(struct diskParam *, FILE *fcb);
-    void (*write)(struct diskParam *, FILE *fcb, PpWord);
+    PpWord (*read)(struct diskParam *);
+    void (*write)(struct diskParam *, PpWord);
+    DiskIoUnit       *ioUnit;
+    i32              filePos;
     i32              sector;
     i32              track;
     i32              cylinder;
@@ -229,6 +229,7 @@ typedef struct diskParam
 **  ---------------------------
 */
 static void     dd8xxActivate(void);
+static void     dd8xxChangeOverlay(char *params, bool commit);
 static void     dd8xxDisconnect(void);
 static void     dd8xxDump(PpWord data);
 static void     dd8xxFlush(void);
@@ -237,15 +238,16 @@ static char    *dd8xxFunc2String(PpWord funcCode);
 static void     dd8xxInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName, DiskSize *size, u8 diskType);
 static void     dd8xxIo(void);
 static FILE    *dd8xxMount(char *deviceName, DiskParam *dp);
-static PpWord   dd8xxReadClassic(DiskParam *dp, FILE *fcb);
-static PpWord   dd8xxReadPacked(DiskParam *dp, FILE *fcb);
-static void     dd8xxSectorRead(DiskParam *dp, FILE *fcb, PpWord *sector);
-static void     dd8xxSectorWrite(DiskParam *dp, FILE *fcb, PpWord *sector);
+static PpWord   dd8xxReadClassic(DiskParam *dp);
+static PpWord   dd8xxReadPacked(DiskParam *dp);
+static void     dd8xxReadAhead(DiskParam *dp);
+static void     dd8xxSectorRead(DiskParam *dp, PpWord *sector);
+static void     dd8xxSectorWrite(DiskParam *dp, PpWord *sector);
 static i32      dd8xxSeek(DiskParam *dp);
 static i32      dd8xxSeekNextSector(DiskParam *dp);
 static void     dd844SetClearFlaw(DiskParam *dp, PpWord flawState);
-static void     dd8xxWriteClassic(DiskParam *dp, FILE *fcb, PpWord data);
-static void     dd8xxWritePacked(DiskParam *dp, FILE *fcb, PpWord data);
+static void     dd8xxWriteClassic(DiskParam *dp, PpWord data);
+static void     dd8xxWritePacked(DiskParam *dp, PpWord data);
 
 /*
 **  ----------------
@@ -315,77 +317,7 @@ static u16 detailedStatus844[] =
     0                  // last command 4
     };
 
-#if DEBUG
-static FILE *dd8xxLog = NULL;
-#endif
-
-#if DEBUG
-#define OctalColumn(x)    (5 * (x) + 1 + 5)
-#define AsciiColumn(x)    (OctalColumn(5) + 2 + (2 * x))
-#define LogLineLength    (AsciiColumn(5))
-#endif
-
-#if DEBUG
-static void dd8xxLogFlush(void);
-static void dd8xxLogByte(int b);
-
-#endif
-
-#if DEBUG
-static char dd8xxLogBuf[LogLineLength + 1];
-static int  dd8xxLogCol = 0;
-#endif
-
-#if DEBUG
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete numeric/ascii data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void dd8xxLogFlush(void)
-    {
-    if (dd8xxLogCol != 0)
-        {
-        fputs(dd8xxLogBuf, dd8xxLog);
-        }
-
-    dd8xxLogCol = 0;
-    memset(dd8xxLogBuf, ' ', LogLineLength);
-    dd8xxLogBuf[0]             = '\n';
-    dd8xxLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a byte in octal/ascii form
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void dd8xxLogByte(int b)
-    {
-    char octal[10];
-    int  col;
-
-    col = OctalColumn(dd8xxLogCol);
-    sprintf(octal, "%04o ", b);
-    memcpy(dd8xxLogBuf + col, octal, 5);
-
-    col = AsciiColumn(dd8xxLogCol);
-    dd8xxLogBuf[col + 0] = cdcToAscii[(b >> 6) & Mask6];
-    dd8xxLogBuf[col + 1] = cdcToAscii[(b >> 0) & Mask6];
-    if (++dd8xxLogCol == 5)
-        {
-        dd8xxLogFlush();
-        }
-    }
-
-#endif
+static DevLogModule *dd8xxLog;
 
 /*
  **--------------------------------------------------------------------------
@@ -617,8 +549,10 @@ void dd8xxUnloadDisk(char *params)
         }
 
     /*
-    **  Close the file.
+    **  Complete pending I/O and close the file.
     */
+    diskIoClose(dp->ioUnit);
+    dp->ioUnit = NULL;
     fclose(ds->fcb[unitNo]);
     ds->fcb[unitNo] = NULL;
 
@@ -631,6 +565,36 @@ void dd8xxUnloadDisk(char *params)
     opDisplay(outBuf);
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Merge the delta of an overlay disk into its base
+**                  image (operator interface).
+**
+**  Parameters:     Name        Description.
+**                  params      parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void dd8xxCommitDisk(char *params)
+    {
+    dd8xxChangeOverlay(params, TRUE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Discard the delta of an overlay disk (operator
+**                  interface).
+**
+**  Parameters:     Name        Description.
+**                  params      parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void dd8xxDiscardDisk(char *params)
+    {
+    dd8xxChangeOverlay(params, FALSE);
+    }
+
 /*
  **--------------------------------------------------------------------------
  **
@@ -662,17 +626,7 @@ static void dd8xxInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName, DiskSi
 
     (void)eqNo;
 
-#if DEBUG
-    if (dd8xxLog == NULL)
-        {
-        dd8xxLog = fopen("dd8xxlog.txt", "wt");
-        if (dd8xxLog == NULL)
-            {
-            logDtError(LogErrorLocation, "Cannot Open dd8xxlog.txt - aborting\n");
-            exit(1);
-            }
-        }
-#endif
+    dd8xxLog = devLogRegister("dd8xx");
 
     /*
     **  Setup channel functions.
@@ -683,6 +637,7 @@ static void dd8xxInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName, DiskSi
     ds->disconnect = dd8xxDisconnect;
     ds->func       = dd8xxFunc;
     ds->io         = dd8xxIo;
+    ds->blockIo    = TRUE;
 
     /*
     **  Save disk parameters.
@@ -825,11 +780,95 @@ static void dd8xxInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName, DiskSi
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Commit or discard the delta of an overlay disk.
+**
+**  Parameters:     Name        Description.
+**                  params      parameters
+**                  commit      TRUE to commit, FALSE to discard
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void dd8xxChangeOverlay(char *params, bool commit)
+    {
+    DiskParam *dp;
+    DevSlot   *ds;
+    int       numParam;
+    int       channelNo;
+    int       equipmentNo;
+    int       unitNo;
+    bool      ok;
+    char      outBuf[MaxFSPath + 128];
+
+    numParam = sscanf(params, "%o,%o,%o", &channelNo, &equipmentNo, &unitNo);
+
+    /*
+    **  Check parameters.
+    */
+    if (numParam != 3)
+        {
+        opDisplay("(dd8xx  ) Not enough or invalid parameters\n");
+
+        return;
+        }
+
+    if ((channelNo < 0) || (channelNo >= MaxChannels))
+        {
+        opDisplay("(dd8xx  ) Invalid channel no\n");
+
+        return;
+        }
+
+    if ((unitNo < 0) || (unitNo >= MaxUnits2))
+        {
+        opDisplay("(dd8xx  ) Invalid unit no\n");
+
+        return;
+        }
+
+    /*
+    **  Locate the device control block.
+    */
+    ds = channelFindDevice((u8)channelNo, DtDd8xx);
+    if (ds == NULL)
+        {
+        sprintf(outBuf, "(dd8xx  ) No disk controller on channel %o\n", channelNo);
+        opDisplay(outBuf);
+
+        return;
+        }
+
+    dp = (DiskParam *)ds->context[unitNo];
+    if ((dp == NULL) || (ds->fcb[unitNo] == NULL) || !diskIoIsOverlay(dp->ioUnit))
+        {
+        sprintf(outBuf, "(dd8xx  ) Unit %d is not a loaded overlay disk\n", unitNo);
+        opDisplay(outBuf);
+
+        return;
+        }
+
+    /*
+    **  Operator requests run on the emulation thread, so the PP cannot
+    **  queue new I/O on the unit while the delta is being changed.
+    */
+    ok = commit ? diskIoCommit(dp->ioUnit) : diskIoDiscard(dp->ioUnit);
+
+    sprintf(outBuf, "(dd8xx  ) %s %s overlay of %s\n",
+            ok ? "Successfully" : "Failed to",
+            commit ? (ok ? "committed" : "commit") : (ok ? "discarded" : "discard"),
+            dp->fileName);
+    opDisplay(outBuf);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Mount an 8xx disk drive.
 **
 **  Parameters:     Name        Description.
-**                  deviceName  pathname of disk container file
+**                  deviceName  pathname of disk container file, or
+**                              <base>+<delta> for an overlay container,
+**                              where <delta> is a file name in the
+**                              directory of <base>
 **                  dp          pointer to disk parameters
 **
 **  Returns:        Pointer to FILE, or NULL if disk not mounted
@@ -838,7 +877,13 @@ static void dd8xxInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName, DiskSi
 static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
     {
     FILE      *fcb;
+    char      *delta;
+    char      deltaPath[MaxFSPath];
     char      fname[MaxFSPath];
+    char      *name;
+#if defined(_WIN32)
+    char      *sep;
+#endif
     char      msg[MaxFSPath + 30];
     time_t    mTime;
     struct tm *lTime;
@@ -869,9 +914,60 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
         }
 
     /*
-    **  Try to open existing disk image.
+    **  Only a '+' in the last path component separates the base image
+    **  of an overlay container from its delta, so directory names may
+    **  contain '+'.
     */
-    fcb = fopen(fname, "r+b");
+    name = strrchr(fname, '/');
+#if defined(_WIN32)
+    sep = strrchr(fname, '\\');
+    if ((sep != NULL) && ((name == NULL) || (sep > name)))
+        {
+        name = sep;
+        }
+#endif
+    name  = (name != NULL) ? name + 1 : fname;
+    delta = strchr(name, '+');
+    if (delta != NULL)
+        {
+        /*
+        **  Overlay container <base>+<delta>: the base image must exist and
+        **  is never written, the delta is created on first use next to it.
+        */
+        *delta++ = '\0';
+        sprintf(deltaPath, "%.*s%s", (int)(name - fname), fname, delta);
+        fcb = fopen(fname, "rb");
+        if (fcb != NULL)
+            {
+            dp->ioUnit = diskIoOpenOverlay(fcb, fname, deltaPath);
+            if (dp->ioUnit == NULL)
+                {
+                fclose(fcb);
+                fcb = NULL;
+                }
+            }
+
+        delta[-1] = '+';
+        if (fcb == NULL)
+            {
+            sprintf(msg, "(dd8xx  ) Failed to open overlay %s\n", fname);
+            opDisplay(msg);
+
+            return NULL;
+            }
+        }
+    else
+        {
+        /*
+        **  Try to open existing disk image.
+        */
+        fcb = fopen(fname, "r+b");
+        if (fcb != NULL)
+            {
+            dp->ioUnit = diskIoOpen(fcb);
+            }
+        }
+
     if (fcb == NULL)
         {
         /*
@@ -886,6 +982,8 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
             return NULL;
             }
 
+        dp->ioUnit = diskIoOpen(fcb);
+
         /*
         **  Write last disk sector to reserve the space.
         */
@@ -893,8 +991,8 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
         dp->cylinder = dp->size.maxCylinders - 1;
         dp->track    = dp->size.maxTracks - 1;
         dp->sector   = dp->size.maxSectors - 1;
-        fseek(fcb, dd8xxSeek(dp), SEEK_SET);
-        dd8xxSectorWrite(dp, fcb, mySector);
+        dp->filePos  = dd8xxSeek(dp);
+        dd8xxSectorWrite(dp, mySector);
 
         /*
         **  Position to cylinder with the disk's factory and utility
@@ -919,8 +1017,8 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
             {
             for (dp->sector = 0; dp->sector < dp->size.maxSectors; dp->sector++)
                 {
-                fseek(fcb, dd8xxSeek(dp), SEEK_SET);
-                dd8xxSectorWrite(dp, fcb, mySector);
+                dp->filePos = dd8xxSeek(dp);
+                dd8xxSectorWrite(dp, mySector);
                 }
             }
 
@@ -943,10 +1041,10 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
         mySector[2] = (dd / 10) << 8 | (dd % 10) << 4 | mm / 10;
         mySector[3] = (mm % 10) << 8 | (yy / 10) << 4 | yy % 10;
 
-        dp->track  = 0;
-        dp->sector = 0;
-        fseek(fcb, dd8xxSeek(dp), SEEK_SET);
-        dd8xxSectorWrite(dp, fcb, mySector);
+        dp->track   = 0;
+        dp->sector  = 0;
+        dp->filePos = dd8xxSeek(dp);
+        dd8xxSectorWrite(dp, mySector);
         }
 
     /*
@@ -961,7 +1059,7 @@ static FILE *dd8xxMount(char *deviceName, DiskParam *dp)
     dp->track     = 0;
     dp->sector    = 0;
     dp->interlace = 1;
-    fseek(fcb, dd8xxSeek(dp), SEEK_SET);
+    dp->filePos   = dd8xxSeek(dp);
 
     return fcb;
     }
@@ -1005,33 +1103,31 @@ static FcStatus dd8xxFunc(PpWord funcCode)
         dp     = (DiskParam *)activeDevice->context[unitNo];
         }
 
-#if DEBUG
-    dd8xxLogFlush();
-    if (dp != NULL)
+    if (DevLogEnabled(dd8xxLog, DevLogInfo))
         {
-        fprintf(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o f:%04o T:%-25s   c:%3d t:%2d s:%2d  >   ",
-                traceSequenceNo,
-                activePpu->id,
-                activeDevice->channel->id,
-                funcCode,
-                dd8xxFunc2String(funcCode),
-                dp->cylinder,
-                dp->track,
-                dp->sector);
-        }
-    else
-        {
-        fprintf(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o DSK:? f:%04o T:%-25s  >   ",
-                traceSequenceNo,
-                activePpu->id,
-                activeDevice->channel->id,
-                funcCode,
-                dd8xxFunc2String(funcCode));
+        if (dp != NULL)
+            {
+            devLogText(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o f:%04o T:%-25s   c:%3d t:%2d s:%2d  >   ",
+                       traceSequenceNo,
+                       activePpu->id,
+                       activeDevice->channel->id,
+                       funcCode,
+                       dd8xxFunc2String(funcCode),
+                       dp->cylinder,
+                       dp->track,
+                       dp->sector);
+            }
+        else
+            {
+            devLogText(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o DSK:? f:%04o T:%-25s  >   ",
+                       traceSequenceNo,
+                       activePpu->id,
+                       activeDevice->channel->id,
+                       funcCode,
+                       dd8xxFunc2String(funcCode));
+            }
         }
 
-    fflush(dd8xxLog);
-#endif
-
     /*
     **  Catch functions which try to operate on not selected drives.
     */
@@ -1061,9 +1157,10 @@ static FcStatus dd8xxFunc(PpWord funcCode)
             /*
             **  All remaining functions are declined if no drive is selected.
             */
-#if DEBUG
-            fprintf(dd8xxLog, " No drive selected, function declined ");
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogError))
+                {
+                devLogText(dd8xxLog, " No drive selected, function declined ");
+                }
 
             return (FcDeclined);
             }
@@ -1075,9 +1172,10 @@ static FcStatus dd8xxFunc(PpWord funcCode)
     switch (funcCode)
         {
     default:
-#if DEBUG
-        fprintf(dd8xxLog, " !!!!!FUNC not implemented & declined!!!!!! ");
-#endif
+        if (DevLogEnabled(dd8xxLog, DevLogError))
+            {
+            devLogText(dd8xxLog, " !!!!!FUNC not implemented & declined!!!!!! ");
+            }
 
         return (FcDeclined);
 
@@ -1221,7 +1319,8 @@ static FcStatus dd8xxFunc(PpWord funcCode)
             break;
             }
 
-        fseek(fcb, dd8xxSeek(dp), SEEK_SET);
+        dp->filePos = dd8xxSeek(dp);
+        dd8xxReadAhead(dp);
         activeDevice->recordLength = SectorSize;
         break;
 
@@ -1257,19 +1356,16 @@ static FcStatus dd8xxFunc(PpWord funcCode)
     case Fc8xxGapWrite:
     case Fc8xxGapWriteVerify:
     case Fc8xxGapReadCheckword:
-#if DEBUG
-        fprintf(dd8xxLog, " !!!!!FUNC not implemented but accepted!!!!!! ");
-#endif
+        if (DevLogEnabled(dd8xxLog, DevLogError))
+            {
+            devLogText(dd8xxLog, " !!!!!FUNC not implemented but accepted!!!!!! ");
+            }
         logDtError(LogErrorLocation, "ch %o, function %04o not implemented\n", activeChannel->id, funcCode);
         break;
         }
 
     activeDevice->fcode = funcCode;
 
-#if DEBUG
-    fflush(dd8xxLog);
-#endif
-
     return (FcAccepted);
     }
 
@@ -1396,7 +1492,8 @@ static void dd8xxIo(void)
                     pos        = dd8xxSeek(dp);
                     if ((pos >= 0) && (fcb != NULL))
                         {
-                        fseek(fcb, pos, SEEK_SET);
+                        dp->filePos = pos;
+                        dd8xxReadAhead(dp);
                         }
                     }
                 else
@@ -1410,9 +1507,10 @@ static void dd8xxIo(void)
                 break;
                 }
 
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
 
             activeChannel->full = FALSE;
             }
@@ -1426,7 +1524,7 @@ static void dd8xxIo(void)
                 /*
                 **  The first word in the sector contains the data length.
                 */
-                activeDevice->recordLength = dp->read(dp, fcb);
+                activeDevice->recordLength = dp->read(dp);
                 if (activeDevice->recordLength > SectorSize)
                     {
                     activeDevice->recordLength = SectorSize;
@@ -1436,7 +1534,7 @@ static void dd8xxIo(void)
                 }
             else
                 {
-                activeChannel->data = dp->read(dp, fcb);
+                activeChannel->data = dp->read(dp);
                 }
 
             activeChannel->full = TRUE;
@@ -1447,7 +1545,8 @@ static void dd8xxIo(void)
                 pos = dd8xxSeekNextSector(dp);
                 if (pos >= 0)
                     {
-                    fseek(fcb, pos, SEEK_SET);
+                    dp->filePos = pos;
+                    dd8xxReadAhead(dp);
                     }
                 }
             }
@@ -1458,11 +1557,12 @@ static void dd8xxIo(void)
     case Fc8xxGapRead:
         if (!activeChannel->full)
             {
-            activeChannel->data = dp->read(dp, fcb);
+            activeChannel->data = dp->read(dp);
             activeChannel->full = TRUE;
-#if DEBUG
-            dd8xxLogByte(activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogWords(dd8xxLog, &activeChannel->data, 1);
+                }
 
             if (--activeDevice->recordLength == 0)
                 {
@@ -1474,7 +1574,12 @@ static void dd8xxIo(void)
                     }
                 if (pos >= 0)
                     {
-                    fseek(fcb, pos, SEEK_SET);
+                    /*
+                    **  Sequential reads are the common case, so start
+                    **  reading the next sector right away.
+                    */
+                    dp->filePos = pos;
+                    dd8xxReadAhead(dp);
                     }
                 }
             }
@@ -1486,18 +1591,19 @@ static void dd8xxIo(void)
     case Fc8xxWriteVerify:
         if (activeChannel->full)
             {
-            dp->write(dp, fcb, activeChannel->data);
+            dp->write(dp, activeChannel->data);
             activeChannel->full = FALSE;
 
-#if DEBUG
-            dd8xxLogByte(activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogWords(dd8xxLog, &activeChannel->data, 1);
+                }
             if (--activeDevice->recordLength == 0)
                 {
                 pos = dd8xxSeekNextSector(dp);
                 if (pos >= 0)
                     {
-                    fseek(fcb, pos, SEEK_SET);
+                    dp->filePos = pos;
                     }
                 }
             }
@@ -1509,9 +1615,10 @@ static void dd8xxIo(void)
             activeChannel->data = activeDevice->status;
             activeChannel->full = TRUE;
 
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
 
             if (--activeDevice->recordLength == 0)
                 {
@@ -1546,9 +1653,10 @@ static void dd8xxIo(void)
                 }
             activeChannel->full = TRUE;
 
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
 
             if (--activeDevice->recordLength == 0)
                 {
@@ -1569,9 +1677,10 @@ static void dd8xxIo(void)
                 activeChannel->data = dp->detailedStatus[20 - activeDevice->recordLength];
                 }
             activeChannel->full = TRUE;
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
 
             if (--activeDevice->recordLength == 0)
                 {
@@ -1584,12 +1693,13 @@ static void dd8xxIo(void)
     case Fc8xxReadUtilityMap:
         if (!activeChannel->full)
             {
-            activeChannel->data = dp->read(dp, fcb);
+            activeChannel->data = dp->read(dp);
             activeChannel->full = TRUE;
 
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
 
             if (--activeDevice->recordLength == 0)
                 {
@@ -1601,9 +1711,10 @@ static void dd8xxIo(void)
     case Fc8xxSetClearFlaw:
         if (activeChannel->full)
             {
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
             dd844SetClearFlaw(dp, activeChannel->data);
             activeChannel->full = FALSE;
             }
@@ -1613,9 +1724,10 @@ static void dd8xxIo(void)
         if (activeChannel->full)
             {
             activeChannel->full = FALSE;
-#if DEBUG
-            fprintf(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
-#endif
+            if (DevLogEnabled(dd8xxLog, DevLogDebug))
+                {
+                devLogText(dd8xxLog, " %04o[%d]", activeChannel->data, activeChannel->data);
+                }
             }
         break;
 
@@ -1648,14 +1760,13 @@ static void dd8xxIo(void)
 **------------------------------------------------------------------------*/
 static void dd8xxActivate(void)
     {
-#if DEBUG
-    fprintf(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o Activate",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id);
-
-    fflush(dd8xxLog);
-#endif
+    if (DevLogEnabled(dd8xxLog, DevLogInfo))
+        {
+        devLogText(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o Activate",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -1673,14 +1784,13 @@ static void dd8xxDisconnect(void)
     */
     activeChannel->discAfterInput = FALSE;
 
-#if DEBUG
-    fprintf(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o Disconnect",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id);
-
-    fflush(dd8xxLog);
-#endif
+    if (DevLogEnabled(dd8xxLog, DevLogInfo))
+        {
+        devLogText(dd8xxLog, "\n(dd8xx  ) %06d PP:%02o CH:%02o Disconnect",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -1703,9 +1813,10 @@ static i32 dd8xxSeek(DiskParam *dp)
 
     if (dp->cylinder >= dp->size.maxCylinders)
         {
-#if DEBUG
-        fprintf(dd8xxLog, "(dd8xx  ) ch %o, cylinder %d invalid\n", activeChannel->id, dp->cylinder);
-#endif
+        if (DevLogEnabled(dd8xxLog, DevLogError))
+            {
+            devLogText(dd8xxLog, "(dd8xx  ) ch %o, cylinder %d invalid\n", activeChannel->id, dp->cylinder);
+            }
         logDtError(LogErrorLocation, "ch %o, cylinder %d invalid\n", activeChannel->id, dp->cylinder);
         dp->device->status = 01000;
 
@@ -1714,9 +1825,10 @@ static i32 dd8xxSeek(DiskParam *dp)
 
     if (dp->track >= dp->size.maxTracks)
         {
-#if DEBUG
-        fprintf(dd8xxLog, "(dd8xx  ) ch %o, track %d invalid\n", activeChannel->id, dp->track);
-#endif
+        if (DevLogEnabled(dd8xxLog, DevLogError))
+            {
+            devLogText(dd8xxLog, "(dd8xx  ) ch %o, track %d invalid\n", activeChannel->id, dp->track);
+            }
         logDtError(LogErrorLocation, "ch %o, track %d invalid\n", activeChannel->id, dp->track);
         dp->device->status = 01000;
 
@@ -1725,9 +1837,10 @@ static i32 dd8xxSeek(DiskParam *dp)
 
     if (dp->sector >= dp->size.maxSectors)
         {
-#if DEBUG
-        fprintf(dd8xxLog, "(dd8xx  ) ch %o, sector %d invalid\n", activeChannel->id, dp->sector);
-#endif
+        if (DevLogEnabled(dd8xxLog, DevLogError))
+            {
+            devLogText(dd8xxLog, "(dd8xx  ) ch %o, sector %d invalid\n", activeChannel->id, dp->sector);
+            }
         logDtError(LogErrorLocation, "ch %o, sector %d invalid\n", activeChannel->id, dp->sector);
         dp->device->status = 01000;
 
@@ -1807,27 +1920,43 @@ static i32 dd8xxSeekNextSector(DiskParam *dp)
     return (dd8xxSeek(dp));
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Start reading the sector at the current position ahead
+**                  of the PP's data requests.
+**
+**  Parameters:     Name        Description.
+**                  dp          Disk parameters (context).
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void dd8xxReadAhead(DiskParam *dp)
+    {
+    if ((dp->ioUnit != NULL) && (dp->filePos >= 0))
+        {
+        diskIoPrefetch(dp->ioUnit, dp->filePos, dp->sectorSize);
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Perform a 12 bit PP word read from a classic disk container.
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **
 **  Returns:        PP word read.
 **
 **------------------------------------------------------------------------*/
-static PpWord dd8xxReadClassic(DiskParam *dp, FILE *fcb)
+static PpWord dd8xxReadClassic(DiskParam *dp)
     {
-    int ignore;
-
     /*
     **  Read an entire sector if the current buffer is empty.
     */
     if (dp->bufPtr == NULL)
         {
         dp->bufPtr = dp->buffer;
-        ignore     = (int)fread(dp->buffer, 1, dp->sectorSize, fcb);
+        (void)diskIoRead(dp->ioUnit, dp->filePos, dp->buffer, dp->sectorSize);
+        dp->filePos += dp->sectorSize;
         }
 
     /*
@@ -1846,13 +1975,12 @@ static PpWord dd8xxReadClassic(DiskParam *dp, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **                  data        PP word to be written.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void dd8xxWriteClassic(DiskParam *dp, FILE *fcb, PpWord data)
+static void dd8xxWriteClassic(DiskParam *dp, PpWord data)
     {
     /*
     **  Fail gracefully if we write too much data.
@@ -1877,7 +2005,8 @@ static void dd8xxWriteClassic(DiskParam *dp, FILE *fcb, PpWord data)
     */
     if (dp->bufPtr == dp->buffer + SectorSize)
         {
-        fwrite(dp->buffer, 1, dp->sectorSize, fcb);
+        diskIoWrite(dp->ioUnit, dp->filePos, dp->buffer, dp->sectorSize);
+        dp->filePos += dp->sectorSize;
         }
     }
 
@@ -1886,15 +2015,13 @@ static void dd8xxWriteClassic(DiskParam *dp, FILE *fcb, PpWord data)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **
 **  Returns:        PP word read.
 **
 **------------------------------------------------------------------------*/
-static PpWord dd8xxReadPacked(DiskParam *dp, FILE *fcb)
+static PpWord dd8xxReadPacked(DiskParam *dp)
     {
     u16       byteCount;
-    int       ignore;
     static u8 sector[512];
     u8        *sp;
     PpWord    *pp;
@@ -1905,7 +2032,8 @@ static PpWord dd8xxReadPacked(DiskParam *dp, FILE *fcb)
     if (dp->bufPtr == NULL)
         {
         dp->bufPtr = dp->buffer;
-        ignore     = (int)fread(sector, 1, dp->sectorSize, fcb);
+        (void)diskIoRead(dp->ioUnit, dp->filePos, sector, dp->sectorSize);
+        dp->filePos += dp->sectorSize;
 
         /*
         **  Unpack the sector into the buffer.
@@ -1939,13 +2067,12 @@ static PpWord dd8xxReadPacked(DiskParam *dp, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **                  data        PP word to be written.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void dd8xxWritePacked(DiskParam *dp, FILE *fcb, PpWord data)
+static void dd8xxWritePacked(DiskParam *dp, PpWord data)
     {
     u16       byteCount;
     static u8 sector[512];
@@ -1992,7 +2119,8 @@ static void dd8xxWritePacked(DiskParam *dp, FILE *fcb, PpWord data)
         /*
         **  Write the sector.
         */
-        fwrite(sector, 1, dp->sectorSize, fcb);
+        diskIoWrite(dp->ioUnit, dp->filePos, sector, dp->sectorSize);
+        dp->filePos += dp->sectorSize;
         }
     }
 
@@ -2001,19 +2129,18 @@ static void dd8xxWritePacked(DiskParam *dp, FILE *fcb, PpWord data)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **                  sector      Pointer to sector to read into.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void dd8xxSectorRead(DiskParam *dp, FILE *fcb, PpWord *sector)
+static void dd8xxSectorRead(DiskParam *dp, PpWord *sector)
     {
     u16 byteCount;
 
     for (byteCount = SectorSize; byteCount > 0; byteCount--)
         {
-        *sector++ = dp->read(dp, fcb);
+        *sector++ = dp->read(dp);
         }
     }
 
@@ -2022,19 +2149,18 @@ static void dd8xxSectorRead(DiskParam *dp, FILE *fcb, PpWord *sector)
 **
 **  Parameters:     Name        Description.
 **                  dp          Disk parameters (context).
-**                  fcb         File control block.
 **                  sector      Pointer to sector to write.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void dd8xxSectorWrite(DiskParam *dp, FILE *fcb, PpWord *sector)
+static void dd8xxSectorWrite(DiskParam *dp, PpWord *sector)
     {
     u16 byteCount;
 
     for (byteCount = SectorSize; byteCount > 0; byteCount--)
         {
-        dp->write(dp, fcb, *sector++);
+        dp->write(dp, *sector++);
         }
     }
 
@@ -2050,9 +2176,6 @@ static void dd8xxSectorWrite(DiskParam *dp, FILE *fcb, PpWord *sector)
 **------------------------------------------------------------------------*/
 static void dd844SetClearFlaw(DiskParam *dp, PpWord flawState)
     {
-    u8     unitNo;
-    FILE   *fcb;
-    int    ignore;
     int    index;
     PpWord flawWord0;
     PpWord flawWord1;
@@ -2060,9 +2183,6 @@ static void dd844SetClearFlaw(DiskParam *dp, PpWord flawState)
     PpWord trackFlaw;
     bool   setFlaw;
 
-    unitNo = activeDevice->selectedUnit;
-    fcb    = activeDevice->fcb[unitNo];
-
     /*
     **  Assemble flaw words.
     */
@@ -2088,8 +2208,8 @@ static void dd844SetClearFlaw(DiskParam *dp, PpWord flawState)
     dp->cylinder = dp->size.maxCylinders - 1;
     dp->track    = 0;
     dp->sector   = 2;
-    fseek(fcb, dd8xxSeek(dp), SEEK_SET);
-    ignore = (int)fread(mySector, 2, SectorSize, fcb);
+    dp->filePos = dd8xxSeek(dp);
+    (void)diskIoRead(dp->ioUnit, dp->filePos, mySector, SectorSize * 2);
 
     /*
     **  Process request.
@@ -2148,8 +2268,8 @@ static void dd844SetClearFlaw(DiskParam *dp, PpWord flawState)
     /*
     **  Update the 844 utility map sector.
     */
-    fseek(fcb, dd8xxSeek(dp), SEEK_SET);
-    dd8xxSectorWrite(dp, fcb, mySector);
+    dp->filePos = dd8xxSeek(dp);
+    dd8xxSectorWrite(dp, mySector);
     }
 
 /*--------------------------------------------------------------------------
@@ -2163,7 +2283,6 @@ static void dd844SetClearFlaw(DiskParam *dp, PpWord flawState)
 **------------------------------------------------------------------------*/
 static char *dd8xxFunc2String(PpWord funcCode)
     {
-#if DEBUG
     switch (funcCode)
         {
     case Fc8xxConnect:
@@ -2268,7 +2387,6 @@ static char *dd8xxFunc2String(PpWord funcCode)
     case Fc8xxStartMemLoad:
         return "StartMemLoad";
         }
-#endif
 
     return "UNKNOWN";
     }
@@ -159,6 +159,12 @@ void deadStart(void)
         ppu[pp].regP   = 0;
         ppu[pp].mem[0] = 0;
 
+        /*
+        **  Forget any spin loop the PP was parked in.
+        */
+        ppu[pp].park  = PpParkNone;
+        ppu[pp].spinP = PpNoSpin;
+
         /*
         **  Set all A registers to an input word count of 10000.
         */
@@ -0,0 +1,867 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: devlog.c
+**
+**  Description:
+**      Runtime switchable device logging.
+**
+**      Device modules register a named log module at initialisation and
+**      test its level before producing a record, so logging costs a
+**      single compare while it is off. Records are copied, without any
+**      formatting beyond what the caller asked for, into a ring buffer
+**      owned by the calling thread. Rings have a single producer and a
+**      single consumer, so no locks are taken on the emulation side. A
+**      background thread drains all rings, formats binary records and
+**      writes each module's records to its own log file. Levels are set
+**      with the set_device_log operator command.
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define DevLogMaxModules        64
+#define DevLogMaxRings          16
+#define DevLogRingSize          (128 * 1024)    /* power of two */
+#define DevLogMaxText           1024
+#define DevLogDrainMsec         50
+
+/*
+**  Record kinds.
+*/
+#define DevLogKindPad           0
+#define DevLogKindText          1
+#define DevLogKindWords         2
+#define DevLogKindBytes         3
+
+/*
+**  Layout of formatted data lines.
+*/
+#define DevLogWordsPerLine      5
+#define DevLogBytesPerLine      16
+#define DevLogLineLength        80
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+#define DevLogAlign(n)          (((n) + sizeof(DevLogHeader) - 1) & ~(sizeof(DevLogHeader) - 1))
+
+#if defined(_WIN32)
+#define DevLogThreadLocal       __declspec(thread)
+#define DevLogLoad(p)           (*(volatile u32 *)(p))
+#define DevLogStore(p, v)       (*(volatile u32 *)(p) = (v))
+#define DevLogFetchAdd(p, v)    ((u32)InterlockedExchangeAdd((volatile LONG *)(p), (v)))
+#else
+#define DevLogThreadLocal       __thread
+#define DevLogLoad(p)           __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define DevLogStore(p, v)       __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define DevLogFetchAdd(p, v)    __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#endif
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+typedef struct devLogHeader
+    {
+    u32 length;                         /* payload length in bytes */
+    u16 module;                         /* module id */
+    u16 kind;                           /* record kind */
+    } DevLogHeader;
+
+typedef struct devLogRing
+    {
+    u32 head;                           /* written by the owning thread */
+    u32 tail;                           /* written by the drain thread */
+    u8  data[DevLogRingSize];
+    } DevLogRing;
+
+/*
+**  Drain thread state of a module.
+*/
+typedef struct devLogOutput
+    {
+    FILE *log;                          /* module log file */
+    int  kind;                          /* kind of data in partial line */
+    int  col;                           /* items in partial line */
+    char line[DevLogLineLength + 1];    /* partial data line */
+    } DevLogOutput;
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static DevLogRing *devLogClaimRing(void);
+static void       devLogDrain(void);
+static void       devLogDrainRings(void);
+static void       devLogFormat(DevLogModule *mp, DevLogHeader *hp, u8 *payload);
+static void       devLogLineFlush(DevLogOutput *op);
+static void       devLogPut(DevLogModule *mp, u16 kind, void *data, u32 len);
+static void       devLogStartThread(void);
+
+#if defined(_WIN32)
+static void devLogThread(void *param);
+
+#else
+static void *devLogThread(void *param);
+
+#endif
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static const char hexDigits[] = "0123456789abcdef";
+
+static char *levelNames[] =
+    {
+    "off",
+    "error",
+    "info",
+    "debug"
+    };
+
+static DevLogModule devLogModules[DevLogMaxModules];
+static DevLogOutput devLogOutputs[DevLogMaxModules];
+static int          devLogModuleCount = 0;
+
+static DevLogRing *devLogRings[DevLogMaxRings];
+static u32        devLogRingCount = 0;
+static u32        devLogNoRing    = 0;
+
+static DevLogThreadLocal DevLogRing *devLogThreadRing = NULL;
+static DevLogThreadLocal bool       devLogThreadNoRing = FALSE;
+
+static bool devLogThreadStarted = FALSE;
+static bool devLogTerminated    = FALSE;
+
+#if defined(_WIN32)
+static CRITICAL_SECTION devLogDrainLock;
+#else
+static pthread_mutex_t devLogDrainLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Register a log module. Registering a name a second
+**                  time returns the existing module.
+**
+**  Parameters:     Name        Description.
+**                  name        Module name, also names the log file.
+**
+**  Returns:        Pointer to module.
+**
+**------------------------------------------------------------------------*/
+DevLogModule *devLogRegister(char *name)
+    {
+    int          i;
+    DevLogModule *mp;
+
+    for (i = 0; i < devLogModuleCount; i++)
+        {
+        if (strcmp(devLogModules[i].name, name) == 0)
+            {
+            return (&devLogModules[i]);
+            }
+        }
+
+    if (devLogModuleCount >= DevLogMaxModules)
+        {
+        logDtError(LogErrorLocation, "Too many device log modules\n");
+        exit(1);
+        }
+
+    mp = &devLogModules[devLogModuleCount];
+    strncpy(mp->name, name, sizeof(mp->name) - 1);
+    mp->level = DevLogOff;
+    mp->lost  = 0;
+    mp->id    = (u8)devLogModuleCount;
+    devLogModuleCount += 1;
+
+    return (mp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Log a formatted text record.
+**
+**  Parameters:     Name        Description.
+**                  mp          Module.
+**                  format      printf style format.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void devLogText(DevLogModule *mp, char *format, ...)
+    {
+    char    buf[DevLogMaxText];
+    int     len;
+    va_list args;
+
+    va_start(args, format);
+    len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (len < 0)
+        {
+        return;
+        }
+
+    if (len >= (int)sizeof(buf))
+        {
+        len = sizeof(buf) - 1;
+        }
+
+    devLogPut(mp, DevLogKindText, buf, (u32)len);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Log 12 bit channel words. Consecutive word records
+**                  are shown as octal and display code dump lines.
+**
+**  Parameters:     Name        Description.
+**                  mp          Module.
+**                  words       Words to log.
+**                  count       Number of words.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void devLogWords(DevLogModule *mp, PpWord *words, int count)
+    {
+    devLogPut(mp, DevLogKindWords, words, (u32)(count * sizeof(PpWord)));
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Log raw bytes. Consecutive byte records are shown as
+**                  hex and ASCII dump lines.
+**
+**  Parameters:     Name        Description.
+**                  mp          Module.
+**                  bytes       Bytes to log.
+**                  len         Number of bytes.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void devLogBytes(DevLogModule *mp, u8 *bytes, int len)
+    {
+    devLogPut(mp, DevLogKindBytes, bytes, (u32)len);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Set the level of one module, or of all modules.
+**
+**  Parameters:     Name        Description.
+**                  name        Module name or "all".
+**                  level       Level name.
+**
+**  Returns:        TRUE if module and level are valid.
+**
+**------------------------------------------------------------------------*/
+bool devLogSetLevel(char *name, char *level)
+    {
+    int  i;
+    int  lvl;
+    bool all;
+    bool found = FALSE;
+
+    for (lvl = DevLogOff; lvl <= DevLogDebug; lvl++)
+        {
+        if (strcasecmp(level, levelNames[lvl]) == 0)
+            {
+            break;
+            }
+        }
+
+    if (lvl > DevLogDebug)
+        {
+        return (FALSE);
+        }
+
+    all = strcasecmp(name, "all") == 0;
+    for (i = 0; i < devLogModuleCount; i++)
+        {
+        if (all || (strcasecmp(devLogModules[i].name, name) == 0))
+            {
+            devLogModules[i].level = lvl;
+            found                  = TRUE;
+            }
+        }
+
+    if (found && (lvl != DevLogOff) && !devLogThreadStarted)
+        {
+        devLogStartThread();
+        }
+
+    return (found);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Show registered modules and their levels.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void devLogShow(void)
+    {
+    int          i;
+    DevLogModule *mp;
+    char         outBuf[80];
+
+    if (devLogModuleCount == 0)
+        {
+        opDisplay("    > No device log modules registered\n");
+
+        return;
+        }
+
+    opDisplay("    > Module           Level  Lost records\n");
+    for (i = 0; i < devLogModuleCount; i++)
+        {
+        mp = &devLogModules[i];
+        snprintf(outBuf, sizeof(outBuf), "    > %-16s %-6s %12u\n", mp->name, levelNames[mp->level], mp->lost);
+        opDisplay(outBuf);
+        }
+
+    if (devLogNoRing != 0)
+        {
+        sprintf(outBuf, "    > %u records from threads without a ring buffer lost\n", devLogNoRing);
+        opDisplay(outBuf);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out all pending records and close log files.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void devLogTerminate(void)
+    {
+    int i;
+
+    if (!devLogThreadStarted)
+        {
+        return;
+        }
+
+    /*
+    **  The drain thread may still be running, so the final drain and the
+    **  closing of the log files are done under the drain lock, and later
+    **  drains find nothing to do.
+    */
+#if defined(_WIN32)
+    EnterCriticalSection(&devLogDrainLock);
+#else
+    pthread_mutex_lock(&devLogDrainLock);
+#endif
+
+    if (!devLogTerminated)
+        {
+        devLogDrainRings();
+
+        for (i = 0; i < devLogModuleCount; i++)
+            {
+            if (devLogOutputs[i].log != NULL)
+                {
+                devLogLineFlush(&devLogOutputs[i]);
+                fputc('\n', devLogOutputs[i].log);
+                fclose(devLogOutputs[i].log);
+                devLogOutputs[i].log = NULL;
+                }
+            }
+
+        devLogTerminated = TRUE;
+        }
+
+#if defined(_WIN32)
+    LeaveCriticalSection(&devLogDrainLock);
+#else
+    pthread_mutex_unlock(&devLogDrainLock);
+#endif
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Copy a record into the calling thread's ring buffer.
+**
+**  Parameters:     Name        Description.
+**                  mp          Module.
+**                  kind        Record kind.
+**                  data        Record payload.
+**                  len         Payload length in bytes.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogPut(DevLogModule *mp, u16 kind, void *data, u32 len)
+    {
+    u32          contiguous;
+    DevLogRing   *rp;
+    DevLogHeader *hp;
+    u32          head;
+    u32          need;
+    u32          offset;
+    u32          room;
+
+    rp = devLogThreadRing;
+    if (rp == NULL)
+        {
+        rp = devLogClaimRing();
+        if (rp == NULL)
+            {
+            DevLogFetchAdd(&devLogNoRing, 1);
+
+            return;
+            }
+        }
+
+    need = (u32)DevLogAlign(sizeof(DevLogHeader) + len);
+    if (need > DevLogRingSize / 4)
+        {
+        DevLogFetchAdd(&mp->lost, 1);
+
+        return;
+        }
+
+    head       = rp->head;
+    room       = DevLogRingSize - (head - DevLogLoad(&rp->tail));
+    offset     = head & (DevLogRingSize - 1);
+    contiguous = DevLogRingSize - offset;
+
+    /*
+    **  Records never wrap, the rest of the ring is skipped with a pad
+    **  record instead.
+    */
+    if (contiguous < need)
+        {
+        if (room < contiguous + need)
+            {
+            DevLogFetchAdd(&mp->lost, 1);
+
+            return;
+            }
+
+        hp         = (DevLogHeader *)(rp->data + offset);
+        hp->length = contiguous - sizeof(DevLogHeader);
+        hp->module = 0;
+        hp->kind   = DevLogKindPad;
+        head      += contiguous;
+        offset     = 0;
+        }
+    else if (room < need)
+        {
+        DevLogFetchAdd(&mp->lost, 1);
+
+        return;
+        }
+
+    hp         = (DevLogHeader *)(rp->data + offset);
+    hp->length = len;
+    hp->module = mp->id;
+    hp->kind   = kind;
+    memcpy(hp + 1, data, len);
+
+    DevLogStore(&rp->head, head + need);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Allocate a ring buffer for the calling thread.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Pointer to ring or NULL if none is available.
+**
+**------------------------------------------------------------------------*/
+static DevLogRing *devLogClaimRing(void)
+    {
+    u32        index;
+    DevLogRing *rp;
+
+    if (devLogThreadNoRing)
+        {
+        return (NULL);
+        }
+
+    index = DevLogFetchAdd(&devLogRingCount, 1);
+    if (index >= DevLogMaxRings)
+        {
+        devLogThreadNoRing = TRUE;
+
+        return (NULL);
+        }
+
+    rp = (DevLogRing *)calloc(1, sizeof(DevLogRing));
+    if (rp == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate device log ring buffer\n");
+        exit(1);
+        }
+
+#if defined(_WIN32)
+    InterlockedExchangePointer((PVOID volatile *)&devLogRings[index], rp);
+#else
+    __atomic_store_n(&devLogRings[index], rp, __ATOMIC_RELEASE);
+#endif
+    devLogThreadRing = rp;
+
+    return (rp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out the records in all ring buffers.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogDrain(void)
+    {
+#if defined(_WIN32)
+    EnterCriticalSection(&devLogDrainLock);
+#else
+    pthread_mutex_lock(&devLogDrainLock);
+#endif
+
+    if (!devLogTerminated)
+        {
+        devLogDrainRings();
+        }
+
+#if defined(_WIN32)
+    LeaveCriticalSection(&devLogDrainLock);
+#else
+    pthread_mutex_unlock(&devLogDrainLock);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out the records in all ring buffers. The caller
+**                  holds the drain lock.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogDrainRings(void)
+    {
+    u32          count;
+    u32          head;
+    DevLogHeader *hp;
+    int          i;
+    DevLogRing   *rp;
+    u32          tail;
+
+    count = DevLogLoad(&devLogRingCount);
+    if (count > DevLogMaxRings)
+        {
+        count = DevLogMaxRings;
+        }
+
+    for (i = 0; i < (int)count; i++)
+        {
+#if defined(_WIN32)
+        rp = devLogRings[i];
+#else
+        rp = __atomic_load_n(&devLogRings[i], __ATOMIC_ACQUIRE);
+#endif
+        if (rp == NULL)
+            {
+            continue;
+            }
+
+        tail = rp->tail;
+        head = DevLogLoad(&rp->head);
+        while (tail != head)
+            {
+            hp = (DevLogHeader *)(rp->data + (tail & (DevLogRingSize - 1)));
+            if (hp->kind != DevLogKindPad)
+                {
+                devLogFormat(&devLogModules[hp->module], hp, (u8 *)(hp + 1));
+                }
+
+            tail += (u32)DevLogAlign(sizeof(DevLogHeader) + hp->length);
+            }
+
+        DevLogStore(&rp->tail, tail);
+        }
+
+    for (i = 0; i < devLogModuleCount; i++)
+        {
+        if (devLogOutputs[i].log != NULL)
+            {
+            fflush(devLogOutputs[i].log);
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write a record to its module's log file.
+**
+**  Parameters:     Name        Description.
+**                  mp          Module.
+**                  hp          Record header.
+**                  payload     Record payload.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogFormat(DevLogModule *mp, DevLogHeader *hp, u8 *payload)
+    {
+    u8           b;
+    char         *cp;
+    char         fileName[32];
+    u32          i;
+    DevLogOutput *op = &devLogOutputs[mp->id];
+    PpWord       word;
+
+    if (op->log == NULL)
+        {
+        /*
+        **  Never reopen (and so truncate) a log file once it was closed.
+        */
+        if (devLogTerminated)
+            {
+            return;
+            }
+
+        sprintf(fileName, "%slog.txt", mp->name);
+        op->log = fopen(fileName, "wt");
+        if (op->log == NULL)
+            {
+            logDtError(LogErrorLocation, "Cannot open %s - logging for %s turned off\n", fileName, mp->name);
+            mp->level = DevLogOff;
+
+            return;
+            }
+        }
+
+    if ((hp->kind != op->kind) || (hp->kind == DevLogKindText))
+        {
+        devLogLineFlush(op);
+        op->kind = hp->kind;
+        }
+
+    switch (hp->kind)
+        {
+    case DevLogKindText:
+        fwrite(payload, 1, hp->length, op->log);
+        break;
+
+    case DevLogKindWords:
+        /*
+        **  Octal words followed by their display code characters.
+        */
+        for (i = 0; i < hp->length / sizeof(PpWord); i++)
+            {
+            if (op->col == 0)
+                {
+                memset(op->line, ' ', DevLogLineLength);
+                op->line[0] = '\n';
+                }
+
+            memcpy(&word, payload + i * sizeof(PpWord), sizeof(PpWord));
+            cp    = op->line + 6 + 5 * op->col;
+            cp[0] = '0' + ((word >> 9) & 07);
+            cp[1] = '0' + ((word >> 6) & 07);
+            cp[2] = '0' + ((word >> 3) & 07);
+            cp[3] = '0' + ((word >> 0) & 07);
+            cp    = op->line + 6 + 5 * DevLogWordsPerLine + 2 + 2 * op->col;
+            cp[0] = cdcToAscii[(word >> 6) & Mask6];
+            cp[1] = cdcToAscii[(word >> 0) & Mask6];
+            op->line[6 + 7 * DevLogWordsPerLine + 2] = '\0';
+            if (++op->col == DevLogWordsPerLine)
+                {
+                devLogLineFlush(op);
+                }
+            }
+        break;
+
+    case DevLogKindBytes:
+        /*
+        **  Hex bytes followed by their printable ASCII characters.
+        */
+        for (i = 0; i < hp->length; i++)
+            {
+            if (op->col == 0)
+                {
+                memset(op->line, ' ', DevLogLineLength);
+                op->line[0] = '\n';
+                }
+
+            b     = payload[i];
+            cp    = op->line + 4 + 3 * op->col;
+            cp[0] = hexDigits[b >> 4];
+            cp[1] = hexDigits[b & 0x0f];
+            op->line[4 + 3 * DevLogBytesPerLine + 2 + op->col] = ((b < 0x20) || (b >= 0x7f)) ? '.' : (char)b;
+            op->line[4 + 4 * DevLogBytesPerLine + 2]           = '\0';
+            if (++op->col == DevLogBytesPerLine)
+                {
+                devLogLineFlush(op);
+                }
+            }
+        break;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out a partial dump line.
+**
+**  Parameters:     Name        Description.
+**                  op          Module output state.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogLineFlush(DevLogOutput *op)
+    {
+    if (op->col != 0)
+        {
+        fputs(op->line, op->log);
+        op->col = 0;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Create the drain thread.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void devLogStartThread(void)
+    {
+#if defined(_WIN32)
+    DWORD  dwThreadId;
+    HANDLE hThread;
+
+    InitializeCriticalSection(&devLogDrainLock);
+
+    hThread = CreateThread(
+        NULL,                                       // no security attribute
+        0,                                          // default stack size
+        (LPTHREAD_START_ROUTINE)devLogThread,
+        (LPVOID)NULL,                               // thread parameter
+        0,                                          // not suspended
+        &dwThreadId);                               // returns thread ID
+
+    if (hThread == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to create device log thread\n");
+        exit(1);
+        }
+#else
+    pthread_t      thread;
+    pthread_attr_t attr;
+    int            rc;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thread, &attr, devLogThread, NULL);
+    if (rc != 0)
+        {
+        logDtError(LogErrorLocation, "Failed to create device log thread\n");
+        exit(1);
+        }
+#endif
+
+    devLogThreadStarted = TRUE;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Periodically drain the ring buffers.
+**
+**  Parameters:     Name        Description.
+**                  param       Thread parameter (unused).
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+#if defined(_WIN32)
+static void devLogThread(void *param)
+#else
+static void *devLogThread(void *param)
+#endif
+    {
+    while (emulationActive && !devLogTerminated)
+        {
+        sleepMsec(DevLogDrainMsec);
+        devLogDrain();
+        }
+
+#if !defined(_WIN32)
+    return (NULL);
+#endif
+    }
+
+/*---------------------------  End Of File  ------------------------------*/
@@ -0,0 +1,1223 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: diskio.c
+**
+**  Description:
+**      Asynchronous disk container I/O shared by the disk controllers.
+**
+**      Each container has a FIFO of pending requests which is served in
+**      order by a dedicated worker thread, so writes complete in the
+**      background with per-unit ordering preserved. Controllers may also
+**      ask for a sector to be read ahead (e.g. when a seek completes), so
+**      that the PP's subsequent data requests are satisfied from memory
+**      instead of waiting for the host storage.
+**
+**      On Windows the requests are performed synchronously.
+**
+**      A container may also be an overlay: a read-only base image plus a
+**      sparse delta file receiving all writes. The delta file starts with
+**      a header and a bitmap with one bit per OverlayBlock bytes of the
+**      base image, followed by the data area which mirrors the layout of
+**      the base image. Blocks never written stay holes in the delta file,
+**      so an overlay costs only the space of the data actually changed.
+**      The delta can be committed into the base image or discarded.
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+#include <errno.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#if defined(_WIN32)
+#include <io.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define MaxDiskIoQueue    32
+
+/*
+**  Overlay delta file layout.
+*/
+#define OverlayMagic      "DTCYOVL1"
+#define OverlayBlock      512
+#define OverlayMapOffset  4096
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+#define Overlaps(p1, l1, p2, l2)    (((p1) < (p2) + (l2)) && ((p2) < (p1) + (l1)))
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+typedef enum
+    {
+    DioWrite,
+    DioPrefetch
+    } DiskIoType;
+
+typedef enum
+    {
+    CacheEmpty,
+    CachePending,
+    CacheValid
+    } DiskIoCacheState;
+
+typedef struct diskIoRequest
+    {
+    DiskIoType type;                    /* request type */
+    i64        pos;                     /* byte offset in container */
+    int        len;                     /* length of transfer */
+    u32        generation;              /* cache generation (prefetch only) */
+    u8         data[MaxDiskIoBlock];    /* data to write or read */
+    } DiskIoRequest;
+
+typedef struct overlayHeader
+    {
+    char magic[8];                      /* OverlayMagic */
+    u32  blockSize;                     /* bytes per bitmap bit */
+    u32  mapOffset;                     /* byte offset of bitmap */
+    i64  baseSize;                      /* size of base image */
+    i64  dataOffset;                    /* byte offset of data area */
+    } OverlayHeader;
+
+struct diskIoUnit
+    {
+    struct diskIoUnit *next;            /* next unit in list of all units */
+    FILE              *fcb;             /* container file (base image of overlay) */
+
+    /*
+    **  Overlay delta, NULL for a plain container.
+    */
+    FILE              *delta;           /* delta file */
+    char              baseName[MaxFSPath];
+    OverlayHeader     header;
+    u8                *map;             /* bitmap of blocks held in delta */
+    int               mapLen;
+#if !defined(_WIN32)
+    pthread_t         thread;           /* worker thread */
+    pthread_mutex_t   mutex;            /* protects everything below */
+    pthread_cond_t    cond;             /* signalled on any state change */
+    bool              stop;             /* worker thread must exit */
+
+    /*
+    **  Pending requests.
+    */
+    DiskIoRequest     queue[MaxDiskIoQueue];
+    int               in;
+    int               out;
+    int               count;
+
+    /*
+    **  Read-ahead cache.
+    */
+    DiskIoCacheState  cacheState;
+    u32               cacheGeneration;
+    i64               cachePos;
+    int               cacheLen;
+    u8                cache[MaxDiskIoBlock];
+#endif
+    };
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static int diskIoBlockRead(DiskIoUnit *up, u8 *buf, int len, i64 pos);
+static bool diskIoBlockWrite(DiskIoUnit *up, u8 *buf, int len, i64 pos);
+static i64 diskIoFileSize(FILE *fcb);
+static bool diskIoOverlayReset(DiskIoUnit *up);
+static bool diskIoOverlayTest(DiskIoUnit *up, i64 block);
+static bool diskIoOverlaySet(DiskIoUnit *up, i64 block);
+static int diskIoPread(FILE *fcb, u8 *buf, int len, i64 pos);
+static bool diskIoPwrite(FILE *fcb, u8 *buf, int len, i64 pos);
+static void diskIoStart(DiskIoUnit *up);
+
+#if !defined(_WIN32)
+static bool diskIoIsWritePending(DiskIoUnit *up, i64 pos, int len);
+static void *diskIoThread(void *param);
+
+#endif
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static DiskIoUnit *firstUnit = NULL;
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Start asynchronous I/O on a disk container.
+**
+**  Parameters:     Name        Description.
+**                  fcb         open container file
+**
+**  Returns:        Pointer to I/O unit. After this call, all I/O on the
+**                  container must go through the diskIo functions.
+**
+**------------------------------------------------------------------------*/
+DiskIoUnit *diskIoOpen(FILE *fcb)
+    {
+    DiskIoUnit *up;
+
+    up = (DiskIoUnit *)calloc(1, sizeof(DiskIoUnit));
+    if (up == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate disk I/O unit\n");
+        exit(1);
+        }
+
+    fflush(fcb);
+    up->fcb = fcb;
+    diskIoStart(up);
+
+    return up;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Start asynchronous I/O on an overlay container. The
+**                  delta file is created if it does not yet exist.
+**
+**  Parameters:     Name        Description.
+**                  fcb         base image opened for reading
+**                  baseName    path name of base image
+**                  deltaName   path name of delta file
+**
+**  Returns:        Pointer to I/O unit, or NULL if the delta file could
+**                  not be opened or does not belong to the base image.
+**
+**------------------------------------------------------------------------*/
+DiskIoUnit *diskIoOpenOverlay(FILE *fcb, char *baseName, char *deltaName)
+    {
+    DiskIoUnit    *up;
+    OverlayHeader *hp;
+    i64           blocks;
+
+    up = (DiskIoUnit *)calloc(1, sizeof(DiskIoUnit));
+    if (up == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate disk I/O unit\n");
+        exit(1);
+        }
+
+    up->fcb = fcb;
+    hp      = &up->header;
+    strcpy(up->baseName, baseName);
+
+    /*
+    **  The bitmap covers the base image as it is now.
+    */
+    blocks     = (diskIoFileSize(fcb) + OverlayBlock - 1) / OverlayBlock;
+    up->mapLen = (int)((blocks + 7) / 8);
+
+    up->map = (u8 *)calloc(1, up->mapLen);
+    if (up->map == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate overlay bitmap\n");
+        exit(1);
+        }
+
+    up->delta = fopen(deltaName, "r+b");
+    if (up->delta != NULL)
+        {
+        /*
+        **  Existing delta - check that it belongs to this base image.
+        */
+        if ((fread(hp, sizeof(OverlayHeader), 1, up->delta) != 1)
+            || (memcmp(hp->magic, OverlayMagic, sizeof hp->magic) != 0)
+            || (hp->blockSize != OverlayBlock)
+            || ((hp->baseSize + OverlayBlock - 1) / OverlayBlock != blocks)
+            || (diskIoPread(up->delta, up->map, up->mapLen, hp->mapOffset) != up->mapLen))
+            {
+            logDtError(LogErrorLocation, "%s is not an overlay of %s\n", deltaName, baseName);
+            fclose(up->delta);
+            free(up->map);
+            free(up);
+
+            return NULL;
+            }
+        }
+    else
+        {
+        /*
+        **  New delta - write header and empty bitmap. The data area is
+        **  aligned so that its blocks line up with host file system blocks.
+        */
+        up->delta = fopen(deltaName, "w+b");
+        if (up->delta == NULL)
+            {
+            logDtError(LogErrorLocation, "Failed to open %s\n", deltaName);
+            free(up->map);
+            free(up);
+
+            return NULL;
+            }
+
+        memcpy(hp->magic, OverlayMagic, sizeof hp->magic);
+        hp->blockSize  = OverlayBlock;
+        hp->mapOffset  = OverlayMapOffset;
+        hp->baseSize   = blocks * OverlayBlock;
+        hp->dataOffset = (OverlayMapOffset + up->mapLen + OverlayMapOffset - 1) / OverlayMapOffset * OverlayMapOffset;
+        if (!diskIoPwrite(up->delta, (u8 *)hp, sizeof(OverlayHeader), 0)
+            || !diskIoPwrite(up->delta, up->map, up->mapLen, hp->mapOffset))
+            {
+            logDtError(LogErrorLocation, "Failed to initialise %s\n", deltaName);
+            fclose(up->delta);
+            free(up->map);
+            free(up);
+
+            return NULL;
+            }
+        }
+
+    fflush(up->delta);
+    diskIoStart(up);
+
+    return up;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Complete all pending requests and stop asynchronous
+**                  I/O on a disk container. The container file itself
+**                  is left open.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void diskIoClose(DiskIoUnit *up)
+    {
+    DiskIoUnit **upp;
+
+    if (up == NULL)
+        {
+        return;
+        }
+
+    diskIoFlush(up);
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&up->mutex);
+    up->stop = TRUE;
+    pthread_cond_broadcast(&up->cond);
+    pthread_mutex_unlock(&up->mutex);
+    pthread_join(up->thread, NULL);
+    pthread_cond_destroy(&up->cond);
+    pthread_mutex_destroy(&up->mutex);
+#endif
+
+    for (upp = &firstUnit; *upp != NULL; upp = &(*upp)->next)
+        {
+        if (*upp == up)
+            {
+            *upp = up->next;
+            break;
+            }
+        }
+
+    if (up->delta != NULL)
+        {
+        fclose(up->delta);
+        free(up->map);
+        }
+
+    free(up);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Merge the delta of an overlay container into its base
+**                  image and start over with an empty delta.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        TRUE if successful.
+**
+**------------------------------------------------------------------------*/
+bool diskIoCommit(DiskIoUnit *up)
+    {
+    FILE *fcb;
+    i64  block;
+    i64  pos;
+    bool ok = TRUE;
+    u8   buf[OverlayBlock];
+
+    if (up->delta == NULL)
+        {
+        return FALSE;
+        }
+
+    diskIoFlush(up);
+
+    /*
+    **  The base image is normally shared read-only, so open a separate
+    **  writable stream just for the duration of the merge.
+    */
+    fcb = fopen(up->baseName, "r+b");
+    if (fcb == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to open %s for update\n", up->baseName);
+
+        return FALSE;
+        }
+
+    for (block = 0; ok && block < (i64)up->mapLen * 8; block++)
+        {
+        if (!diskIoOverlayTest(up, block))
+            {
+            continue;
+            }
+
+        pos = block * OverlayBlock;
+        ok  = (diskIoPread(up->delta, buf, OverlayBlock, up->header.dataOffset + pos) == OverlayBlock)
+              && diskIoPwrite(fcb, buf, OverlayBlock, pos);
+        }
+
+    if (fclose(fcb) != 0)
+        {
+        ok = FALSE;
+        }
+
+    if (!ok)
+        {
+        logDtError(LogErrorLocation, "Failed to commit overlay into %s\n", up->baseName);
+
+        return FALSE;
+        }
+
+    return diskIoOverlayReset(up);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Throw away the delta of an overlay container, so that
+**                  it shows the unmodified base image again.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        TRUE if successful.
+**
+**------------------------------------------------------------------------*/
+bool diskIoDiscard(DiskIoUnit *up)
+    {
+    if (up->delta == NULL)
+        {
+        return FALSE;
+        }
+
+    diskIoFlush(up);
+
+    return diskIoOverlayReset(up);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether a container is an overlay.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        TRUE if overlay.
+**
+**------------------------------------------------------------------------*/
+bool diskIoIsOverlay(DiskIoUnit *up)
+    {
+    return up != NULL && up->delta != NULL;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Wait until all pending requests of a disk container
+**                  have completed.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void diskIoFlush(DiskIoUnit *up)
+    {
+#if defined(_WIN32)
+    fflush(up->fcb);
+#else
+    pthread_mutex_lock(&up->mutex);
+    while (up->count > 0)
+        {
+        pthread_cond_wait(&up->cond, &up->mutex);
+        }
+    pthread_mutex_unlock(&up->mutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Request that a block of a disk container be read ahead.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  pos         byte offset of block
+**                  len         length of block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void diskIoPrefetch(DiskIoUnit *up, i64 pos, int len)
+    {
+#if defined(_WIN32)
+    (void)up;
+    (void)pos;
+    (void)len;
+#else
+    DiskIoRequest *rp;
+
+    if (len > MaxDiskIoBlock)
+        {
+        return;
+        }
+
+    pthread_mutex_lock(&up->mutex);
+
+    /*
+    **  Nothing to do if the block is already cached or on its way, and
+    **  read-ahead is dropped rather than waited for if the queue is full.
+    */
+    if (((up->cacheState != CacheEmpty) && (up->cachePos == pos) && (up->cacheLen >= len))
+        || (up->count >= MaxDiskIoQueue))
+        {
+        pthread_mutex_unlock(&up->mutex);
+
+        return;
+        }
+
+    up->cacheGeneration += 1;
+    up->cacheState       = CachePending;
+    up->cachePos         = pos;
+    up->cacheLen         = len;
+
+    rp             = up->queue + up->in;
+    rp->type       = DioPrefetch;
+    rp->pos        = pos;
+    rp->len        = len;
+    rp->generation = up->cacheGeneration;
+    up->in         = (up->in + 1) % MaxDiskIoQueue;
+    up->count     += 1;
+
+    pthread_cond_broadcast(&up->cond);
+    pthread_mutex_unlock(&up->mutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read a block from a disk container. The data is taken
+**                  from the read-ahead cache if possible, otherwise it is
+**                  read once all pending writes to the block completed.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  pos         byte offset of block
+**                  buf         buffer to receive the data
+**                  len         length of block
+**
+**  Returns:        Number of bytes read from the container. The rest of
+**                  the buffer is zero filled.
+**
+**------------------------------------------------------------------------*/
+int diskIoRead(DiskIoUnit *up, i64 pos, void *buf, int len)
+    {
+    int n;
+
+    metrics.diskReads     += 1;
+    metrics.diskReadBytes += len;
+
+#if defined(_WIN32)
+    n = diskIoBlockRead(up, buf, len, pos);
+#else
+    pthread_mutex_lock(&up->mutex);
+    for (;;)
+        {
+        if ((up->cacheState == CacheEmpty)
+            || (pos < up->cachePos)
+            || (pos + len > up->cachePos + up->cacheLen))
+            {
+            break;
+            }
+
+        if (up->cacheState == CacheValid)
+            {
+            memcpy(buf, up->cache + (pos - up->cachePos), len);
+            pthread_mutex_unlock(&up->mutex);
+
+            return len;
+            }
+
+        pthread_cond_wait(&up->cond, &up->mutex);
+        }
+
+    while (diskIoIsWritePending(up, pos, len))
+        {
+        pthread_cond_wait(&up->cond, &up->mutex);
+        }
+    pthread_mutex_unlock(&up->mutex);
+
+    n = diskIoBlockRead(up, buf, len, pos);
+#endif
+
+    if (n < 0)
+        {
+        n = 0;
+        }
+
+    if (n < len)
+        {
+        memset((u8 *)buf + n, 0, len - n);
+        }
+
+    return n;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Queue a block to be written to a disk container.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  pos         byte offset of block
+**                  buf         data to write
+**                  len         length of block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void diskIoWrite(DiskIoUnit *up, i64 pos, void *buf, int len)
+    {
+    metrics.diskWrites     += 1;
+    metrics.diskWriteBytes += len;
+
+#if defined(_WIN32)
+    if (!diskIoBlockWrite(up, buf, len, pos))
+        {
+        logDtError(LogErrorLocation, "Disk write of %d bytes at offset %ld failed\n", len, (long)pos);
+        }
+#else
+    DiskIoRequest *rp;
+
+    if (len > MaxDiskIoBlock)
+        {
+        logDtError(LogErrorLocation, "Disk write of %d bytes exceeds maximum block size\n", len);
+
+        return;
+        }
+
+    pthread_mutex_lock(&up->mutex);
+
+    /*
+    **  A write invalidates overlapping read-ahead data, including data
+    **  which is still being read.
+    */
+    if ((up->cacheState != CacheEmpty) && Overlaps(pos, len, up->cachePos, up->cacheLen))
+        {
+        up->cacheGeneration += 1;
+        up->cacheState       = CacheEmpty;
+        }
+
+    while (up->count >= MaxDiskIoQueue)
+        {
+        pthread_cond_wait(&up->cond, &up->mutex);
+        }
+
+    rp       = up->queue + up->in;
+    rp->type = DioWrite;
+    rp->pos  = pos;
+    rp->len  = len;
+    memcpy(rp->data, buf, len);
+    up->in     = (up->in + 1) % MaxDiskIoQueue;
+    up->count += 1;
+
+    pthread_cond_broadcast(&up->cond);
+    pthread_mutex_unlock(&up->mutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Complete pending I/O of all disk containers.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void diskIoTerminate(void)
+    {
+    while (firstUnit != NULL)
+        {
+        diskIoClose(firstUnit);
+        }
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read a block from a container, taking the parts held
+**                  in the delta of an overlay from there.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  buf         buffer to receive data
+**                  len         number of bytes to read
+**                  pos         byte offset
+**
+**  Returns:        Number of bytes read, or -1 on error.
+**
+**------------------------------------------------------------------------*/
+static int diskIoBlockRead(DiskIoUnit *up, u8 *buf, int len, i64 pos)
+    {
+    int  done;
+    int  n;
+    int  run;
+    bool inDelta;
+
+    if (up->delta == NULL)
+        {
+        return diskIoPread(up->fcb, buf, len, pos);
+        }
+
+    /*
+    **  Split the request into runs of blocks which come from the same file.
+    */
+    for (done = 0; done < len; done += run)
+        {
+        inDelta = diskIoOverlayTest(up, (pos + done) / OverlayBlock);
+        run     = OverlayBlock - (int)((pos + done) % OverlayBlock);
+        while ((done + run < len) && (diskIoOverlayTest(up, (pos + done + run) / OverlayBlock) == inDelta))
+            {
+            run += OverlayBlock;
+            }
+
+        if (done + run > len)
+            {
+            run = len - done;
+            }
+
+        if (inDelta)
+            {
+            n = diskIoPread(up->delta, buf + done, run, up->header.dataOffset + pos + done);
+            }
+        else
+            {
+            n = diskIoPread(up->fcb, buf + done, run, pos + done);
+            }
+
+        if (n < 0)
+            {
+            return -1;
+            }
+
+        if (n < run)
+            {
+            memset(buf + done + n, 0, run - n);
+            }
+        }
+
+    return len;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write a block to a container. For an overlay the data
+**                  goes to the delta, and partially written blocks are
+**                  completed from the base image first.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  buf         data to write
+**                  len         number of bytes to write
+**                  pos         byte offset
+**
+**  Returns:        TRUE if all data was written.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoBlockWrite(DiskIoUnit *up, u8 *buf, int len, i64 pos)
+    {
+    i64 block;
+    int offset;
+    int part;
+    int n;
+    u8  merge[OverlayBlock];
+
+    if (up->delta == NULL)
+        {
+        return diskIoPwrite(up->fcb, buf, len, pos);
+        }
+
+    if (pos + len > up->header.baseSize)
+        {
+        errno = ENOSPC;
+
+        return FALSE;
+        }
+
+    while (len > 0)
+        {
+        block  = pos / OverlayBlock;
+        offset = (int)(pos % OverlayBlock);
+        part   = OverlayBlock - offset;
+        if (part > len)
+            {
+            part = len;
+            }
+
+        if ((part < OverlayBlock) && !diskIoOverlayTest(up, block))
+            {
+            n = diskIoPread(up->fcb, merge, OverlayBlock, block * OverlayBlock);
+            if (n < 0)
+                {
+                return FALSE;
+                }
+
+            memset(merge + n, 0, OverlayBlock - n);
+            memcpy(merge + offset, buf, part);
+            if (!diskIoPwrite(up->delta, merge, OverlayBlock, up->header.dataOffset + block * OverlayBlock))
+                {
+                return FALSE;
+                }
+            }
+        else if (!diskIoPwrite(up->delta, buf, part, up->header.dataOffset + pos))
+            {
+            return FALSE;
+            }
+
+        if (!diskIoOverlaySet(up, block))
+            {
+            return FALSE;
+            }
+
+        buf += part;
+        pos += part;
+        len -= part;
+        }
+
+    return TRUE;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine the size of a file, which may exceed what a
+**                  long can hold.
+**
+**  Parameters:     Name        Description.
+**                  fcb         file
+**
+**  Returns:        Size in bytes.
+**
+**------------------------------------------------------------------------*/
+static i64 diskIoFileSize(FILE *fcb)
+    {
+#if defined(_WIN32)
+    _fseeki64(fcb, 0, SEEK_END);
+
+    return (i64)_ftelli64(fcb);
+#else
+    fseeko(fcb, 0, SEEK_END);
+
+    return (i64)ftello(fcb);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Empty the delta of an overlay container. Caller must
+**                  have flushed pending requests.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        TRUE if successful.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoOverlayReset(DiskIoUnit *up)
+    {
+    bool ok;
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&up->mutex);
+    up->cacheGeneration += 1;
+    up->cacheState       = CacheEmpty;
+#endif
+    memset(up->map, 0, up->mapLen);
+    ok = diskIoPwrite(up->delta, up->map, up->mapLen, up->header.mapOffset);
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&up->mutex);
+#endif
+
+    /*
+    **  Give the space of the old data back to the host.
+    */
+    fflush(up->delta);
+#if defined(_WIN32)
+    ok = ok && _chsize_s(_fileno(up->delta), up->header.dataOffset) == 0;
+#else
+    ok = ok && ftruncate(fileno(up->delta), (off_t)up->header.dataOffset) == 0;
+#endif
+
+    if (!ok)
+        {
+        logDtError(LogErrorLocation, "Failed to reset overlay of %s\n", up->baseName);
+        }
+
+    return ok;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether an overlay block is held in the delta.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  block       block number
+**
+**  Returns:        TRUE if the block is in the delta.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoOverlayTest(DiskIoUnit *up, i64 block)
+    {
+    bool result;
+
+    if (block >= (i64)up->mapLen * 8)
+        {
+        return FALSE;
+        }
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&up->mutex);
+#endif
+    result = (up->map[block >> 3] & (1 << (block & 7))) != 0;
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&up->mutex);
+#endif
+
+    return result;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Record that an overlay block is held in the delta.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  block       block number
+**
+**  Returns:        TRUE if the bitmap was updated successfully.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoOverlaySet(DiskIoUnit *up, i64 block)
+    {
+    u8  *mp = up->map + (block >> 3);
+    u8  bits;
+    u8  mask = (u8)(1 << (block & 7));
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&up->mutex);
+#endif
+    bits = *mp;
+    *mp |= mask;
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&up->mutex);
+#endif
+
+    if ((bits & mask) != 0)
+        {
+        return TRUE;
+        }
+
+    /*
+    **  The bitmap byte is only written by the thread doing the writes, so
+    **  it can be written back outside the lock.
+    */
+    bits |= mask;
+
+    return diskIoPwrite(up->delta, &bits, 1, up->header.mapOffset + (block >> 3));
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read from a file at a given offset, retrying partial
+**                  and interrupted reads.
+**
+**  Parameters:     Name        Description.
+**                  fcb         file
+**                  buf         buffer to receive data
+**                  len         number of bytes to read
+**                  pos         byte offset
+**
+**  Returns:        Number of bytes read, or -1 on error.
+**
+**------------------------------------------------------------------------*/
+static int diskIoPread(FILE *fcb, u8 *buf, int len, i64 pos)
+    {
+#if defined(_WIN32)
+    if (_fseeki64(fcb, pos, SEEK_SET) != 0)
+        {
+        return -1;
+        }
+
+    return (int)fread(buf, 1, len, fcb);
+#else
+    int     done = 0;
+    int     fd   = fileno(fcb);
+    ssize_t n;
+
+    while (done < len)
+        {
+        n = pread(fd, buf + done, len - done, (off_t)(pos + done));
+        if (n < 0)
+            {
+            if (errno == EINTR)
+                {
+                continue;
+                }
+
+            return -1;
+            }
+        else if (n == 0)
+            {
+            break;
+            }
+
+        done += (int)n;
+        }
+
+    return done;
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write to a file at a given offset, retrying partial
+**                  and interrupted writes.
+**
+**  Parameters:     Name        Description.
+**                  fcb         file
+**                  buf         data to write
+**                  len         number of bytes to write
+**                  pos         byte offset
+**
+**  Returns:        TRUE if all data was written.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoPwrite(FILE *fcb, u8 *buf, int len, i64 pos)
+    {
+#if defined(_WIN32)
+    if (_fseeki64(fcb, pos, SEEK_SET) != 0)
+        {
+        return FALSE;
+        }
+
+    return fwrite(buf, 1, len, fcb) == (size_t)len;
+#else
+    int     done = 0;
+    int     fd   = fileno(fcb);
+    ssize_t n;
+
+    while (done < len)
+        {
+        n = pwrite(fd, buf + done, len - done, (off_t)(pos + done));
+        if (n < 0)
+            {
+            if (errno == EINTR)
+                {
+                continue;
+                }
+
+            return FALSE;
+            }
+
+        done += (int)n;
+        }
+
+    return TRUE;
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Start the request processing of an I/O unit and link
+**                  it into the list of units.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void diskIoStart(DiskIoUnit *up)
+    {
+#if !defined(_WIN32)
+    up->cacheState = CacheEmpty;
+    pthread_mutex_init(&up->mutex, NULL);
+    pthread_cond_init(&up->cond, NULL);
+    if (pthread_create(&up->thread, NULL, diskIoThread, up) != 0)
+        {
+        logDtError(LogErrorLocation, "Failed to create disk I/O thread\n");
+        exit(1);
+        }
+#endif
+
+    up->next  = firstUnit;
+    firstUnit = up;
+    }
+
+#if !defined(_WIN32)
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether a write overlapping a block is still
+**                  pending. Caller must hold the unit's mutex.
+**
+**  Parameters:     Name        Description.
+**                  up          pointer to I/O unit
+**                  pos         byte offset of block
+**                  len         length of block
+**
+**  Returns:        TRUE if an overlapping write is pending.
+**
+**------------------------------------------------------------------------*/
+static bool diskIoIsWritePending(DiskIoUnit *up, i64 pos, int len)
+    {
+    int           i;
+    DiskIoRequest *rp;
+
+    for (i = 0; i < up->count; i++)
+        {
+        rp = up->queue + ((up->out + i) % MaxDiskIoQueue);
+        if ((rp->type == DioWrite) && Overlaps(pos, len, rp->pos, rp->len))
+            {
+            return TRUE;
+            }
+        }
+
+    return FALSE;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Worker thread serving the request queue of a disk
+**                  container.
+**
+**  Parameters:     Name        Description.
+**                  param       pointer to I/O unit
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void *diskIoThread(void *param)
+    {
+    int           n;
+    DiskIoRequest *rp;
+    DiskIoUnit    *up = (DiskIoUnit *)param;
+
+    pthread_mutex_lock(&up->mutex);
+    for (;;)
+        {
+        while ((up->count == 0) && !up->stop)
+            {
+            pthread_cond_wait(&up->cond, &up->mutex);
+            }
+
+        if (up->count == 0)
+            {
+            break;
+            }
+
+        /*
+        **  The request stays in the queue while it is being processed, so
+        **  that readers see the write as pending until it is done.
+        */
+        rp = up->queue + up->out;
+        pthread_mutex_unlock(&up->mutex);
+
+        if (rp->type == DioWrite)
+            {
+            if (!diskIoBlockWrite(up, rp->data, rp->len, rp->pos))
+                {
+                logDtError(LogErrorLocation, "Disk write of %d bytes at offset %ld failed: %s\n",
+                           rp->len, (long)rp->pos, strerror(errno));
+                }
+            n = rp->len;
+            }
+        else
+            {
+            n = diskIoBlockRead(up, rp->data, rp->len, rp->pos);
+            if (n < 0)
+                {
+                n = 0;
+                }
+            }
+
+        pthread_mutex_lock(&up->mutex);
+        if ((rp->type == DioPrefetch) && (rp->generation == up->cacheGeneration))
+            {
+            memcpy(up->cache, rp->data, n);
+            memset(up->cache + n, 0, rp->len - n);
+            up->cacheState = CacheValid;
+            }
+
+        up->out    = (up->out + 1) % MaxDiskIoQueue;
+        up->count -= 1;
+        pthread_cond_broadcast(&up->cond);
+        }
+    pthread_mutex_unlock(&up->mutex);
+
+    return NULL;
+    }
+
+#endif
+
+/*---------------------------  End Of File  ------------------------------*/
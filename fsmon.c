@@ -55,12 +55,20 @@
 
 #endif
 
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
 
 /*
 **  -----------------
 **  Private Constants
 **  -----------------
 */
+#if defined(__linux__)
+#define FsEventBufSize    (16 * (sizeof(struct inotify_event) + 256))
+#endif
 
 /*
 **  -----------------------
@@ -74,11 +82,30 @@
 **  -----------------------------------------
 */
 
+#if defined(__linux__)
+
+/*
+**  Card reader hopper served by the shared inotify watcher.
+*/
+typedef struct fsWatch
+    {
+    struct fsWatch *next;
+    fswContext     *parms;
+    DevSlot        *dp;                 /* card reader */
+    int            wd;                  /* inotify watch descriptor */
+    bool           pending;             /* deck may be waiting in hopper */
+    char           crDevId[16];         /* load_cards parameters */
+    } FsWatch;
+#endif
+
 /*
 **  ---------------------------
 **  Private Function Prototypes
 **  ---------------------------
 */
+static DevSlot *fsFindDevice(fswContext *parms);
+static bool fsHasDeck(char *dir);
+
 #if defined(_WIN32)
 static void fsWatchThread(void *parms);
 
@@ -87,6 +114,12 @@ static void *fsWatchThread(void *parms);
 
 #endif
 
+#if defined(__linux__)
+static bool fsInotifyAdd(fswContext *parms);
+static void *fsInotifyThread(void *parms);
+
+#endif
+
 /*
 **  ----------------
 **  Public Variables
@@ -101,6 +134,11 @@ extern int errno;
 **  Private Variables
 **  -----------------
 */
+#if defined(__linux__)
+static int             fsInotifyFd  = -1;
+static FsWatch         *fsWatchList = NULL;
+static pthread_mutex_t fsWatchMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /*
  **--------------------------------------------------------------------------
@@ -168,6 +206,17 @@ bool fsCreateThread(fswContext *parms)
     {
     bool noLaunch = TRUE;
 
+#if defined(__linux__)
+
+    /*
+    **  Prefer the shared event driven watcher, polling is the fallback.
+    */
+    if (fsInotifyAdd(parms))
+        {
+        return TRUE;
+        }
+#endif
+
 #if (defined(_WIN32) || defined(__CYGWIN__))
     DWORD  dwThreadId;
     HANDLE hThread;
@@ -236,9 +285,6 @@ static void *fsWatchThread(void * parms)
     //      Just need to be large enough to hold the unit spec.
     char crDevId[16] = "";
 
-    struct dirent *curDirEntry;
-    DIR           *curDir;
-
     //  Bring the Parameter List into the thread context
     sprintf(crDevId, "%02o,%02o,*",
             lparms->channelNo,
@@ -258,15 +304,81 @@ static void *fsWatchThread(void * parms)
 
     printf("(fsmon  ) Watching Directory:  %s\n", lpDir);
 
+    dp = fsFindDevice(lparms);
+    if (dp == NULL)
+        {
+        return fsReturn;
+        }
+
+    /*
+    **  After exploring Operating System specific APIs for
+    **  various filesystem watch strategies, Polling proved
+    **  to be the most effective AND the most portable.
+    **
+    **  On Linux the inotify watcher is used instead, this
+    **  thread only serves hoppers which it can't watch.
+    */
+
+    printf("(fsmon  ) Waiting ...\n");
+
+    while (emulationActive)
+        {
+        u32 waitTimeout = readerScanSecs * 1000 * 2 / 3;
+        sleepMsec(waitTimeout);
+
+        /*
+        **  Ensure the tray is empty/card reader isn't busy
+        */
+        if (dp->fcb[0] != NULL)
+            {
+            continue;
+            }
+
+        if (fsHasDeck(lparms->inWatchDir))
+            {
+            /*
+            **  We have found at least ONE unprocessed file
+            **  Therefore we invoke the card load command
+            **  to pre-process and queue the deck.
+            */
+            opCmdLoadCards(FALSE, crDevId);
+            }
+        }
+
+    /*
+    **  The expectation is that we were passed a "calloc"ed
+    **  context block.  So we must free it at the end of the
+    **  thread's life
+    */
+    printf("(fsmon  ) Terminating Monitor Thread '%s'.\n", lparms->inWatchDir);
+
+    free(lparms);
+
+    return fsReturn;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Locate the card reader a watcher works for.
+**
+**  Parameters:     Name        Description.
+**                  parms       Pointer to the Thread Context Block
+**
+**  Returns:        Pointer to device slot, or NULL if not found.
+**
+**------------------------------------------------------------------------*/
+static DevSlot *fsFindDevice(fswContext *parms)
+    {
+    DevSlot *dp = NULL;
+
     //  Build the additional information for the operator command
-    switch (lparms->devType)
+    switch (parms->devType)
         {
     case DtCr3447:
-        dp = dcc6681FindDevice((u8)lparms->channelNo, (u8)lparms->eqNo, (u8)lparms->devType);
+        dp = dcc6681FindDevice((u8)parms->channelNo, (u8)parms->eqNo, (u8)parms->devType);
         break;
 
     case DtCr405:
-        dp = channelFindDevice((u8)lparms->channelNo, (u8)lparms->devType);
+        dp = channelFindDevice((u8)parms->channelNo, (u8)parms->devType);
         break;
 
     default:
@@ -278,72 +390,247 @@ static void *fsWatchThread(void * parms)
         printf("\n(fsmon  ) Cannot find device in Equipment Table"
                " Channel %o Equipment %o DeviceType %o"
                ".\n",
-               lparms->channelNo,
-               lparms->eqNo,
-               lparms->devType);
+               parms->channelNo,
+               parms->eqNo,
+               parms->devType);
+        }
 
-        return fsReturn;
+    return dp;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Check whether a hopper directory holds at least one
+**                  deck.
+**
+**  Parameters:     Name        Description.
+**                  dir         hopper directory
+**
+**  Returns:        TRUE if a deck is waiting.
+**
+**------------------------------------------------------------------------*/
+static bool fsHasDeck(char *dir)
+    {
+    struct dirent *curDirEntry;
+    DIR           *curDir;
+    bool          found = FALSE;
+
+    curDir = opendir(dir);
+    if (curDir == NULL)
+        {
+        return FALSE;
+        }
+
+    //  See if there are files in the directory, popping over the dot (.) entries
+    while ((curDirEntry = readdir(curDir)) != NULL)
+        {
+        if (curDirEntry->d_name[0] != '.')
+            {
+            found = TRUE;
+            break;
+            }
+        }
+
+    closedir(curDir);
+
+    return found;
+    }
+
+#if defined(__linux__)
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Add a card reader hopper to the shared inotify watcher,
+**                  starting the watcher thread with the first one.
+**
+**  Parameters:     Name        Description.
+**                  parms       Pointer to the Thread Context Block
+**
+**  Returns:        TRUE if the hopper is watched, FALSE if the caller
+**                  should fall back to polling.
+**
+**------------------------------------------------------------------------*/
+static bool fsInotifyAdd(fswContext *parms)
+    {
+    pthread_t thread;
+    FsWatch   *wp;
+    char      lpDir[MaxFSPath];
+
+    if (realpath(parms->inWatchDir, lpDir) == NULL)
+        {
+        return FALSE;
+        }
+
+    wp = (FsWatch *)calloc(1, sizeof(FsWatch));
+    if (wp == NULL)
+        {
+        return FALSE;
+        }
+
+    wp->dp = fsFindDevice(parms);
+    if (wp->dp == NULL)
+        {
+        free(wp);
+
+        return FALSE;
+        }
+
+    if (fsInotifyFd < 0)
+        {
+        fsInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fsInotifyFd < 0)
+            {
+            free(wp);
+
+            return FALSE;
+            }
+
+        if (pthread_create(&thread, NULL, fsInotifyThread, NULL) != 0)
+            {
+            close(fsInotifyFd);
+            fsInotifyFd = -1;
+            free(wp);
+
+            return FALSE;
+            }
+
+        pthread_detach(thread);
         }
 
     /*
-    **  After exploring Operating System specific APIs for
-    **  various filesystem watch strategies, Polling proved
-    **  to be the most effective AND the most portable.
-    **
-    **  ALL of the OS-Specific APIs had serious draw-backs.
+    **  Only completed files are of interest: decks written in place and
+    **  decks moved into the hopper.
     */
+    wp->wd = inotify_add_watch(fsInotifyFd, lpDir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wp->wd < 0)
+        {
+        free(wp);
 
-    printf("(fsmon  ) Waiting ...\n");
+        return FALSE;
+        }
 
+    /*
+    **  Decks already in the hopper are picked up straight away.
+    */
+    wp->parms   = parms;
+    wp->pending = TRUE;
+    sprintf(wp->crDevId, "%02o,%02o,*", parms->channelNo, parms->eqNo);
+
+    pthread_mutex_lock(&fsWatchMutex);
+    wp->next    = fsWatchList;
+    fsWatchList = wp;
+    pthread_mutex_unlock(&fsWatchMutex);
+
+    printf("(fsmon  ) Watching Directory:  %s\n", lpDir);
+
+    return TRUE;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Shared watcher thread serving all card reader hoppers
+**                  from inotify events.
+**
+**                  A new deck is dispatched as soon as it arrives if its
+**                  card reader is idle. The hopper then stays marked, and
+**                  the next deck is dispatched each time the reader has
+**                  become idle again, until the hopper is empty.
+**
+**  Parameters:     Name        Description.
+**                  parms       unused
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void *fsInotifyThread(void *parms)
+    {
+    char                       buf[FsEventBufSize];
+    char                       *cp;
+    const struct inotify_event *ep;
+    ssize_t                    n;
+    FsWatch                    *next;
+    struct pollfd              pfd;
+    FsWatch                    *wp;
+
+    (void)parms;
+
+    pfd.fd     = fsInotifyFd;
+    pfd.events = POLLIN;
+
+    /*
+    **  Wake up at least once a second to check for emulation termination
+    **  and for card readers which have become idle.
+    */
     while (emulationActive)
         {
-        u32 waitTimeout = readerScanSecs * 1000 * 2 / 3;
-        sleepMsec(waitTimeout);
-
-        /*
-        **  Ensure the tray is empty/card reader isn't busy
-        */
-        if (dp->fcb[0] != NULL)
+        if (poll(&pfd, 1, 1000) > 0)
             {
-            continue;
+            while ((n = read(fsInotifyFd, buf, sizeof(buf))) > 0)
+                {
+                for (cp = buf; cp < buf + n; cp += sizeof(struct inotify_event) + ep->len)
+                    {
+                    ep = (const struct inotify_event *)cp;
+                    if ((ep->len == 0) || (ep->name[0] == '.'))
+                        {
+                        continue;
+                        }
+
+                    pthread_mutex_lock(&fsWatchMutex);
+                    for (wp = fsWatchList; wp != NULL; wp = wp->next)
+                        {
+                        if (wp->wd == ep->wd)
+                            {
+                            wp->pending = TRUE;
+                            }
+                        }
+                    pthread_mutex_unlock(&fsWatchMutex);
+                    }
+                }
             }
 
-        curDir = opendir(lparms->inWatchDir);
-        do
+        pthread_mutex_lock(&fsWatchMutex);
+        for (wp = fsWatchList; wp != NULL; wp = wp->next)
             {
-            //  See if there are files in the directory
-            curDirEntry = readdir(curDir);
-            if (curDirEntry == NULL)
+            /*
+            **  Ensure the tray is empty/card reader isn't busy.
+            */
+            if (!wp->pending || (wp->dp->fcb[0] != NULL))
                 {
-                break;
+                continue;
                 }
-            //  Pop over the dot (.) directories
-            if (curDirEntry->d_name[0] == '.')
+
+            /*
+            **  The readers only pull the next deck when told to, so the
+            **  hopper is served until no deck is left in it.
+            */
+            if (fsHasDeck(wp->parms->inWatchDir))
                 {
-                continue;
+                opCmdLoadCards(FALSE, wp->crDevId);
                 }
             else
                 {
-                /*
-                **  We have found at least ONE unprocessed file
-                **  Therefore we invoke the card load command
-                **  to pre-process and queue the deck.
-                */
-                opCmdLoadCards(FALSE, crDevId);
-                break;
+                wp->pending = FALSE;
                 }
-            } while (curDirEntry != NULL);
-        closedir(curDir);
+            }
+        pthread_mutex_unlock(&fsWatchMutex);
         }
 
     /*
-    **  The expectation is that we were passed a "calloc"ed
-    **  context block.  So we must free it at the end of the
-    **  thread's life
+    **  The context blocks were "calloc"ed by the card readers, so they
+    **  must be freed at the end of the thread's life.
     */
-    printf("(fsmon  ) Terminating Monitor Thread '%s'.\n", lparms->inWatchDir);
+    pthread_mutex_lock(&fsWatchMutex);
+    for (wp = fsWatchList; wp != NULL; wp = next)
+        {
+        next = wp->next;
+        printf("(fsmon  ) Terminating Monitor Thread '%s'.\n", wp->parms->inWatchDir);
+        free(wp->parms);
+        free(wp);
+        }
+    fsWatchList = NULL;
+    pthread_mutex_unlock(&fsWatchMutex);
 
-    free(lparms);
+    close(fsInotifyFd);
+    fsInotifyFd = -1;
 
-    return fsReturn;
+    return NULL;
     }
+
+#endif
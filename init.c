@@ -233,12 +233,15 @@ static char *connTypeNames[] = // indexed by ordinal
 
 static InitVal sectVals[] =
     {
+    "benchmark",                     "cyber",   "Valid",
+    "blockIo",                       "cyber",   "Valid",
     "CEJ/MEJ",                       "cyber",   "Valid",
     "channels",                      "cyber",   "Deprecated",
     "clock",                         "cyber",   "Valid",
     "cmFile",                        "cyber",   "Deprecated",
     "console",                       "cyber",   "Valid",
     "cpus",                          "cyber",   "Valid",
+    "cycleLatency",                  "cyber",   "Valid",
     "deadstart",                     "cyber",   "Valid",
     "displayName",                   "cyber",   "Valid",
     "ecsBanks",                      "cyber",   "Valid",
@@ -251,6 +254,7 @@ static InitVal sectVals[] =
     "idleTime",                      "cyber",   "Valid",
     "ipAddress",                     "cyber",   "Valid",
     "memory",                        "cyber",   "Valid",
+    "metricsPort",                   "cyber",   "Valid",
     "model",                         "cyber",   "Valid",
     "networkInterface",              "cyber",   "Valid",
     "npuConnections",                "cyber",   "Valid",
@@ -260,11 +264,14 @@ static InitVal sectVals[] =
     "platoConns",                    "cyber",   "Deprecated",
     "platoPort",                     "cyber",   "Deprecated",
     "pps",                           "cyber",   "Valid",
+    "printPostProcess",              "cyber",   "Valid",
     "setMhz",                        "cyber",   "Valid",
+    "spinPark",                      "cyber",   "Valid",
     "telnetConns",                   "cyber",   "Deprecated",
     "telnetPort",                    "cyber",   "Deprecated",
     "trace",                         "cyber",   "Valid",
 
+    "bulkRate",                      "npu",     "Valid",
     "cdcnetNode",                    "npu",     "Valid",
     "cdcnetPrivilegedTcpPortOffset", "npu",     "Valid",
     "cdcnetPrivilegedUdpPortOffset", "npu",     "Valid",
@@ -272,6 +279,8 @@ static InitVal sectVals[] =
     "hostID",                        "npu",     "Valid",
     "hostIP",                        "npu",     "Deprecated",
     "idleNetBufs",                   "npu",     "Valid",
+    "interactiveRate",               "npu",     "Valid",
+    "maxConnections",                "npu",     "Valid",
     "npuNode",                       "npu",     "Valid",
     "terminals",                     "npu",     "Valid",
 
@@ -986,6 +995,96 @@ static void initCyber(char *config)
 
     ppInit((u8)pps);
 
+    /*
+    **  Get optional block I/O setting. When enabled, IAM/OAM instructions
+    **  addressing devices which support it complete in a single PP step.
+    */
+    initGetString("blockIo", "off", dummy, sizeof(dummy));
+    if ((strcasecmp(dummy, "on") == 0)
+        || (strcasecmp(dummy, "true") == 0)
+        || (strcasecmp(dummy, "1") == 0))
+        {
+        ppBlockIo = TRUE;
+        fputs("(init   ) Block I/O on.\n", stdout);
+        }
+    else if ((strcasecmp(dummy, "off") != 0)
+             && (strcasecmp(dummy, "false") != 0)
+             && (strcasecmp(dummy, "0") != 0))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid value for 'blockIo' - must be one of 'on' or 'off'\n", startupFile, config);
+        exit(1);
+        }
+
+    /*
+    **  Get optional spin loop parking setting. When enabled, PPs looping on
+    **  a channel or CM word are parked until the watched state changes.
+    */
+    initGetString("spinPark", "off", dummy, sizeof(dummy));
+    if ((strcasecmp(dummy, "on") == 0)
+        || (strcasecmp(dummy, "true") == 0)
+        || (strcasecmp(dummy, "1") == 0))
+        {
+        ppSpinPark = TRUE;
+        fputs("(init   ) Spin loop parking on.\n", stdout);
+        }
+    else if ((strcasecmp(dummy, "off") != 0)
+             && (strcasecmp(dummy, "false") != 0)
+             && (strcasecmp(dummy, "0") != 0))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid value for 'spinPark' - must be one of 'on' or 'off'\n", startupFile, config);
+        exit(1);
+        }
+
+    /*
+    **  Get optional major cycle latency tracking setting. It can also be
+    **  turned on and off with the show_latency operator command.
+    */
+    initGetString("cycleLatency", "off", dummy, sizeof(dummy));
+    if ((strcasecmp(dummy, "on") == 0)
+        || (strcasecmp(dummy, "true") == 0)
+        || (strcasecmp(dummy, "1") == 0))
+        {
+        latencyActive = TRUE;
+        fputs("(init   ) Cycle latency tracking on.\n", stdout);
+        }
+    else if ((strcasecmp(dummy, "off") != 0)
+             && (strcasecmp(dummy, "false") != 0)
+             && (strcasecmp(dummy, "0") != 0))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid value for 'cycleLatency' - must be one of 'on' or 'off'\n", startupFile, config);
+        exit(1);
+        }
+
+    /*
+    **  Get optional command to be run on each completed printer output
+    **  file after the paper has been removed, e.g. to convert it to PDF.
+    */
+    initGetString("printPostProcess", "", lpSpoolPostCmd, MaxFSPath);
+
+    /*
+    **  Get optional benchmark script. When set the emulator runs headless
+    **  with a fixed clock increment and takes its operator input from the
+    **  script, so runs can be compared between builds and hosts.
+    */
+    if (initGetString("benchmark", "", benchScript, MaxFSPath))
+        {
+        benchActive = TRUE;
+        fprintf(stdout, "(init   ) Benchmark mode, script %s.\n", benchScript);
+        }
+
+    /*
+    **  Get optional TCP port on which performance metrics are served in
+    **  Prometheus text format. Zero (the default) disables the endpoint.
+    */
+    initGetInteger("metricsPort", 0, &dummyInt);
+    if ((dummyInt < 0) || (dummyInt > 65535))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid value for 'metricsPort' - must be between 0 and 65535\n", startupFile, config);
+        exit(1);
+        }
+
+    metricsPort = (u16)dummyInt;
+
     /*
     **  Calculate number of channels and initialise channel subsystem.
     */
@@ -1019,6 +1118,13 @@ static void initCyber(char *config)
     **  Get clock increment value and initialise clock.
     */
     (void)initGetInteger("clock", 0, &clockIncrement);
+    if (benchActive && (clockIncrement == 0))
+        {
+        /*
+        **  The host clock would make benchmark runs irreproducible.
+        */
+        clockIncrement = 1;
+        }
 
     rtcInit((u8)clockIncrement, setMHz);
     fprintf(stdout, "(init   ) %ld Clock increment set.\n", clockIncrement);
@@ -1194,6 +1300,14 @@ static void initCyber(char *config)
     idleTime = (u32)dummyInt;
 #endif
 
+    if (benchActive)
+        {
+        /*
+        **  Sleeping in the idle loop would only distort benchmark timing.
+        */
+        idle = FALSE;
+        }
+
     if (idle)
         {
         fprintf(stdout, "(init   ) Idle every %d cycles for %d microseconds.\n",
@@ -1233,6 +1347,10 @@ static void initCyber(char *config)
         {
         idleDetector = &idleDetectorCOS;
         }
+    else if (strcasecmp(osType, "auto") == 0)
+        {
+        idleDetector = &idleDetectorAuto;
+        }
     else
         {
         logDtError(LogErrorLocation, "file '%s' section [%s]: WARNING: Unrecognized operating system type: '%s'\n",
@@ -1542,6 +1660,7 @@ static void initNpuConnections(void)
     u16          destHostPort;
     char         *destHostName;
     u8           destNode;
+    bool         isCompressing;
     u32          localHostIP;
     Pcb          *pcbp;
     long         pingInterval;
@@ -1702,6 +1821,47 @@ static void initNpuConnections(void)
     idleNetBufs = (u32)val;
     logDtError(LogErrorLocation, "Idle network buffer threshold is %d\n", idleNetBufs);
 
+    /*
+    **  Get optional maximum number of concurrent terminal connections. If not specified,
+    **  use the CCP limit of 255.
+    */
+    initGetInteger("maxConnections", MaxTcbs - 1, &val);
+    if ((val < 1) || (val > MaxTcbs - 1))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid 'maxConnections' value %ld - correct values are 1..%d\n",
+                   startupFile, npuConnections, val, MaxTcbs - 1);
+        exit(1);
+        }
+    npuTcbCount = (int)val + 1;
+    logDtError(LogErrorLocation, "Maximum terminal connections is %d\n", npuTcbCount - 1);
+
+    /*
+    **  Get optional upline rate limits in bytes per second for each interactive
+    **  and each bulk (HASP, NJE, trunk) connection. Zero means unlimited.
+    */
+    initGetInteger("interactiveRate", 0, &val);
+    if ((val < 0) || (val > 100000000))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid 'interactiveRate' value %ld - correct values are 0..100000000\n",
+                   startupFile, npuConnections, val);
+        exit(1);
+        }
+    npuNetInteractiveRate = (u32)val;
+
+    initGetInteger("bulkRate", 0, &val);
+    if ((val < 0) || (val > 100000000))
+        {
+        logDtError(LogErrorLocation, "file '%s' section [%s]: Invalid 'bulkRate' value %ld - correct values are 0..100000000\n",
+                   startupFile, npuConnections, val);
+        exit(1);
+        }
+    npuNetBulkRate = (u32)val;
+    if ((npuNetInteractiveRate != 0) || (npuNetBulkRate != 0))
+        {
+        logDtError(LogErrorLocation, "Upline rate limits are %u bytes/s interactive, %u bytes/s bulk\n",
+                   npuNetInteractiveRate, npuNetBulkRate);
+        }
+
     /*
     **  Process all equipment entries.
     */
@@ -1832,13 +1992,18 @@ static void initNpuConnections(void)
 
             case ConnTypeHasp:
                 /*
-                **  terminals=<local-port>,<cla-port>,<connections>,hasp[,<block-size>]
+                **  terminals=<local-port>,<cla-port>,<connections>,hasp[,<block-size>][,compress]
                 */
-                blockSize = DefaultHaspBlockSize;
-                token     = strtok(remainder, " ");
-                if (token != NULL)
+                blockSize     = DefaultHaspBlockSize;
+                isCompressing = FALSE;
+                token         = strtok(remainder, ", ");
+                while (token != NULL)
                     {
-                    if ((*token == 'B') || (*token == 'b'))
+                    if (strcasecmp(token, "compress") == 0)
+                        {
+                        isCompressing = TRUE;
+                        }
+                    else if ((*token == 'B') || (*token == 'b'))
                         {
                         val = strtol(token + 1, NULL, 10);
                         if ((val < MinBlockSize) || (val > MaxBlockSize))
@@ -1854,15 +2019,21 @@ static void initNpuConnections(void)
                         logDtError(LogErrorLocation, "Invalid block size specification '%s'\n", token);
                         exit(1);
                         }
+                    token = strtok(NULL, ", ");
                     }
                 pcbp = npuNetFindPcb(claPort);
                 pcbp->controls.hasp.blockSize = blockSize;
-                logDtError(LogErrorLocation, "  block size %4d", blockSize);
+                while (numConns-- > 0)
+                    {
+                    pcbp = npuNetFindPcb(claPort++);
+                    pcbp->controls.hasp.isCompressing = isCompressing;
+                    }
+                logDtError(LogErrorLocation, "  block size %4d%s", blockSize, isCompressing ? ", compressed" : "");
                 break;
 
             case ConnTypeRevHasp:
                 /*
-                **   terminals=<local-port>,<cla-port>,<connections>,rhasp,<remote-ip>:<remote-port>[,<block-size>]
+                **   terminals=<local-port>,<cla-port>,<connections>,rhasp,<remote-ip>:<remote-port>[,<block-size>][,compress]
                 */
                 token = strtok(remainder, ", ");
                 if (token == NULL)
@@ -1881,12 +2052,17 @@ static void initNpuConnections(void)
                     logDtError(LogErrorLocation, "Missing port number on Reverse HASP address '%s'\n", destHostAddr);
                     exit(1);
                     }
-                destHostName = destHostAddr;
-                blockSize    = DefaultRevHaspBlockSize;
-                token        = strtok(NULL, " ");
-                if (token != NULL)
+                destHostName  = destHostAddr;
+                blockSize     = DefaultRevHaspBlockSize;
+                isCompressing = FALSE;
+                token         = strtok(NULL, ", ");
+                while (token != NULL)
                     {
-                    if ((*token == 'B') || (*token == 'b'))
+                    if (strcasecmp(token, "compress") == 0)
+                        {
+                        isCompressing = TRUE;
+                        }
+                    else if ((*token == 'B') || (*token == 'b'))
                         {
                         val = strtol(token + 1, NULL, 10);
                         if ((val < MinBlockSize) || (val > MaxBlockSize))
@@ -1902,14 +2078,21 @@ static void initNpuConnections(void)
                         logDtError(LogErrorLocation, "Invalid Reverse HASP block size specification '%s'\n", token);
                         exit(1);
                         }
+                    token = strtok(NULL, ", ");
+                    }
+                while (numConns-- > 0)
+                    {
+                    pcbp = npuNetFindPcb(claPort++);
+                    pcbp->controls.hasp.isCompressing = isCompressing;
                     }
-                logDtError(LogErrorLocation, "  block size %4d, destination host %s", blockSize, destHostName);
+                logDtError(LogErrorLocation, "  block size %4d, destination host %s%s", blockSize, destHostName,
+                           isCompressing ? ", compressed" : "");
                 break;
 
             case ConnTypeNje:
                 /*
                 **   terminals=<local-port>,<cla-port>,1,nje,<remote-ip>:<remote-port>,<remote-name> ...
-                **       [,<local-ip>][,<block-size>]
+                **       [,<local-ip>][,<block-size>][,<ping-interval>][,compress]
                 */
                 if (numConns != 1)
                     {
@@ -1938,11 +2121,16 @@ static void initNpuConnections(void)
                 initToUpperCase(destHostName);
                 localHostIP  = npuNetHostIP;
                 blockSize    = DefaultNjeBlockSize;
-                pingInterval = DefaultNjePingInterval;
-                token        = strtok(NULL, ", ");
+                pingInterval  = DefaultNjePingInterval;
+                isCompressing = FALSE;
+                token         = strtok(NULL, ", ");
                 while (token != NULL)
                     {
-                    if ((*token == 'B') || (*token == 'b'))
+                    if (strcasecmp(token, "compress") == 0)
+                        {
+                        isCompressing = TRUE;
+                        }
+                    else if ((*token == 'B') || (*token == 'b'))
                         {
                         val = strtol(token + 1, NULL, 10);
                         if (val < MinNjeBlockSize)
@@ -1969,10 +2157,10 @@ static void initNpuConnections(void)
                         }
                     token = strtok(NULL, ", ");
                     }
-                logDtError(LogErrorLocation, "  block size %4d, destination host %s/%s, source address %d.%d.%d.%d, ping interval %ld",
+                logDtError(LogErrorLocation, "  block size %4d, destination host %s/%s, source address %d.%d.%d.%d, ping interval %ld%s",
                            blockSize, destHostName, destHostAddr, 
                            (localHostIP >> 24) & 0xff, (localHostIP >> 16) & 0xff, (localHostIP >> 8) & 0xff, localHostIP & 0xff,
-                           pingInterval);
+                           pingInterval, isCompressing ? ", compressed" : "");
                 break;
 
             case ConnTypeTrunk:
@@ -2044,12 +2232,13 @@ static void initNpuConnections(void)
                 if (connType == ConnTypeNje)
                     {
                     pcbp = npuNetFindPcb(claPort);
-                    pcbp->controls.nje.blockSize    = (int)blockSize;
-                    pcbp->controls.nje.pingInterval = (int)pingInterval;
-                    pcbp->controls.nje.localIP      = localHostIP;
-                    pcbp->controls.nje.remoteIP     = destHostIP;
-                    pcbp->controls.nje.inputBufSize = pcbp->controls.nje.blockSize * 2;
-                    pcbp->controls.nje.inputBuf     = (u8 *)malloc(pcbp->controls.nje.inputBufSize);
+                    pcbp->controls.nje.blockSize     = (int)blockSize;
+                    pcbp->controls.nje.pingInterval  = (int)pingInterval;
+                    pcbp->controls.nje.isCompressing = isCompressing;
+                    pcbp->controls.nje.localIP       = localHostIP;
+                    pcbp->controls.nje.remoteIP      = destHostIP;
+                    pcbp->controls.nje.inputBufSize  = pcbp->controls.nje.blockSize * 2;
+                    pcbp->controls.nje.inputBuf      = (u8 *)malloc(pcbp->controls.nje.inputBufSize);
                     if (pcbp->controls.nje.inputBuf == NULL)
                         {
                         logDtError(LogErrorLocation, "Out of memory\n");
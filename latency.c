@@ -0,0 +1,845 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: latency.c
+**
+**  Description:
+**      Major cycle latency histogram and stall attribution.
+**
+**      While tracking is on, the main emulation loop marks the end of
+**      each of its phases and every device I/O request and network poll
+**      is timed individually. The duration of each major cycle (not
+**      counting deliberate idle sleeps) is recorded in a log-linear
+**      histogram, and cycles longer than the stall threshold are
+**      attributed to the phase, or the channel device, which used most
+**      of their time. The time ppStep spends on each PP is accumulated
+**      as well. The show_latency operator command reports it all.
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+
+/*
+**  Histogram buckets are grouped by the position of the most significant
+**  bit of the cycle time in clock ticks, each group being split into
+**  LatSubBuckets linear sub-buckets. This keeps the relative error below
+**  1/LatSubBuckets over the whole range at a fixed cost per sample.
+*/
+#define LatSubBits              4
+#define LatSubBuckets           (1 << LatSubBits)
+#define LatMaxExponent          40          /* longest cycle tracked is 2^40 ticks */
+#define LatBuckets              ((LatMaxExponent - LatSubBits + 1) * LatSubBuckets)
+
+#define LatMaxNest              4
+#define LatMaxStalls            16
+#define LatDefaultThreshold     1000        /* usec */
+#define LatCalibrateMsec        20
+
+/*
+**  Cycles are timed with the processor's time stamp counter where it is
+**  cheap to read, which keeps the cost of tracking low enough to leave
+**  it on for long runs.
+*/
+#if defined(__GNUC__) && (defined(__x86_64) || defined(__i386))
+#define LatUseTsc               1
+#else
+#define LatUseTsc               0
+#endif
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+#define LatUsec(ticks)    ((double)(ticks) * latNsPerTick / 1000.0)
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+typedef struct latStall
+    {
+    time_t when;                        /* wall clock time of stall */
+    u64    total;                       /* cycle time in ticks */
+    u64    culprit;                     /* time used by culprit in ticks */
+    u8     phase;                       /* culprit phase */
+    u8     channelNo;                   /* culprit channel if phase is I/O */
+    } LatStall;
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static int  latencyBucket(u64 ticks);
+static u64  latencyBucketTop(int bucket);
+static void latencyCalibrate(void);
+static char *latencyCulpritName(u8 phase, u8 channelNo);
+static u64  latencyNow(void);
+static u64  latencyPercentile(double percent);
+static char *latencyPpName(int ppNo);
+static void latencyStall(u64 total);
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+bool latencyActive = FALSE;
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static const char *latPhaseNames[LatPhaseCount] =
+    {
+    "opRequest",
+    "rtcTick",
+    "ppStep",
+    "cpuStep",
+    "channelStep",
+    "device io",
+    "npuNetCheckStatus",
+    "idle"
+    };
+
+/*
+**  Accumulated since the last reset.
+*/
+static u64 latHistogram[LatBuckets];
+static u64 latCount;
+static u64 latSum;
+static u64 latMin;
+static u64 latMax;
+static u64 latPhaseTime[LatPhaseCount];
+static u64 latIoTime[MaxChannels];
+static u64 latPpTime[MaxPps];
+static u64 latStallCount;
+static u64 latStallPhase[LatPhaseCount];
+static u64 latStallChannel[MaxChannels];
+static u32 latThresholdUsec = LatDefaultThreshold;
+static u64 latThreshold;
+
+static LatStall latStalls[LatMaxStalls];
+static int      latStallNext;
+
+/*
+**  State of the current major cycle.
+*/
+static u64  latMark;
+static u64  latExcluded;
+static u64  latCycPhase[LatPhaseCount];
+static u64  latCycIo[MaxChannels];
+static bool latCycSeen[MaxChannels];
+static u8   latCycChannels[MaxChannels];
+static int  latCycChannelCount;
+static u64  latNestStart[LatMaxNest];
+static u64  latNestExcluded[LatMaxNest];
+static int  latNestDepth;
+static int  latPpCurrent = -1;
+static u64  latPpMark;
+
+static double latNsPerTick = 0.0;
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Turn cycle latency tracking on or off.
+**
+**  Parameters:     Name        Description.
+**                  on          TRUE to start tracking, FALSE to stop.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyEnable(bool on)
+    {
+    latencyCalibrate();
+
+    /*
+    **  Start over with a fresh cycle, the current one is only partially
+    **  timed.
+    */
+    memset(latCycPhase, 0, sizeof(latCycPhase));
+    memset(latCycIo, 0, sizeof(latCycIo));
+    memset(latCycSeen, 0, sizeof(latCycSeen));
+    latCycChannelCount = 0;
+    latNestDepth       = 0;
+    latPpCurrent       = -1;
+    latExcluded        = 0;
+    latMark            = latencyNow();
+    latencyActive      = on;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Discard all latency samples and stall records.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyReset(void)
+    {
+    memset(latHistogram, 0, sizeof(latHistogram));
+    memset(latPhaseTime, 0, sizeof(latPhaseTime));
+    memset(latIoTime, 0, sizeof(latIoTime));
+    memset(latPpTime, 0, sizeof(latPpTime));
+    memset(latStallPhase, 0, sizeof(latStallPhase));
+    memset(latStallChannel, 0, sizeof(latStallChannel));
+    memset(latStalls, 0, sizeof(latStalls));
+    latCount      = 0;
+    latSum        = 0;
+    latMin        = 0;
+    latMax        = 0;
+    latStallCount = 0;
+    latStallNext  = 0;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Set the cycle time above which a cycle is a stall.
+**
+**  Parameters:     Name        Description.
+**                  usec        Threshold in microseconds.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencySetThreshold(u32 usec)
+    {
+    latThresholdUsec = usec;
+    latencyCalibrate();
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Mark the end of a top level phase of the major cycle.
+**
+**  Parameters:     Name        Description.
+**                  phase       Phase which just completed.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyPhase(int phase)
+    {
+    u64 now = latencyNow();
+
+    /*
+    **  Time spent in nested device I/O and network polls has already
+    **  been attributed to those.
+    */
+    latCycPhase[phase] += now - latMark - latExcluded;
+    latExcluded         = 0;
+    latMark             = now;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Mark the start of a PP's turn within ppStep, ending
+**                  the turn of the previous PP.
+**
+**  Parameters:     Name        Description.
+**                  ppNo        PP about to be stepped, or -1 once the
+**                              last PP has been stepped.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyPp(int ppNo)
+    {
+    u64 now = latencyNow();
+
+    /*
+    **  A PP's time includes any device I/O it started.
+    */
+    if (latPpCurrent >= 0)
+        {
+        latPpTime[latPpCurrent] += now - latPpMark;
+        }
+
+    latPpCurrent = ppNo;
+    latPpMark    = now;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Start timing a region nested within a phase.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyEnter(void)
+    {
+    if (latNestDepth < LatMaxNest)
+        {
+        latNestStart[latNestDepth]    = latencyNow();
+        latNestExcluded[latNestDepth] = latExcluded;
+        }
+
+    latNestDepth += 1;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Finish timing a nested region and attribute its own
+**                  time (less any regions nested within it).
+**
+**  Parameters:     Name        Description.
+**                  phase       LatPhaseIo or LatPhaseNetCheck.
+**                  channelNo   Channel number for LatPhaseIo.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyLeave(int phase, u8 channelNo)
+    {
+    u64 elapsed;
+    u64 self;
+
+    if (latNestDepth == 0)
+        {
+        return;
+        }
+
+    latNestDepth -= 1;
+    if (latNestDepth >= LatMaxNest)
+        {
+        return;
+        }
+
+    elapsed     = latencyNow() - latNestStart[latNestDepth];
+    self        = elapsed - (latExcluded - latNestExcluded[latNestDepth]);
+    latExcluded = latNestExcluded[latNestDepth] + elapsed;
+
+    latCycPhase[phase] += self;
+    if (phase == LatPhaseIo)
+        {
+        latCycIo[channelNo] += self;
+        if (!latCycSeen[channelNo])
+            {
+            latCycSeen[channelNo]                = TRUE;
+            latCycChannels[latCycChannelCount++] = channelNo;
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Record the major cycle which just completed.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyCycleEnd(void)
+    {
+    int i;
+    u8  ch;
+    u64 total = 0;
+
+    for (i = 0; i < LatPhaseCount; i++)
+        {
+        if (i != LatPhaseIdle)
+            {
+            total += latCycPhase[i];
+            }
+
+        latPhaseTime[i] += latCycPhase[i];
+        }
+
+    latHistogram[latencyBucket(total)] += 1;
+    if ((latCount == 0) || (total < latMin))
+        {
+        latMin = total;
+        }
+
+    if (total > latMax)
+        {
+        latMax = total;
+        }
+
+    latCount += 1;
+    latSum   += total;
+
+    if (total >= latThreshold)
+        {
+        latencyStall(total);
+        }
+
+    for (i = 0; i < latCycChannelCount; i++)
+        {
+        ch             = latCycChannels[i];
+        latIoTime[ch]   += latCycIo[ch];
+        latCycIo[ch]   = 0;
+        latCycSeen[ch] = FALSE;
+        }
+
+    latCycChannelCount = 0;
+    memset(latCycPhase, 0, sizeof(latCycPhase));
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Display the latency histogram and stall attribution.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void latencyShow(void)
+    {
+    u64       busy;
+    u64       count;
+    int       exponent;
+    int       i;
+    int       j;
+    LatStall  *lsp;
+    char      outBuf[160];
+    struct tm *tmp;
+
+    sprintf(outBuf, "    > Cycle latency tracking is %s, stall threshold %u usec\n",
+            latencyActive ? "on" : "off", latThresholdUsec);
+    opDisplay(outBuf);
+
+    if (latCount == 0)
+        {
+        opDisplay("    > No cycles recorded\n");
+
+        return;
+        }
+
+    sprintf(outBuf, "    >   Cycles %llu, min %.2f, mean %.2f, max %.2f usec\n",
+            (unsigned long long)latCount, LatUsec(latMin),
+            LatUsec(latSum) / latCount, LatUsec(latMax));
+    opDisplay(outBuf);
+
+    sprintf(outBuf, "    >   p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, p99.99 %.2f usec\n",
+            LatUsec(latencyPercentile(50.0)), LatUsec(latencyPercentile(90.0)),
+            LatUsec(latencyPercentile(99.0)), LatUsec(latencyPercentile(99.9)),
+            LatUsec(latencyPercentile(99.99)));
+    opDisplay(outBuf);
+
+    /*
+    **  Condense the histogram to one line per power of two.
+    */
+    opDisplay("    >   Distribution (usec)\n");
+    for (i = 0; i < LatBuckets; i = j)
+        {
+        exponent = i < LatSubBuckets ? LatSubBits - 1 : i / LatSubBuckets + LatSubBits - 1;
+        count    = 0;
+        for (j = i; j < LatBuckets && j < (exponent - LatSubBits + 2) * LatSubBuckets; j++)
+            {
+            count += latHistogram[j];
+            }
+
+        if (count != 0)
+            {
+            sprintf(outBuf, "    >     %12.3f - %12.3f %12llu %7.3f%%\n",
+                    i == 0 ? 0.0 : LatUsec((u64)1 << exponent),
+                    LatUsec((u64)1 << (exponent + 1)),
+                    (unsigned long long)count, count * 100.0 / latCount);
+            opDisplay(outBuf);
+            }
+        }
+
+    busy = latSum == 0 ? 1 : latSum;
+    opDisplay("    >   Time by phase\n");
+    for (i = 0; i < LatPhaseCount; i++)
+        {
+        sprintf(outBuf, "    >     %-18s %12.3f msec %6.2f%%%s\n", latPhaseNames[i],
+                LatUsec(latPhaseTime[i]) / 1000.0, latPhaseTime[i] * 100.0 / busy,
+                i == LatPhaseIdle ? " (not counted)" : "");
+        opDisplay(outBuf);
+        if (i == LatPhasePp)
+            {
+            for (j = 0; j < ppuCount; j++)
+                {
+                if (latPpTime[j] != 0)
+                    {
+                    sprintf(outBuf, "    >       %-34s %12.3f msec %6.2f%%\n", latencyPpName(j),
+                            LatUsec(latPpTime[j]) / 1000.0, latPpTime[j] * 100.0 / busy);
+                    opDisplay(outBuf);
+                    }
+                }
+            }
+        }
+
+    for (i = 0; i < channelCount; i++)
+        {
+        if (latIoTime[i] != 0)
+            {
+            sprintf(outBuf, "    >       %-34s %12.3f msec %6.2f%%\n", latencyCulpritName(LatPhaseIo, (u8)i),
+                    LatUsec(latIoTime[i]) / 1000.0, latIoTime[i] * 100.0 / busy);
+            opDisplay(outBuf);
+            }
+        }
+
+    sprintf(outBuf, "    >   Stalls %llu\n", (unsigned long long)latStallCount);
+    opDisplay(outBuf);
+    if (latStallCount == 0)
+        {
+        return;
+        }
+
+    for (i = 0; i < LatPhaseCount; i++)
+        {
+        if ((i != LatPhaseIo) && (latStallPhase[i] != 0))
+            {
+            sprintf(outBuf, "    >     %-36s %12llu\n", latPhaseNames[i], (unsigned long long)latStallPhase[i]);
+            opDisplay(outBuf);
+            }
+        }
+
+    for (i = 0; i < channelCount; i++)
+        {
+        if (latStallChannel[i] != 0)
+            {
+            sprintf(outBuf, "    >     %-36s %12llu\n", latencyCulpritName(LatPhaseIo, (u8)i),
+                    (unsigned long long)latStallChannel[i]);
+            opDisplay(outBuf);
+            }
+        }
+
+    opDisplay("    >   Recent stalls\n");
+    for (i = 0; i < LatMaxStalls; i++)
+        {
+        lsp = &latStalls[(latStallNext + i) % LatMaxStalls];
+        if (lsp->total == 0)
+            {
+            continue;
+            }
+
+        tmp = localtime(&lsp->when);
+        sprintf(outBuf, "    >     %02d:%02d:%02d %10.3f usec, %10.3f usec in %s\n",
+                tmp->tm_hour, tmp->tm_min, tmp->tm_sec, LatUsec(lsp->total),
+                LatUsec(lsp->culprit), latencyCulpritName(lsp->phase, lsp->channelNo));
+        opDisplay(outBuf);
+        }
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Return a monotonic time stamp.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Time in clock ticks.
+**
+**------------------------------------------------------------------------*/
+static u64 latencyNow(void)
+    {
+#if defined(_WIN32)
+    LARGE_INTEGER count;
+
+    QueryPerformanceCounter(&count);
+
+    return ((u64)count.QuadPart);
+
+#elif LatUseTsc
+    u32 a;
+    u32 d;
+
+    __asm__ __volatile__ ("rdtsc" : "=a" (a), "=d" (d));
+
+    return (((u64)d << 32) | (u64)a);
+
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine the length of a clock tick and convert the
+**                  stall threshold to ticks.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void latencyCalibrate(void)
+    {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+#elif LatUseTsc
+    u64             ticks;
+    struct timespec ts0;
+    struct timespec ts1;
+#endif
+
+    if (latNsPerTick == 0.0)
+        {
+#if defined(_WIN32)
+        QueryPerformanceFrequency(&frequency);
+        latNsPerTick = 1000000000.0 / (double)frequency.QuadPart;
+#elif LatUseTsc
+        clock_gettime(CLOCK_MONOTONIC, &ts0);
+        ticks = latencyNow();
+        sleepMsec(LatCalibrateMsec);
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+        ticks        = latencyNow() - ticks;
+        latNsPerTick = ((ts1.tv_sec - ts0.tv_sec) * 1000000000.0 + (ts1.tv_nsec - ts0.tv_nsec)) / (double)ticks;
+#else
+        latNsPerTick = 1.0;
+#endif
+        }
+
+    latThreshold = (u64)(latThresholdUsec * 1000.0 / latNsPerTick);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Map a cycle time to its histogram bucket.
+**
+**  Parameters:     Name        Description.
+**                  ticks       Cycle time in clock ticks.
+**
+**  Returns:        Bucket index.
+**
+**------------------------------------------------------------------------*/
+static int latencyBucket(u64 ticks)
+    {
+    int exponent;
+
+    if (ticks < LatSubBuckets)
+        {
+        return ((int)ticks);
+        }
+
+    if (ticks >= ((u64)1 << LatMaxExponent))
+        {
+        return (LatBuckets - 1);
+        }
+
+#if defined(__GNUC__)
+    exponent = 63 - __builtin_clzll(ticks);
+#else
+    exponent = LatSubBits;
+    while ((ticks >> (exponent + 1)) != 0)
+        {
+        exponent += 1;
+        }
+#endif
+
+    return ((exponent - LatSubBits + 1) * LatSubBuckets
+            + (int)((ticks >> (exponent - LatSubBits)) & (LatSubBuckets - 1)));
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Return the largest cycle time held by a bucket.
+**
+**  Parameters:     Name        Description.
+**                  bucket      Bucket index.
+**
+**  Returns:        Cycle time in clock ticks.
+**
+**------------------------------------------------------------------------*/
+static u64 latencyBucketTop(int bucket)
+    {
+    int shift;
+
+    if (bucket < LatSubBuckets)
+        {
+        return ((u64)bucket);
+        }
+
+    shift = bucket / LatSubBuckets - 1;
+
+    return (((u64)(LatSubBuckets + bucket % LatSubBuckets + 1) << shift) - 1);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Return the cycle time below which a given percentage
+**                  of cycles completed.
+**
+**  Parameters:     Name        Description.
+**                  percent     Percentile.
+**
+**  Returns:        Cycle time in clock ticks.
+**
+**------------------------------------------------------------------------*/
+static u64 latencyPercentile(double percent)
+    {
+    int i;
+    u64 seen   = 0;
+    u64 target = (u64)(latCount * percent / 100.0 + 0.5);
+
+    if (target == 0)
+        {
+        target = 1;
+        }
+
+    for (i = 0; i < LatBuckets; i++)
+        {
+        seen += latHistogram[i];
+        if (seen >= target)
+            {
+            return (latencyBucketTop(i) < latMax ? latencyBucketTop(i) : latMax);
+            }
+        }
+
+    return (latMax);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Attribute a stalled cycle to the phase or channel
+**                  device which used most of its time.
+**
+**  Parameters:     Name        Description.
+**                  total       Cycle time in clock ticks.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void latencyStall(u64 total)
+    {
+    u8       ch;
+    int      i;
+    LatStall *lsp;
+
+    lsp            = &latStalls[latStallNext];
+    latStallNext   = (latStallNext + 1) % LatMaxStalls;
+    lsp->when      = time(NULL);
+    lsp->total     = total;
+    lsp->culprit   = 0;
+    lsp->phase     = LatPhaseOpRequest;
+    lsp->channelNo = 0;
+
+    for (i = 0; i < LatPhaseCount; i++)
+        {
+        if ((i != LatPhaseIo) && (i != LatPhaseIdle) && (latCycPhase[i] > lsp->culprit))
+            {
+            lsp->culprit = latCycPhase[i];
+            lsp->phase   = (u8)i;
+            }
+        }
+
+    for (i = 0; i < latCycChannelCount; i++)
+        {
+        ch = latCycChannels[i];
+        if (latCycIo[ch] > lsp->culprit)
+            {
+            lsp->culprit   = latCycIo[ch];
+            lsp->phase     = LatPhaseIo;
+            lsp->channelNo = ch;
+            }
+        }
+
+    latStallCount += 1;
+    if (lsp->phase == LatPhaseIo)
+        {
+        latStallChannel[lsp->channelNo] += 1;
+        }
+    else
+        {
+        latStallPhase[lsp->phase] += 1;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Describe a stall culprit.
+**
+**  Parameters:     Name        Description.
+**                  phase       Culprit phase.
+**                  channelNo   Channel number if phase is LatPhaseIo.
+**
+**  Returns:        Pointer to static description.
+**
+**------------------------------------------------------------------------*/
+static char *latencyCulpritName(u8 phase, u8 channelNo)
+    {
+    static char name[64];
+
+    if (phase != LatPhaseIo)
+        {
+        return ((char *)latPhaseNames[phase]);
+        }
+
+    if (channel[channelNo].ioDevice != NULL)
+        {
+        sprintf(name, "io ch %02o %s", channelNo, channelDeviceTypeName(channel[channelNo].ioDevice->devType));
+        }
+    else if (channel[channelNo].firstDevice != NULL)
+        {
+        sprintf(name, "io ch %02o %s", channelNo, channelDeviceTypeName(channel[channelNo].firstDevice->devType));
+        }
+    else
+        {
+        sprintf(name, "io ch %02o", channelNo);
+        }
+
+    return (name);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Describe a PP in the ppStep breakdown.
+**
+**  Parameters:     Name        Description.
+**                  ppNo        PP index.
+**
+**  Returns:        Pointer to static description.
+**
+**------------------------------------------------------------------------*/
+static char *latencyPpName(int ppNo)
+    {
+    static char name[64];
+
+    sprintf(name, "PP%02o (including device io)", (ppNo < 10) ? ppNo : ppNo + 6);
+
+    return (name);
+    }
+
+/*---------------------------  End Of File  ------------------------------*/
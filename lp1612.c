@@ -38,7 +38,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
-#include <errno.h>
 #include <string.h>
 #include "const.h"
 #include "types.h"
@@ -142,6 +141,9 @@ typedef struct lpContext
 
     char             path[MaxFSPath];
     char             curFileName[MaxFSPath + 128];
+    LpSpool          *spool;                 //  output spool
+    u32              removeSeq;              //  sequence number of paper removals
+    u32              renameRetries;          //  failed renames of generated names
     } LpContext;
 
 /*
@@ -151,13 +153,15 @@ typedef struct lpContext
 */
 static char    *lp1612FeForPostPrint(LpContext *lc, PpWord func);
 static char    *lp1612FeForPrePrint(LpContext *lc, PpWord func);
+static void     lp1612NewFileName(LpContext *lc, char *fName);
+static void     lp1612Rotated(void *owner, char *newName, bool isGenerated, LpRotateStatus status, int err);
 static FcStatus lp1612Func(PpWord funcCode);
 static void     lp1612Io(void);
 static void     lp1612Activate(void);
 static void     lp1612Disconnect(void);
-static void     lp1612PrintANSI(LpContext *lc, FILE *fcb);
-static void     lp1612PrintASCII(LpContext *lc, FILE *fcb);
-static void     lp1612PrintCDC(LpContext *lc, FILE *fcb);
+static void     lp1612PrintANSI(LpContext *lc, LpSpool *sp);
+static void     lp1612PrintASCII(LpContext *lc, LpSpool *sp);
+static void     lp1612PrintCDC(LpContext *lc, LpSpool *sp);
 
 #if DEBUG
 static void lp1612DebugData(LpContext *lc);
@@ -264,6 +268,7 @@ void lp1612Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     dp->disconnect   = lp1612Disconnect;
     dp->func         = lp1612Func;
     dp->io           = lp1612Io;
+    dp->blockIo      = TRUE;
     dp->selectedUnit = 0;
     lc = (LpContext *)calloc(1, sizeof(LpContext));
     if (lc == NULL)
@@ -337,9 +342,8 @@ void lp1612Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     **  Open the device file.
     */
     sprintf(lc->curFileName, "%sLP1612_C%02o", lc->path, channelNo);
-    dp->fcb[0] = fopen(lc->curFileName, "w+t");
-
-    if (dp->fcb[0] == NULL)
+    lc->spool = lpSpoolOpen(lc->curFileName, lp1612Rotated, lc);
+    if (lc->spool == NULL)
         {
         logDtError(LogErrorLocation, "Failed to open %s\n", lc->curFileName);
         exit(1);
@@ -402,16 +406,12 @@ void lp1612ShowStatus()
 void lp1612RemovePaper(char *params)
     {
     int       channelNo;
-    time_t    currentTime;
     DevSlot   *dp;
     int       equipmentNo;
     char      fNameNew[MaxFSPath + 128];
-    int       iSuffix;
     LpContext *lc;
     int       numParam;
     char      outBuf[MaxFSPath * 2 + 300];
-    bool      renameOK;
-    struct tm t;
 
     /*
     **  Operator wants to remove paper.
@@ -453,99 +453,102 @@ void lp1612RemovePaper(char *params)
 
     lc = (LpContext *)dp->context[0];
 
-    renameOK = FALSE;
-
-    //  SZoppi: this can happen if something goes wrong in the open
-    //          and the file fails to be properly re-opened.
-    if (dp->fcb[0] == NULL)
+    if (lpSpoolSize(lc->spool) == 0)
         {
-        logDtError(LogErrorLocation, "RemovePaper: FCB is null on channel %o equipment %o\n",
-                   dp->channel->id,
-                   dp->eqNo);
-        //  proceed to attempt to open a new FCB
+        sprintf(outBuf, "(lp1612 ) No output has been written on channel %o and equipment %o\n", channelNo, equipmentNo);
+        opDisplay(outBuf);
+
+        return;
         }
-    else
+
+    if (numParam <= 2)
         {
-        fflush(dp->fcb[0]);
+        lp1612NewFileName(lc, fNameNew);
+        }
 
-        if (ftell(dp->fcb[0]) == 0)
-            {
-            sprintf(outBuf, "(lp1612 ) No output has been written on channel %o and equipment %o\n", channelNo, equipmentNo);
-            opDisplay(outBuf);
+    /*
+    **  The spool writer closes and renames the device file once all output
+    **  printed so far has been written, and starts a new one. The outcome
+    **  is displayed by lp1612Rotated.
+    */
+    lpSpoolRotate(lc->spool, fNameNew, numParam <= 2);
+    }
 
-            return;
-            }
+/*--------------------------------------------------------------------------
+**  Purpose:        Name removed output in the format
+**                  "LP5xx_yyyymmdd_hhmmss_nn.txt". The sequence number
+**                  keeps removals within the same second apart.
+**
+**  Parameters:     Name        Description.
+**                  lc          pointer to printer context
+**                  fName       buffer receiving the path name
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lp1612NewFileName(LpContext *lc, char *fName)
+    {
+    time_t    currentTime;
+    struct tm t;
 
-        /*
-        **  Close the old device file.
-        */
-        fclose(dp->fcb[0]);
-        dp->fcb[0] = NULL;
+    time(&currentTime);
+    t = *localtime(&currentTime);
+    sprintf(fName, "%sLP5xx_%04d%02d%02d_%02d%02d%02d_%02d.txt",
+            lc->path,
+            t.tm_year + 1900,
+            t.tm_mon + 1,
+            t.tm_mday,
+            t.tm_hour,
+            t.tm_min,
+            t.tm_sec,
+            lc->removeSeq++ % 100);
+    }
 
-        if (numParam > 2)
-            {
-            if (rename(lc->curFileName, fNameNew) == 0)
-                {
-                renameOK = TRUE;
-                }
-            else
-                {
-                sprintf(outBuf, "(lp1612 ) Rename Failure '%s' to '%s' - (%s).\n", lc->curFileName, fNameNew, strerror(errno));
-                opDisplay(outBuf);
-                }
-            }
-        else
+/*--------------------------------------------------------------------------
+**  Purpose:        Report the outcome of a paper removal to the operator.
+**                  A generated name which could not be used is retried
+**                  with the next sequence number.
+**
+**  Parameters:     Name        Description.
+**                  owner       pointer to printer context
+**                  newName     path name of the removed output
+**                  isGenerated TRUE if newName was generated
+**                  status      outcome of the removal
+**                  err         errno of a failed rename
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lp1612Rotated(void *owner, char *newName, bool isGenerated, LpRotateStatus status, int err)
+    {
+    char      fNameNew[MaxFSPath + 128];
+    LpContext *lc = (LpContext *)owner;
+    char      outBuf[MaxFSPath * 2 + 300];
+
+    if (status == LpRotateRenameFailed)
+        {
+        if (isGenerated && (++lc->renameRetries < 100))
             {
-            /*
-            **  Rename the device file to the format "LP5xx_yyyymmdd_hhmmss_nn.txt".
-            */
-            for (iSuffix = 0; iSuffix < 100; iSuffix++)
-                {
-                time(&currentTime);
-                t = *localtime(&currentTime);
-                sprintf(fNameNew, "%sLP5xx_%04d%02d%02d_%02d%02d%02d_%02d.txt",
-                        lc->path,
-                        t.tm_year + 1900,
-                        t.tm_mon + 1,
-                        t.tm_mday,
-                        t.tm_hour,
-                        t.tm_min,
-                        t.tm_sec,
-                        iSuffix);
-
-                if (rename(lc->curFileName, fNameNew) == 0)
-                    {
-                    renameOK = TRUE;
-                    break;
-                    }
-
-                logDtError(LogErrorLocation, "Rename Failure '%s' to '%s' - (%s). Retrying (%d)...\n",
-                           lc->curFileName,
-                           fNameNew,
-                           strerror(errno),
-                           iSuffix);
-                }
-            }
-        }
+            lp1612NewFileName(lc, fNameNew);
+            lpSpoolRotate(lc->spool, fNameNew, TRUE);
 
-    /*
-    **  Open the device file.
-    */
-    dp->fcb[0] = fopen(lc->curFileName, renameOK ? "w" : "a");
+            return;
+            }
 
-    /*
-    **  Check if the open succeeded.
-    */
-    if (dp->fcb[0] == NULL)
-        {
-        logDtError(LogErrorLocation, "Failed to open %s\n", lc->curFileName);
+        lc->renameRetries = 0;
+        sprintf(outBuf, "(lp1612 ) Rename Failure '%s' to '%s' - (%s).\n", lc->curFileName, newName, strerror(err));
+        opDisplay(outBuf);
 
         return;
         }
 
-    if (renameOK)
+    lc->renameRetries = 0;
+    sprintf(outBuf, "(lp1612 ) Paper removed and available on '%s'\n", newName);
+    opDisplay(outBuf);
+
+    if (status == LpRotatePostFailed)
         {
-        sprintf(outBuf, "(lp1612 ) Paper removed and available on '%s'\n", fNameNew);
+        sprintf(outBuf, "(lp1612 ) Post-processing of '%s' failed\n", newName);
         opDisplay(outBuf);
         }
     }
@@ -561,21 +564,8 @@ void lp1612RemovePaper(char *params)
 **------------------------------------------------------------------------*/
 static FcStatus lp1612Func(PpWord funcCode)
     {
-    LpContext *lc  = (LpContext *)activeDevice->context[0];
-    FILE      *fcb = activeDevice->fcb[0];
-
-    //
-    //  This can happen if something goes wrong in the open and the file fails
-    //  to be properly re-opened.
-    //
-    if (fcb == NULL)
-        {
-        logDtError(LogErrorLocation, "Io: FCB is null on channel %o equipment %o\n",
-                   activeDevice->channel->id,
-                   activeDevice->eqNo);
-
-        return FcProcessed;
-        }
+    LpContext *lc = (LpContext *)activeDevice->context[0];
+    LpSpool   *sp = lc->spool;
 
 #if DEBUG
     fprintf(lp1612Log, "\n%06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
@@ -604,15 +594,15 @@ static FcStatus lp1612Func(PpWord funcCode)
             {
         default:
         case ModeCDC:
-            lp1612PrintCDC(lc, fcb);
+            lp1612PrintCDC(lc, sp);
             break;
 
         case ModeANSI:
-            lp1612PrintANSI(lc, fcb);
+            lp1612PrintANSI(lc, sp);
             break;
 
         case ModeASCII:
-            lp1612PrintASCII(lc, fcb);
+            lp1612PrintASCII(lc, sp);
             break;
             }
         lc->linePos = 0;
@@ -624,11 +614,11 @@ static FcStatus lp1612Func(PpWord funcCode)
     case FcPrintEject:
         if ((lc->prePrintFunc != 0) && (lc->prePrintFunc != FcPrintNoSpace))
             {
-            fputs(lp1612FeForPrePrint(lc, lc->prePrintFunc), fcb);
-            fputc('\n', fcb);
+            lpSpoolPuts(sp, lp1612FeForPrePrint(lc, lc->prePrintFunc));
+            lpSpoolPutc(sp, '\n');
             }
         lc->prePrintFunc = funcCode;
-        fflush(fcb);
+        lpSpoolFlush(sp);
         break;
 
     case FcPrintNoSpace:
@@ -667,21 +657,7 @@ static FcStatus lp1612Func(PpWord funcCode)
 **------------------------------------------------------------------------*/
 static void lp1612Io(void)
     {
-    LpContext *lc  = (LpContext *)activeDevice->context[0];
-    FILE      *fcb = activeDevice->fcb[0];
-
-    //
-    //  This can happen if something goes wrong in the open and the file fails
-    //  to be properly re-opened.
-    //
-    if (fcb == NULL)
-        {
-        logDtError(LogErrorLocation, "Io: FCB is null on channel %o equipment %o\n",
-                   activeDevice->channel->id,
-                   activeDevice->eqNo);
-
-        return;
-        }
+    LpContext *lc = (LpContext *)activeDevice->context[0];
 
     if (activeDevice->fcode == FcPrintStatusReq)
         {
@@ -736,12 +712,12 @@ static void lp1612Disconnect(void)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp1612PrintANSI(LpContext *lc, FILE *fcb)
+static void lp1612PrintANSI(LpContext *lc, LpSpool *sp)
     {
     char *fe;
     u8   i;
@@ -766,12 +742,12 @@ static void lp1612PrintANSI(LpContext *lc, FILE *fcb)
     lc->doSuppress = FALSE;
     if ((fe == NULL) || (*fe != '+') || (lc->linePos > 0))
         {
-        fputs(fe != NULL ? fe : " ", fcb);
+        lpSpoolPuts(sp, fe != NULL ? fe : " ");
         for (i = 0; i < lc->linePos; i++)
             {
-            fputc(lc->line[i], fcb);
+            lpSpoolPutc(sp, lc->line[i]);
             }
-        fputc('\n', fcb);
+        lpSpoolPutc(sp, '\n');
         }
     }
 
@@ -780,32 +756,32 @@ static void lp1612PrintANSI(LpContext *lc, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp1612PrintASCII(LpContext *lc, FILE *fcb)
+static void lp1612PrintASCII(LpContext *lc, LpSpool *sp)
     {
     int i;
 
     if (lc->prePrintFunc != 0)
         {
-        fputs(lp1612FeForPrePrint(lc, lc->prePrintFunc), fcb);
+        lpSpoolPuts(sp, lp1612FeForPrePrint(lc, lc->prePrintFunc));
         lc->prePrintFunc = 0;
         }
     for (i = 0; i < lc->linePos; i++)
         {
-        fputc(lc->line[i], fcb);
+        lpSpoolPutc(sp, lc->line[i]);
         }
     if (lc->doSuppress)
         {
-        fputc('\r', fcb);
+        lpSpoolPutc(sp, '\r');
         lc->doSuppress = FALSE;
         }
     else
         {
-        fputc('\n', fcb);
+        lpSpoolPutc(sp, '\n');
         }
     }
 
@@ -814,12 +790,12 @@ static void lp1612PrintASCII(LpContext *lc, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp1612PrintCDC(LpContext *lc, FILE *fcb)
+static void lp1612PrintCDC(LpContext *lc, LpSpool *sp)
     {
     u8   i;
     char *postFE;
@@ -850,19 +826,19 @@ static void lp1612PrintCDC(LpContext *lc, FILE *fcb)
             {
             return;
             }
-        fputs(preFE, fcb);
+        lpSpoolPuts(sp, preFE);
         if (postFE != NULL)
             {
-            fputc('\n', fcb);
+            lpSpoolPutc(sp, '\n');
             }
         }
     if (postFE != NULL)
         {
-        fputs(postFE, fcb);
+        lpSpoolPuts(sp, postFE);
         }
     if ((preFE == NULL) && (postFE == NULL))
         {
-        fputc(' ', fcb);
+        lpSpoolPutc(sp, ' ');
         if (lc->doSuppress)
             {
             lc->prePrintFunc = FcPrintNoSpace;
@@ -870,9 +846,9 @@ static void lp1612PrintCDC(LpContext *lc, FILE *fcb)
         }
     for (i = 0; i < lc->linePos; i++)
         {
-        fputc(lc->line[i], fcb);
+        lpSpoolPutc(sp, lc->line[i]);
         }
-    fputc('\n', fcb);
+    lpSpoolPutc(sp, '\n');
     }
 
 /*--------------------------------------------------------------------------
@@ -35,8 +35,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -46,7 +44,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <errno.h>
 #include "const.h"
 #include "types.h"
 #include "proto.h"
@@ -212,6 +209,9 @@ typedef struct lpContext
     bool             doBurst;            //  bursting option for forced segmentation at EOJ
     char             path[MaxFSPath];    //  preserve the device folder path
     char             curFileName[MaxFSPath + 128];
+    LpSpool          *spool;             //  output spool
+    u32              removeSeq;          //  sequence number of paper removals
+    u32              renameRetries;      //  failed renames of generated names
     } LpContext;
 
 
@@ -223,20 +223,19 @@ typedef struct lpContext
 static void     lp3000Init(u16 lpType, u8 eqNo, u8 unitNo, u8 channelNo, char *deviceParams);
 static char    *lp3000FeForPostPrint(LpContext *lc, u8 func);
 static char    *lp3000FeForPrePrint(LpContext *lc, u8 func);
+static void     lp3000NewFileName(LpContext *lc, char *fName);
+static void     lp3000Rotated(void *owner, char *newName, bool isGenerated, LpRotateStatus status, int err);
 static FcStatus lp3000Func(PpWord funcCode);
 static void     lp3000Io(void);
 static void     lp3000Activate(void);
 static void     lp3000Disconnect(void);
-static void     lp3000PrintANSI(LpContext *lc, FILE *fcb);
-static void     lp3000PrintASCII(LpContext *lc, FILE *fcb);
-static void     lp3000PrintCDC(LpContext *lc, FILE *fcb);
+static void     lp3000PrintANSI(LpContext *lc, LpSpool *sp);
+static void     lp3000PrintASCII(LpContext *lc, LpSpool *sp);
+static void     lp3000PrintCDC(LpContext *lc, LpSpool *sp);
 
-#if DEBUG
 static void     lp3000DebugData(LpContext *lc);
 static char    *lp3000Func2String(LpContext *lc, PpWord funcCode);
 
-#endif
-
 /*
 **  ----------------
 **  Public Variables
@@ -307,9 +306,7 @@ static char *renderingModes[] =
     "ASCII"
     };
 
-#if DEBUG
-static FILE *lp3000Log = NULL;
-#endif
+static DevLogModule *lp3000Log;
 
 /*
  **--------------------------------------------------------------------------
@@ -395,12 +392,7 @@ static void lp3000Init(u16 lpType, u8 eqNo, u8 unitNo, u8 channelNo, char *devic
     u8        mode;
     DevSlot   *up;
 
-#if DEBUG
-    if (lp3000Log == NULL)
-        {
-        lp3000Log = fopen("lp3000log.txt", "wt");
-        }
-#endif
+    lp3000Log = devLogRegister("lp3000");
 
     flags      = lpType;
     lpTypeName = (lpType == Lp3000Type501) ? "LP501" : "LP512",
@@ -499,6 +491,7 @@ static void lp3000Init(u16 lpType, u8 eqNo, u8 unitNo, u8 channelNo, char *devic
     up->disconnect = lp3000Disconnect;
     up->func       = lp3000Func;
     up->io         = lp3000Io;
+    up->blockIo    = TRUE;
 
     /*
     **  Only one printer unit is possible per equipment.
@@ -552,8 +545,8 @@ static void lp3000Init(u16 lpType, u8 eqNo, u8 unitNo, u8 channelNo, char *devic
     */
     sprintf(lc->curFileName, "%sLP5xx_C%02o_E%o", lc->path, channelNo, eqNo);
 
-    up->fcb[0] = fopen(lc->curFileName, "w");
-    if (up->fcb[0] == NULL)
+    lc->spool = lpSpoolOpen(lc->curFileName, lp3000Rotated, lc);
+    if (lc->spool == NULL)
         {
         logDtError(LogErrorLocation, "Failed to open %s\n", lc->curFileName);
         exit(1);
@@ -626,16 +619,12 @@ void lp3000ShowStatus()
 void lp3000RemovePaper(char *params)
     {
     int       channelNo;
-    time_t    currentTime;
     DevSlot   *dp;
     int       equipmentNo;
     char      fNameNew[MaxFSPath + 128];
-    int       iSuffix;
     LpContext *lc;
     int       numParam;
     char      outBuf[MaxFSPath * 2 + 300];
-    bool      renameOK;
-    struct tm t;
 
     /*
     **  Operator wants to remove paper.
@@ -678,102 +667,104 @@ void lp3000RemovePaper(char *params)
         return;
         }
 
-    lc       = (LpContext *)dp->context[0];
-    renameOK = FALSE;
+    lc = (LpContext *)dp->context[0];
 
-    //
-    //  This can happen if something goes wrong in the open and the file fails
-    //  to be properly re-opened.
-    //
-    if (dp->fcb[0] == NULL)
+    if (lpSpoolSize(lc->spool) == 0)
         {
-        logDtError(LogErrorLocation, "lp3000RemovePaper: FCB is null on channel %o equipment %o\n",
-                   dp->channel->id,
-                   dp->eqNo);
-        //  proceed to attempt to open a new FCB
-        }
-    else
-        {
-        fflush(dp->fcb[0]);
-
-        if (ftell(dp->fcb[0]) == 0)
-            {
-            sprintf(outBuf, "(lp3000 ) No output has been written on channel %o and equipment %o\n", channelNo, equipmentNo);
-            opDisplay(outBuf);
-
-            return;
-            }
+        sprintf(outBuf, "(lp3000 ) No output has been written on channel %o and equipment %o\n", channelNo, equipmentNo);
+        opDisplay(outBuf);
 
-        /*
-        **  Close the old device file.
-        */
-        fclose(dp->fcb[0]);
-        dp->fcb[0] = NULL;
+        return;
+        }
 
-        if (numParam > 2)
-            {
-            if (rename(lc->curFileName, fNameNew) == 0)
-                {
-                renameOK = TRUE;
-                }
-            else
-                {
-                sprintf(outBuf, "(lp3000 ) Rename Failure '%s' to '%s' - (%s).\n", lc->curFileName, fNameNew, strerror(errno));
-                opDisplay(outBuf);
-                }
-            }
-        else
-            {
-            /*
-            **  Rename the device file to the format "LP5xx_yyyymmdd_hhmmss_nn.txt".
-            */
-            for (iSuffix = 0; iSuffix < 100; iSuffix++)
-                {
-                time(&currentTime);
-                t = *localtime(&currentTime);
-                sprintf(fNameNew, "%sLP5xx_%04d%02d%02d_%02d%02d%02d_%02d.txt",
-                        lc->path,
-                        t.tm_year + 1900,
-                        t.tm_mon + 1,
-                        t.tm_mday,
-                        t.tm_hour,
-                        t.tm_min,
-                        t.tm_sec,
-                        iSuffix);
-
-                if (rename(lc->curFileName, fNameNew) == 0)
-                    {
-                    renameOK = TRUE;
-                    break;
-                    }
-                logDtError(LogErrorLocation, "Rename Failure '%s' to '%s' - (%s). Retrying (%d)...\n",
-                           lc->curFileName,
-                           fNameNew,
-                           strerror(errno),
-                           iSuffix);
-                }
-            }
+    if (numParam <= 2)
+        {
+        lp3000NewFileName(lc, fNameNew);
         }
 
     /*
-    **  Open the device file.
+    **  The spool writer closes and renames the device file once all output
+    **  printed so far has been written, and starts a new one. The outcome
+    **  is displayed by lp3000Rotated.
     */
+    lpSpoolRotate(lc->spool, fNameNew, numParam <= 2);
+    }
 
-    //  Just append to the old file if the rename didn't happen correctly
-    dp->fcb[0] = fopen(lc->curFileName, renameOK ? "w" : "a");
+/*--------------------------------------------------------------------------
+**  Purpose:        Name removed output in the format
+**                  "LP5xx_yyyymmdd_hhmmss_nn.txt". The sequence number
+**                  keeps removals within the same second apart.
+**
+**  Parameters:     Name        Description.
+**                  lc          pointer to printer context
+**                  fName       buffer receiving the path name
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lp3000NewFileName(LpContext *lc, char *fName)
+    {
+    time_t    currentTime;
+    struct tm t;
 
-    /*
-    **  Check if the open succeeded.
-    */
-    if (dp->fcb[0] == NULL)
+    time(&currentTime);
+    t = *localtime(&currentTime);
+    sprintf(fName, "%sLP5xx_%04d%02d%02d_%02d%02d%02d_%02d.txt",
+            lc->path,
+            t.tm_year + 1900,
+            t.tm_mon + 1,
+            t.tm_mday,
+            t.tm_hour,
+            t.tm_min,
+            t.tm_sec,
+            lc->removeSeq++ % 100);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Report the outcome of a paper removal to the operator.
+**                  A generated name which could not be used is retried
+**                  with the next sequence number.
+**
+**  Parameters:     Name        Description.
+**                  owner       pointer to printer context
+**                  newName     path name of the removed output
+**                  isGenerated TRUE if newName was generated
+**                  status      outcome of the removal
+**                  err         errno of a failed rename
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lp3000Rotated(void *owner, char *newName, bool isGenerated, LpRotateStatus status, int err)
+    {
+    char      fNameNew[MaxFSPath + 128];
+    LpContext *lc = (LpContext *)owner;
+    char      outBuf[MaxFSPath * 2 + 300];
+
+    if (status == LpRotateRenameFailed)
         {
-        logDtError(LogErrorLocation, "Failed to open %s\n", lc->curFileName);
+        if (isGenerated && (++lc->renameRetries < 100))
+            {
+            lp3000NewFileName(lc, fNameNew);
+            lpSpoolRotate(lc->spool, fNameNew, TRUE);
+
+            return;
+            }
+
+        lc->renameRetries = 0;
+        sprintf(outBuf, "(lp3000 ) Rename Failure '%s' to '%s' - (%s).\n", lc->curFileName, newName, strerror(err));
+        opDisplay(outBuf);
 
         return;
         }
-    if (renameOK)
+
+    lc->renameRetries = 0;
+    sprintf(outBuf, "(lp3000 ) Paper removed from 5xx printer and available on '%s'\n", newName);
+    opDisplay(outBuf);
+
+    if (status == LpRotatePostFailed)
         {
-        sprintf(outBuf, "(lp3000 ) Paper removed from 5xx printer and available on '%s'\n", fNameNew);
+        sprintf(outBuf, "(lp3000 ) Post-processing of '%s' failed\n", newName);
         opDisplay(outBuf);
         }
     }
@@ -789,38 +780,26 @@ void lp3000RemovePaper(char *params)
 **------------------------------------------------------------------------*/
 static FcStatus lp3000Func(PpWord funcCode)
     {
-    FILE      *fcb;
     LpContext *lc;
+    LpSpool   *sp;
 
     char         dispLpDevId[16];       //  Used for automatically removing printouts at EOJ
     unsigned int channelId;
     unsigned int deviceId;
 
-    fcb = active3000Device->fcb[0];
-    lc  = (LpContext *)active3000Device->context[0];
+    lc = (LpContext *)active3000Device->context[0];
+    sp = lc->spool;
 
-    /*
-    **  This can happen if something goes wrong in the open and the file fails
-    **  to be properly re-opened.
-    */
-    if (fcb == NULL)
+    if (DevLogEnabled(lp3000Log, DevLogInfo))
         {
-        logDtError(LogErrorLocation, "lp3000Func: FCB is null on channel %o equipment %o\n",
-                   active3000Device->channel->id,
-                   active3000Device->eqNo);
-
-        return FcProcessed;
+        devLogText(lp3000Log, "\n%06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id,
+                   funcCode,
+                   lp3000Func2String(lc, funcCode));
         }
 
-#if DEBUG
-    fprintf(lp3000Log, "\n%06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id,
-            funcCode,
-            lp3000Func2String(lc, funcCode));
-#endif
-
     //  Start with the common codes
 
     switch (funcCode)
@@ -833,7 +812,7 @@ static FcStatus lp3000Func(PpWord funcCode)
     case FcPrintAutoEject:
         if ((lc->renderingMode != ModeASCII) && (lc->doAutoEject == FALSE))
             {
-            fputs("R\n", fcb);
+            lpSpoolPuts(sp, "R\n");
             }
         lc->doAutoEject = TRUE;
 
@@ -853,7 +832,7 @@ static FcStatus lp3000Func(PpWord funcCode)
     case FcPrintRelease:
         // clear all interrupt conditions
         lc->flags &= ~(StPrintIntReady | StPrintIntEnd);
-        fflush(fcb);
+        lpSpoolFlush(sp);
 
         // Release is sent at end of job, so flush the print file
         if (lc->isPrinted && lc->doBurst)
@@ -873,8 +852,8 @@ static FcStatus lp3000Func(PpWord funcCode)
     case FcPrintEject:
         if ((lc->prePrintFunc != 0) && (lc->prePrintFunc != FcPrintNoSpace))
             {
-            fputs(lp3000FeForPrePrint(lc, lc->prePrintFunc), fcb);
-            fputc('\n', fcb);
+            lpSpoolPuts(sp, lp3000FeForPrePrint(lc, lc->prePrintFunc));
+            lpSpoolPutc(sp, '\n');
             }
         lc->prePrintFunc = (u8)funcCode;
 
@@ -927,7 +906,7 @@ static FcStatus lp3000Func(PpWord funcCode)
         case Fc3555Sel8Lpi:
             if ((lc->renderingMode != ModeASCII) && (lc->lpi != 8))
                 {
-                fputs("T\n", fcb);
+                lpSpoolPuts(sp, "T\n");
                 }
             lc->lpi = 8;
 
@@ -936,7 +915,7 @@ static FcStatus lp3000Func(PpWord funcCode)
         case Fc3555Sel6Lpi:
             if ((lc->renderingMode != ModeASCII) && (lc->lpi != 6))
                 {
-                fputs("S\n", fcb);
+                lpSpoolPuts(sp, "S\n");
                 }
             lc->lpi = 6;
 
@@ -946,7 +925,7 @@ static FcStatus lp3000Func(PpWord funcCode)
             if ((lc->renderingMode != ModeASCII)
                 && ((lc->lpi != 6) || lc->doAutoEject))
                 {
-                fputs("Q\n", fcb);
+                lpSpoolPuts(sp, "Q\n");
                 }
 
         case Fc3555CondClearFormat:
@@ -1090,7 +1069,7 @@ static FcStatus lp3000Func(PpWord funcCode)
         case Fc3152ClearFormat:
             if ((lc->renderingMode != ModeASCII) && lc->doAutoEject)
                 {
-                fputs("Q\n", fcb);
+                lpSpoolPuts(sp, "Q\n");
                 }
             lc->postPrintFunc = 0;
             lc->lpi           = 6;
@@ -1210,13 +1189,11 @@ static void lp3000Io(void)
     case Fc6681Output:
         if (activeChannel->full)
             {
-#if DEBUG
-            if (lc->linePos % 16 == 0)
+            if (DevLogEnabled(lp3000Log, DevLogDebug))
                 {
-                fputs("\n   ", lp3000Log);
+                devLogText(lp3000Log, "%s %04o", lc->linePos % 16 == 0 ? "\n   " : "", activeChannel->data);
                 }
-            fprintf(lp3000Log, " %04o", activeChannel->data);
-#endif
+
             if (lc->linePos < MaxLineSize)
                 {
                 if (lc->flags & Lp3000ExtArray)
@@ -1271,40 +1248,28 @@ static void lp3000Activate(void)
 **------------------------------------------------------------------------*/
 static void lp3000Disconnect(void)
     {
-    FILE      *fcb = active3000Device->fcb[0];
-    LpContext *lc  = (LpContext *)active3000Device->context[0];
-
-    //
-    //  This can happen if something goes wrong in the open and the file fails
-    //  to be properly re-opened.
-    //
-    if (fcb == NULL)
-        {
-        logDtError(LogErrorLocation, "lp3000Disconnect: FCB is null on channel %o equipment %o\n",
-                   active3000Device->channel->id,
-                   active3000Device->eqNo);
-
-        return;
-        }
+    LpContext *lc = (LpContext *)active3000Device->context[0];
 
     if (active3000Device->fcode == Fc6681Output)
         {
-#if DEBUG
-        lp3000DebugData(lc);
-#endif
+        if (DevLogEnabled(lp3000Log, DevLogDebug))
+            {
+            lp3000DebugData(lc);
+            }
+
         switch (lc->renderingMode)
             {
         default:
         case ModeCDC:
-            lp3000PrintCDC(lc, fcb);
+            lp3000PrintCDC(lc, lc->spool);
             break;
 
         case ModeANSI:
-            lp3000PrintANSI(lc, fcb);
+            lp3000PrintANSI(lc, lc->spool);
             break;
 
         case ModeASCII:
-            lp3000PrintASCII(lc, fcb);
+            lp3000PrintASCII(lc, lc->spool);
             break;
             }
         lc->linePos             = 0;
@@ -1317,12 +1282,12 @@ static void lp3000Disconnect(void)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp3000PrintANSI(LpContext *lc, FILE *fcb)
+static void lp3000PrintANSI(LpContext *lc, LpSpool *sp)
     {
     char *fe;
     u8   i;
@@ -1349,12 +1314,12 @@ static void lp3000PrintANSI(LpContext *lc, FILE *fcb)
     lc->doSuppress = FALSE;
     if ((fe == NULL) || (*fe != '+') || (lc->linePos > 0))
         {
-        fputs(fe != NULL ? fe : " ", fcb);
+        lpSpoolPuts(sp, fe != NULL ? fe : " ");
         for (i = 0; i < lc->linePos; i++)
             {
-            fputc(lc->line[i], fcb);
+            lpSpoolPutc(sp, lc->line[i]);
             }
-        fputc('\n', fcb);
+        lpSpoolPutc(sp, '\n');
         }
     }
 
@@ -1363,32 +1328,32 @@ static void lp3000PrintANSI(LpContext *lc, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp3000PrintASCII(LpContext *lc, FILE *fcb)
+static void lp3000PrintASCII(LpContext *lc, LpSpool *sp)
     {
     int i;
 
     if (lc->prePrintFunc != 0)
         {
-        fputs(lp3000FeForPrePrint(lc, lc->prePrintFunc), fcb);
+        lpSpoolPuts(sp, lp3000FeForPrePrint(lc, lc->prePrintFunc));
         lc->prePrintFunc = 0;
         }
     for (i = 0; i < lc->linePos; i++)
         {
-        fputc(lc->line[i], fcb);
+        lpSpoolPutc(sp, lc->line[i]);
         }
     if (lc->doSuppress)
         {
-        fputc('\r', fcb);
+        lpSpoolPutc(sp, '\r');
         lc->doSuppress = FALSE;
         }
     else
         {
-        fputc('\n', fcb);
+        lpSpoolPutc(sp, '\n');
         }
     }
 
@@ -1397,12 +1362,12 @@ static void lp3000PrintASCII(LpContext *lc, FILE *fcb)
 **
 **  Parameters:     Name        Description.
 **                  lc          pointer to line printer context
-**                  fcb         pointer to printer file descriptor
+**                  sp          pointer to printer spool
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-static void lp3000PrintCDC(LpContext *lc, FILE *fcb)
+static void lp3000PrintCDC(LpContext *lc, LpSpool *sp)
     {
     u8   i;
     char *postFE;
@@ -1433,19 +1398,19 @@ static void lp3000PrintCDC(LpContext *lc, FILE *fcb)
             {
             return;
             }
-        fputs(preFE, fcb);
+        lpSpoolPuts(sp, preFE);
         if (postFE != NULL)
             {
-            fputc('\n', fcb);
+            lpSpoolPutc(sp, '\n');
             }
         }
     if (postFE != NULL)
         {
-        fputs(postFE, fcb);
+        lpSpoolPuts(sp, postFE);
         }
     if ((preFE == NULL) && (postFE == NULL))
         {
-        fputc(' ', fcb);
+        lpSpoolPutc(sp, ' ');
         if (lc->doSuppress)
             {
             lc->prePrintFunc = FcPrintNoSpace;
@@ -1453,9 +1418,9 @@ static void lp3000PrintCDC(LpContext *lc, FILE *fcb)
         }
     for (i = 0; i < lc->linePos; i++)
         {
-        fputc(lc->line[i], fcb);
+        lpSpoolPutc(sp, lc->line[i]);
         }
-    fputc('\n', fcb);
+    lpSpoolPutc(sp, '\n');
     }
 
 /*--------------------------------------------------------------------------
@@ -1694,8 +1659,6 @@ static char *lp3000FeForPrePrint(LpContext *lc, u8 func)
         }
     }
 
-#if DEBUG
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Dump raw line data.
 **
@@ -1707,21 +1670,26 @@ static char *lp3000FeForPrePrint(LpContext *lc, u8 func)
 **------------------------------------------------------------------------*/
 static void lp3000DebugData(LpContext *lc)
     {
-    int i;
+    int  i;
+    int  n;
+    char text[137];
 
     if (lc->linePos > 0)
         {
-        fprintf(lp3000Log, "\n    prePrintFunc:%04o  postPrintFunc:%04o  doSuppress:%s",
-                lc->prePrintFunc, lc->postPrintFunc, lc->doSuppress ? "TRUE" : "FALSE");
+        devLogText(lp3000Log, "\n    prePrintFunc:%04o  postPrintFunc:%04o  doSuppress:%s",
+                   lc->prePrintFunc, lc->postPrintFunc, lc->doSuppress ? "TRUE" : "FALSE");
+        n = 0;
         for (i = 0; i < lc->linePos; i++)
             {
-            if (i % 136 == 0)
+            text[n++] = (char)lc->line[i];
+            if ((n == 136) || (i == lc->linePos - 1))
                 {
-                fputc('\n', lp3000Log);
+                text[n] = '\0';
+                devLogText(lp3000Log, "\n%s", text);
+                n = 0;
                 }
-            fputc(lc->line[i], lp3000Log);
             }
-        fputc('\n', lp3000Log);
+        devLogText(lp3000Log, "\n");
         }
     }
 
@@ -1981,6 +1949,4 @@ static char *lp3000Func2String(LpContext *lc, PpWord funcCode)
     return (buf);
     }
 
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -0,0 +1,691 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: lpspool.c
+**
+**  Description:
+**      Line printer spool engine shared by the line printer emulations.
+**
+**      Printed lines are collected in memory and handed in batches to a
+**      writer thread owned by the spool file, so a slow host disk does
+**      not stall the emulation. Removing the paper is queued behind the
+**      data already printed and carried out by the writer thread, which
+**      closes, renames and reopens the spool file and then optionally
+**      runs a post-processing command on the completed file. The outcome
+**      is handed back and reported to the printer emulation on the main
+**      emulation thread.
+**
+**      On Windows the spool operations are performed synchronously.
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define LpSpoolStageSize    4096
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+typedef struct lpSpoolBlock
+    {
+    struct lpSpoolBlock *next;
+    bool                isRotate;       /* data holds new file name, not output */
+    bool                isGenerated;    /* new file name was not given by operator */
+    i64                 size;           /* bytes printed into the rotated file */
+    LpRotateStatus      status;         /* outcome of rotate */
+    int                 err;            /* errno of failed rename */
+    int                 len;
+    char                data[1];
+    } LpSpoolBlock;
+
+struct lpSpool
+    {
+    struct lpSpool  *next;              /* next spool in list of all spools */
+    char            fileName[MaxFSPath + 128];
+    FILE            *fcb;               /* spool file, owned by the writer */
+    LpRotateDone    rotated;            /* reports the outcome of rotates */
+    void            *owner;             /* printer context passed to rotated */
+
+    /*
+    **  Used by the emulation thread only.
+    */
+    i64             size;               /* bytes printed since last rotate */
+    int             stageLen;
+    char            stage[LpSpoolStageSize];
+
+#if !defined(_WIN32)
+    pthread_t       thread;             /* writer thread */
+    pthread_mutex_t mutex;              /* protects everything below */
+    pthread_cond_t  cond;               /* signalled on any state change */
+    bool            stop;               /* writer thread must exit */
+    LpSpoolBlock    *first;             /* queued blocks */
+    LpSpoolBlock    *last;
+#endif
+    LpSpoolBlock    *doneFirst;         /* completed rotates waiting to be reported */
+    LpSpoolBlock    *doneLast;
+    };
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static void         lpSpoolDone(LpSpool *sp, LpSpoolBlock *bp);
+static void         lpSpoolFreeBlocks(LpSpoolBlock *bp);
+static LpSpoolBlock *lpSpoolNewBlock(bool isRotate, char *data, int len);
+static void         lpSpoolPost(LpSpool *sp, LpSpoolBlock *bp);
+static void         lpSpoolProcess(LpSpool *sp, LpSpoolBlock *bp);
+static void         lpSpoolRename(LpSpool *sp, LpSpoolBlock *bp);
+
+#if !defined(_WIN32)
+static void *lpSpoolThread(void *param);
+
+#endif
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+char          lpSpoolPostCmd[MaxFSPath] = "";
+volatile bool lpSpoolReportPending      = FALSE;
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static LpSpool *firstSpool = NULL;
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Create a spool file and start its writer.
+**
+**  Parameters:     Name        Description.
+**                  fileName    path name of spool file
+**                  rotated     function called on the emulation thread
+**                              with the outcome of each rotate
+**                  owner       printer context passed to rotated
+**
+**  Returns:        Pointer to spool, or NULL if the file could not be
+**                  created.
+**
+**------------------------------------------------------------------------*/
+LpSpool *lpSpoolOpen(char *fileName, LpRotateDone rotated, void *owner)
+    {
+    LpSpool *sp;
+
+    sp = (LpSpool *)calloc(1, sizeof(LpSpool));
+    if (sp == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate printer spool\n");
+        exit(1);
+        }
+
+    strcpy(sp->fileName, fileName);
+    sp->rotated = rotated;
+    sp->owner   = owner;
+    sp->fcb     = fopen(fileName, "w");
+    if (sp->fcb == NULL)
+        {
+        free(sp);
+
+        return NULL;
+        }
+
+#if !defined(_WIN32)
+    pthread_mutex_init(&sp->mutex, NULL);
+    pthread_cond_init(&sp->cond, NULL);
+    if (pthread_create(&sp->thread, NULL, lpSpoolThread, sp) != 0)
+        {
+        logDtError(LogErrorLocation, "Failed to create printer spool thread\n");
+        exit(1);
+        }
+#endif
+
+    sp->next   = firstSpool;
+    firstSpool = sp;
+
+    return sp;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out everything printed, stop the writer and
+**                  close the spool file.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolClose(LpSpool *sp)
+    {
+    LpSpool **spp;
+
+    if (sp == NULL)
+        {
+        return;
+        }
+
+    lpSpoolFlush(sp);
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&sp->mutex);
+    sp->stop = TRUE;
+    pthread_cond_broadcast(&sp->cond);
+    pthread_mutex_unlock(&sp->mutex);
+    pthread_join(sp->thread, NULL);
+    pthread_cond_destroy(&sp->cond);
+    pthread_mutex_destroy(&sp->mutex);
+#endif
+
+    for (spp = &firstSpool; *spp != NULL; spp = &(*spp)->next)
+        {
+        if (*spp == sp)
+            {
+            *spp = sp->next;
+            break;
+            }
+        }
+
+    if (sp->fcb != NULL)
+        {
+        fclose(sp->fcb);
+        }
+
+    lpSpoolFreeBlocks(sp->doneFirst);
+    free(sp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Hand the output collected so far to the writer.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolFlush(LpSpool *sp)
+    {
+    if (sp->stageLen > 0)
+        {
+        lpSpoolPost(sp, lpSpoolNewBlock(FALSE, sp->stage, sp->stageLen));
+        sp->stageLen = 0;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Print a character.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  ch          character
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolPutc(LpSpool *sp, char ch)
+    {
+    if (sp->stageLen >= LpSpoolStageSize)
+        {
+        lpSpoolFlush(sp);
+        }
+
+    sp->stage[sp->stageLen++] = ch;
+    sp->size                 += 1;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Print a string.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  str         string
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolPuts(LpSpool *sp, char *str)
+    {
+    while (*str != '\0')
+        {
+        lpSpoolPutc(sp, *str++);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Report the outcome of completed rotates to their
+**                  printers. Called on the emulation thread when
+**                  lpSpoolReportPending is set.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolReport(void)
+    {
+    LpSpoolBlock *bp;
+    LpSpoolBlock *next;
+    LpSpool      *sp;
+
+    lpSpoolReportPending = FALSE;
+    for (sp = firstSpool; sp != NULL; sp = sp->next)
+        {
+#if !defined(_WIN32)
+        pthread_mutex_lock(&sp->mutex);
+#endif
+        bp            = sp->doneFirst;
+        sp->doneFirst = NULL;
+        sp->doneLast  = NULL;
+#if !defined(_WIN32)
+        pthread_mutex_unlock(&sp->mutex);
+#endif
+
+        while (bp != NULL)
+            {
+            next = bp->next;
+
+            /*
+            **  Output which could not be renamed is still in the spool
+            **  file and counts towards the next removal.
+            */
+            if (bp->status == LpRotateRenameFailed)
+                {
+                sp->size += bp->size;
+                }
+
+            if (sp->rotated != NULL)
+                {
+                sp->rotated(sp->owner, bp->data, bp->isGenerated, bp->status, bp->err);
+                }
+
+            free(bp);
+            bp = next;
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Remove the paper: once everything printed so far has
+**                  been written, the spool file is renamed and a new one
+**                  started under the original name. The outcome is
+**                  reported through the spool's rotated function.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  newName     path name for the completed output
+**                  isGenerated TRUE if the printer made up newName
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolRotate(LpSpool *sp, char *newName, bool isGenerated)
+    {
+    LpSpoolBlock *bp;
+
+    lpSpoolFlush(sp);
+    bp              = lpSpoolNewBlock(TRUE, newName, (int)strlen(newName) + 1);
+    bp->isGenerated = isGenerated;
+    bp->size        = sp->size;
+    sp->size        = 0;
+    lpSpoolPost(sp, bp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Return the amount of output printed since the spool
+**                  was created or last rotated.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**
+**  Returns:        Number of bytes.
+**
+**------------------------------------------------------------------------*/
+i64 lpSpoolSize(LpSpool *sp)
+    {
+    return sp->size;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Write out and close all spools.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void lpSpoolTerminate(void)
+    {
+    while (firstSpool != NULL)
+        {
+        lpSpoolClose(firstSpool);
+        }
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Queue a completed rotate for lpSpoolReport.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  bp          pointer to rotate block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lpSpoolDone(LpSpool *sp, LpSpoolBlock *bp)
+    {
+    bp->next = NULL;
+
+#if !defined(_WIN32)
+    pthread_mutex_lock(&sp->mutex);
+#endif
+    if (sp->doneFirst == NULL)
+        {
+        sp->doneFirst = bp;
+        }
+    else
+        {
+        sp->doneLast->next = bp;
+        }
+
+    sp->doneLast         = bp;
+    lpSpoolReportPending = TRUE;
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&sp->mutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Release a list of blocks.
+**
+**  Parameters:     Name        Description.
+**                  bp          pointer to first block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lpSpoolFreeBlocks(LpSpoolBlock *bp)
+    {
+    LpSpoolBlock *next;
+
+    while (bp != NULL)
+        {
+        next = bp->next;
+        free(bp);
+        bp = next;
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Allocate a block.
+**
+**  Parameters:     Name        Description.
+**                  isRotate    TRUE if data is a file name to rotate to
+**                  data        output or file name
+**                  len         length of data
+**
+**  Returns:        Pointer to block.
+**
+**------------------------------------------------------------------------*/
+static LpSpoolBlock *lpSpoolNewBlock(bool isRotate, char *data, int len)
+    {
+    LpSpoolBlock *bp;
+
+    bp = (LpSpoolBlock *)calloc(1, sizeof(LpSpoolBlock) + len);
+    if (bp == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate printer spool block\n");
+        exit(1);
+        }
+
+    bp->isRotate = isRotate;
+    bp->len      = len;
+    memcpy(bp->data, data, len);
+
+    return bp;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Queue a block for the writer.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  bp          pointer to block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lpSpoolPost(LpSpool *sp, LpSpoolBlock *bp)
+    {
+#if defined(_WIN32)
+    lpSpoolProcess(sp, bp);
+#else
+    pthread_mutex_lock(&sp->mutex);
+    if (sp->first == NULL)
+        {
+        sp->first = bp;
+        }
+    else
+        {
+        sp->last->next = bp;
+        }
+
+    sp->last = bp;
+    pthread_cond_broadcast(&sp->cond);
+    pthread_mutex_unlock(&sp->mutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Carry out a queued block and release it. Rotate
+**                  blocks are passed on to lpSpoolReport instead.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  bp          pointer to block
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lpSpoolProcess(LpSpool *sp, LpSpoolBlock *bp)
+    {
+    if (bp->isRotate)
+        {
+        lpSpoolRename(sp, bp);
+        lpSpoolDone(sp, bp);
+
+        return;
+        }
+
+    if (sp->fcb != NULL)
+        {
+        if (fwrite(bp->data, 1, bp->len, sp->fcb) != (size_t)bp->len)
+            {
+            logDtError(LogErrorLocation, "Failed to write to %s - (%s)\n", sp->fileName, strerror(errno));
+            }
+        }
+
+    free(bp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Rename the spool file, start a new one and run the
+**                  post-processing command on the completed file.
+**
+**  Parameters:     Name        Description.
+**                  sp          pointer to spool
+**                  bp          pointer to rotate block holding the path
+**                              name for the completed output; receives
+**                              the outcome
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void lpSpoolRename(LpSpool *sp, LpSpoolBlock *bp)
+    {
+    char cmd[MaxFSPath * 3];
+    char *newName = bp->data;
+    bool renameOK = FALSE;
+
+    if (sp->fcb != NULL)
+        {
+        fclose(sp->fcb);
+        sp->fcb = NULL;
+        }
+
+    if (rename(sp->fileName, newName) == 0)
+        {
+        renameOK   = TRUE;
+        bp->status = LpRotateOk;
+        }
+    else
+        {
+        bp->status = LpRotateRenameFailed;
+        bp->err    = errno;
+        logDtError(LogErrorLocation, "Rename Failure '%s' to '%s' - (%s). Output remains in '%s'\n",
+                   sp->fileName, newName, strerror(bp->err), sp->fileName);
+        }
+
+    /*
+    **  Just append to the old file if the rename didn't happen correctly.
+    */
+    sp->fcb = fopen(sp->fileName, renameOK ? "w" : "a");
+    if (sp->fcb == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to open %s\n", sp->fileName);
+        }
+
+    if (renameOK && (lpSpoolPostCmd[0] != '\0'))
+        {
+        sprintf(cmd, "%s \"%s\"", lpSpoolPostCmd, newName);
+        if (system(cmd) != 0)
+            {
+            bp->status = LpRotatePostFailed;
+            logDtError(LogErrorLocation, "Printer post-processing of '%s' failed\n", newName);
+            }
+        }
+    }
+
+#if !defined(_WIN32)
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Writer thread of a spool.
+**
+**  Parameters:     Name        Description.
+**                  param       pointer to spool
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void *lpSpoolThread(void *param)
+    {
+    LpSpoolBlock *bp;
+    LpSpoolBlock *next;
+    LpSpool      *sp = (LpSpool *)param;
+
+    pthread_mutex_lock(&sp->mutex);
+    for (;;)
+        {
+        while ((sp->first == NULL) && !sp->stop)
+            {
+            pthread_cond_wait(&sp->cond, &sp->mutex);
+            }
+
+        if (sp->first == NULL)
+            {
+            break;
+            }
+
+        /*
+        **  Take the whole queue and write it out as one batch.
+        */
+        bp        = sp->first;
+        sp->first = NULL;
+        sp->last  = NULL;
+        pthread_mutex_unlock(&sp->mutex);
+
+        while (bp != NULL)
+            {
+            next = bp->next;
+            lpSpoolProcess(sp, bp);
+            bp = next;
+            }
+
+        /*
+        **  Keep the spool file current for anyone watching it.
+        */
+        if (sp->fcb != NULL)
+            {
+            fflush(sp->fcb);
+            }
+
+        pthread_mutex_lock(&sp->mutex);
+        }
+    pthread_mutex_unlock(&sp->mutex);
+
+    return NULL;
+    }
+
+#endif
+
+/*---------------------------  End Of File  ------------------------------*/
@@ -68,6 +68,12 @@ extern int _isatty(int fd);
 **  -----------------
 */
 
+/*
+**  Number of consecutive matching samples before a CPU loop is
+**  considered idle by the generic detector.
+*/
+#define IdleAutoMinHits    64
+
 /*
 **  -----------------------
 **  Private Macro Functions
@@ -242,6 +248,11 @@ int main(int argc, char **argv)
     */
     opInit();
 
+    /*
+    **  Start performance metrics reporting.
+    */
+    metricsInit();
+
     /*
     **  Initiate deadstart sequence.
     */
@@ -249,6 +260,22 @@ int main(int argc, char **argv)
 
     fputs("(cpu    ) CPU0 started\n", stdout);
 
+    /*
+    **  Start the benchmark script, if any.
+    */
+    if (benchActive)
+        {
+        benchInit();
+        }
+
+    /*
+    **  Start timing the first major cycle now that initialisation is done.
+    */
+    if (latencyActive)
+        {
+        latencyEnable(TRUE);
+        }
+
     /*
     **  Emulation loop.
     */
@@ -263,6 +290,7 @@ int main(int argc, char **argv)
         **  Count major cycles.
         */
         cycles++;
+        metrics.cycles += 1;
 
         /*
         **  Deal with operator interface requests.
@@ -273,25 +301,77 @@ int main(int argc, char **argv)
             }
 
         /*
-        **  Execute PP, CPU and RTC.
+        **  Report completed paper removals.
+        */
+        if (lpSpoolReportPending)
+            {
+            lpSpoolReport();
+            }
+
+        /*
+        **  Advance the benchmark script.
+        */
+        if (benchActive)
+            {
+            benchStep();
+            }
+
+        /*
+        **  Execute PP, CPU and RTC. While latency tracking is on, the end
+        **  of each phase is time stamped.
         */
+        if (latencyActive)
+            {
+            latencyPhase(LatPhaseOpRequest);
+            }
+
         rtcTick();
+        if (latencyActive)
+            {
+            latencyPhase(LatPhaseRtc);
+            }
+
         ppStep();
+        if (latencyActive)
+            {
+            latencyPhase(LatPhasePp);
+            }
 
         cpuStep(cpus);
         cpuStep(cpus);
         cpuStep(cpus);
         cpuStep(cpus);
+        if (latencyActive)
+            {
+            latencyPhase(LatPhaseCpu);
+            }
 
         channelStep();
+        if (latencyActive)
+            {
+            latencyPhase(LatPhaseChannel);
+            }
 
         idleThrottle(cpus);
+        if (latencyActive)
+            {
+            latencyPhase(LatPhaseIdle);
+            latencyCycleEnd();
+            }
 
 #if CcCycleTime
         cycleTime = rtcStopTimer();
 #endif
         }
 
+    /*
+    **  Report benchmark results.
+    */
+    if (benchActive)
+        {
+        benchTerminate();
+        }
+
 #if CcDebug == 1
     /*
     **  Example post-mortem dumps.
@@ -312,7 +392,10 @@ int main(int argc, char **argv)
     windowTerminate();
     cpuTerminate();
     ppTerminate();
+    diskIoTerminate();
+    lpSpoolTerminate();
     channelTerminate();
+    devLogTerminate();
 
     /*
     **  Stop helpers, if any
@@ -321,7 +404,7 @@ int main(int argc, char **argv)
 
     opDisplay("Goodbye for now.\n\n");
 
-    exit(0);
+    exit(benchFailed ? 1 : 0);
     }
 
 /*--------------------------------------------------------------------------
@@ -475,6 +558,109 @@ bool idleDetectorMACE(CpuContext *ctx)
     return FALSE;
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Generic idle cycle detector for any operating system.
+**
+**                  Each call samples the CPU state. A program mode loop
+**                  at a fixed RA/FL which visits at most MaxIdleSlots
+**                  locations, and has identical registers every time it
+**                  passes one of them, cannot change anything until some
+**                  other agent (PP, other CPU) changes CM. Any stores it
+**                  makes rewrite the same values to the same addresses.
+**                  Such a loop is taken to be the idle loop once it has
+**                  been seen IdleAutoMinHits times in a row.
+**
+**  Parameters:     Name        Description.
+**                  ctx         Cpu context to check for idle.
+**
+**  Returns:        TRUE if in idle, FALSE if not.
+**
+**------------------------------------------------------------------------*/
+bool idleDetectorAuto(CpuContext *ctx)
+    {
+    u32 hash;
+    int i;
+    u32 where;
+
+    if (ctx->isMonitorMode)
+        {
+        ctx->idleHits  = 0;
+        ctx->idleSlots = 0;
+
+        return FALSE;
+        }
+
+    /*
+    **  Start a new fingerprint when the CPU runs another program.
+    */
+    if ((ctx->regRaCm != ctx->idleRa) || (ctx->regFlCm != ctx->idleFl))
+        {
+        ctx->idleRa    = ctx->regRaCm;
+        ctx->idleFl    = ctx->regFlCm;
+        ctx->idleHits  = 0;
+        ctx->idleSlots = 0;
+
+        return FALSE;
+        }
+
+    hash = 0;
+    for (i = 0; i < 8; i++)
+        {
+        hash = (hash * 31) + (u32)(ctx->regX[i] ^ (ctx->regX[i] >> 32));
+        hash = (hash * 31) + ctx->regA[i];
+        hash = (hash * 31) + ctx->regB[i];
+        }
+
+    where = (ctx->regP << 6) | ctx->opOffset;
+    for (i = 0; i < ctx->idleSlots; i++)
+        {
+        if (ctx->idleWhere[i] == where)
+            {
+            break;
+            }
+        }
+
+    if (i == ctx->idleSlots)
+        {
+        /*
+        **  New location in the loop, remember its register state unless
+        **  the loop is too large to be an idle loop.
+        */
+        if (i == MaxIdleSlots)
+            {
+            ctx->idleSlots = 0;
+            i = 0;
+            }
+
+        ctx->idleWhere[i] = where;
+        ctx->idleHash[i]  = hash;
+        ctx->idleSlots   += 1;
+        ctx->idleHits     = 0;
+
+        return FALSE;
+        }
+
+    if (ctx->idleHash[i] != hash)
+        {
+        /*
+        **  Registers are changing, the CPU is doing real work.
+        */
+        ctx->idleHash[i] = hash;
+        ctx->idleHits    = 0;
+
+        return FALSE;
+        }
+
+    if (ctx->idleHits < IdleAutoMinHits)
+        {
+        ctx->idleHits += 1;
+
+        return FALSE;
+        }
+
+    return TRUE;
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Run a helper process.
 **
@@ -25,11 +25,6 @@
 **--------------------------------------------------------------------------
 */
 
-/*
-**  If this is set to 1, the DEBUG flag in npu_hip.c must also be set to 1.
-*/
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -157,11 +152,6 @@
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG
-#define HexColumn(x)      (4 * (x) + 1 + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(24))
-#endif
 
 /*
 **  -----------------------------------------
@@ -203,21 +193,12 @@ static PpWord mdiHipReadMdiStatus(void);
 static bool mdiHipDownlineBlockImpl(NpuBuffer *bp);
 static bool mdiHipUplineBlockImpl(NpuBuffer *bp);
 static char *mdiHipFunc2String(PpWord funcCode);
-
-#if DEBUG
 static void mdiLogBuffer(u8 *dp);
-static void mdiLogBytes(int b);
-static void mdiLogFlush(void);
-static void mdiLogPpWord(int b);
+static void mdiLogParcel(u32 parcel);
 static char *mdiPfc2String(u8 pfc);
 static char *mdiSfc2String(u8 sfc);
-
-#endif
-#if defined(__APPLE__)
 static void mdiPrintStackTrace(FILE *fp);
 
-#endif
-
 /*
 **  ----------------
 **  Public Variables
@@ -228,9 +209,7 @@ extern bool (*npuHipDownlineBlockFunc)(NpuBuffer *bp);
 extern void (*npuHipResetFunc)(void);
 extern bool (*npuHipUplineBlockFunc)(NpuBuffer *bp);
 
-#if DEBUG
-extern FILE *npuLog;
-#endif
+extern DevLogModule *npuLog;
 
 /*
 **  -----------------
@@ -317,12 +296,6 @@ static u8 mdiSupervisionRequest[] =
     0x00, 0x00        // NCF version in NDL file (ignored)
     };
 
-#if DEBUG
-static char mdiLogBuf[LogLineLength + 1];
-static int  mdiLogBytesCol = 0;
-static int  mdiLogWordCol  = 0;
-#endif
-
 /*
  **--------------------------------------------------------------------------
  **
@@ -346,12 +319,7 @@ void mdiInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     {
     DevSlot *dp;
 
-#if DEBUG
-    if (npuLog == NULL)
-        {
-        npuLog = fopen("mdilog.txt", "wt");
-        }
-#endif
+    npuLog = devLogRegister("npu");
 
     /*
     ** set HCP software type, exit if npuSw is not SwUndefined
@@ -426,15 +394,14 @@ bool mdiHipUplineBlockImpl(NpuBuffer *bp)
     {
     if (mdi->uplineData != NULL)
         {
-#if DEBUG
-        if ((bp != mdi->uplineData)
-            || (bp->data[BlkOffCN] != mdi->uplineData->data[BlkOffCN]))
+        if (DevLogEnabled(npuLog, DevLogError)
+            && ((bp != mdi->uplineData)
+                || (bp->data[BlkOffCN] != mdi->uplineData->data[BlkOffCN])))
             {
             logDtError(LogErrorLocation, "MDI upline block rejected, CN=%02X, BT=%02X, PDU size=%d\n", bp->data[BlkOffCN],
                        bp->data[BlkOffBTBSN] & BlkMaskBT, bp->numBytes);
             mdiPrintStackTrace(stderr);
             }
-#endif
 
         return (FALSE);
         }
@@ -521,15 +488,15 @@ static FcStatus mdiHipFunc(PpWord funcCode)
 
     funcCode &= ~FcMdiEqMask;
 
-#if DEBUG
-    mdiLogFlush();
-    fprintf(npuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
-            traceSequenceNo,
-            activePpu->id,
-            activeChannel->id,
-            funcCode,
-            mdiHipFunc2String(funcCode));
-#endif
+    if (DevLogEnabled(npuLog, DevLogDebug))
+        {
+        devLogText(npuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeChannel->id,
+                   funcCode,
+                   mdiHipFunc2String(funcCode));
+        }
 
     switch (funcCode)
         {
@@ -540,9 +507,10 @@ static FcStatus mdiHipFunc(PpWord funcCode)
             }
         else
             {
-#if DEBUG
-            fprintf(npuLog, " FUNC not implemented & declined!");
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                devLogText(npuLog, " FUNC not implemented & declined!");
+                }
 
             return (FcDeclined);
             }
@@ -679,9 +647,10 @@ static void mdiHipIo(void)
     case FcMdiReqGeneralStatus:
         activeChannel->data = mdiHipReadMdiStatus();
         activeChannel->full = TRUE;
-#if DEBUG
-        fprintf(npuLog, " %03X", activeChannel->data);
-#endif
+        if (DevLogEnabled(npuLog, DevLogDebug))
+            {
+            devLogText(npuLog, " %03X", activeChannel->data);
+            }
         break;
 
     case FcMdiReqDetailedStatus:
@@ -711,13 +680,10 @@ static void mdiHipIo(void)
 
         activeChannel->full = TRUE;
 
-#if DEBUG
-        mdiLogPpWord(activeChannel->data);
-        if (mdi->wordState == MdiIoStateEvenWord)
+        if (DevLogEnabled(npuLog, DevLogDebug) && (mdi->wordState == MdiIoStateEvenWord))
             {
-            mdiLogBytes(mdi->parcel);
+            mdiLogParcel(mdi->parcel);
             }
-#endif
 
         if (activeDevice->recordLength < 1)
             {
@@ -766,24 +732,21 @@ static void mdiHipIo(void)
 
         activeChannel->full = TRUE;
 
-#if DEBUG
-        mdiLogPpWord(activeChannel->data);
-        if (mdi->wordState == MdiIoStateEvenWord)
+        if (DevLogEnabled(npuLog, DevLogDebug) && (mdi->wordState == MdiIoStateEvenWord))
             {
-            mdiLogBytes(mdi->parcel);
+            mdiLogParcel(mdi->parcel);
             }
-#endif
 
         if (activeDevice->recordLength < 1)
             {
             /*
             **  Transmission complete.
             */
-#if DEBUG
-            mdiLogFlush();
-            mdiLogBuffer(mdi->uplineData->data);
-            fprintf(npuLog, "    PDU size=%d\n", mdi->uplineData->numBytes);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                mdiLogBuffer(mdi->uplineData->data);
+                devLogText(npuLog, "    PDU size=%d\n", mdi->uplineData->numBytes);
+                }
             activeChannel->discAfterInput = TRUE;
             activeDevice->fcode           = 0;
             mdi->uplineData = NULL;
@@ -821,13 +784,10 @@ static void mdiHipIo(void)
                         }
                     }
                 }
-#if DEBUG
-            mdiLogPpWord(activeChannel->data);
-            if (mdi->wordState == MdiIoStateEvenWord)
+            if (DevLogEnabled(npuLog, DevLogDebug) && (mdi->wordState == MdiIoStateEvenWord))
                 {
-                mdiLogBytes(mdi->parcel);
+                mdiLogParcel(mdi->parcel);
                 }
-#endif
             }
         break;
         }
@@ -880,14 +840,16 @@ static void mdiHipDisconnect(void)
                     activeDevice->recordLength += 1;
                     }
                 }
-#if DEBUG
-            mdiLogBytes(mdi->parcel);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                mdiLogParcel(mdi->parcel);
+                }
+            }
+
+        if (DevLogEnabled(npuLog, DevLogDebug))
+            {
+            mdiLogBuffer(mbp->data);
             }
-#if DEBUG
-        mdiLogFlush();
-        mdiLogBuffer(mbp->data);
-#endif
         if (mbp->numBytes >= 2)
             {
             /*
@@ -895,9 +857,10 @@ static void mdiHipDisconnect(void)
             ** the 19-byte MDI header.
             */
             mbp->numBytes = ((mbp->data[mbp->numBytes - 2] << 8) | mbp->data[mbp->numBytes - 1]) - MdiHdrLen;
-#if DEBUG
-            fprintf(npuLog, "    PDU size=%d\n", mbp->numBytes);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                devLogText(npuLog, "    PDU size=%d\n", mbp->numBytes);
+                }
             }
 
         activeDevice->fcode = 0;
@@ -1023,7 +986,6 @@ static char *mdiHipFunc2String(PpWord funcCode)
     {
     static char buf[30];
 
-#if DEBUG
     switch (funcCode)
         {
     case FcMdiMasterClear:
@@ -1074,7 +1036,6 @@ static char *mdiHipFunc2String(PpWord funcCode)
     case FcMdiReqProtoVersion:
         return "FcMdiReqProtoVersion";
         }
-#endif
     if ((funcCode >= FcMdiReqProtoVersion) && (funcCode <= FcMdiReqProtoVersion + 0177))
         {
         return "FcMdiReqProtoVersion";
@@ -1087,8 +1048,6 @@ static char *mdiHipFunc2String(PpWord funcCode)
         }
     }
 
-#if DEBUG
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Convert primary function code to string.
 **
@@ -1270,28 +1229,6 @@ static char *mdiSfc2String(u8 sfc)
         }
     }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete numeric/ascii data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void mdiLogFlush(void)
-    {
-    if (mdiLogWordCol > 0)
-        {
-        fputs(mdiLogBuf, npuLog);
-        }
-
-    mdiLogWordCol  = 0;
-    mdiLogBytesCol = 0;
-    memset(mdiLogBuf, ' ', LogLineLength);
-    mdiLogBuf[0]             = '\n';
-    mdiLogBuf[LogLineLength] = '\0';
-    }
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Log information about a buffer sent or received
 **
@@ -1310,108 +1247,87 @@ static void mdiLogBuffer(u8 *dp)
     byte      = dp[BlkOffBTBSN];
     blockType = byte & BlkMaskBT;
 
-    fprintf(npuLog, "\n    DN=%02X SN=%02X CN=%02X Pri=%d BSN=%d BT=",
-            dp[BlkOffDN], dp[BlkOffSN], dp[BlkOffCN],
-            (byte >> BlkShiftPRIO) & BlkMaskPRIO,
-            (byte >> BlkShiftBSN) & BlkMaskBSN);
+    devLogText(npuLog, "\n    DN=%02X SN=%02X CN=%02X Pri=%d BSN=%d BT=",
+               dp[BlkOffDN], dp[BlkOffSN], dp[BlkOffCN],
+               (byte >> BlkShiftPRIO) & BlkMaskPRIO,
+               (byte >> BlkShiftBSN) & BlkMaskBSN);
 
     switch (blockType)
         {
     case BtHTBLK:
-        fputs("Block\n", npuLog);
+        devLogText(npuLog, "Block\n");
         break;
 
     case BtHTMSG:
-        fputs("Message\n", npuLog);
+        devLogText(npuLog, "Message\n");
         break;
 
     case BtHTBACK:
-        fputs("Back\n", npuLog);
+        devLogText(npuLog, "Back\n");
         break;
 
     case BtHTCMD:
-        fputs("Command\n", npuLog);
-        fprintf(npuLog, "    PFC=%s\n    SFC=", mdiPfc2String(dp[BlkOffPfc]));
+        devLogText(npuLog, "Command\n");
+        devLogText(npuLog, "    PFC=%s\n    SFC=", mdiPfc2String(dp[BlkOffPfc]));
         sfc = dp[BlkOffSfc];
         if ((sfc & SfcResp) != 0)
             {
-            fprintf(npuLog, "Normal Response, %s\n", mdiSfc2String(sfc));
+            devLogText(npuLog, "Normal Response, %s\n", mdiSfc2String(sfc));
             }
         else if ((sfc & SfcErr) != 0)
             {
-            fprintf(npuLog, "Abnormal Response, %s\n", mdiSfc2String(sfc));
+            devLogText(npuLog, "Abnormal Response, %s\n", mdiSfc2String(sfc));
             }
         else
             {
-            fprintf(npuLog, "Request, %s\n", mdiSfc2String(sfc));
+            devLogText(npuLog, "Request, %s\n", mdiSfc2String(sfc));
             }
         break;
 
     case BtHTBREAK:
-        fputs("Break\n", npuLog);
+        devLogText(npuLog, "Break\n");
         break;
 
     case BtHTQBLK:
-        fputs("Qualified Block\n", npuLog);
+        devLogText(npuLog, "Qualified Block\n");
         break;
 
     case BtHTQMSG:
-        fputs("Qualified Message\n", npuLog);
+        devLogText(npuLog, "Qualified Message\n");
         break;
 
     case BtHTRESET:
-        fputs("Reset\n", npuLog);
+        devLogText(npuLog, "Reset\n");
         break;
 
     case BtHTRINIT:
-        fputs("Initialize Request\n", npuLog);
+        devLogText(npuLog, "Initialize Request\n");
         break;
 
     case BtHTNINIT:
-        fputs("Initialize Response\n", npuLog);
+        devLogText(npuLog, "Initialize Response\n");
         break;
 
     case BtHTTERM:
-        fputs("Terminate\n", npuLog);
+        devLogText(npuLog, "Terminate\n");
         break;
 
     case BtHTICMD:
-        fputs("Interrupt Command\n", npuLog);
+        devLogText(npuLog, "Interrupt Command\n");
         break;
 
     case BtHTICMR:
-        fputs("Interrupt Command Response\n", npuLog);
+        devLogText(npuLog, "Interrupt Command Response\n");
         break;
 
     default:
-        fprintf(npuLog, "<%02X>\n", blockType);
+        devLogText(npuLog, "<%02X>\n", blockType);
         break;
         }
-
-    fflush(npuLog);
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Log a word sent/received on a channel in hex form
-**
-**  Parameters:     Name        Description.
-**                  word        12-bit word sent/received on channel
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void mdiLogPpWord(int word)
-    {
-    char hex[5];
-    int  col;
-
-    col = HexColumn(mdiLogWordCol++);
-    sprintf(hex, "%03X ", word);
-    memcpy(mdiLogBuf + col, hex, 4);
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a 24-bit parcel in ascii form
+**  Purpose:        Log a 24-bit parcel as three bytes
 **
 **  Parameters:     Name        Description.
 **                  parcel      24-bit parcel sent/received on channel
@@ -1419,34 +1335,16 @@ static void mdiLogPpWord(int word)
 **  Returns:        nothing
 **
 **------------------------------------------------------------------------*/
-static void mdiLogBytes(int parcel)
+static void mdiLogParcel(u32 parcel)
     {
-    int b;
-    int col;
-    int i;
-    int shift;
+    u8 bytes[3];
 
-    col = AsciiColumn(mdiLogBytesCol);
-
-    for (i = 0, shift = 16; i < 3; shift -= 8, i++)
-        {
-        b = (parcel >> shift) & 0x7f;
-        if ((b < 0x20) || (b >= 0x7f))
-            {
-            b = '.';
-            }
-
-        mdiLogBuf[col++] = b;
-        }
-    mdiLogBytesCol += 3;
-    if (mdiLogBytesCol >= 24)
-        {
-        mdiLogFlush();
-        }
+    bytes[0] = (parcel >> 16) & 0xff;
+    bytes[1] = (parcel >> 8) & 0xff;
+    bytes[2] = parcel & 0xff;
+    devLogBytes(npuLog, bytes, 3);
     }
 
-#endif
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Log a stack trace
 **
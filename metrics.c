@@ -0,0 +1,507 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: metrics.c
+**
+**  Description:
+**      Runtime performance metrics.
+**
+**      The emulation updates plain counters in the global 'metrics'
+**      structure (and the per CPU instruction counters) on its hot
+**      paths. This module turns them into rates for the show_metrics
+**      operator command and, when 'metricsPort' is configured, serves
+**      them in Prometheus text exposition format to HTTP clients from
+**      its own thread, so many instances can be monitored without
+**      attaching a profiler.
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <winsock.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define MetricsBufSize       32768
+#define MetricsReqTimeout    2          /* seconds to wait for request */
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static void metricsAppend(char *buf, int *len, char *format, ...);
+static int  metricsFormat(char *buf);
+static void metricsServe(void);
+
+#if defined(_WIN32)
+static void metricsThread(void *param);
+
+#else
+static void *metricsThread(void *param);
+
+#endif
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+Metrics metrics;
+u16     metricsPort = 0;
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+#if defined(_WIN32)
+static SOCKET metricsListenFd;
+#else
+static int metricsListenFd;
+#endif
+
+static char    metricsBuf[MetricsBufSize];
+
+/*
+**  Snapshot taken by the previous show_metrics command.
+*/
+static Metrics lastMetrics;
+static u64     lastCpuInstructions[MaxCpus];
+static u64     lastMsec = 0;
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Initialise metrics and start the HTTP endpoint if a
+**                  port has been configured.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void metricsInit(void)
+    {
+#if defined(_WIN32)
+    DWORD  dwThreadId;
+    HANDLE hThread;
+#else
+    pthread_t      thread;
+    pthread_attr_t attr;
+    int            rc;
+#endif
+
+    lastMsec = getMilliseconds();
+
+    if (metricsPort == 0)
+        {
+        return;
+        }
+
+    metricsListenFd = netCreateListener(metricsPort);
+#if defined(_WIN32)
+    if (metricsListenFd == INVALID_SOCKET)
+#else
+    if (metricsListenFd == -1)
+#endif
+        {
+        logDtError(LogErrorLocation, "Can't listen for metrics requests on port %d\n", metricsPort);
+
+        return;
+        }
+
+#if defined(_WIN32)
+    hThread = CreateThread(
+        NULL,                                       // no security attribute
+        0,                                          // default stack size
+        (LPTHREAD_START_ROUTINE)metricsThread,
+        (LPVOID)NULL,                               // thread parameter
+        0,                                          // not suspended
+        &dwThreadId);                               // returns thread ID
+
+    if (hThread == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to create metrics thread\n");
+        exit(1);
+        }
+#else
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thread, &attr, metricsThread, NULL);
+    if (rc != 0)
+        {
+        logDtError(LogErrorLocation, "Failed to create metrics thread\n");
+        exit(1);
+        }
+#endif
+
+    printf("(metrics) Serving metrics on port %d\n", metricsPort);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Display emulator throughput since the previous call
+**                  (or since startup) to the operator.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void metricsShow(void)
+    {
+    u64    cycles;
+    u64    diskReadBytes;
+    u64    diskReads;
+    u64    diskWriteBytes;
+    u64    diskWrites;
+    double elapsed;
+    int    i;
+    u64    now;
+    char   outBuf[128];
+    u64    tapeReadBytes;
+    u64    tapeReads;
+    u64    tapeWriteBytes;
+    u64    tapeWrites;
+    u64    total;
+
+    now     = getMilliseconds();
+    elapsed = (now - lastMsec) / 1000.0;
+    if (elapsed <= 0.0)
+        {
+        elapsed = 0.001;
+        }
+
+    sprintf(outBuf, "    > Metrics over the last %.1f seconds\n", elapsed);
+    opDisplay(outBuf);
+
+    cycles = metrics.cycles - lastMetrics.cycles;
+    sprintf(outBuf, "    >   Major cycles/sec        %12.0f\n", cycles / elapsed);
+    opDisplay(outBuf);
+
+    for (i = 0; i < cpuCount; i++)
+        {
+        sprintf(outBuf, "    >   CPU%d instructions/sec  %12.0f\n", i,
+                (cpus[i].instructions - lastCpuInstructions[i]) / elapsed);
+        opDisplay(outBuf);
+        lastCpuInstructions[i] = cpus[i].instructions;
+        }
+
+    /*
+    **  A PP is busy in a barrel pass when it executes an instruction or
+    **  continues one waiting on a channel or in a block transfer, rather
+    **  than sitting parked in a spin loop.
+    */
+    opDisplay("    >   PP busy %\n");
+    for (i = 0; i < ppuCount; i++)
+        {
+        sprintf(outBuf, "%s PP%02o %3.0f%s", (i % 8) == 0 ? "    >    " : "", i,
+                cycles == 0 ? 0.0 : (metrics.ppInstructions[i] - lastMetrics.ppInstructions[i]
+                                     + metrics.ppBusyPasses[i] - lastMetrics.ppBusyPasses[i]) * 100.0 / cycles,
+                ((i % 8) == 7) || (i == ppuCount - 1) ? "\n" : "");
+        opDisplay(outBuf);
+        }
+
+    total = 0;
+    for (i = 0; i < channelCount; i++)
+        {
+        total += metrics.channelFunctions[i] - lastMetrics.channelFunctions[i];
+        }
+    sprintf(outBuf, "    >   Channel functions/sec   %12.0f\n", total / elapsed);
+    opDisplay(outBuf);
+
+    diskReads      = metrics.diskReads - lastMetrics.diskReads;
+    diskWrites     = metrics.diskWrites - lastMetrics.diskWrites;
+    diskReadBytes  = metrics.diskReadBytes - lastMetrics.diskReadBytes;
+    diskWriteBytes = metrics.diskWriteBytes - lastMetrics.diskWriteBytes;
+    sprintf(outBuf, "    >   Disk reads/sec %8.0f (%8.0f KB/sec) writes/sec %8.0f (%8.0f KB/sec)\n",
+            diskReads / elapsed, diskReadBytes / elapsed / 1024.0,
+            diskWrites / elapsed, diskWriteBytes / elapsed / 1024.0);
+    opDisplay(outBuf);
+
+    tapeReads      = metrics.tapeReads - lastMetrics.tapeReads;
+    tapeWrites     = metrics.tapeWrites - lastMetrics.tapeWrites;
+    tapeReadBytes  = metrics.tapeReadBytes - lastMetrics.tapeReadBytes;
+    tapeWriteBytes = metrics.tapeWriteBytes - lastMetrics.tapeWriteBytes;
+    sprintf(outBuf, "    >   Tape reads/sec %8.0f (%8.0f KB/sec) writes/sec %8.0f (%8.0f KB/sec)\n",
+            tapeReads / elapsed, tapeReadBytes / elapsed / 1024.0,
+            tapeWrites / elapsed, tapeWriteBytes / elapsed / 1024.0);
+    opDisplay(outBuf);
+
+    sprintf(outBuf, "    >   NPU free buffers        %12d\n", npuBipBufCount());
+    opDisplay(outBuf);
+    sprintf(outBuf, "    >   NPU connections         %12d\n", npuNetConnectionCount());
+    opDisplay(outBuf);
+
+    lastMetrics = metrics;
+    lastMsec    = now;
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Append formatted text to the metrics buffer.
+**
+**  Parameters:     Name        Description.
+**                  buf         buffer
+**                  len         pointer to current length, updated
+**                  format      printf style format
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void metricsAppend(char *buf, int *len, char *format, ...)
+    {
+    va_list args;
+    int     n;
+
+    if (*len >= MetricsBufSize - 1)
+        {
+        return;
+        }
+
+    va_start(args, format);
+    n = vsnprintf(buf + *len, MetricsBufSize - *len, format, args);
+    va_end(args);
+
+    if (n > 0)
+        {
+        *len += n;
+        if (*len > MetricsBufSize - 1)
+            {
+            *len = MetricsBufSize - 1;
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Format all metrics in Prometheus text exposition format.
+**
+**  Parameters:     Name        Description.
+**                  buf         buffer of MetricsBufSize bytes
+**
+**  Returns:        Length of formatted text.
+**
+**------------------------------------------------------------------------*/
+static int metricsFormat(char *buf)
+    {
+    int i;
+    int len = 0;
+
+    metricsAppend(buf, &len, "# HELP dtcyber_cycles_total Major emulation cycles.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_cycles_total counter\n");
+    metricsAppend(buf, &len, "dtcyber_cycles_total %llu\n", (unsigned long long)metrics.cycles);
+
+    metricsAppend(buf, &len, "# HELP dtcyber_cpu_instructions_total Instructions executed by each CPU.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_cpu_instructions_total counter\n");
+    for (i = 0; i < cpuCount; i++)
+        {
+        metricsAppend(buf, &len, "dtcyber_cpu_instructions_total{cpu=\"%d\"} %llu\n", i,
+                      (unsigned long long)cpus[i].instructions);
+        }
+
+    metricsAppend(buf, &len, "# HELP dtcyber_pp_instructions_total Barrel passes in which each PP executed an instruction.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_pp_instructions_total counter\n");
+    for (i = 0; i < ppuCount; i++)
+        {
+        metricsAppend(buf, &len, "dtcyber_pp_instructions_total{pp=\"%02o\"} %llu\n", i,
+                      (unsigned long long)metrics.ppInstructions[i]);
+        }
+
+    metricsAppend(buf, &len, "# HELP dtcyber_pp_busy_passes_total Barrel passes in which each PP continued a busy instruction.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_pp_busy_passes_total counter\n");
+    for (i = 0; i < ppuCount; i++)
+        {
+        metricsAppend(buf, &len, "dtcyber_pp_busy_passes_total{pp=\"%02o\"} %llu\n", i,
+                      (unsigned long long)metrics.ppBusyPasses[i]);
+        }
+
+    metricsAppend(buf, &len, "# HELP dtcyber_channel_functions_total Function codes issued on each channel.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_channel_functions_total counter\n");
+    for (i = 0; i < channelCount; i++)
+        {
+        metricsAppend(buf, &len, "dtcyber_channel_functions_total{channel=\"%02o\"} %llu\n", i,
+                      (unsigned long long)metrics.channelFunctions[i]);
+        }
+
+    metricsAppend(buf, &len, "# HELP dtcyber_io_operations_total Disk and tape operations.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_io_operations_total counter\n");
+    metricsAppend(buf, &len, "dtcyber_io_operations_total{device=\"disk\",op=\"read\"} %llu\n", (unsigned long long)metrics.diskReads);
+    metricsAppend(buf, &len, "dtcyber_io_operations_total{device=\"disk\",op=\"write\"} %llu\n", (unsigned long long)metrics.diskWrites);
+    metricsAppend(buf, &len, "dtcyber_io_operations_total{device=\"tape\",op=\"read\"} %llu\n", (unsigned long long)metrics.tapeReads);
+    metricsAppend(buf, &len, "dtcyber_io_operations_total{device=\"tape\",op=\"write\"} %llu\n", (unsigned long long)metrics.tapeWrites);
+
+    metricsAppend(buf, &len, "# HELP dtcyber_io_bytes_total Disk and tape bytes transferred.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_io_bytes_total counter\n");
+    metricsAppend(buf, &len, "dtcyber_io_bytes_total{device=\"disk\",op=\"read\"} %llu\n", (unsigned long long)metrics.diskReadBytes);
+    metricsAppend(buf, &len, "dtcyber_io_bytes_total{device=\"disk\",op=\"write\"} %llu\n", (unsigned long long)metrics.diskWriteBytes);
+    metricsAppend(buf, &len, "dtcyber_io_bytes_total{device=\"tape\",op=\"read\"} %llu\n", (unsigned long long)metrics.tapeReadBytes);
+    metricsAppend(buf, &len, "dtcyber_io_bytes_total{device=\"tape\",op=\"write\"} %llu\n", (unsigned long long)metrics.tapeWriteBytes);
+
+    metricsAppend(buf, &len, "# HELP dtcyber_npu_free_buffers Free NPU buffers.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_npu_free_buffers gauge\n");
+    metricsAppend(buf, &len, "dtcyber_npu_free_buffers %d\n", npuBipBufCount());
+
+    metricsAppend(buf, &len, "# HELP dtcyber_npu_connections Connected NPU terminals.\n");
+    metricsAppend(buf, &len, "# TYPE dtcyber_npu_connections gauge\n");
+    metricsAppend(buf, &len, "dtcyber_npu_connections %d\n", npuNetConnectionCount());
+
+    return (len);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Accept one HTTP connection and answer it with the
+**                  current metrics, whatever has been requested.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void metricsServe(void)
+    {
+#if defined(_WIN32)
+    SOCKET connFd;
+#else
+    int    connFd;
+#endif
+    char           header[160];
+    int            len;
+    fd_set         readFds;
+    char           request[1024];
+    struct timeval timeout;
+
+    connFd = netAcceptConnection(metricsListenFd);
+#if defined(_WIN32)
+    if (connFd == INVALID_SOCKET)
+#else
+    if (connFd == -1)
+#endif
+        {
+        return;
+        }
+
+    /*
+    **  Consume the request header if the client sends it promptly.
+    */
+    FD_ZERO(&readFds);
+    FD_SET(connFd, &readFds);
+    timeout.tv_sec  = MetricsReqTimeout;
+    timeout.tv_usec = 0;
+    if (select((int)(connFd + 1), &readFds, NULL, NULL, &timeout) > 0)
+        {
+        recv(connFd, request, sizeof(request), 0);
+        }
+
+    len = metricsFormat(metricsBuf);
+    sprintf(header, "HTTP/1.0 200 OK\r\n"
+                    "Content-Type: text/plain; version=0.0.4\r\n"
+                    "Content-Length: %d\r\n"
+                    "Connection: close\r\n\r\n", len);
+    send(connFd, header, (int)strlen(header), 0);
+    send(connFd, metricsBuf, len, 0);
+
+    netCloseConnection(connFd);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Metrics endpoint thread.
+**
+**  Parameters:     Name        Description.
+**                  param       unused
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+#if defined(_WIN32)
+static void metricsThread(void *param)
+#else
+static void *metricsThread(void *param)
+#endif
+    {
+    fd_set         acceptFds;
+    int            rc;
+    struct timeval timeout;
+
+    while (emulationActive)
+        {
+        FD_ZERO(&acceptFds);
+        FD_SET(metricsListenFd, &acceptFds);
+        timeout.tv_sec  = 1;
+        timeout.tv_usec = 0;
+        rc = select((int)(metricsListenFd + 1), &acceptFds, NULL, NULL, &timeout);
+        if (rc > 0)
+            {
+            metricsServe();
+            }
+        }
+
+    netCloseConnection(metricsListenFd);
+
+#if !defined(_WIN32)
+    return (NULL);
+#endif
+    }
+
+/*---------------------------  End Of File  ------------------------------*/
@@ -0,0 +1,651 @@
+/*--------------------------------------------------------------------------
+**
+**  Copyright (c) 2026
+**
+**  Name: microbench.c
+**
+**  Description:
+**      CPU and PP instruction micro-benchmarks.
+**
+**      Standalone program built by the 'microbench' make target. It links
+**      the CPU and PP interpreters (cpu.c, pp.c, float.c, shift.c) and the
+**      channel layer with a loopback device and stubs for the rest of the
+**      emulator, runs synthetic instruction streams for each opcode class
+**      and reports the time per instruction. This is the baseline against
+**      which interpreter changes are judged.
+**
+**      Usage: microbench [-m model] [-n millions] [name]
+**
+**          -m model     6400, cyber73, cyber173 (default), cyber175 or
+**                       cyber865
+**          -n millions  instructions executed per benchmark (default 20)
+**          name         run only benchmarks whose name contains this
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License version 3 as
+**  published by the Free Software Foundation.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License version 3 for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  version 3 along with this program in file "license-gpl-3.0.txt".
+**  If not, see <http://www.gnu.org/licenses/gpl-3.0.txt>.
+**
+**--------------------------------------------------------------------------
+*/
+
+/*
+**  -------------
+**  Include Files
+**  -------------
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "const.h"
+#include "types.h"
+#include "proto.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+/*
+**  -----------------
+**  Private Constants
+**  -----------------
+*/
+#define MbCmSize          0400000   /* CM words */
+#define MbEcsBanks        1
+#define MbXpAddress       0100      /* absolute address of exchange package */
+#define MbRa              01000     /* RA of benchmark program */
+#define MbFl              0200000   /* FL of benchmark program */
+#define MbFle             0100000   /* FLE of benchmark program */
+#define MbCpuStart        0100      /* relative start of CPU instruction block */
+#define MbCpuWords        1024      /* words in CPU instruction block */
+#define MbData            0170000   /* relative address of data and CMU fields */
+
+#define MbPpSetup         0020      /* PP channel setup code */
+#define MbPpStart         0100      /* PP instruction block */
+#define MbPpWords         03000     /* PP words in instruction block */
+#define MbPpChannel       010       /* channel of the loopback device */
+
+#define MbPass            046000    /* CPU pass (NO) */
+
+/*
+**  -----------------------
+**  Private Macro Functions
+**  -----------------------
+*/
+
+/*
+**  Build 30 bit CPU instruction parcel fm i j K.
+*/
+#define MbLong(fm, i, j, k)    (((CpWord)(fm) << 24) | ((CpWord)(i) << 21) | ((CpWord)(j) << 18) | ((CpWord)(k) & Mask18))
+
+/*
+**  Build CPU instruction words from parcels.
+*/
+#define MbWord4(a, b, c, d)    (((CpWord)(a) << 45) | ((CpWord)(b) << 30) | ((CpWord)(c) << 15) | (CpWord)(d))
+#define MbWord2(a, b)          (((CpWord)(a) << 30) | (CpWord)(b))
+
+/*
+**  -----------------------------------------
+**  Private Typedef and Structure Definitions
+**  -----------------------------------------
+*/
+typedef enum
+    {
+    MbPlain,                            /* words repeated as given */
+    MbBranch,                           /* EQ B0,B0 to the next word */
+    MbCmu                               /* CMU move direct, needs HasCMU */
+    } MbKind;
+
+typedef struct mbCpuBench
+    {
+    char   *name;
+    MbKind kind;
+    CpWord word;                        /* instruction word to repeat */
+    } MbCpuBench;
+
+typedef struct mbPpBench
+    {
+    char   *name;
+    int    length;                      /* PP words per instruction */
+    PpWord code[2];                     /* instruction to repeat */
+    bool   useChannel;                  /* activate loopback channel first */
+    } MbPpBench;
+
+typedef struct mbModel
+    {
+    char          *name;
+    ModelType     type;
+    ModelFeatures features;
+    } MbModel;
+
+/*
+**  ---------------------------
+**  Private Function Prototypes
+**  ---------------------------
+*/
+static void     mbCpuRun(MbCpuBench *bp, u64 count);
+static u64      mbNow(void);
+static void     mbPpRun(MbPpBench *bp, u64 count);
+static void     mbReport(char *name, u64 instructions, u64 nsec);
+
+static void     mbActivate(void);
+static void     mbDisconnect(void);
+static FcStatus mbFunc(PpWord funcCode);
+static void     mbIo(void);
+
+/*
+**  ----------------
+**  Public Variables
+**  ----------------
+*/
+
+/*
+**  Emulator globals normally defined by main.c, init.c, metrics.c,
+**  operator.c, latency.c, rtc.c and trace.c.
+*/
+bool          emulationActive = TRUE;
+ModelFeatures features;
+bool          latencyActive = FALSE;
+Metrics       metrics;
+ModelType     modelType;
+volatile bool opPaused = FALSE;
+char          persistDir[256];
+u32           rtcClock = 0;
+u32           traceSequenceNo;
+
+/*
+**  -----------------
+**  Private Variables
+**  -----------------
+*/
+static MbModel models[] =
+    {
+    { "6400",     Model6400,     (IsSeries6x00) },
+    { "cyber73",  ModelCyber73,  (IsSeries70 | HasInterlockReg | HasCMU) },
+    { "cyber173", ModelCyber173, (IsSeries170 | HasStatusAndControlReg | HasCMU) },
+    { "cyber175", ModelCyber175, (IsSeries170 | HasStatusAndControlReg | HasInstructionStack | HasIStackPrefetch | Has175Float) },
+    { "cyber865", ModelCyber865, (IsSeries800 | HasNoCmWrap | HasFullRTC | HasTwoPortMux | HasStatusAndControlReg
+                                  | HasRelocationRegShort | HasMicrosecondClock | HasInstructionStack | HasIStackPrefetch
+                                  | Has175Float) },
+    { NULL,       Model6400,     0 }
+    };
+
+static MbCpuBench cpuBenches[] =
+    {
+    { "cpu boolean",        MbPlain,  MbWord4(011123, 012456, 013712, 015345) },
+    { "cpu shift",          MbPlain,  MbWord4(020106, 021203, 022324, 023405) },
+    { "cpu normalize/pack", MbPlain,  MbWord4(024506, 026123, 027431, 024706) },
+    { "cpu integer add",    MbPlain,  MbWord4(036123, 037456, 036712, 037345) },
+    { "cpu fp add",         MbPlain,  MbWord4(030123, 031456, 032712, 033345) },
+    { "cpu fp multiply",    MbPlain,  MbWord4(040123, 041456, 042712, 040345) },
+    { "cpu fp divide",      MbPlain,  MbWord4(044123, 045456, 044712, 045345) },
+    { "cpu increment",      MbPlain,  MbWord4(076123, 066456, 072412, 063230) },
+    { "cpu load",           MbPlain,  MbWord2(MbLong(051, 1, 0, MbData), MbLong(051, 2, 0, MbData + 1)) },
+    { "cpu store",          MbPlain,  MbWord2(MbLong(051, 6, 0, MbData + 2), MbLong(051, 7, 0, MbData + 3)) },
+    { "cpu branch",         MbBranch, 0 },
+    { "cpu ecs read",       MbPlain,  MbWord2(MbLong(001, 1, 0, 8), (MbPass << 15) | MbPass) },
+    { "cpu ecs write",      MbPlain,  MbWord2(MbLong(001, 2, 0, 8), (MbPass << 15) | MbPass) },
+    { "cpu cmu move",       MbCmu,    0 },
+    { NULL,                 MbPlain,  0 }
+    };
+
+static MbPpBench ppBenches[] =
+    {
+    { "pp no address",   1, { 01405, 0 },               FALSE },  /* LDN 5 */
+    { "pp add constant", 1, { 01601, 0 },               FALSE },  /* ADN 1 */
+    { "pp shift",        1, { 01001, 0 },               FALSE },  /* SHN 1 */
+    { "pp branch",       1, { 00301, 0 },               FALSE },  /* UJN *+1 */
+    { "pp direct load",  1, { 03040, 0 },               FALSE },  /* LDD 40 */
+    { "pp direct store", 1, { 03441, 0 },               FALSE },  /* STD 41 */
+    { "pp replace add",  1, { 03642, 0 },               FALSE },  /* AOD 42 */
+    { "pp memory load",  2, { 05000, 07000 },           FALSE },  /* LDM 7000 */
+    { "pp memory store", 2, { 05400, 07001 },           FALSE },  /* STM 7001 */
+    { "pp cm read",      1, { 06050, 0 },               FALSE },  /* CRD 50 */
+    { "pp cm write",     1, { 06250, 0 },               FALSE },  /* CWD 50 */
+    { "pp channel in",   1, { 07000 | MbPpChannel, 0 }, TRUE },   /* IAN ch */
+    { "pp channel out",  1, { 07200 | MbPpChannel, 0 }, TRUE },   /* OAN ch */
+    { NULL,              0, { 0, 0 },                   FALSE }
+    };
+
+static MbModel *model;
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Public Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Run the micro-benchmarks.
+**
+**  Parameters:     Name        Description.
+**                  argc        Argument count.
+**                  argv        Array of argument strings.
+**
+**  Returns:        Zero.
+**
+**------------------------------------------------------------------------*/
+int main(int argc, char **argv)
+    {
+    DevSlot    *dp;
+    MbCpuBench *cbp;
+    char       *filter;
+    int        i;
+    u64        count;
+    MbPpBench  *pbp;
+
+    model  = models + 2;
+    count  = 20000000;
+    filter = NULL;
+
+    for (i = 1; i < argc; i++)
+        {
+        if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+            {
+            i += 1;
+            for (model = models; model->name != NULL; model++)
+                {
+                if (strcasecmp(model->name, argv[i]) == 0)
+                    {
+                    break;
+                    }
+                }
+            if (model->name == NULL)
+                {
+                fprintf(stderr, "Unknown model %s\n", argv[i]);
+                exit(1);
+                }
+            }
+        else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+            {
+            i    += 1;
+            count = (u64)strtol(argv[i], NULL, 10) * 1000000;
+            if (count == 0)
+                {
+                fprintf(stderr, "Invalid instruction count %s\n", argv[i]);
+                exit(1);
+                }
+            }
+        else if (argv[i][0] == '-')
+            {
+            fprintf(stderr, "Usage: %s [-m model] [-n millions] [name]\n", argv[0]);
+            exit(1);
+            }
+        else
+            {
+            filter = argv[i];
+            }
+        }
+
+    features  = model->features;
+    modelType = model->type;
+
+    /*
+    **  Initialise the interpreters and a loopback device.
+    */
+    cpuCount = 1;
+    cpuInit(model->name, MbCmSize, MbEcsBanks, ECS);
+    ppInit(1);
+    channelInit(040);
+
+    dp             = channelAttach(MbPpChannel, 0, DtNone);
+    dp->activate   = mbActivate;
+    dp->disconnect = mbDisconnect;
+    dp->func       = mbFunc;
+    dp->io         = mbIo;
+
+    printf("\nMicro-benchmarks for %s, %llu instructions each\n\n", model->name, (unsigned long long)count);
+    printf("    %-20s %12s %12s\n", "Benchmark", "ns/instr", "MIPS");
+    printf("    %-20s %12s %12s\n", "---------", "--------", "----");
+
+    for (cbp = cpuBenches; cbp->name != NULL; cbp++)
+        {
+        if ((filter == NULL) || (strstr(cbp->name, filter) != NULL))
+            {
+            mbCpuRun(cbp, count);
+            }
+        }
+
+    for (pbp = ppBenches; pbp->name != NULL; pbp++)
+        {
+        if ((filter == NULL) || (strstr(pbp->name, filter) != NULL))
+            {
+            mbPpRun(pbp, count);
+            }
+        }
+
+    printf("\n");
+
+    return (0);
+    }
+
+/*
+**  Link stubs for the parts of the emulator the interpreters and the
+**  channel layer refer to but which play no part in the benchmarks.
+*/
+void cciHipTerminate(DevSlot *dp)
+    {
+    (void)dp;
+    }
+
+void dcc6681Terminate(DevSlot *dp)
+    {
+    (void)dp;
+    }
+
+void idleThrottle(CpuContext *ctx)
+    {
+    (void)ctx;
+    }
+
+void latencyEnter(void)
+    {
+    }
+
+void latencyLeave(int phase, u8 channelNo)
+    {
+    (void)phase;
+    (void)channelNo;
+    }
+
+void latencyPp(int ppNo)
+    {
+    (void)ppNo;
+    }
+
+void mt669Terminate(DevSlot *dp)
+    {
+    (void)dp;
+    }
+
+void mt679Terminate(DevSlot *dp)
+    {
+    (void)dp;
+    }
+
+void opDisplay(char *msg)
+    {
+    fputs(msg, stdout);
+    }
+
+/*
+ **--------------------------------------------------------------------------
+ **
+ **  Private Functions
+ **
+ **--------------------------------------------------------------------------
+ */
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Run one CPU benchmark.
+**
+**                  The instruction word is repeated to fill a block which
+**                  ends with a jump back to its start, and the CPU is
+**                  started on it through an exchange package.
+**
+**  Parameters:     Name        Description.
+**                  bp          benchmark
+**                  count       number of instructions to execute
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mbCpuRun(MbCpuBench *bp, u64 count)
+    {
+    CpuContext *cp;
+    CpWord     *mem;
+    u64        start;
+    u64        instructions;
+    int        i;
+    u32        k1;
+    u32        k2;
+
+    if ((bp->kind == MbCmu) && ((features & HasCMU) == 0))
+        {
+        printf("    %-20s %12s %12s\n", bp->name, "n/a", "n/a");
+
+        return;
+        }
+
+    /*
+    **  Build the instruction block.
+    */
+    mem = cpMem + MbRa;
+    for (i = 0; i < MbCpuWords; i++)
+        {
+        switch (bp->kind)
+            {
+        case MbPlain:
+            mem[MbCpuStart + i] = bp->word;
+            break;
+
+        case MbBranch:
+            /*
+            **  EQ B0,B0,*+1 followed by two passes.
+            */
+            mem[MbCpuStart + i] = MbWord2(MbLong(004, 0, 0, MbCpuStart + i + 1), (MbPass << 15) | MbPass);
+            break;
+
+        case MbCmu:
+            /*
+            **  Move 10 characters direct from MbData to MbData + 1.
+            */
+            k1 = MbData;
+            k2 = MbData + 1;
+            mem[MbCpuStart + i] = ((CpWord)0465 << 51) | ((CpWord)k1 << 30) | ((CpWord)10 << 26) | (CpWord)k2;
+            break;
+            }
+        }
+
+    mem[MbCpuStart + MbCpuWords] = MbWord2(MbLong(004, 0, 0, MbCpuStart), (MbPass << 15) | MbPass);
+
+    /*
+    **  Exchange package: P, RA, FL, FLE, A0 for ECS transfers and operands
+    **  which keep the floating point units on normal values.
+    */
+    mem    = cpMem + MbXpAddress;
+    mem[0] = ((CpWord)MbCpuStart << 36) | ((CpWord)MbData << 18);
+    mem[1] = ((CpWord)MbRa << 36) | 1;
+    mem[2] = ((CpWord)MbFl << 36) | ((CpWord)MbData << 18) | 3;
+    mem[3] = 0;
+    mem[4] = 0;
+    mem[5] = (CpWord)MbFle << 36;
+    mem[6] = 0;
+    mem[7] = 0;
+    for (i = 0; i < 8; i++)
+        {
+        mem[010 + i] = (CpWord)01720400000000000000 + ((CpWord)i << 40);
+        }
+    mem[010] = 0;
+
+    cp                       = cpus;
+    cp->isStopped            = TRUE;
+    cp->ppExchangeAddress    = MbXpAddress;
+    cp->doChangeMode         = FALSE;
+    cp->ppRequestingExchange = 0;
+
+    /*
+    **  Run.
+    */
+    instructions = cp->instructions;
+    start        = mbNow();
+    while (cp->instructions - instructions < count)
+        {
+        cpuStep(cp);
+        if (cp->isStopped)
+            {
+            printf("    %-20s stopped at P=%06o, exit condition %o\n", bp->name, cp->regP, cp->exitCondition);
+
+            return;
+            }
+        }
+
+    mbReport(bp->name, cp->instructions - instructions, mbNow() - start);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Run one PP benchmark.
+**
+**  Parameters:     Name        Description.
+**                  bp          benchmark
+**                  count       number of instructions to execute
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mbPpRun(MbPpBench *bp, u64 count)
+    {
+    u64    instructions;
+    PpWord *mem;
+    PpSlot *pp;
+    u64    start;
+    int    i;
+
+    pp  = ppu;
+    mem = pp->mem;
+
+    /*
+    **  Channel setup: FNC 0,ch; ACN ch; LJM MbPpStart.
+    */
+    mem[MbPpSetup]     = 07700 | MbPpChannel;
+    mem[MbPpSetup + 1] = 0;
+    mem[MbPpSetup + 2] = 07400 | MbPpChannel;
+    mem[MbPpSetup + 3] = 00100;
+    mem[MbPpSetup + 4] = MbPpStart;
+
+    /*
+    **  Build the instruction block ending in LJM MbPpStart.
+    */
+    for (i = 0; i + bp->length <= MbPpWords; i += bp->length)
+        {
+        mem[MbPpStart + i] = bp->code[0];
+        if (bp->length == 2)
+            {
+            mem[MbPpStart + i + 1] = bp->code[1];
+            }
+        }
+
+    mem[MbPpStart + i]     = 00100;
+    mem[MbPpStart + i + 1] = MbPpStart;
+
+    pp->busy = FALSE;
+    pp->regA = MbRa + MbData;
+    pp->regP = bp->useChannel ? MbPpSetup : MbPpStart;
+
+    /*
+    **  Make sure the loopback channel starts out inactive and empty.
+    */
+    channel[MbPpChannel].active = FALSE;
+    channel[MbPpChannel].full   = FALSE;
+
+    /*
+    **  Run.
+    */
+    instructions = metrics.ppInstructions[0];
+    start        = mbNow();
+    while (metrics.ppInstructions[0] - instructions < count)
+        {
+        ppStep();
+        }
+
+    mbReport(bp->name, metrics.ppInstructions[0] - instructions, mbNow() - start);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Print a benchmark result.
+**
+**  Parameters:     Name        Description.
+**                  name        benchmark name
+**                  instructions instructions executed
+**                  nsec        elapsed time in nanoseconds
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mbReport(char *name, u64 instructions, u64 nsec)
+    {
+    double perInstruction;
+
+    perInstruction = (double)(i64)nsec / (double)(i64)instructions;
+    printf("    %-20s %12.2f %12.1f\n", name, perInstruction, 1000.0 / perInstruction);
+    fflush(stdout);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Return a monotonic time stamp.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Time in nanoseconds.
+**
+**------------------------------------------------------------------------*/
+static u64 mbNow(void)
+    {
+#if defined(_WIN32)
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+
+    return ((u64)((double)count.QuadPart * 1000000000.0 / (double)frequency.QuadPart));
+
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Loopback device: accept every function, always have
+**                  input available and consume output immediately.
+**
+**  Parameters:     Name        Description.
+**                  funcCode    function code
+**
+**  Returns:        FcStatus
+**
+**------------------------------------------------------------------------*/
+static FcStatus mbFunc(PpWord funcCode)
+    {
+    (void)funcCode;
+
+    return (FcAccepted);
+    }
+
+static void mbIo(void)
+    {
+    if (activeChannel->full)
+        {
+        activeChannel->full = FALSE;
+        }
+    else
+        {
+        activeChannel->data = 01234;
+        activeChannel->full = TRUE;
+        }
+    }
+
+static void mbActivate(void)
+    {
+    }
+
+static void mbDisconnect(void)
+    {
+    }
+
+/*---------------------------  End Of File  ------------------------------*/
@@ -1497,6 +1497,9 @@ static void mt362xDisconnect(void)
         fwrite(&rawBuffer, 1, recLen0, fcb);
         fwrite(&recLen1, sizeof(recLen1), 1, fcb);
 
+        metrics.tapeWrites     += 1;
+        metrics.tapeWriteBytes += recLen0;
+
         /*
         **  The following fseek prepares for any subsequent fread.
         */
@@ -1611,6 +1614,8 @@ static void mt362xFuncRead(void)
     **  Read and verify the actual raw data.
     */
     len = (u32)fread(rawBuffer, 1, recLen1, active3000Device->fcb[unitNo]);
+    metrics.tapeReads     += 1;
+    metrics.tapeReadBytes += len;
 
     if (recLen1 != (u32)len)
         {
@@ -1813,6 +1818,8 @@ static void mt362xFuncReadBkw(void)
         **  Read and verify the actual raw data.
         */
         len = (u32)fread(rawBuffer, 1, recLen1, active3000Device->fcb[unitNo]);
+        metrics.tapeReads     += 1;
+        metrics.tapeReadBytes += len;
 
         if (recLen1 != (u32)len)
             {
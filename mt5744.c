@@ -15,6 +15,16 @@
 **      Cyber channel to connect the mainframe to the StorageTek device
 **      via a CCC (Cyber Channel Coupler) connected to a FIPS controller.
 **
+**      Requests to the tape server are pipelined when the server says it
+**      supports this in its response to REGISTER. Responses arrive in the
+**      order in which requests were sent, so each unit keeps a queue of
+**      the requests in flight. During sequential reads, blocks are read
+**      ahead of the PP, and any not consumed are backspaced over before
+**      the next positioning request is sent. Writes are posted, and up to
+**      MaxWritesPosted of them may await acknowledgement at once. A write
+**      error closes the connection, as it always has, and is latched so
+**      that it is reported as an alert until the PP reads general status.
+**
 **  This program is free software: you can redistribute it and/or modify
 **  it under the terms of the GNU General Public License version 3 as
 **  published by the Free Software Foundation.
@@ -159,6 +169,16 @@
 #define MaxByteBuf                           60000
 #define VolumeNameSize                       6
 
+/*
+**  Request pipelining.
+*/
+#define MaxRequests                          16
+#define MaxRequestLength                     31
+#define MaxWritesPosted                      4
+#define ReadAheadDepth                       4
+#define ReadAheadThreshold                   2
+#define TapeBufSize                          (2 * (MaxByteBuf + 16))
+
 /*
 **  -----------------------
 **  Private Macro Functions
@@ -194,9 +214,31 @@ typedef struct tapeBuffer
     {
     u32 in;
     u32 out;
-    u8  data[MaxByteBuf + 16];
+    u8  data[TapeBufSize];
     } TapeBuffer;
 
+/*
+**  Request in flight to the tape server.
+*/
+struct tapeParam;
+
+typedef struct tapeRequest
+    {
+    void (*callback)(struct tapeParam *tp);
+    bool isSync;                        /* PP waits for the response */
+    u32  tag;
+    } TapeRequest;
+
+/*
+**  Block read ahead of the PP.
+*/
+typedef struct readAheadBlock
+    {
+    int status;
+    int len;
+    u8  *data;
+    } ReadAheadBlock;
+
 /*
 **  ACS controller.
 */
@@ -222,7 +264,6 @@ typedef struct tapeParam
     CtrlParam          *controller;
     struct tapeParam   *nextTape;
     AcsState           state;
-    void (*callback)(struct tapeParam *tp);
     time_t             nextConnectionAttempt;
     char               *driveName;
     char               *serverName;
@@ -247,10 +288,30 @@ typedef struct tapeParam
     bool               isReady;
     bool               isTapeMark;
     bool               isWriteEnabled;
+    bool               isWriteError;    /* posted write failed, not yet reported */
     PpWord             errorCode;
     u32                recordLength;
     PpWord             ioBuffer[MaxPpBuf];
     PpWord             *bp;
+    bool               isPipelined;
+    TapeRequest        requests[MaxRequests];
+    int                requestCount;
+    int                requestIn;
+    int                requestOut;
+    u32                requestTag;
+    char               deferredRequest[MaxRequestLength + 1];
+    void (*deferredCallback)(struct tapeParam *tp);
+    int                writesPosted;
+    bool               isWriteWindowFull;
+    ReadAheadBlock     readAhead[ReadAheadDepth];
+    int                readAheadCount;  /* blocks received, not yet consumed */
+    int                readAheadIn;
+    int                readAheadOut;
+    int                readAheadIssued; /* requests sent, no response yet */
+    int                sequentialReads;
+    bool               isReadAheadCancelling;
+    bool               isReadAheadStopped;
+    bool               isReadWaiting;   /* PP waits for oldest read ahead */
     } TapeParam;
 
 /*
@@ -262,9 +323,12 @@ static void mt5744Activate(void);
 static void mt5744CalculateBufferedLog(TapeParam *tp);
 static void mt5744CalculateDetailedStatus(TapeParam *tp);
 static void mt5744CalculateGeneralStatus(TapeParam *tp);
+static bool mt5744CancelReadAhead(TapeParam *tp);
 static void mt5744CheckTapeServer(void);
 static void mt5744CloseTapeServerConnection(TapeParam *tp);
 static void mt5744ConnectCallback(TapeParam *tp);
+static void mt5744ConsumeReadAhead(TapeParam *tp);
+static void mt5744DiscardRequestCallback(TapeParam *tp);
 static void mt5744DismountRequestCallback(TapeParam *tp);
 static FcStatus mt5744Func(PpWord funcCode);
 static void mt5744FuncBackspace(void);
@@ -275,24 +339,34 @@ static void mt5744Disconnect(void);
 static void mt5744FlushWrite(void);
 static void mt5744Io(void);
 static void mt5744InitiateConnection(TapeParam *tp);
+static bool mt5744IsSyncPending(TapeParam *tp);
 static void mt5744IssueTapeServerRequest(TapeParam *tp, char *request, void (*callback)(struct tapeParam *tp));
 void mt5744LoadTape(TapeParam *tp, bool writeEnable);
 static void mt5744LocateBlockRequestCallback(TapeParam *tp);
 static int mt5744PackBytes(TapeParam *tp, u8 *rp, int recLen);
 static char *mt5744ParseTapeServerResponse(TapeParam *tp, int *status);
+static void mt5744PushRequest(TapeParam *tp, void (*callback)(struct tapeParam *tp), bool isSync);
+static void mt5744QueueRequest(TapeParam *tp, char *request, void (*callback)(struct tapeParam *tp), bool isSync);
+static void mt5744ReadAhead(TapeParam *tp);
+static void mt5744ReadAheadCallback(TapeParam *tp);
 static void mt5744ReadBlockIdRequestCallback(TapeParam *tp);
+static void mt5744ReadForward(TapeParam *tp);
 static void mt5744ReadRequestCallback(TapeParam *tp);
 static void mt5744ReceiveTapeServerResponse(TapeParam *tp);
 static void mt5744RegisterUnit(TapeParam *tp);
 static void mt5744RegisterUnitRequestCallback(TapeParam *tp);
+static u8 *mt5744ReserveOutput(TapeParam *tp, u32 len);
 static void mt5744ResetInputBuffer(TapeParam *tp, u8 *eor);
+static void mt5744ResetPipeline(TapeParam *tp);
 static void mt5744ResetStatus(TapeParam *tp);
 static void mt5744ResetUnit(TapeParam *tp);
 static void mt5744RewindRequestCallback(TapeParam *tp);
 static void mt5744RewindUnloadRequestCallback(TapeParam *tp);
 static void mt5744SendTapeServerRequest(TapeParam *tp);
+static void mt5744SetReadResult(TapeParam *tp, int status, u8 *data, int len);
 static void mt5744SpaceRequestCallback(TapeParam *tp);
 void mt5744UnloadTape(TapeParam *tp);
+static void mt5744UpdateWriteWindow(TapeParam *tp);
 static void mt5744WriteRequestCallback(TapeParam *tp);
 static void mt5744WriteMarkRequestCallback(TapeParam *tp);
 
@@ -677,6 +751,47 @@ static void mt5744CalculateGeneralStatus(TapeParam *tp)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Cancel reading ahead before the tape is positioned
+**                  otherwise. The server is backspaced over the blocks
+**                  read ahead which the PP has not consumed.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        TRUE if read ahead requests are still in flight, and
+**                  the cancellation completes when they have been answered.
+**
+**------------------------------------------------------------------------*/
+static bool mt5744CancelReadAhead(TapeParam *tp)
+    {
+    ReadAheadBlock *rbp;
+
+    tp->sequentialReads = 0;
+    tp->isReadWaiting   = FALSE;
+    if (tp->readAheadIssued > 0)
+        {
+        tp->isReadAheadCancelling = TRUE;
+
+        return (TRUE);
+        }
+    tp->isReadAheadCancelling = FALSE;
+
+    while (tp->readAheadCount > 0)
+        {
+        rbp              = &tp->readAhead[tp->readAheadOut];
+        tp->readAheadOut = (tp->readAheadOut + 1) % ReadAheadDepth;
+        tp->readAheadCount -= 1;
+        if ((rbp->status == 201) || (rbp->status == 202))
+            {
+            mt5744QueueRequest(tp, "SPACEBKW", mt5744DiscardRequestCallback, FALSE);
+            }
+        }
+    tp->readAheadIn = tp->readAheadOut = 0;
+
+    return (FALSE);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Process tape server I/O and state transitions.
 **
@@ -812,6 +927,7 @@ static void mt5744CloseTapeServerConnection(TapeParam *tp)
             tp->fd, tp->serverName, ntohs(tp->serverAddr.sin_port), tp->channelNo, tp->unitNo);
 #endif
     netCloseConnection(tp->fd);
+    mt5744ResetPipeline(tp);
     tp->fd                    = 0;
     tp->isReady               = FALSE;
     tp->isBusy                = FALSE;
@@ -852,6 +968,53 @@ static void mt5744ConnectCallback(TapeParam *tp)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Hand the oldest block read ahead to the PP.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744ConsumeReadAhead(TapeParam *tp)
+    {
+    ReadAheadBlock *rbp;
+
+    rbp              = &tp->readAhead[tp->readAheadOut];
+    tp->readAheadOut = (tp->readAheadOut + 1) % ReadAheadDepth;
+    tp->readAheadCount -= 1;
+    mt5744SetReadResult(tp, rbp->status, rbp->data, rbp->len);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Process a response from the StorageTek simulator to a
+**                  SPACEBKW request issued to undo reading ahead.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744DiscardRequestCallback(TapeParam *tp)
+    {
+    char *eor;
+    int  status;
+
+    eor = mt5744ParseTapeServerResponse(tp, &status);
+    if (eor == NULL)
+        {
+        return;
+        }
+    if ((status != 200) && (status != 202) && (status != 203))
+        {
+        logDtError(LogErrorLocation, "Unexpected status %d received from StorageTek simulator for SPACEBKW request\n", status);
+        mt5744CloseTapeServerConnection(tp);
+        }
+    mt5744ResetInputBuffer(tp, (u8 *)eor);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Handle disconnecting of channel.
 **
@@ -923,6 +1086,7 @@ static void mt5744FlushWrite(void)
     char      buffer[10];
     CtrlParam *cp = activeDevice->controllerContext;
     u8        *dataStart;
+    u8        *hp;
     u32       i;
     PpWord    *ip;
     int       len;
@@ -944,8 +1108,20 @@ static void mt5744FlushWrite(void)
     recLen0 = 0;
     recLen2 = tp->recordLength;
     ip      = tp->ioBuffer;
-    memcpy(&tp->outputBuffer.data[0], "WRITE          \n", 16);
-    rp = dataStart = &tp->outputBuffer.data[16];
+
+    /*
+    **  The write is appended to any requests not yet sent.
+    */
+    hp = mt5744ReserveOutput(tp, 16 + ((recLen2 + 1) / 2) * 3);
+    if (hp == NULL)
+        {
+        logDtError(LogErrorLocation, "Output buffer overflow on CH:%02o u:%d\n", tp->channelNo, tp->unitNo);
+        mt5744CloseTapeServerConnection(tp);
+
+        return;
+        }
+    memcpy(hp, "WRITE          \n", 16);
+    rp = dataStart = hp + 16;
 
     for (i = 0; i < recLen2; i += 2)
         {
@@ -967,13 +1143,20 @@ static void mt5744FlushWrite(void)
         }
 
     len = sprintf(buffer, "%d", recLen0);
-    memcpy(&tp->outputBuffer.data[6], buffer, len);
-    tp->outputBuffer.out = 0;
-    tp->outputBuffer.in  = recLen0 + 16;
-    tp->callback         = mt5744WriteRequestCallback;
-    tp->isBusy           = TRUE;
-    cp->isWriting        = FALSE;
-    cp->isOddFrameCount  = FALSE;
+    memcpy(hp + 6, buffer, len);
+    tp->outputBuffer.in    += recLen0 + 16;
+    metrics.tapeWrites     += 1;
+    metrics.tapeWriteBytes += recLen0;
+    cp->isWriting           = FALSE;
+    cp->isOddFrameCount     = FALSE;
+
+    /*
+    **  The PP continues as soon as the write is posted, unless too many
+    **  writes await acknowledgement.
+    */
+    mt5744PushRequest(tp, mt5744WriteRequestCallback, FALSE);
+    tp->writesPosted += 1;
+    mt5744UpdateWriteWindow(tp);
 #if DEBUG
     fprintf(mt5744Log, "\n%010u PP:%02o CH:%02o P:%04o Write %d PP words",
             traceSequenceNo,
@@ -1146,7 +1329,7 @@ static FcStatus mt5744Func(PpWord funcCode)
             mt5744ResetStatus(tp);
             if (tp->isReady)
                 {
-                mt5744IssueTapeServerRequest(tp, "READFWD", mt5744ReadRequestCallback);
+                mt5744ReadForward(tp);
                 }
             break;
             }
@@ -1209,6 +1392,10 @@ static FcStatus mt5744Func(PpWord funcCode)
         if (unitNo != -1)
             {
             mt5744ResetStatus(tp);
+            if (mt5744CancelReadAhead(tp))
+                {
+                tp->isBusy = TRUE;
+                }
             tp->bp              = tp->ioBuffer;
             tp->recordLength    = 0;
             cp->isWriting       = TRUE;
@@ -1434,7 +1621,8 @@ static void mt5744Io(void)
                     }
                 if (tp != NULL)
                     {
-                    tp->isAlert = FALSE;
+                    tp->isAlert      = FALSE;
+                    tp->isWriteError = FALSE;
                     }
 
                 activeChannel->full = TRUE;
@@ -1640,6 +1828,36 @@ static void mt5744Io(void)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether the PP waits for a response other
+**                  than a write acknowledgement.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        TRUE if a synchronous request is outstanding.
+**
+**------------------------------------------------------------------------*/
+static bool mt5744IsSyncPending(TapeParam *tp)
+    {
+    int i;
+    int n;
+
+    if (tp->isReadWaiting || tp->isReadAheadCancelling || (tp->deferredCallback != NULL))
+        {
+        return (TRUE);
+        }
+    for (i = tp->requestOut, n = tp->requestCount; n > 0; i = (i + 1) % MaxRequests, n--)
+        {
+        if (tp->requests[i].isSync)
+            {
+            return (TRUE);
+            }
+        }
+
+    return (FALSE);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Set up for sending a request to the StorageTek simulator.
 **
@@ -1653,22 +1871,21 @@ static void mt5744Io(void)
 **------------------------------------------------------------------------*/
 static void mt5744IssueTapeServerRequest(TapeParam *tp, char *request, void (*callback)(struct tapeParam *tp))
     {
-    u8   *bp;
-    char *sp;
+    tp->isBusy  = TRUE;
+    tp->isAlert = FALSE;
 
-    bp = &tp->outputBuffer.data[0];
-    sp = request;
-    while (*sp && *sp != '\n')
+    /*
+    **  Requests which position the tape wait until the server's position
+    **  is that of the PP again.
+    */
+    if (mt5744CancelReadAhead(tp))
         {
-        *bp++ = (u8) * sp++;
+        snprintf(tp->deferredRequest, sizeof(tp->deferredRequest), "%s", request);
+        tp->deferredCallback = callback;
+
+        return;
         }
-    *bp++ = '\n';
-    tp->outputBuffer.out = 0;
-    tp->outputBuffer.in  = (u32)(bp - &tp->outputBuffer.data[0]);
-    tp->callback         = callback;
-    tp->isBusy           = TRUE;
-    tp->isAlert          = FALSE;
-    mt5744SendTapeServerRequest(tp);
+    mt5744QueueRequest(tp, request, callback, TRUE);
     }
 
 /*--------------------------------------------------------------------------
@@ -1713,6 +1930,11 @@ void mt5744LoadTape(TapeParam *tp, bool writeEnable)
 
         return;
         }
+
+    /*
+    **  A write error latched on the previous volume no longer applies.
+    */
+    tp->isWriteError = FALSE;
     mt5744ResetUnit(tp);
     strcpy(tp->volumeName, volumeName);
     tp->isBOT          = TRUE;
@@ -1782,13 +2004,7 @@ static int mt5744PackBytes(TapeParam *tp, u8 *rp, int recLen)
     */
     op = tp->ioBuffer;
 
-    /*
-    **  Fill the last few bytes with zeroes.
-    */
-    rp[recLen + 0] = 0;
-    rp[recLen + 1] = 0;
-
-    for (i = 0; i < recLen; i += 3)
+    for (i = 0; i + 3 <= recLen; i += 3)
         {
         c1 = *rp++;
         c2 = *rp++;
@@ -1798,6 +2014,19 @@ static int mt5744PackBytes(TapeParam *tp, u8 *rp, int recLen)
         *op++ = ((c2 << 8) | (c3 >> 0)) & Mask12;
         }
 
+    /*
+    **  Pad the last few bytes with zeroes. The record is not modified
+    **  because the next response may follow it in the input buffer.
+    */
+    if (i < recLen)
+        {
+        c1 = rp[0];
+        c2 = (i + 1 < recLen) ? rp[1] : 0;
+
+        *op++ = ((c1 << 4) | (c2 >> 4)) & Mask12;
+        *op++ = (c2 << 8) & Mask12;
+        }
+
     ppWords             = (int)(op - tp->ioBuffer);
     tp->isCharacterFill = FALSE;
 
@@ -1870,6 +2099,214 @@ static char *mt5744ParseTapeServerResponse(TapeParam *tp, int *status)
     return sp + 1;
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Add a request to the queue of requests in flight.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**                  callback    pointer to response processor
+**                  isSync      TRUE if the PP waits for the response
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744PushRequest(TapeParam *tp, void (*callback)(struct tapeParam *tp), bool isSync)
+    {
+    TapeRequest *rp;
+
+    if (tp->requestCount >= MaxRequests)
+        {
+        logDtError(LogErrorLocation, "Too many requests in flight on CH:%02o u:%d\n", tp->channelNo, tp->unitNo);
+        mt5744CloseTapeServerConnection(tp);
+
+        return;
+        }
+    rp             = &tp->requests[tp->requestIn];
+    tp->requestIn  = (tp->requestIn + 1) % MaxRequests;
+    rp->callback   = callback;
+    rp->isSync     = isSync;
+    rp->tag        = ++tp->requestTag;
+    tp->requestCount += 1;
+#if DEBUG
+    fprintf(mt5744Log, "\n%010u Request %u queued for CH:%02o u:%d, %d in flight", traceSequenceNo,
+            rp->tag, tp->channelNo, tp->unitNo, tp->requestCount);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Queue a request line to the StorageTek simulator and
+**                  start sending it.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**                  request     the request to send
+**                  callback    pointer to response processor
+**                  isSync      TRUE if the PP waits for the response
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744QueueRequest(TapeParam *tp, char *request, void (*callback)(struct tapeParam *tp), bool isSync)
+    {
+    u8   *bp;
+    u32  len;
+    char *sp;
+
+    len = 0;
+    while (request[len] && request[len] != '\n')
+        {
+        len += 1;
+        }
+    bp = mt5744ReserveOutput(tp, len + 1);
+    if (bp == NULL)
+        {
+        logDtError(LogErrorLocation, "Output buffer overflow on CH:%02o u:%d\n", tp->channelNo, tp->unitNo);
+        mt5744CloseTapeServerConnection(tp);
+
+        return;
+        }
+    for (sp = request; len > 0; len--)
+        {
+        *bp++ = (u8) * sp++;
+        }
+    *bp++ = '\n';
+    tp->outputBuffer.in = (u32)(bp - &tp->outputBuffer.data[0]);
+    mt5744PushRequest(tp, callback, isSync);
+    mt5744SendTapeServerRequest(tp);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Keep blocks being read ahead of the PP while it reads
+**                  sequentially.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744ReadAhead(TapeParam *tp)
+    {
+    if (!tp->isPipelined || tp->isReadAheadStopped || tp->isReadAheadCancelling
+        || (tp->sequentialReads < ReadAheadThreshold))
+        {
+        return;
+        }
+    while ((tp->fd > 0) && (tp->readAheadCount + tp->readAheadIssued < ReadAheadDepth))
+        {
+        tp->readAheadIssued += 1;
+        mt5744QueueRequest(tp, "READFWD", mt5744ReadAheadCallback, FALSE);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Process a response from the StorageTek simulator to a
+**                  READFWD request. The block is passed to the PP if it
+**                  waits for it, and is kept for it otherwise.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744ReadAheadCallback(TapeParam *tp)
+    {
+    int            dataIdx;
+    char           *eor;
+    long           len;
+    ReadAheadBlock *rbp;
+    int            status;
+
+    eor = mt5744ParseTapeServerResponse(tp, &status);
+    if (eor == NULL)
+        {
+        return;
+        }
+    len = 0;
+    switch (status)
+        {
+    case 201:
+        len     = strtol((char *)&tp->inputBuffer.data[4], NULL, 10);
+        dataIdx = (int)(eor - (char *)tp->inputBuffer.data);
+        if ((len < 0) || (len > MaxByteBuf))
+            {
+            logDtError(LogErrorLocation, "Invalid block length %ld received from StorageTek simulator\n", len);
+            mt5744CloseTapeServerConnection(tp);
+
+            return;
+            }
+        if ((long)(tp->inputBuffer.in - dataIdx) < len)
+            {
+            return;
+            }
+        break;
+
+    case 202:
+    case 203:
+    case 505:
+        tp->isReadAheadStopped = TRUE;
+        break;
+
+    default:
+        logDtError(LogErrorLocation, "Unexpected status %d received from StorageTek simulator for READFWD request\n", status);
+        mt5744CloseTapeServerConnection(tp);
+
+        return;
+        }
+    tp->readAheadIssued -= 1;
+
+    if (tp->isReadWaiting)
+        {
+        tp->isReadWaiting = FALSE;
+        mt5744SetReadResult(tp, status, (u8 *)eor, (int)len);
+        }
+    else if (tp->isReady)
+        {
+        rbp             = &tp->readAhead[tp->readAheadIn];
+        tp->readAheadIn = (tp->readAheadIn + 1) % ReadAheadDepth;
+        tp->readAheadCount += 1;
+        rbp->status     = status;
+        rbp->len        = (int)len;
+        if ((len > 0) && !tp->isReadAheadCancelling)
+            {
+            if (rbp->data == NULL)
+                {
+                rbp->data = (u8 *)malloc(MaxByteBuf);
+                if (rbp->data == NULL)
+                    {
+                    fputs("(mt5744 ) Failed to allocate read ahead buffer\n", stderr);
+                    exit(1);
+                    }
+                }
+            memcpy(rbp->data, eor, len);
+            }
+        }
+    mt5744ResetInputBuffer(tp, (u8 *)eor + len);
+
+    if (!tp->isReadAheadCancelling)
+        {
+        mt5744ReadAhead(tp);
+        }
+    else if (tp->readAheadIssued == 0)
+        {
+        /*
+        **  All blocks read ahead are known now, so the server can be
+        **  repositioned and the request which waited for it sent.
+        */
+        mt5744CancelReadAhead(tp);
+        if (tp->deferredCallback != NULL)
+            {
+            mt5744QueueRequest(tp, tp->deferredRequest, tp->deferredCallback, TRUE);
+            tp->deferredCallback = NULL;
+            }
+        else
+            {
+            tp->isBusy = tp->isWriteWindowFull;
+            }
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Process a response from the StorageTek simulator to a
 **                  READBLOCKID request.
@@ -1933,9 +2370,11 @@ static void mt5744ReadBlockIdRequestCallback(TapeParam *tp)
 **------------------------------------------------------------------------*/
 static void mt5744ReceiveTapeServerResponse(TapeParam *tp)
     {
-    char *eor;
-    int  n;
-    int  status;
+    char        *eor;
+    u32         in;
+    int         n;
+    TapeRequest *rp;
+    int         status;
 
     n = recv(tp->fd, &tp->inputBuffer.data[tp->inputBuffer.in], sizeof(tp->inputBuffer.data) - tp->inputBuffer.in, 0);
     if (n <= 0)
@@ -1956,14 +2395,24 @@ static void mt5744ReceiveTapeServerResponse(TapeParam *tp)
         mt5744LogFlush();
 #endif
         tp->inputBuffer.in += n;
-        if (tp->inputBuffer.data[0] == '1') // mount/dismount event
+
+        /*
+        **  Several responses may have arrived. Each is processed by the
+        **  callback of the oldest request in flight.
+        */
+        while ((tp->fd > 0) && (tp->inputBuffer.in > 0))
             {
-            if (tp->inputBuffer.in > 3)
+            in = tp->inputBuffer.in;
+            if (tp->inputBuffer.data[0] == '1') // mount/dismount event
                 {
+                if (tp->inputBuffer.in < 4)
+                    {
+                    break;
+                    }
                 eor = mt5744ParseTapeServerResponse(tp, &status);
                 if (eor == NULL)
                     {
-                    return;
+                    break;
                     }
                 switch (status)
                     {
@@ -1984,12 +2433,75 @@ static void mt5744ReceiveTapeServerResponse(TapeParam *tp)
                     }
                 mt5744ResetInputBuffer(tp, (u8 *)eor);
                 }
+            else if (tp->requestCount > 0)
+                {
+                rp             = &tp->requests[tp->requestOut];
+                tp->requestOut = (tp->requestOut + 1) % MaxRequests;
+                tp->requestCount -= 1;
+#if DEBUG
+                fprintf(mt5744Log, "\n%010u Response to request %u for CH:%02o u:%d", traceSequenceNo,
+                        rp->tag, tp->channelNo, tp->unitNo);
+#endif
+                rp->callback(tp);
+                if ((tp->fd > 0) && (tp->inputBuffer.in == in))
+                    {
+                    /*
+                    **  Incomplete response, the request stays at the head
+                    **  of the queue.
+                    */
+                    tp->requestOut = (tp->requestOut + MaxRequests - 1) % MaxRequests;
+                    tp->requestCount += 1;
+
+                    break;
+                    }
+                }
+            else
+                {
+                logDtError(LogErrorLocation, "Unexpected response from %s:%u for CH:%02o u:%d\n",
+                           tp->serverName, ntohs(tp->serverAddr.sin_port), tp->channelNo, tp->unitNo);
+                mt5744CloseTapeServerConnection(tp);
+                }
             }
-        else
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Read the next block forward, from the blocks read
+**                  ahead if there are any.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744ReadForward(TapeParam *tp)
+    {
+    if (tp->isReadAheadCancelling)
+        {
+        mt5744IssueTapeServerRequest(tp, "READFWD", mt5744ReadRequestCallback);
+
+        return;
+        }
+
+    tp->sequentialReads += 1;
+    if (tp->readAheadCount > 0)
+        {
+        mt5744ConsumeReadAhead(tp);
+        }
+    else
+        {
+        tp->isBusy        = TRUE;
+        tp->isAlert       = FALSE;
+        tp->isReadWaiting = TRUE;
+        if (tp->readAheadIssued == 0)
             {
-            tp->callback(tp);
+            tp->isReadAheadStopped = FALSE;
+            tp->readAheadIssued    = 1;
+            mt5744QueueRequest(tp, "READFWD", mt5744ReadAheadCallback, FALSE);
             }
         }
+    mt5744ReadAhead(tp);
     }
 
 /*--------------------------------------------------------------------------
@@ -2015,8 +2527,7 @@ static void mt5744ReadRequestCallback(TapeParam *tp)
         {
         return;
         }
-    tp->isEOT = FALSE;
-    tp->bp    = tp->ioBuffer;
+    len = 0;
     switch (status)
         {
     case 201:
@@ -2027,27 +2538,11 @@ static void mt5744ReadRequestCallback(TapeParam *tp)
             {
             return;
             }
-        tp->recordLength = mt5744PackBytes(tp, (u8 *)eor, len);
-        eor      += len;
-        tp->isBOT = FALSE;
         break;
 
     case 202:
-        tp->recordLength = 0;
-        tp->isBOT        = FALSE;
-        tp->isTapeMark   = TRUE;
-        break;
-
     case 203:
-        tp->recordLength = 0;
-        tp->isBOT        = TRUE;
-        break;
-
     case 505:
-        tp->recordLength = 0;
-        tp->isBOT        = FALSE;
-        //tp->isEOT = TRUE;
-        tp->isTapeMark = TRUE; // simulate tape mark instead of end-of-medium
         break;
 
     default:
@@ -2056,8 +2551,8 @@ static void mt5744ReadRequestCallback(TapeParam *tp)
 
         return;
         }
-    tp->isBusy = FALSE;
-    mt5744ResetInputBuffer(tp, (u8 *)eor);
+    mt5744SetReadResult(tp, status, (u8 *)eor, (int)len);
+    mt5744ResetInputBuffer(tp, (u8 *)eor + len);
     }
 
 /*--------------------------------------------------------------------------
@@ -2074,6 +2569,7 @@ static void mt5744RegisterUnit(TapeParam *tp)
     u8     *bp;
     size_t len;
 
+    mt5744ResetPipeline(tp);
     bp  = tp->outputBuffer.data;
     len = strlen(tp->driveName);
     memcpy(bp, "REGISTER ", 9);
@@ -2085,7 +2581,7 @@ static void mt5744RegisterUnit(TapeParam *tp)
     tp->outputBuffer.in  = (u32)(len + 10);
     tp->outputBuffer.out = 0;
     tp->state            = StAcsRegistering;
-    tp->callback         = mt5744RegisterUnitRequestCallback;
+    mt5744PushRequest(tp, mt5744RegisterUnitRequestCallback, FALSE);
     }
 
 /*--------------------------------------------------------------------------
@@ -2111,6 +2607,14 @@ static void mt5744RegisterUnitRequestCallback(TapeParam *tp)
         {
         mt5744ResetUnit(tp);
         tp->state = StAcsReady;
+
+        /*
+        **  Servers which accept requests before answering earlier ones say
+        **  so in their response.
+        */
+        eor[-1]         = '\0';
+        tp->isPipelined = strstr((char *)tp->inputBuffer.data, " pipelined") != NULL;
+        eor[-1]         = '\n';
         }
     else
         {
@@ -2120,6 +2624,35 @@ static void mt5744RegisterUnitRequestCallback(TapeParam *tp)
     mt5744ResetInputBuffer(tp, (u8 *)eor);
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Reserve space for a request at the end of the output
+**                  buffer.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape parameters
+**                  len         length of request
+**
+**  Returns:        Pointer to reserved space, NULL if there is not
+**                  enough space.
+**
+**------------------------------------------------------------------------*/
+static u8 *mt5744ReserveOutput(TapeParam *tp, u32 len)
+    {
+    if (tp->outputBuffer.out > 0)
+        {
+        memmove(tp->outputBuffer.data, &tp->outputBuffer.data[tp->outputBuffer.out],
+                tp->outputBuffer.in - tp->outputBuffer.out);
+        tp->outputBuffer.in -= tp->outputBuffer.out;
+        tp->outputBuffer.out = 0;
+        }
+    if (tp->outputBuffer.in + len > sizeof(tp->outputBuffer.data))
+        {
+        return (NULL);
+        }
+
+    return (&tp->outputBuffer.data[tp->outputBuffer.in]);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Reset input buffer indices to prepare for processing
 **                  next available input.
@@ -2148,6 +2681,35 @@ static void mt5744ResetInputBuffer(TapeParam *tp, u8 *eor)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Forget all requests in flight and all buffered data
+**                  when a connection starts or ends.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape parameters
+**
+**  Returns:        Nothing
+**
+**------------------------------------------------------------------------*/
+static void mt5744ResetPipeline(TapeParam *tp)
+    {
+    tp->inputBuffer.out  = tp->inputBuffer.in = 0;
+    tp->outputBuffer.out = tp->outputBuffer.in = 0;
+    tp->isPipelined           = FALSE;
+    tp->requestCount          = 0;
+    tp->requestIn             = tp->requestOut = 0;
+    tp->deferredCallback      = NULL;
+    tp->writesPosted          = 0;
+    tp->isWriteWindowFull     = FALSE;
+    tp->readAheadCount        = 0;
+    tp->readAheadIn           = tp->readAheadOut = 0;
+    tp->readAheadIssued       = 0;
+    tp->sequentialReads       = 0;
+    tp->isReadAheadCancelling = FALSE;
+    tp->isReadAheadStopped    = FALSE;
+    tp->isReadWaiting         = FALSE;
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Reset tape unit status prior to initiating I/O.
 **
@@ -2168,6 +2730,16 @@ static void mt5744ResetStatus(TapeParam *tp)
         tp->isEOT           = FALSE;
         tp->isTapeMark      = FALSE;
         tp->errorCode       = 0;
+
+        /*
+        **  The PP was told a posted write succeeded before the server
+        **  answered it, so a failure stays latched until it is reported.
+        */
+        if (tp->isWriteError)
+            {
+            tp->isAlert   = TRUE;
+            tp->errorCode = EcTranportNotOnline;
+            }
         }
     }
 
@@ -2182,13 +2754,21 @@ static void mt5744ResetStatus(TapeParam *tp)
 **------------------------------------------------------------------------*/
 static void mt5744ResetUnit(TapeParam *tp)
     {
-    tp->inputBuffer.out  = tp->inputBuffer.in = 0;
-    tp->outputBuffer.out = tp->outputBuffer.in = 0;
     mt5744ResetStatus(tp);
     tp->isBusy         = FALSE;
     tp->isReady        = FALSE;
     tp->isWriteEnabled = FALSE;
     tp->volumeName[0]  = '\0';
+
+    /*
+    **  Blocks read ahead belong to the previous volume. Requests in flight
+    **  are still answered, so the queue is kept.
+    */
+    tp->readAheadCount     = 0;
+    tp->readAheadIn        = tp->readAheadOut = 0;
+    tp->sequentialReads    = 0;
+    tp->isReadAheadStopped = TRUE;
+    tp->isReadWaiting      = FALSE;
     }
 
 /*--------------------------------------------------------------------------
@@ -2282,7 +2862,57 @@ static void mt5744SendTapeServerRequest(TapeParam *tp)
             {
             tp->outputBuffer.out = tp->outputBuffer.in = 0;
             }
+        if (tp->isWriteWindowFull)
+            {
+            mt5744UpdateWriteWindow(tp);
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Present the result of reading a block to the PP.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**                  status      response status
+**                  data        pointer to block data
+**                  len         length of block data
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744SetReadResult(TapeParam *tp, int status, u8 *data, int len)
+    {
+    tp->isEOT = FALSE;
+    tp->bp    = tp->ioBuffer;
+    switch (status)
+        {
+    case 201:
+        tp->recordLength       = mt5744PackBytes(tp, data, len);
+        tp->isBOT              = FALSE;
+        metrics.tapeReads     += 1;
+        metrics.tapeReadBytes += len;
+        break;
+
+    case 202:
+        tp->recordLength = 0;
+        tp->isBOT        = FALSE;
+        tp->isTapeMark   = TRUE;
+        break;
+
+    case 203:
+        tp->recordLength = 0;
+        tp->isBOT        = TRUE;
+        break;
+
+    case 505:
+        tp->recordLength = 0;
+        tp->isBOT        = FALSE;
+        //tp->isEOT = TRUE;
+        tp->isTapeMark = TRUE; // simulate tape mark instead of end-of-medium
+        break;
         }
+    tp->isBusy = tp->isWriteWindowFull;
     }
 
 /*--------------------------------------------------------------------------
@@ -2353,6 +2983,40 @@ void mt5744UnloadTape(TapeParam *tp)
 #endif
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Hold the PP off further writes while too many await
+**                  acknowledgement or the output buffer cannot take
+**                  another block.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to tape unit parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void mt5744UpdateWriteWindow(TapeParam *tp)
+    {
+    bool isFull;
+    u32  unsent;
+
+    unsent = tp->outputBuffer.in - tp->outputBuffer.out;
+    isFull = (tp->writesPosted >= (tp->isPipelined ? MaxWritesPosted : 1))
+             || (sizeof(tp->outputBuffer.data) - unsent < MaxByteBuf + 16);
+    if (isFull)
+        {
+        tp->isWriteWindowFull = TRUE;
+        tp->isBusy            = TRUE;
+        }
+    else if (tp->isWriteWindowFull)
+        {
+        tp->isWriteWindowFull = FALSE;
+        if (!mt5744IsSyncPending(tp))
+            {
+            tp->isBusy = FALSE;
+            }
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Process a response from the StorageTek simulator to a
 **                  WRITE request.
@@ -2373,15 +3037,18 @@ static void mt5744WriteRequestCallback(TapeParam *tp)
         {
         return;
         }
-    tp->isBusy = FALSE;
+    tp->writesPosted -= 1;
     if (status == 200)
         {
         tp->isBOT = FALSE;
+        mt5744UpdateWriteWindow(tp);
         }
     else
         {
         logDtError(LogErrorLocation, "Unexpected status %d received from StorageTek simulator for WRITE request\n", status);
         mt5744CloseTapeServerConnection(tp);
+        tp->isWriteError = TRUE;
+        tp->isAlert      = TRUE;
         }
     mt5744ResetInputBuffer(tp, (u8 *)eor);
     }
@@ -195,6 +195,7 @@ void mt607Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     dp->disconnect   = mt607Disconnect;
     dp->func         = mt607Func;
     dp->io           = mt607Io;
+    dp->blockIo      = TRUE;
     dp->selectedUnit = unitNo;
 
     /*
@@ -361,6 +362,8 @@ static FcStatus mt607Func(PpWord funcCode)
         **  Read and verify the actual raw data.
         */
         len = (u32)fread(rawBuffer, 1, recLen1, activeDevice->fcb[activeDevice->selectedUnit]);
+        metrics.tapeReads     += 1;
+        metrics.tapeReadBytes += len;
 
         if (recLen1 != (u32)len)
             {
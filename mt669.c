@@ -2022,6 +2022,9 @@ static void mt669Disconnect(void)
     fwrite(&rawBuffer, 1, recLen0, fcb);
     fwrite(&recLen1, sizeof(recLen1), 1, fcb);
 
+    metrics.tapeWrites     += 1;
+    metrics.tapeWriteBytes += recLen0;
+
     /*
     **  The following fseek prepares for any subsequent fread.
     */
@@ -2248,6 +2251,8 @@ static void mt669FuncRead(void)
     **  Read and verify the actual raw data.
     */
     len = (u32)fread(rawBuffer, 1, recLen1, activeDevice->fcb[unitNo]);
+    metrics.tapeReads     += 1;
+    metrics.tapeReadBytes += len;
 
     if (recLen1 != (u32)len)
         {
@@ -2443,6 +2448,8 @@ static void mt669FuncReadBkw(void)
         **  Read and verify the actual raw data.
         */
         len = (u32)fread(rawBuffer, 1, recLen1, activeDevice->fcb[unitNo]);
+        metrics.tapeReads     += 1;
+        metrics.tapeReadBytes += len;
 
         if (recLen1 != (u32)len)
             {
@@ -24,8 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -241,9 +239,7 @@ static TapeParam *firstTape = NULL;
 static TapeParam *lastTape  = NULL;
 static u8        rawBuffer[MaxByteBuf];
 
-#if DEBUG
-static FILE *mt679Log = NULL;
-#endif
+static DevLogModule *mt679Log;
 
 /*
  **--------------------------------------------------------------------------
@@ -270,12 +266,7 @@ void mt679Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     FILE      *fcb;
     TapeParam *tp;
 
-#if DEBUG
-    if (mt679Log == NULL)
-        {
-        mt679Log = fopen("mt679log.txt", "wt");
-        }
-#endif
+    mt679Log = devLogRegister("mt679");
 
     /*
     **  Attach device to channel.
@@ -988,23 +979,11 @@ static void mt679UnpackConversionTable(u8 *convTable)
 
     *op++ = ((ip[0] >> 4) & 0xFF);    // discard last 4 bits
 
-#if DEBUG
+    if (DevLogEnabled(mt679Log, DevLogDebug))
         {
-        int i;
-        fprintf(mt679Log, "\n(mt679  ) Conversion Table %d", cp->selectedConversion);
-
-        for (i = 0; i < 256; i++)
-            {
-            if (i % 16 == 0)
-                {
-                fprintf(mt679Log, "\n  %02X :", i);
-                }
-
-            fprintf(mt679Log, "  %02X", convTable[i]);
-            }
+        devLogText(mt679Log, "\n(mt679  ) Conversion Table %d\n", cp->selectedConversion);
+        devLogBytes(mt679Log, convTable, 256);
         }
-    fprintf(mt679Log, "\n");
-#endif
     }
 
 /*--------------------------------------------------------------------------
@@ -1030,23 +1009,11 @@ static void mt679Unpack6BitTable(u8 *convTable)
         ip   += 1;
         }
 
-#if DEBUG
+    if (DevLogEnabled(mt679Log, DevLogDebug))
         {
-        int i;
-        fprintf(mt679Log, "\n(mt679  ) Conversion Table %d", cp->selectedConversion);
-
-        for (i = 0; i < 256; i++)
-            {
-            if (i % 16 == 0)
-                {
-                fprintf(mt679Log, "\n%02X :", i);
-                }
-
-            fprintf(mt679Log, " %02X", convTable[i]);
-            }
+        devLogText(mt679Log, "\n(mt679  ) Conversion Table %d\n", cp->selectedConversion);
+        devLogBytes(mt679Log, convTable, 256);
         }
-    fprintf(mt679Log, "\n");
-#endif
     }
 
 /*--------------------------------------------------------------------------
@@ -1076,15 +1043,16 @@ static FcStatus mt679Func(PpWord funcCode)
         tp = NULL;
         }
 
-#if DEBUG
-    fprintf(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o u:%d f:%04o T:%-25s  >   ",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id,
-            unitNo,
-            funcCode,
-            mt679Func2String(funcCode));
-#endif
+    if (DevLogEnabled(mt679Log, DevLogInfo))
+        {
+        devLogText(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o u:%d f:%04o T:%-25s  >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id,
+                   unitNo,
+                   funcCode,
+                   mt679Func2String(funcCode));
+        }
 
     /*
     **  Reset function code.
@@ -1123,9 +1091,10 @@ static FcStatus mt679Func(PpWord funcCode)
     switch (funcCode)
         {
     default:
-#if DEBUG
-        fprintf(mt679Log, " FUNC not implemented & declined!");
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, " FUNC not implemented & declined!");
+            }
         if (unitNo != -1)
             {
             tp->errorCode = EcIllegalFunction;
@@ -1504,9 +1473,10 @@ static FcStatus mt679Func(PpWord funcCode)
     case Fc679MeasureStartTFwd:
     case Fc679SetTransferCheckCh:
     case Fc679SetLoopWTRTcu:
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) maintenance functions not implemented %o\n", funcCode);
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) maintenance functions not implemented %o\n", funcCode);
+            }
 
         return (FcProcessed);
 
@@ -1522,9 +1492,10 @@ static FcStatus mt679Func(PpWord funcCode)
     case Fc679SetEvenWrParity:
     case Fc679SetEvenChParity:
     case Fc679ForceDataErrors:
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) maintenance functions not implemented %o\n", funcCode);
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) maintenance functions not implemented %o\n", funcCode);
+            }
 
         return (FcProcessed);
 
@@ -1601,9 +1572,10 @@ static void mt679Io(void)
                 {
                 wordNumber = 4 - activeDevice->recordLength;
 
-#if DEBUG
-                fprintf(mt679Log, " %04o", activeChannel->data);
-#endif
+                if (DevLogEnabled(mt679Log, DevLogDebug))
+                    {
+                    devLogText(mt679Log, " %04o", activeChannel->data);
+                    }
 
                 if (wordNumber == 1)
                     {
@@ -1695,9 +1667,10 @@ static void mt679Io(void)
                     }
 
                 activeChannel->full = TRUE;
-#if DEBUG
-                fprintf(mt679Log, " %04o", activeChannel->data);
-#endif
+                if (DevLogEnabled(mt679Log, DevLogDebug))
+                    {
+                    devLogText(mt679Log, " %04o", activeChannel->data);
+                    }
                 }
             }
         break;
@@ -1761,16 +1734,13 @@ static void mt679Io(void)
 
         if (activeDevice->recordLength < MaxPackedConvBuf)
             {
-#if DEBUG
-            if (activeDevice->recordLength % 8 == 0)
+            activeChannel->data = cp->packedConv[activeDevice->recordLength];
+            if (DevLogEnabled(mt679Log, DevLogDebug))
                 {
-                fprintf(mt679Log, "\n");
+                devLogText(mt679Log, "%s %04o", activeDevice->recordLength % 8 == 0 ? "\n" : "", activeChannel->data);
                 }
-#endif
-            activeChannel->data = cp->packedConv[activeDevice->recordLength++];
-#if DEBUG
-            fprintf(mt679Log, " %04o", activeChannel->data);
-#endif
+
+            activeDevice->recordLength += 1;
             }
         else
             {
@@ -1801,13 +1771,11 @@ static void mt679Io(void)
 
         if (activeDevice->recordLength < MaxPackedConvBuf)
             {
-#if DEBUG
-            fprintf(mt679Log, " %04o", activeChannel->data);
-            if (activeDevice->recordLength % 8 == 0)
+            if (DevLogEnabled(mt679Log, DevLogDebug))
                 {
-                fprintf(mt679Log, "\n");
+                devLogText(mt679Log, " %04o%s", activeChannel->data, activeDevice->recordLength % 8 == 0 ? "\n" : "");
                 }
-#endif
+
             cp->packedConv[activeDevice->recordLength++] = activeChannel->data;   // <<<<<<<<<<<<<<< add wrapping.
             }
         break;
@@ -1824,13 +1792,14 @@ static void mt679Io(void)
 **------------------------------------------------------------------------*/
 static void mt679Activate(void)
     {
-#if DEBUG
-    CtrlParam *cp = activeDevice->controllerContext;
-    fprintf(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o Activate",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id);
-#endif
+    if (DevLogEnabled(mt679Log, DevLogInfo))
+        {
+        devLogText(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o Activate",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id);
+        }
+
     activeChannel->delayStatus = 5;
     }
 
@@ -1846,12 +1815,13 @@ static void mt679Disconnect(void)
     {
     CtrlParam *cp = activeDevice->controllerContext;
 
-#if DEBUG
-    fprintf(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o Disconnect",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id);
-#endif
+    if (DevLogEnabled(mt679Log, DevLogInfo))
+        {
+        devLogText(mt679Log, "\n(mt679  ) %06d PP:%02o CH:%02o Disconnect",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id);
+        }
 
     /*
     **  Abort pending device disconnects - the PP is doing the disconnect.
@@ -2021,6 +1991,9 @@ static void mt679FlushWrite(void)
     fwrite(&rawBuffer, 1, recLen0, fcb);
     fwrite(&recLen1, sizeof(recLen1), 1, fcb);
 
+    metrics.tapeWrites     += 1;
+    metrics.tapeWriteBytes += recLen0;
+
     /*
     **  The following fseek prepares for any subsequent fread.
     */
@@ -2186,9 +2159,10 @@ static void mt679FuncRead(void)
             {
 //            tp->endOfTape = TRUE;
             tp->fileMark = TRUE;
-#if DEBUG
-            fprintf(mt679Log, "TAP is at EOF (simulate tape mark)\n");
-#endif
+            if (DevLogEnabled(mt679Log, DevLogInfo))
+                {
+                devLogText(mt679Log, "TAP is at EOF (simulate tape mark)\n");
+                }
             }
 
         return;
@@ -2226,9 +2200,10 @@ static void mt679FuncRead(void)
         tp->fileMark = TRUE;
         tp->blockNo += 1;
 
-#if DEBUG
-        fprintf(mt679Log, "Tape mark\n");
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "Tape mark\n");
+            }
 
         return;
         }
@@ -2237,6 +2212,8 @@ static void mt679FuncRead(void)
     **  Read and verify the actual raw data.
     */
     len = (u32)fread(rawBuffer, 1, recLen1, activeDevice->fcb[unitNo]);
+    metrics.tapeReads     += 1;
+    metrics.tapeReadBytes += len;
 
     if (recLen1 != (u32)len)
         {
@@ -2298,9 +2275,10 @@ static void mt679FuncRead(void)
     /*
     **  Setup length, buffer pointer and block number.
     */
-#if DEBUG
-    fprintf(mt679Log, "(mt679  ) Read fwd %d PP words (%d 8-bit bytes)\n", activeDevice->recordLength, recLen1);
-#endif
+    if (DevLogEnabled(mt679Log, DevLogInfo))
+        {
+        devLogText(mt679Log, "(mt679  ) Read fwd %d PP words (%d 8-bit bytes)\n", activeDevice->recordLength, recLen1);
+        }
 
     tp->recordLength = activeDevice->recordLength;
     tp->bp           = tp->ioBuffer;
@@ -2431,6 +2409,8 @@ static void mt679FuncReadBkw(void)
         **  Read and verify the actual raw data.
         */
         len = (u32)fread(rawBuffer, 1, recLen1, activeDevice->fcb[unitNo]);
+        metrics.tapeReads     += 1;
+        metrics.tapeReadBytes += len;
 
         if (recLen1 != (u32)len)
             {
@@ -2454,9 +2434,10 @@ static void mt679FuncReadBkw(void)
         /*
         **  Setup length and buffer pointer.
         */
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) Read bkwd %d bytes\n", activeDevice->recordLength);
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) Read bkwd %d bytes\n", activeDevice->recordLength);
+            }
 
         tp->recordLength = activeDevice->recordLength;
         tp->bp           = tp->ioBuffer + tp->recordLength - 1;
@@ -2468,9 +2449,10 @@ static void mt679FuncReadBkw(void)
         */
         tp->fileMark = TRUE;
 
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) Tape mark\n");
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) Tape mark\n");
+            }
         }
 
     /*
@@ -2528,9 +2510,10 @@ static void mt679FuncForespace(void)
             {
 //            tp->endOfTape = TRUE;
             tp->fileMark = TRUE;
-#if DEBUG
-            fprintf(mt679Log, "(mt679  ) TAP is at EOF (simulate tape mark)\n");
-#endif
+            if (DevLogEnabled(mt679Log, DevLogInfo))
+                {
+                devLogText(mt679Log, "(mt679  ) TAP is at EOF (simulate tape mark)\n");
+                }
             }
 
         return;
@@ -2568,9 +2551,10 @@ static void mt679FuncForespace(void)
         tp->fileMark = TRUE;
         tp->blockNo += 1;
 
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) Tape mark\n");
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) Tape mark\n");
+            }
 
         return;
         }
@@ -2761,9 +2745,10 @@ static void mt679FuncBackspace(void)
         */
         tp->fileMark = TRUE;
 
-#if DEBUG
-        fprintf(mt679Log, "(mt679  ) Tape mark\n");
-#endif
+        if (DevLogEnabled(mt679Log, DevLogInfo))
+            {
+            devLogText(mt679Log, "(mt679  ) Tape mark\n");
+            }
         }
 
     /*
@@ -2792,7 +2777,6 @@ static char *mt679Func2String(PpWord funcCode)
     {
     static char buf[40];
 
-#if DEBUG
     switch (funcCode)
         {
     case Fc679ClearUnit:
@@ -3074,7 +3058,7 @@ static char *mt679Func2String(PpWord funcCode)
     case Fc679MasterClear:
         return "MasterClear";
         }
-#endif
+
     sprintf(buf, "(mt679  ) Unknown Function: %04o", funcCode);
 
     return (buf);
@@ -25,11 +25,6 @@
 **
 **--------------------------------------------------------------------------
 */
-#define DEBUG_6671            0
-#define DEBUG_6676            0
-#define DEBUG_NETIO           0
-#define DEBUG_PPIO            0
-#define DEBUG_PPIO_VERBOSE    0
 
 /*
 **  -------------
@@ -83,11 +78,6 @@
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG_6671 || DEBUG_6676
-#define HexColumn(x)      (3 * (x) + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
 
 /*
 **  -----------------------------------------
@@ -132,6 +122,7 @@ typedef struct muxParam
     int             ioTurns;
     PortGroup       portGroups[MaxPortGroups];
     PortParam       *ports;
+    DevLogModule    *log;
     } MuxParam;
 
 /*
@@ -148,13 +139,7 @@ static void mux667xDisconnect(void);
 static void mux667xInit(u8 eqNo, u8 channelNo, int muxType, char *params);
 static void mux667xIo(void);
 static bool mux667xInputRequired(MuxParam *mp);
-
-#if DEBUG_6671 || DEBUG_6676
 static char *mux667xFunc2String(PpWord funcCode);
-static void mux667xLogBytes(FILE *log, MuxParam *mp, u8 *bytes, int len);
-static void mux667xLogFlush(FILE *log, MuxParam *mp);
-
-#endif
 
 /*
 **  ----------------
@@ -175,17 +160,6 @@ MuxParam *lastMux  = NULL;
 static char connectingMsg[] = "\r\nConnecting to host - please wait ...";
 static char noPortsMsg[]    = "\r\nNo free ports available - please try again later.\r\n";
 
-#if DEBUG_6671
-static FILE *mux6671Log = NULL;
-#endif
-#if DEBUG_6676
-static FILE *mux6676Log = NULL;
-#endif
-#if DEBUG_6671 || DEBUG_6676
-static char mux667xLogBuf[LogLineLength + 1];
-static int  mux667xLogBytesCol = 0;
-#endif
-
 /*
  **--------------------------------------------------------------------------
  **
@@ -371,6 +345,7 @@ static void mux667xInit(u8 eqNo, u8 channelNo, int muxType, char *params)
 
     sprintf(mp->name, "%s_CH%02o_EQ%02o", mts, channelNo, eqNo);
     mp->type      = muxType;
+    mp->log       = devLogRegister(muxType == DtMux6671 ? "mux6671" : "mux6676");
     mp->channelNo = channelNo;
     mp->eqNo      = eqNo;
     mp->ioTurns   = IoTurnsPerPoll - 1;
@@ -511,19 +486,6 @@ static void mux667xInit(u8 eqNo, u8 channelNo, int muxType, char *params)
             }
         }
     fputc('\n', stdout);
-
-#if DEBUG_6671
-    if (mux6671Log == NULL)
-        {
-        mux6671Log = fopen("mux6671log.txt", "wt");
-        }
-#endif
-#if DEBUG_6676
-    if (mux6676Log == NULL)
-        {
-        mux6676Log = fopen("mux6676log.txt", "wt");
-        }
-#endif
     }
 
 /*--------------------------------------------------------------------------
@@ -540,24 +502,12 @@ static FcStatus mux667xFunc(PpWord funcCode)
     u8       eqNo;
     MuxParam *mp = (MuxParam *)activeDevice->context[0];
 
-#if DEBUG_PPIO
-#if DEBUG_6671
-    if ((mp->type == DtMux6671) && (DEBUG_PPIO_VERBOSE != 0))
+    if (DevLogEnabled(mp->log, DevLogDebug))
         {
-        fprintf(mux6671Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s",
-                traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                activePpu->regP, funcCode, mux667xFunc2String(funcCode));
+        devLogText(mp->log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s",
+                   traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
+                   activePpu->regP, funcCode, mux667xFunc2String(funcCode));
         }
-#endif
-#if DEBUG_6676
-    if ((mp->type == DtMux6676) && (DEBUG_PPIO_VERBOSE != 0))
-        {
-        fprintf(mux6676Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s",
-                traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                activePpu->regP, funcCode, mux667xFunc2String(funcCode));
-        }
-#endif
-#endif
 
     eqNo = (funcCode & Fc667xEqMask) >> Fc667xEqShift;
     if (eqNo != activeDevice->eqNo)
@@ -573,20 +523,10 @@ static FcStatus mux667xFunc(PpWord funcCode)
     switch (funcCode)
         {
     default:
-#if DEBUG_PPIO
-#if DEBUG_6671
-        if ((mp->type == DtMux6671) && (DEBUG_PPIO_VERBOSE != 0))
+        if (DevLogEnabled(mp->log, DevLogError))
             {
-            fputs("\n  FUNC not implemented & declined!", mux6671Log);
+            devLogText(mp->log, "\n  FUNC not implemented & declined!");
             }
-#endif
-#if DEBUG_6676
-        if ((mp->type == DtMux6676) && (DEBUG_PPIO_VERBOSE != 0))
-            {
-            fputs("\n  FUNC not implemented & declined!", mux6676Log);
-            }
-#endif
-#endif
 
         return (FcDeclined);
 
@@ -639,24 +579,12 @@ static void mux667xIo(void)
                 {
                 word     = activeChannel->data;
                 function = word >> 9;
-#if DEBUG_PPIO
-#if DEBUG_6671
-                if (mp->type == DtMux6671)
+                if (DevLogEnabled(mp->log, DevLogInfo))
                     {
-                    fprintf(mux6671Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
-                            traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                            activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, word);
+                    devLogText(mp->log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
+                               traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
+                               activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, word);
                     }
-#endif
-#if DEBUG_6676
-                if (mp->type == DtMux6676)
-                    {
-                    fprintf(mux6676Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
-                            traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                            activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, word);
-                    }
-#endif
-#endif
                 pp = mp->ports + portNumber;
                 if (pp->active)
                     {
@@ -694,22 +622,11 @@ static void mux667xIo(void)
                             {
                             pp->outBuffer[pp->outInIdx++] = x;
                             }
-#if DEBUG_NETIO
-#if DEBUG_6671
-                        else if (pp->mux->type == DtMux6671)
+                        else if (DevLogEnabled(pp->mux->log, DevLogError))
                             {
-                            fprintf(mux6671Log, "\n%010u %s output buffer overflow on port %02o",
-                                    traceSequenceNo, pp->mux->name, pp->id);
+                            devLogText(pp->mux->log, "\n%010u %s output buffer overflow on port %02o",
+                                       traceSequenceNo, pp->mux->name, pp->id);
                             }
-#endif
-#if DEBUG_6676
-                        else if (pp->mux->type == DtMux6676)
-                            {
-                            fprintf(mux6676Log, "\n%010u %s output buffer overflow on port %02o",
-                                    traceSequenceNo, pp->mux->name, pp->id);
-                            }
-#endif
-#endif
                         break;
 
                     case 6:
@@ -771,27 +688,13 @@ static void mux667xIo(void)
                             }
                         }
                     }
-#if DEBUG_PPIO
-                if ((DEBUG_PPIO_VERBOSE != 0) || ((activeChannel->data & 04000) != 0))
+                if (DevLogEnabled(mp->log, DevLogDebug)
+                    || (DevLogEnabled(mp->log, DevLogInfo) && ((activeChannel->data & 04000) != 0)))
                     {
-#if DEBUG_6671
-                    if (mp->type == DtMux6671)
-                        {
-                        fprintf(mux6671Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
-                                traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                                activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, activeChannel->data);
-                        }
-#endif
-#if DEBUG_6676
-                    if (mp->type == DtMux6676)
-                        {
-                        fprintf(mux6676Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
-                                traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                                activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, activeChannel->data);
-                        }
-#endif
+                    devLogText(mp->log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Port:%02o Data:%04o",
+                               traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
+                               activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), portNumber, activeChannel->data);
                     }
-#endif
                 }
             }
         break;
@@ -804,24 +707,12 @@ static void mux667xIo(void)
             }
         activeChannel->full = TRUE;
 
-#if DEBUG_PPIO
-#if DEBUG_6671
-        if (mp->type == DtMux6671)
-            {
-            fprintf(mux6671Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Data:%04o",
-                    traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                    activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), activeChannel->data);
-            }
-#endif
-#if DEBUG_6676
-        if (mp->type == DtMux6676)
+        if (DevLogEnabled(mp->log, DevLogDebug))
             {
-            fprintf(mux6676Log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Data:%04o",
-                    traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
-                    activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), activeChannel->data);
+            devLogText(mp->log, "\n%010u %s PP:%02o CH:%02o P:%04o f:%04o T:%s Data:%04o",
+                       traceSequenceNo, mp->name, activePpu->id, activeDevice->channel->id,
+                       activePpu->regP, activeDevice->fcode, mux667xFunc2String(activeDevice->fcode), activeChannel->data);
             }
-#endif
-#endif
         break;
         }
     }
@@ -950,24 +841,12 @@ static void mux667xCheckIo(MuxParam *mp)
                 n = recv(pp->connFd, &pp->inBuffer[pp->inInIdx], InBufSize - pp->inInIdx, 0);
                 if (n > 0)
                     {
-#if DEBUG_NETIO
-#if DEBUG_6671
-                    if (pp->mux->type == DtMux6671)
-                        {
-                        fprintf(mux6671Log, "\n%010u %s received %d bytes on port %02o",
-                                traceSequenceNo, mp->name, n, pp->id);
-                        mux667xLogBytes(mux6671Log, mp, &pp->inBuffer[pp->inInIdx], n);
-                        }
-#endif
-#if DEBUG_6676
-                    if (pp->mux->type == DtMux6676)
+                    if (DevLogEnabled(mp->log, DevLogInfo))
                         {
-                        fprintf(mux6676Log, "\n%010u %s received %d bytes on port %02o",
-                                traceSequenceNo, mp->name, n, pp->id);
-                        mux667xLogBytes(mux6676Log, mp, &pp->inBuffer[pp->inInIdx], n);
+                        devLogText(mp->log, "\n%010u %s received %d bytes on port %02o",
+                                   traceSequenceNo, mp->name, n, pp->id);
+                        devLogBytes(mp->log, &pp->inBuffer[pp->inInIdx], n);
                         }
-#endif
-#endif
                     pp->inInIdx += n;
                     }
                 else
@@ -980,24 +859,12 @@ static void mux667xCheckIo(MuxParam *mp)
                 n = send(pp->connFd, &pp->outBuffer[pp->outOutIdx], pp->outInIdx - pp->outOutIdx, 0);
                 if (n >= 0)
                     {
-#if DEBUG_NETIO
-#if DEBUG_6671
-                    if (pp->mux->type == DtMux6671)
+                    if (DevLogEnabled(mp->log, DevLogInfo))
                         {
-                        fprintf(mux6671Log, "\n%010u %s sent %d bytes to port %02o",
-                                traceSequenceNo, mp->name, n, pp->id);
-                        mux667xLogBytes(mux6671Log, mp, &pp->outBuffer[pp->outOutIdx], n);
+                        devLogText(mp->log, "\n%010u %s sent %d bytes to port %02o",
+                                   traceSequenceNo, mp->name, n, pp->id);
+                        devLogBytes(mp->log, &pp->outBuffer[pp->outOutIdx], n);
                         }
-#endif
-#if DEBUG_6676
-                    if (pp->mux->type == DtMux6676)
-                        {
-                        fprintf(mux6676Log, "\n%010u %s sent %d bytes to port %02o",
-                                traceSequenceNo, mp->name, n, pp->id);
-                        mux667xLogBytes(mux6676Log, mp, &pp->outBuffer[pp->outOutIdx], n);
-                        }
-#endif
-#endif
                     pp->outOutIdx += n;
                     if (pp->outOutIdx >= pp->outInIdx)
                         {
@@ -1055,22 +922,11 @@ static void mux667xCheckIo(MuxParam *mp)
                     {
                     send(fd, connectingMsg, (int)strlen(connectingMsg), 0);
                     }
-#if DEBUG_NETIO
-#if DEBUG_6671
-                if (availablePort->mux->type == DtMux6671)
-                    {
-                    fprintf(mux6671Log, "\n%010u %s accepted connection on port %02o",
-                            traceSequenceNo, availablePort->mux->name, availablePort->id);
-                    }
-#endif
-#if DEBUG_6676
-                if (availablePort->mux->type == DtMux6676)
+                if (DevLogEnabled(availablePort->mux->log, DevLogInfo))
                     {
-                    fprintf(mux6676Log, "\n%010u %s accepted connection on port %02o",
-                            traceSequenceNo, availablePort->mux->name, availablePort->id);
+                    devLogText(availablePort->mux->log, "\n%010u %s accepted connection on port %02o",
+                               traceSequenceNo, availablePort->mux->name, availablePort->id);
                     }
-#endif
-#endif
                 }
             else
                 {
@@ -1132,26 +988,13 @@ static void mux667xClose(PortParam *pp)
         pp->enabled   = FALSE;
         pp->carrierOn = FALSE;
         }
-#if DEBUG_NETIO
-#if DEBUG_6671
-    if (pp->mux->type == DtMux6671)
+    if (DevLogEnabled(pp->mux->log, DevLogInfo))
         {
-        fprintf(mux6671Log, "\n%010u %s connection closed on port %02o",
-                traceSequenceNo, pp->mux->name, pp->id);
+        devLogText(pp->mux->log, "\n%010u %s connection closed on port %02o",
+                   traceSequenceNo, pp->mux->name, pp->id);
         }
-#endif
-#if DEBUG_6676
-    if (pp->mux->type == DtMux6676)
-        {
-        fprintf(mux6676Log, "\n%010u %s connection closed on port %02o",
-                traceSequenceNo, pp->mux->name, pp->id);
-        }
-#endif
-#endif
     }
 
-#if DEBUG_6671 || DEBUG_6676
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Convert function code to string.
 **
@@ -1181,77 +1024,4 @@ static char *mux667xFunc2String(PpWord funcCode)
     return (buf);
     }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete data line
-**
-**  Parameters:     Name        Description.
-**                  log         log file pointer
-**                  mp          pointer to mux parameters
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void mux667xLogFlush(FILE *log, MuxParam *mp)
-    {
-    if (mux667xLogBytesCol > 0)
-        {
-        fprintf(log, "\n%010u %s ", traceSequenceNo, mp->name);
-        fputs(mux667xLogBuf, log);
-        fflush(log);
-        }
-    mux667xLogBytesCol = 0;
-    memset(mux667xLogBuf, ' ', LogLineLength);
-    mux667xLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of ASCII bytes
-**
-**  Parameters:     Name        Description.
-**                  log         log file pointer
-**                  mp          pointer to mux parameters
-**                  bytes       pointer to sequence of bytes
-**                  len         length of the sequence
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void mux667xLogBytes(FILE *log, MuxParam *mp, u8 *bytes, int len)
-    {
-    u8   ac;
-    int  ascCol;
-    u8   b;
-    char hex[3];
-    int  hexCol;
-    int  i;
-
-    mux667xLogBytesCol = 0;
-    mux667xLogFlush(log, mp); // initialize the log buffer
-    ascCol = AsciiColumn(mux667xLogBytesCol);
-    hexCol = HexColumn(mux667xLogBytesCol);
-
-    for (i = 0; i < len; i++)
-        {
-        b  = bytes[i];
-        ac = b;
-        if ((ac < 0x20) || (ac >= 0x7f))
-            {
-            ac = '.';
-            }
-        sprintf(hex, "%02x", b);
-        memcpy(mux667xLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        mux667xLogBuf[ascCol++] = ac;
-        if (++mux667xLogBytesCol >= 16)
-            {
-            mux667xLogFlush(log, mp);
-            ascCol = AsciiColumn(mux667xLogBytesCol);
-            hexCol = HexColumn(mux667xLogBytesCol);
-            }
-        }
-    mux667xLogFlush(log, mp);
-    }
-
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -10,8 +10,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG_PP       0
-#define DEBUG_NET      0
 #define REAL_TIMING    1
 
 /*
@@ -33,6 +31,7 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #endif
 #include "const.h"
 #include "types.h"
@@ -48,7 +47,22 @@
 
 #define IoTurnsPerPoll      4
 #define InBufSize           32
-#define OutBufSize          256
+#define OutBufSize          1024
+
+/*
+**  Readiness events.
+*/
+#if defined(_WIN32)
+#define NiuPollIn           0x0001
+#define NiuPollOut          0x0004
+#define NiuPollErr          0x0008
+#define NiuPollHup          0x0010
+#else
+#define NiuPollIn           POLLIN
+#define NiuPollOut          POLLOUT
+#define NiuPollErr          POLLERR
+#define NiuPollHup          POLLHUP
+#endif
 
 /*
 **  Function codes.
@@ -61,11 +75,6 @@
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG_PP || DEBUG_NET
-#define HexColumn(x)      (3 * (x) + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
 
 /*
 **  -----------------------------------------
@@ -79,6 +88,8 @@ typedef struct portParam
     u16  currInput;
     u8   ibytes;             // how many bytes have been assembled into currInput (0..2)
     bool active;
+    bool outQueued;          // station is in the output queue
+    int  slot;               // index of station in pollFds, 0 if inactive
     int  inInIdx;
     int  inOutIdx;
     u8   inBuffer[InBufSize];
@@ -87,6 +98,17 @@ typedef struct portParam
     u8   outBuffer[OutBufSize];
     } PortParam;
 
+#if defined(_WIN32)
+typedef struct niuPollFd
+    {
+    int   fd;
+    short events;
+    short revents;
+    } NiuPollFd;
+#else
+typedef struct pollfd NiuPollFd;
+#endif
+
 typedef struct localRing
     {
     u8  buf[NiuLocalBufSize];
@@ -103,22 +125,19 @@ static void niuClose(PortParam *pp);
 static FcStatus niuInFunc(PpWord funcCode);
 static void niuInIo(void);
 static void niuInit(void);
-static void niuLogBytes(u8 *bytes, int len);
-static void niuLogFlush(void);
 static FcStatus niuOutFunc(PpWord funcCode);
 static void niuOutIo(void);
 static void niuActivate(void);
 static void niuDisconnect(void);
 static void niuCheckIo(void);
+static void niuFlushOutput(void);
+static void niuFlushPort(PortParam *pp);
+static int niuPoll(int count);
 static void niuWelcome(int stat);
 static void niuSend(int stat, int word);
 static void niuSendstr(int stat, const char *p);
-
-#if DEBUG_PP || DEBUG_NET
 static char *niuFunc2String(PpWord funcCode);
 
-#endif
-
 /*
 **  ----------------
 **  Public Variables
@@ -142,6 +161,11 @@ static int              listenFd = 0;
 static LocalRing        localInput[NiuLocalStations];
 static int              obytes;
 static niuProcessOutput *outputHandler[NiuLocalStations];
+static PortParam        **outQueue;      // stations with output pending
+static int              outQueueCount = 0;
+static int              pollCount     = 0;
+static NiuPollFd        *pollFds;       // listener followed by active stations
+static PortParam        **pollPorts;    // station of each pollFds entry
 static PortParam        *portVector;
 
 #if REAL_TIMING
@@ -149,11 +173,7 @@ static bool frameStart;
 static u32  lastFrame;
 #endif
 
-#if DEBUG_PP || DEBUG_NET
-static FILE *niuLog = NULL;
-static char niuLogBuf[LogLineLength + 1];
-static int  niuLogBytesCol = 0;
-#endif
+static DevLogModule *niuLog;
 
 /*
  **--------------------------------------------------------------------------
@@ -389,13 +409,7 @@ static void niuInit(void)
     u8        i;
     PortParam *pp;
 
-#if DEBUG_PP || DEBUG_NET
-    if (niuLog == NULL)
-        {
-        niuLog = fopen("niuLog.txt", "wt");
-        fputs("\nniuLog opened.\n", niuLog);
-        }
-#endif
+    niuLog = devLogRegister("niu");
 
     pp = portVector = calloc(platoConns, sizeof(PortParam));
     if (portVector == NULL)
@@ -406,15 +420,26 @@ static void niuInit(void)
 
     in->context[0] = portVector;
 
+    pollFds   = calloc(platoConns + 1, sizeof(NiuPollFd));
+    pollPorts = calloc(platoConns + 1, sizeof(PortParam *));
+    outQueue  = calloc(platoConns, sizeof(PortParam *));
+    if ((pollFds == NULL) || (pollPorts == NULL) || (outQueue == NULL))
+        {
+        fputs("Failed to allocate NIU poll tables\n", stderr);
+        exit(1);
+        }
+
     /*
     **  Initialise port control blocks.
     */
     for (i = 0; i < platoConns; i++)
         {
         pp->id     = i;
-        pp->active = FALSE;
-        pp->connFd = 0;
-        pp->ibytes = 0;
+        pp->active    = FALSE;
+        pp->connFd    = 0;
+        pp->ibytes    = 0;
+        pp->outQueued = FALSE;
+        pp->slot      = 0;
         pp++;
         }
 
@@ -443,6 +468,16 @@ static void niuInit(void)
 
     fprintf(stdout, "(niu    ) Listening on port %d (%d connections permitted).\n", platoPort, platoConns);
 
+    /*
+    **  The listening socket is always the first entry in the poll table,
+    **  active stations follow without gaps.
+    */
+    pollFds[0].fd     = listenFd;
+    pollFds[0].events = NiuPollIn;
+    pollPorts[0]      = NULL;
+    pollCount         = 1;
+    outQueueCount     = 0;
+
 #if REAL_TIMING
     frameStart = FALSE;
 #endif
@@ -459,14 +494,16 @@ static void niuInit(void)
 **------------------------------------------------------------------------*/
 static FcStatus niuInFunc(PpWord funcCode)
     {
-#if DEBUG_PP
-    fprintf(niuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-8s >   ",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id,
-            funcCode,
-            niuFunc2String(funcCode));
-#endif
+    if (DevLogEnabled(niuLog, DevLogDebug))
+        {
+        devLogText(niuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-8s >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id,
+                   funcCode,
+                   niuFunc2String(funcCode));
+        }
+
     niuCheckIo();
     if (funcCode == FcNiuInput)
         {
@@ -492,14 +529,16 @@ static FcStatus niuInFunc(PpWord funcCode)
 **------------------------------------------------------------------------*/
 static FcStatus niuOutFunc(PpWord funcCode)
     {
-#if DEBUG_PP
-    fprintf(niuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-8s >   ",
-            traceSequenceNo,
-            activePpu->id,
-            activeDevice->channel->id,
-            funcCode,
-            niuFunc2String(funcCode));
-#endif
+    if (DevLogEnabled(niuLog, DevLogDebug))
+        {
+        devLogText(niuLog, "\n%06d PP:%02o CH:%02o f:%04o T:%-8s >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeDevice->channel->id,
+                   funcCode,
+                   niuFunc2String(funcCode));
+        }
+
     niuCheckIo();
     if (funcCode == FcNiuOutput)
         {
@@ -575,10 +614,12 @@ static void niuInIo(void)
                     {
                     pp->inOutIdx = pp->inInIdx = 0;
                     }
-#if DEBUG_PP
-                fprintf(niuLog, "\n%010u input byte %d %03o on port %d",
-                        traceSequenceNo, pp->ibytes, in, pp->id);
-#endif
+                if (DevLogEnabled(niuLog, DevLogDebug))
+                    {
+                    devLogText(niuLog, "\n%010u input byte %d %03o on port %d",
+                               traceSequenceNo, pp->ibytes, in, pp->id);
+                    }
+
                 // Connection has data -- assemble it and see if we have
                 // a complete input word
                 if (pp->ibytes != 0)
@@ -586,10 +627,12 @@ static void niuInIo(void)
                     if ((in & 0200) == 0)
                         {
                         // Sequence error, drop the byte
-#if DEBUG_PP || DEBUG_NET
-                        fprintf(niuLog, "\n%010u input sequence error, second byte %03o, port %d",
-                                traceSequenceNo, in, port);
-#endif
+                        if (DevLogEnabled(niuLog, DevLogError))
+                            {
+                            devLogText(niuLog, "\n%010u input sequence error, second byte %03o, port %d",
+                                       traceSequenceNo, in, port);
+                            }
+
                         continue;
                         }
                     pp->currInput      |= (in & 0177);
@@ -605,10 +648,12 @@ static void niuInIo(void)
                     if ((in & 370) != 0)
                         {
                         // sequence error, drop the byte
-#if DEBUG_PP || DEBUG_NET
-                        fprintf(niuLog, "\n%010u input sequence error, first byte %03o, port %d",
-                                traceSequenceNo, in, port);
-#endif
+                        if (DevLogEnabled(niuLog, DevLogError))
+                            {
+                            devLogText(niuLog, "\n%010u input sequence error, first byte %03o, port %d",
+                                       traceSequenceNo, in, port);
+                            }
+
                         continue;
                         }
                     pp->currInput = in << 7;
@@ -686,49 +731,49 @@ static void niuOutIo(void)
             }
         frameStart = FALSE;
 #endif
-#if DEBUG_PP
-        fprintf(niuLog, "\n%010u output byte %d %04o", traceSequenceNo, obytes, d);
-#endif
-#if DEBUG_PP || DEBUG_NET
-        if ((d & 06000) != 04000)
+        if (DevLogEnabled(niuLog, DevLogDebug))
             {
-            fprintf(niuLog, "\n%010u output out of sync, first word %04o",
-                    traceSequenceNo, d);
+            devLogText(niuLog, "\n%010u output byte %d %04o", traceSequenceNo, obytes, d);
             }
-#endif
+
+        if (((d & 06000) != 04000) && DevLogEnabled(niuLog, DevLogError))
+            {
+            devLogText(niuLog, "\n%010u output out of sync, first word %04o",
+                       traceSequenceNo, d);
+            }
+
         currOutput = (d & 01777) << 9;
         obytes     = 1;
 
         return;
         }
 
-#if DEBUG_PP
-    fprintf(niuLog, "\n%010u output byte %d %04o", traceSequenceNo, obytes, d);
-#endif
+    if (DevLogEnabled(niuLog, DevLogDebug))
+        {
+        devLogText(niuLog, "\n%010u output byte %d %04o", traceSequenceNo, obytes, d);
+        }
 
     if (obytes == 1)
         {
         // second word of the triple
-#if DEBUG_PP || DEBUG_NET
-        if ((d & 06001) != 0)
+        if (((d & 06001) != 0) && DevLogEnabled(niuLog, DevLogError))
             {
-            fprintf(niuLog, "\n%010u output out of sync, second word %04o",
-                    traceSequenceNo, d);
+            devLogText(niuLog, "\n%010u output out of sync, second word %04o",
+                       traceSequenceNo, d);
             }
-#endif
+
         currOutput |= d >> 1;
         obytes      = 2;
 
         return;
         }
     // Third word of the triple
-#if DEBUG_PP || DEBUG_NET
-    if ((d & 04000) != 0)
+    if (((d & 04000) != 0) && DevLogEnabled(niuLog, DevLogError))
         {
-        fprintf(niuLog, "\n%010u output out of sync, third word %04o",
-                traceSequenceNo, d);
+        devLogText(niuLog, "\n%010u output out of sync, third word %04o",
+                   traceSequenceNo, d);
         }
-#endif
+
 #if REAL_TIMING
     /*
     **  If end of frame bit is set, remember that so the next
@@ -743,6 +788,15 @@ static void niuOutIo(void)
     port = (d & 01777);
     niuSend(port, currOutput);
     obytes = 0;
+
+    /*
+    **  At the end of a frame send everything the stations have been given
+    **  during the frame, one send per station.
+    */
+    if ((d & 02000) != 0)
+        {
+        niuFlushOutput();
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -783,22 +837,19 @@ static void niuCheckIo(void)
     PortParam *availablePort;
 
 #if defined(_WIN32)
-    u_long         blockEnable = 1;
+    u_long             blockEnable = 1;
 #endif
     struct sockaddr_in from;
 #if defined(_WIN32)
-    int            fromLen;
+    int                fromLen;
 #else
-    socklen_t      fromLen;
+    socklen_t          fromLen;
 #endif
-    int            i;
-    int            maxFd;
-    int            n;
-    int            optEnable = 1;
-    PortParam      *pp;
-    fd_set         readFds;
-    struct timeval timeout;
-    fd_set         writeFds;
+    int                i;
+    int                n;
+    int                optEnable = 1;
+    PortParam          *pp;
+    short              revents;
 
     ioTurns = (ioTurns + 1) % IoTurnsPerPoll;
     if (ioTurns != 0)
@@ -806,99 +857,82 @@ static void niuCheckIo(void)
         return;
         }
 
-    FD_ZERO(&readFds);
-    FD_ZERO(&writeFds);
-    maxFd         = 0;
-    availablePort = NULL;
-
-    for (i = 0, pp = portVector; i < platoConns; i++, pp++)
-        {
-        if (pp->active)
-            {
-            if (pp->inInIdx < InBufSize)
-                {
-                FD_SET(pp->connFd, &readFds);
-                if (pp->connFd > maxFd)
-                    {
-                    maxFd = pp->connFd;
-                    }
-                }
-            if (pp->outInIdx > pp->outOutIdx)
-                {
-                FD_SET(pp->connFd, &writeFds);
-                if (pp->connFd > maxFd)
-                    {
-                    maxFd = pp->connFd;
-                    }
-                }
-            }
-        else if (availablePort == NULL)
-            {
-            availablePort = pp;
-            FD_SET(listenFd, &readFds);
-            if (listenFd > maxFd)
-                {
-                maxFd = listenFd;
-                }
-            }
-        }
+    /*
+    **  Send output queued outside of a frame.
+    */
+    niuFlushOutput();
 
-    if (maxFd < 1)
+    /*
+    **  Only active stations are in the poll table. Ask for input while there
+    **  is room in the input buffer and for output readiness while a previous
+    **  send was incomplete. Accept new connections while a station is free.
+    */
+    pollFds[0].events = (pollCount <= platoConns) ? NiuPollIn : 0;
+    for (i = 1; i < pollCount; i++)
         {
-        return;
+        pp = pollPorts[i];
+        pollFds[i].events = ((pp->inInIdx < InBufSize) ? NiuPollIn : 0)
+                            | ((pp->outOutIdx < pp->outInIdx) ? NiuPollOut : 0);
+        pollFds[i].revents = 0;
         }
+    pollFds[0].revents = 0;
 
-    timeout.tv_sec  = 0;
-    timeout.tv_usec = 0;
-    n = select(maxFd + 1, &readFds, &writeFds, NULL, &timeout);
+    n = niuPoll(pollCount);
     if (n < 1)
         {
         return;
         }
 
-    for (i = 0, pp = portVector; i < platoConns; i++, pp++)
+    /*
+    **  Walk the table backwards, so that closing a station (which moves the
+    **  last entry into its slot) does not skip an entry.
+    */
+    for (i = pollCount - 1; i > 0; i--)
         {
-        if (pp->active)
+        pp      = pollPorts[i];
+        revents = pollFds[i].revents;
+        if ((revents & (NiuPollIn | NiuPollErr | NiuPollHup)) && (pp->inInIdx < InBufSize))
             {
-            if (FD_ISSET(pp->connFd, &readFds))
+            n = recv(pp->connFd, &pp->inBuffer[pp->inInIdx], InBufSize - pp->inInIdx, 0);
+            if (n > 0)
                 {
-                n = recv(pp->connFd, &pp->inBuffer[pp->inInIdx], InBufSize - pp->inInIdx, 0);
-                if (n > 0)
+                if (DevLogEnabled(niuLog, DevLogInfo))
                     {
-#if DEBUG_NET
-                    fprintf(niuLog, "\n%010u received %d bytes on port %02o",
-                            traceSequenceNo, n, pp->id);
-                    niuLogBytes(&pp->inBuffer[pp->inInIdx], n);
-#endif
-                    pp->inInIdx += n;
-                    }
-                else
-                    {
-                    niuClose(pp);
+                    devLogText(niuLog, "\n%010u received %d bytes on port %02o",
+                               traceSequenceNo, n, pp->id);
+                    devLogBytes(niuLog, &pp->inBuffer[pp->inInIdx], n);
                     }
+
+                pp->inInIdx += n;
                 }
-            if (FD_ISSET(pp->connFd, &writeFds) && (pp->outOutIdx < pp->outInIdx))
+            else
                 {
-                n = send(pp->connFd, &pp->outBuffer[pp->outOutIdx], pp->outInIdx - pp->outOutIdx, 0);
-                if (n >= 0)
-                    {
-#if DEBUG_NET
-                    fprintf(niuLog, "\n%010u sent %d bytes to port %02o",
-                            traceSequenceNo, n, pp->id);
-                    niuLogBytes(&pp->outBuffer[pp->outOutIdx], n);
-#endif
-                    pp->outOutIdx += n;
-                    if (pp->outOutIdx >= pp->outInIdx)
-                        {
-                        pp->outInIdx  = 0;
-                        pp->outOutIdx = 0;
-                        }
-                    }
+                niuClose(pp);
+                continue;
                 }
             }
+        if (revents & NiuPollOut)
+            {
+            niuFlushPort(pp);
+            }
         }
-    if ((availablePort != NULL) && FD_ISSET(listenFd, &readFds))
+
+    if (pollFds[0].revents & NiuPollIn)
         {
+        availablePort = NULL;
+        for (i = 0, pp = portVector; i < platoConns; i++, pp++)
+            {
+            if (!pp->active)
+                {
+                availablePort = pp;
+                break;
+                }
+            }
+        if (availablePort == NULL)
+            {
+            return;
+            }
+
         fromLen = sizeof(from);
         availablePort->connFd = (int)accept(listenFd, (struct sockaddr *)&from, &fromLen);
         if (availablePort->connFd > 0)
@@ -909,6 +943,15 @@ static void niuCheckIo(void)
             availablePort->outInIdx  = 0;
             availablePort->outOutIdx = 0;
 
+            /*
+            **  Add the station to the poll table.
+            */
+            availablePort->slot        = pollCount;
+            pollFds[pollCount].fd      = availablePort->connFd;
+            pollFds[pollCount].events  = 0;
+            pollFds[pollCount].revents = 0;
+            pollPorts[pollCount++]     = availablePort;
+
             /*
             **  Set Keepalive option so that we can eventually discover if
             **  a client has been rebooted.
@@ -923,15 +966,162 @@ static void niuCheckIo(void)
 #else
             fcntl(availablePort->connFd, F_SETFL, O_NONBLOCK);
 #endif
-#if DEBUG_NET
-            fprintf(niuLog, "\n%010u accepted connection on port %02o",
-                    traceSequenceNo, availablePort->id);
-#endif
+            if (DevLogEnabled(niuLog, DevLogInfo))
+                {
+                devLogText(niuLog, "\n%010u accepted connection on port %02o",
+                           traceSequenceNo, availablePort->id);
+                }
+
             niuWelcome(availablePort->id + NiuLocalStations);
             }
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Wait (without blocking) for readiness of the sockets in
+**                  the poll table.
+**
+**  Parameters:     Name        Description.
+**                  count       number of poll table entries
+**
+**  Returns:        Number of ready sockets, 0 if none, -1 on error.
+**
+**------------------------------------------------------------------------*/
+static int niuPoll(int count)
+    {
+#if defined(_WIN32)
+    int            i;
+    int            maxFd;
+    int            n;
+    fd_set         readFds;
+    struct timeval timeout;
+    fd_set         writeFds;
+
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+    maxFd = 0;
+    for (i = 0; i < count; i++)
+        {
+        if (pollFds[i].events & NiuPollIn)
+            {
+            FD_SET(pollFds[i].fd, &readFds);
+            }
+        if (pollFds[i].events & NiuPollOut)
+            {
+            FD_SET(pollFds[i].fd, &writeFds);
+            }
+        if (pollFds[i].fd > maxFd)
+            {
+            maxFd = pollFds[i].fd;
+            }
+        }
+
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = 0;
+    n = select(maxFd + 1, &readFds, &writeFds, NULL, &timeout);
+    if (n < 1)
+        {
+        return (n);
+        }
+
+    for (i = 0; i < count; i++)
+        {
+        pollFds[i].revents = (FD_ISSET(pollFds[i].fd, &readFds) ? NiuPollIn : 0)
+                             | (FD_ISSET(pollFds[i].fd, &writeFds) ? NiuPollOut : 0);
+        }
+
+    return (n);
+#else
+    return (poll(pollFds, count, 0));
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Send the pending output of all stations which received
+**                  output words since the last flush.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void niuFlushOutput(void)
+    {
+    int       i;
+    int       j;
+    PortParam *pp;
+
+    for (i = 0, j = 0; i < outQueueCount; i++)
+        {
+        pp = outQueue[i];
+        if (pp->active)
+            {
+            niuFlushPort(pp);
+            }
+
+        /*
+        **  Stations whose socket did not take everything stay queued and
+        **  are completed when the socket becomes writable.
+        */
+        if (pp->active && (pp->outOutIdx < pp->outInIdx))
+            {
+            outQueue[j++] = pp;
+            }
+        else
+            {
+            pp->outQueued = FALSE;
+            }
+        }
+    outQueueCount = j;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Send as much of a station's pending output as the
+**                  socket will take.
+**
+**  Parameters:     Name        Description.
+**                  pp          pointer to mux port parameters.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void niuFlushPort(PortParam *pp)
+    {
+    int n;
+
+    if (pp->outOutIdx >= pp->outInIdx)
+        {
+        return;
+        }
+
+    n = send(pp->connFd, &pp->outBuffer[pp->outOutIdx], pp->outInIdx - pp->outOutIdx, 0);
+    if (n >= 0)
+        {
+        if (DevLogEnabled(niuLog, DevLogInfo))
+            {
+            devLogText(niuLog, "\n%010u sent %d bytes to port %02o",
+                       traceSequenceNo, n, pp->id);
+            devLogBytes(niuLog, &pp->outBuffer[pp->outOutIdx], n);
+            }
+
+        pp->outOutIdx += n;
+        if (pp->outOutIdx >= pp->outInIdx)
+            {
+            pp->outInIdx  = 0;
+            pp->outOutIdx = 0;
+            }
+        else if (pp->outOutIdx > 0)
+            {
+            /*
+            **  Move the unsent remainder to the front to make room for more.
+            */
+            memmove(pp->outBuffer, &pp->outBuffer[pp->outOutIdx], pp->outInIdx - pp->outOutIdx);
+            pp->outInIdx -= pp->outOutIdx;
+            pp->outOutIdx = 0;
+            }
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Close a port and mark it inactive.
 **
@@ -943,13 +1133,31 @@ static void niuCheckIo(void)
 **------------------------------------------------------------------------*/
 static void niuClose(PortParam *pp)
     {
+    int last;
+
     netCloseConnection(pp->connFd);
-    pp->active = FALSE;
-    pp->connFd = 0;
-#if DEBUG_NET
-    fprintf(niuLog, "\n%010u connection closed on port %02o",
-            traceSequenceNo, pp->id);
-#endif
+    pp->active    = FALSE;
+    pp->connFd    = 0;
+    pp->outInIdx  = 0;
+    pp->outOutIdx = 0;
+
+    /*
+    **  Remove the station from the poll table by moving the last entry
+    **  into its slot.
+    */
+    last = --pollCount;
+    if (pp->slot != last)
+        {
+        pollFds[pp->slot]         = pollFds[last];
+        pollPorts[pp->slot]       = pollPorts[last];
+        pollPorts[pp->slot]->slot = pp->slot;
+        }
+    pp->slot = 0;
+    if (DevLogEnabled(niuLog, DevLogInfo))
+        {
+        devLogText(niuLog, "\n%010u connection closed on port %02o",
+                   traceSequenceNo, pp->id);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -1080,26 +1288,34 @@ static void niuSend(int stat, int word)
             pp = portVector + stat;
             if (pp->active)
                 {
+                if (pp->outInIdx + 2 >= OutBufSize)
+                    {
+                    /*
+                    **  Buffer full - try to make room before giving up.
+                    */
+                    niuFlushPort(pp);
+                    }
                 if (pp->outInIdx + 2 < OutBufSize)
                     {
                     pp->outBuffer[pp->outInIdx++] = word >> 12;
                     pp->outBuffer[pp->outInIdx++] = ((word >> 6) & 077) | 0200;
                     pp->outBuffer[pp->outInIdx++] = (word & 077) | 0300;
+                    if (!pp->outQueued)
+                        {
+                        pp->outQueued             = TRUE;
+                        outQueue[outQueueCount++] = pp;
+                        }
                     }
-#if DEBUG_PP || DEBUG_NET
-                else
+                else if (DevLogEnabled(niuLog, DevLogError))
                     {
-                    fprintf(niuLog, "\n%010u output buffer overflow, port %d",
-                            traceSequenceNo, pp->id);
+                    devLogText(niuLog, "\n%010u output buffer overflow, port %d",
+                               traceSequenceNo, pp->id);
                     }
-#endif
                 }
             }
         }
     }
 
-#if DEBUG_PP || DEBUG_NET
-
 /*--------------------------------------------------------------------------
 **  Purpose:        Convert function code to string.
 **
@@ -1128,73 +1344,4 @@ static char *niuFunc2String(PpWord funcCode)
         }
     }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void niuLogFlush(void)
-    {
-    if (niuLogBytesCol > 0)
-        {
-        fprintf(niuLog, "\n%010u ", traceSequenceNo);
-        fputs(niuLogBuf, niuLog);
-        fflush(niuLog);
-        }
-    niuLogBytesCol = 0;
-    memset(niuLogBuf, ' ', LogLineLength);
-    niuLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of ASCII bytes
-**
-**  Parameters:     Name        Description.
-**                  bytes       pointer to sequence of bytes
-**                  len         length of the sequence
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void niuLogBytes(u8 *bytes, int len)
-    {
-    u8   ac;
-    int  ascCol;
-    u8   b;
-    char hex[3];
-    int  hexCol;
-    int  i;
-
-    niuLogBytesCol = 0;
-    niuLogFlush(); // initialize the log buffer
-    ascCol = AsciiColumn(niuLogBytesCol);
-    hexCol = HexColumn(niuLogBytesCol);
-
-    for (i = 0; i < len; i++)
-        {
-        b  = bytes[i];
-        ac = b;
-        if ((ac < 0x20) || (ac >= 0x7f))
-            {
-            ac = '.';
-            }
-        sprintf(hex, "%02x", b);
-        memcpy(niuLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        niuLogBuf[ascCol++] = ac;
-        if (++niuLogBytesCol >= 16)
-            {
-            niuLogFlush();
-            ascCol = AsciiColumn(niuLogBytesCol);
-            hexCol = HexColumn(niuLogBytesCol);
-            }
-        }
-    niuLogFlush();
-    }
-
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -314,7 +314,7 @@
 #define HostIdSize                 9
 #define MaxBuffer                  2048
 #define MaxHaspStreams             7
-#define MaxTcbs                    256
+#define MaxTcbs                    256   // connection numbers are one byte in CCP block headers
 #define MaxTermDefs                255
 #define MinNjeBlockSize            1024
 
@@ -546,6 +546,7 @@ typedef struct hcb
     u8             sRCBParam;
     u8             strLength;
     int            blockSize;
+    bool           isCompressing;
     NpuBuffer      *lastBlockSent;
     NpuBuffer      *outBuf;
     u8             pollIndex;
@@ -588,6 +589,7 @@ typedef struct njecb
     int          retries;          // count of upline block retransmission attempts
     time_t       lastXmit;         // timestamp of last data transmission to peer
     int          pingInterval;     // interval in seconds between pings during idle periods
+    bool         isCompressing;    // TRUE if downline records are sent with SCB compression
     u8           *inputBuf;        // NJE/TCP block input buffer
     int          inputBufSize;     // input buffer size
     u8           *inputBufPtr;     // pointer to next storage location
@@ -646,6 +648,11 @@ typedef struct pcb
     bool         cciIsDisabled;           // line for port is disabled by operator
     bool         cciWaitForTcb;           // wait until terminal is configured
     time_t       cciTcbWaitStart;         // start time to determine timeout for tcb getting ready
+    u32          uplineTokens;            // upline bytes which may be received before next refill
+    u64          uplineRefill;            // time of last upline token refill in milliseconds
+    u64          bytesIn;                 // bytes received from network
+    u64          bytesOut;                // bytes sent to network
+    u32          deferrals;               // receives deferred by network scheduler
     PortControls controls;                // TIP-dependent controls
 #if defined(_WIN32)
     SOCKET       connFd;                  // connected socket descriptor
@@ -849,6 +856,7 @@ void npuSvmSendTermBlock(Tcb *tp);
 /*
 **  npu_tip.c
 */
+void npuTipAllocTcbs(void);
 void npuTipDiscardOutputQ(Tcb *tp);
 Tcb *npuTipFindFreeTcb(void);
 Tcb *npuTipFindTcbForCN(u8 cn);
@@ -873,6 +881,7 @@ void npuNetConnected(Tcb *tp);
 void npuNetDisconnected(Tcb *tp);
 int npuNetRegisterConnType(int tcpPort, int claPort, int numPorts, int connType, Ncb **ncbpp);
 void npuNetSend(Tcb *tp, u8 *data, int len);
+int npuNetSendQueue(Tcb *tp, void (*notifySent)(Tcb *tp, u8 blockSeqNo), void (*logSent)(Tcb *tp, u8 *data, int len));
 void npuNetSetMaxCN(u8 cn);
 void npuNetQueueAck(Tcb *tp, u8 blockSeqNo);
 void npuNetQueueOutput(Tcb *tp, u8 *data, int len);
@@ -900,6 +909,7 @@ void npuAsyncTryOutput(Pcb *pcbp);
 **  npu_hasp.c
 */
 void npuHaspCloseStream(Tcb *tp);
+int npuHaspEncodeStrings(u8 *dst, u8 *src, int len, bool compress);
 bool npuHaspParseDevParams(u8 *mp, int len, Tcb *tp);
 bool npuHaspParseFileParams(u8 *mp, int len, Tcb *tp);
 void npuHaspNotifyAck(Tcb *tcbp, u8 bsn);
@@ -952,7 +962,10 @@ extern u16 cdcnetPrivilegedUdpPortOffset;
 extern u8  npuLipTrunkCount;
 extern u8  npuNetMaxClaPort;
 extern u8  npuNetMaxCN;
-extern Tcb npuTcbs[];
+extern u32 npuNetBulkRate;
+extern u32 npuNetInteractiveRate;
+extern Tcb *npuTcbs;
+extern int npuTcbCount;
 
 #endif /* NPU_H */
 /*---------------------------  End Of File  ------------------------------*/
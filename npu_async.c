@@ -24,8 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -41,10 +39,6 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #endif
-#if defined(__APPLE__)
-#include <execinfo.h>
-#endif
-
 #include "const.h"
 #include "types.h"
 #include "proto.h"
@@ -92,11 +86,7 @@
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG
-#define HexColumn(x)    (3 * (x) + 4)
-#define AsciiColumn(x)  (HexColumn(16) + 2 + (x))
-#define LogLineLength   (AsciiColumn(16))
-#endif
+#define HasZeroByte(w)  (((w) - 0x0101010101010101ULL) & ~(w) & 0x8080808080808080ULL)
 
 /*
 **  -----------------------------------------
@@ -112,26 +102,20 @@
 static void npuAsyncDoFeBefore(u8 fe);
 static void npuAsyncDoFeAfter(u8 fe);
 static Tcb *npuAsyncFindTcb(Pcb *pcbp);
+static void npuAsyncLogSent(Tcb *tp, u8 *data, int len);
 static void npuAsyncProcessUplineTransparent(Tcb *tp);
 static void npuAsyncProcessUplineAscii(Tcb *tp);
 static void npuAsyncProcessUplineSpecial(Tcb *tp);
 static void npuAsyncProcessUplineNormal(Tcb *tp);
-
-#if DEBUG
-static void npuAsyncLogBytes(u8 *bytes, int len);
-static void npuAsyncLogFlush(void);
-static void npuAsyncPrintStackTrace(FILE *fp);
-
-#endif
+static int npuAsyncScanPlain(u8 *sp, int len, int c1, int c2);
+static void npuAsyncSendTransparent(Tcb *tp, int n);
 
 /*
 **  ----------------
 **  Public Variables
 **  ----------------
 */
-#if DEBUG
-FILE *npuAsyncLog = NULL;
-#endif
+DevLogModule *npuAsyncLog;
 
 /*
 **  -----------------
@@ -170,11 +154,6 @@ static u8 blockResetConnection[] =
     BtHTRESET,          // BT/BSN/PRIO
     };
 
-#if DEBUG
-static char npuAsyncLogBuf[LogLineLength + 1];
-static int  npuAsyncLogBytesCol = 0;
-#endif
-
 /*
 ** Function tables to interface to either CCP or CCI functions
 */
@@ -225,18 +204,10 @@ void npuAsyncPresetPcb(Pcb *pcbp)
     pcbp->controls.async.pendingWills = 0;
     pcbp->controls.async.tp           = NULL;
 
-#if DEBUG
     if (npuAsyncLog == NULL)
         {
-        npuAsyncLog = fopen("asynclog.txt", "wt");
-        if (npuAsyncLog == NULL)
-            {
-            logDtError(LogErrorLocation, "asynclog.txt - aborting\n");
-            exit(1);
-            }
-        npuAsyncLogFlush();    // initialize log buffer
+        npuAsyncLog = devLogRegister("npuasync");
         }
-#endif
     }
 
 /*--------------------------------------------------------------------------
@@ -255,9 +226,10 @@ void npuAsyncProcessBreakIndication(Tcb *tp)
     blockResetConnection[BlkOffSN] = npuSvmNpuNode;
     blockResetConnection[BlkOffCN] = tp->cn;
     npuBipRequestUplineCanned(blockResetConnection, sizeof(blockResetConnection));
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: break indication for %.7s\n", tp->pcbp->claPort, tp->termName);
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: break indication for %.7s\n", tp->pcbp->claPort, tp->termName);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -273,6 +245,7 @@ void npuAsyncProcessTelnetData(Pcb *pcbp)
     {
     u8  *dp;
     u8  *lp;
+    int n;
     u8  opt;
     u8  *sp;
     u8  tnOutBuf[MaxBuffer];
@@ -287,39 +260,50 @@ void npuAsyncProcessTelnetData(Pcb *pcbp)
     tnOutLimit = tnOutPtr + sizeof(tnOutBuf);
     lp         = sp + pcbp->inputCount;
 
-#if DEBUG
-    if (tp != NULL)
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
         {
-        fprintf(npuAsyncLog, "Port %02x: Telnet data received from %.7s, size %d\n", pcbp->claPort,
-                tp->termName, pcbp->inputCount);
-        }
-    else
-        {
-        fprintf(npuAsyncLog, "Port %02x: Telnet data received, size %d\n", pcbp->claPort,
-                pcbp->inputCount);
+        if (tp != NULL)
+            {
+            devLogText(npuAsyncLog, "Port %02x: Telnet data received from %.7s, size %d\n", pcbp->claPort,
+                       tp->termName, pcbp->inputCount);
+            }
+        else
+            {
+            devLogText(npuAsyncLog, "Port %02x: Telnet data received, size %d\n", pcbp->claPort,
+                       pcbp->inputCount);
+            }
+        devLogBytes(npuAsyncLog, pcbp->inputData, pcbp->inputCount);
         }
-    npuAsyncLogBytes(pcbp->inputData, pcbp->inputCount);
-    npuAsyncLogFlush();
-#endif
 
     while (sp < lp)
         {
         switch (pcbp->controls.async.state)
             {
         case StTelnetData:
+            /*
+            **  Move the run of plain data up to the next IAC or CR in bulk.
+            */
+            n = npuAsyncScanPlain(sp, (int)(lp - sp), TELNET_IAC, ChrCR);
+            if (n > 0)
+                {
+                if (dp != sp)
+                    {
+                    memmove(dp, sp, n);
+                    }
+                dp += n;
+                sp += n;
+                break;
+                }
+
             if (*sp == TELNET_IAC)
                 {
                 sp++;
                 pcbp->controls.async.state = StTelnetProtoElem;
                 }
-            else if (*sp == 0x0D)
-                {
-                *dp++ = *sp++;
-                pcbp->controls.async.state = StTelnetCR;
-                }
             else
                 {
                 *dp++ = *sp++;
+                pcbp->controls.async.state = StTelnetCR;
                 }
             break;
 
@@ -497,20 +481,20 @@ void npuAsyncProcessTelnetData(Pcb *pcbp)
     if (tnOutPtr > tnOutBuf)
         {
         send(pcbp->connFd, tnOutBuf, (int)(tnOutPtr - tnOutBuf), 0);
-#if DEBUG
-        if (tp != NULL)
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
             {
-            fprintf(npuAsyncLog, "Port %02x: Telnet options sent to %.7s, size %ld\n", pcbp->claPort,
-                    tp->termName, tnOutPtr - tnOutBuf);
-            }
-        else
-            {
-            fprintf(npuAsyncLog, "Port %02x: Telnet options sent, size %ld\n", pcbp->claPort,
-                    tnOutPtr - tnOutBuf);
+            if (tp != NULL)
+                {
+                devLogText(npuAsyncLog, "Port %02x: Telnet options sent to %.7s, size %ld\n", pcbp->claPort,
+                           tp->termName, tnOutPtr - tnOutBuf);
+                }
+            else
+                {
+                devLogText(npuAsyncLog, "Port %02x: Telnet options sent, size %ld\n", pcbp->claPort,
+                           tnOutPtr - tnOutBuf);
+                }
+            devLogBytes(npuAsyncLog, tnOutBuf, (int)(tnOutPtr - tnOutBuf));
             }
-        npuAsyncLogBytes(tnOutBuf, tnOutPtr - tnOutBuf);
-        npuAsyncLogFlush();
-#endif
         }
 
     pcbp->inputCount = (int)(dp - pcbp->inputData);
@@ -550,12 +534,12 @@ void npuAsyncPtermNetSend(Tcb *tp, u8 *data, int len)
             count = (int)(p - data);
             npuNetQueueOutput(tp, data, count);
             npuNetQueueOutput(tp, (u8 *)"\xFF", 1);
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
-            npuAsyncLogBytes(data, count);
-            npuAsyncLogBytes((u8 *)"\xFF", 1);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
+                devLogBytes(npuAsyncLog, data, count);
+                devLogBytes(npuAsyncLog, (u8 *)"\xFF", 1);
+                }
             data = p;
             break;
 
@@ -566,12 +550,12 @@ void npuAsyncPtermNetSend(Tcb *tp, u8 *data, int len)
             count = (int)(p - data);
             npuNetQueueOutput(tp, data, count);
             npuNetQueueOutput(tp, (u8 *)"\x00", 1);
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
-            npuAsyncLogBytes(data, count);
-            npuAsyncLogBytes((u8 *)"\x00", 1);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
+                devLogBytes(npuAsyncLog, data, count);
+                devLogBytes(npuAsyncLog, (u8 *)"\x00", 1);
+                }
             data = p;
             break;
             }
@@ -580,11 +564,11 @@ void npuAsyncPtermNetSend(Tcb *tp, u8 *data, int len)
     if ((count = (int)(p - data)) > 0)
         {
         npuNetQueueOutput(tp, data, count);
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count);
-        npuAsyncLogBytes(data, count);
-        npuAsyncLogFlush();
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: send Pterm data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count);
+            devLogBytes(npuAsyncLog, data, count);
+            }
         }
     }
 
@@ -612,9 +596,10 @@ void npuAsyncResetPcb(Pcb *pcbp)
         pcbp->controls.async.tp = NULL;
         }
 
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: reset PCB\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: reset PCB\n", pcbp->claPort);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -647,12 +632,12 @@ void npuAsyncTelnetNetSend(Tcb *tp, u8 *data, int len)
             count = (int)(p - data);
             npuNetQueueOutput(tp, data, count);
             npuNetQueueOutput(tp, iac, 1);
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send Telnet data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
-            npuAsyncLogBytes(data, count);
-            npuAsyncLogBytes(iac, 1);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send Telnet data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count + 1);
+                devLogBytes(npuAsyncLog, data, count);
+                devLogBytes(npuAsyncLog, iac, 1);
+                }
             data = p;
             }
         }
@@ -660,11 +645,11 @@ void npuAsyncTelnetNetSend(Tcb *tp, u8 *data, int len)
     if ((count = (int)(p - data)) > 0)
         {
         npuNetQueueOutput(tp, data, count);
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: send Telnet data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count);
-        npuAsyncLogBytes(data, count);
-        npuAsyncLogFlush();
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: send Telnet data to %.7s, size %d\n", tp->pcbp->claPort, tp->termName, count);
+            devLogBytes(npuAsyncLog, data, count);
+            }
         }
     }
 
@@ -679,10 +664,8 @@ void npuAsyncTelnetNetSend(Tcb *tp, u8 *data, int len)
 **------------------------------------------------------------------------*/
 void npuAsyncTryOutput(Pcb *pcbp)
     {
-    NpuBuffer *bp;
-    u8        *data;
-    int       result;
-    Tcb       *tp;
+    int result;
+    Tcb *tp;
 
     tp = npuAsyncFindTcb(pcbp);
     if (tp == NULL)
@@ -695,9 +678,10 @@ void npuAsyncTryOutput(Pcb *pcbp)
     */
     if (tp->xInputTimerRunning && ((cycles - tp->xStartCycle) >= Ms200))
         {
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: transparent input timeout on %.7s\n", pcbp->claPort, tp->termName);
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: transparent input timeout on %.7s\n", pcbp->claPort, tp->termName);
+            }
         npuAsyncFlushUplineTransparent(tp);
         }
 
@@ -710,74 +694,15 @@ void npuAsyncTryOutput(Pcb *pcbp)
         }
 
     /*
-    **  Process all queued output buffers.
+    **  Send all queued output buffers in one gather write. If the socket
+    **  would block, the select() call will later tell us when we can send
+    **  again. Any disconnects or other errors will be handled by the
+    **  receive handler.
     */
-    while ((bp = npuBipQueueExtract(&tp->outputQ)) != NULL)
+    result = npuNetSendQueue(tp, tipNotifySent[npuSw], npuAsyncLogSent);
+    if ((result > 0) && DevLogEnabled(npuAsyncLog, DevLogInfo))
         {
-        data = bp->data + bp->offset;
-
-        /*
-        **  Don't call into TCP if there is no data to send.
-        */
-        if (bp->numBytes > 0)
-            {
-            result = send(pcbp->connFd, data, bp->numBytes, 0);
-#if DEBUG
-            if (result > 0)
-                {
-                fprintf(npuAsyncLog, "Port %02x: %d bytes sent to %.7s\n", tp->pcbp->claPort, result, tp->termName);
-                npuAsyncLogBytes(data, result);
-                npuAsyncLogFlush();
-                }
-#endif
-            }
-        else
-            {
-            result = 0;
-            }
-
-        if (result >= bp->numBytes)
-            {
-            /*
-            **  The socket took all our data - let TIP know what block sequence
-            **  number we processed, free the buffer and then continue.
-            */
-            if (bp->blockSeqNo != 0)
-                {
-                tipNotifySent[npuSw](tp, bp->blockSeqNo);
-                }
-
-            npuBipBufRelease(bp);
-            continue;
-            }
-
-        /*
-        **  Not all has been sent. Put the buffer back into the queue.
-        */
-        npuBipQueuePrepend(bp, &tp->outputQ);
-
-        /*
-        **  Was there an error?
-        */
-        if (result < 0)
-            {
-            /*
-            **  Likely this is a "would block" type of error - no need to do
-            **  anything here. The select() call will later tell us when we
-            **  can send again. Any disconnects or other errors will be handled
-            **  by the receive handler.
-            */
-            return;
-            }
-
-        /*
-        **  The socket did not take all data - update offset and count.
-        */
-        if (result > 0)
-            {
-            bp->offset   += result;
-            bp->numBytes -= result;
-            }
+        devLogText(npuAsyncLog, "Port %02x: %d bytes sent to %.7s\n", tp->pcbp->claPort, result, tp->termName);
         }
     }
 
@@ -811,12 +736,12 @@ void npuAsyncProcessDownlineData(Tcb *tp, NpuBuffer *bp, bool last)
     npuTp->dbcNoEchoplex  = (dbc & DbcEchoplex) != 0;
     npuTp->dbcNoCursorPos = (dbc & DbcNoCursorPos) != 0;
 
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: downline data received for %.7s, size %d, block type %u, dbc %02x\n",
-            tp->pcbp->claPort, tp->termName, len, bp->data[BlkOffBTBSN] & BlkMaskBT, dbc);
-    npuAsyncLogBytes(bp->data, bp->numBytes);
-    npuAsyncLogFlush();
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: downline data received for %.7s, size %d, block type %u, dbc %02x\n",
+                   tp->pcbp->claPort, tp->termName, len, bp->data[BlkOffBTBSN] & BlkMaskBT, dbc);
+        devLogBytes(npuAsyncLog, bp->data, bp->numBytes);
+        }
 
     if ((dbc & DbcTransparent) != 0)
         {
@@ -914,11 +839,11 @@ void npuAsyncProcessUplineData(Pcb *pcbp)
         return;
         }
 
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: upline data received from %.7s, size %d\n", pcbp->claPort, tp->termName, pcbp->inputCount);
-    npuAsyncLogBytes(pcbp->inputData, pcbp->inputCount);
-    npuAsyncLogFlush();
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: upline data received from %.7s, size %d\n", pcbp->claPort, tp->termName, pcbp->inputCount);
+        devLogBytes(npuAsyncLog, pcbp->inputData, pcbp->inputCount);
+        }
 
     echoPtr = echoBuffer;
 
@@ -969,29 +894,28 @@ void npuAsyncFlushUplineTransparent(Tcb *tp)
         **  Terminate transparent mode unless sticky timeout has been selected.
         */
         tp->params.fvXInput = FALSE;
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: terminate upline transparent mode on %.7s\n", tp->pcbp->claPort, tp->termName);
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: terminate upline transparent mode on %.7s\n", tp->pcbp->claPort, tp->termName);
+            }
         }
-#if DEBUG
-    else
+    else if (DevLogEnabled(npuAsyncLog, DevLogInfo))
         {
-        fprintf(npuAsyncLog, "Port %02x: continue upline transparent mode on %.7s\n", tp->pcbp->claPort, tp->termName);
+        devLogText(npuAsyncLog, "Port %02x: continue upline transparent mode on %.7s\n", tp->pcbp->claPort, tp->termName);
         }
-#endif
 
     /*
     **  Send the upline data.
     */
     tp->inBuf[BlkOffDbc] = DbcTransparent;
     npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
-            tp->pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-    npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-    npuAsyncLogFlush();
-    fprintf(npuAsyncLog, "Port %02x: cancel transparent input timer for %.7s\n", tp->pcbp->claPort, tp->termName);
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
+                   tp->pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+        devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+        devLogText(npuAsyncLog, "Port %02x: cancel transparent input timer for %.7s\n", tp->pcbp->claPort, tp->termName);
+        }
     npuTipInputReset(tp);
     tp->xInputTimerRunning = FALSE;
     }
@@ -1011,9 +935,10 @@ bool npuAsyncNotifyNetConnect(Pcb *pcbp, bool isPassive)
     {
     npuAsyncResetPcb(pcbp);
 
-#if DEBUG
-    fprintf(npuAsyncLog, "Port %02x: request terminal connection\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        devLogText(npuAsyncLog, "Port %02x: request terminal connection\n", pcbp->claPort);
+        }
 
     return svmConnectTerminal[npuSw](pcbp);
     }
@@ -1034,16 +959,18 @@ void npuAsyncNotifyNetDisconnect(Pcb *pcbp)
     tp = npuAsyncFindTcb(pcbp);
     if (tp != NULL)
         {
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: terminal %.7s disconnected\n", pcbp->claPort, tp->termName);
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: terminal %.7s disconnected\n", pcbp->claPort, tp->termName);
+            }
         svmSendDiscRequest[npuSw](tp);
         }
     else
         {
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: terminal disconnected\n", pcbp->claPort);
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: terminal disconnected\n", pcbp->claPort);
+            }
 
         /*
         **  Close socket and reset PCB.
@@ -1217,6 +1144,25 @@ static void npuAsyncDoFeAfter(u8 fe)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Log data the socket took from a terminal's output queue.
+**
+**  Parameters:     Name        Description.
+**                  tp          pointer to TCB
+**                  data        pointer to data sent
+**                  len         length of data sent
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void npuAsyncLogSent(Tcb *tp, u8 *data, int len)
+    {
+    if (DevLogEnabled(npuAsyncLog, DevLogDebug))
+        {
+        devLogBytes(npuAsyncLog, data, len);
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Find the TCB assoicated with a given PCB
 **
@@ -1236,7 +1182,7 @@ static Tcb *npuAsyncFindTcb(Pcb *pcbp)
         return pcbp->controls.async.tp;
         }
 
-    for (i = 1; i < MaxTcbs; i++)
+    for (i = 1; i <= npuNetMaxCN; i++)
         {
         tp = &npuTcbs[i];
         if ((tp->state != StTermIdle) && (tp->pcbp == pcbp))
@@ -1262,8 +1208,10 @@ static Tcb *npuAsyncFindTcb(Pcb *pcbp)
 static void npuAsyncProcessUplineTransparent(Tcb *tp)
     {
     u8  ch;
+    int count;
     u8  *dp;
     int len;
+    int limit;
     int n;
     Pcb *pcbp;
 
@@ -1274,19 +1222,57 @@ static void npuAsyncProcessUplineTransparent(Tcb *tp)
     /*
     **  Cancel transparent input forwarding timeout.
     */
-#if DEBUG
-    if (tp->xInputTimerRunning)
+    if (tp->xInputTimerRunning && DevLogEnabled(npuAsyncLog, DevLogInfo))
         {
-        fprintf(npuAsyncLog, "Port %02x: cancel transparent input timer on %.7s\n", pcbp->claPort, tp->termName);
+        devLogText(npuAsyncLog, "Port %02x: cancel transparent input timer on %.7s\n", pcbp->claPort, tp->termName);
         }
-#endif
     tp->xInputTimerRunning = FALSE;
 
     /*
     **  Process transparent input.
     */
+    limit = tp->params.fvXCnt;
+    if (limit > MaxBuffer - BlkOffDbc - 2)
+        {
+        limit = MaxBuffer - BlkOffDbc - 2;
+        }
+
     while (len > 0)
         {
+        /*
+        **  Copy the run of ordinary characters up to the next delimiter or user break
+        **  character in bulk, but no further than the forwarding character count.
+        */
+        count = limit - (int)(tp->inBufPtr - tp->inBufStart);
+        if (count > len)
+            {
+            count = len;
+            }
+
+        count = npuAsyncScanPlain(dp, count,
+                                  tp->params.fvXCharFlag ? tp->params.fvXChar : -1,
+                                  tp->params.fvEnaXUserBreak ? tp->params.fvUserBreak2 : -1);
+        if (count > 0)
+            {
+            if (tp->params.fvEchoplex)
+                {
+                memcpy(echoPtr, dp, count);
+                echoPtr += count;
+                }
+
+            memcpy(tp->inBufPtr, dp, count);
+            tp->inBufPtr += count;
+            dp           += count;
+            len          -= count;
+            n             = (int)(tp->inBufPtr - tp->inBufStart);
+            if (n >= limit)
+                {
+                npuAsyncSendTransparent(tp, n);
+                }
+
+            continue;
+            }
+
         ch   = *dp++;
         len -= 1;
 
@@ -1310,15 +1296,15 @@ static void npuAsyncProcessUplineTransparent(Tcb *tp)
             */
             tp->inBuf[BlkOffDbc] = DbcTransparent;
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: transparent mode termination character (%02x) detected on %.7s\n", pcbp->claPort, ch, tp->termName);
-            fprintf(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-            fprintf(npuAsyncLog, "Port %02x: %s upline transparent mode on %.7s\n", pcbp->claPort,
-                    tp->params.fvXInput ? "continue" : "terminate", tp->termName);
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: transparent mode termination character (%02x) detected on %.7s\n", pcbp->claPort, ch, tp->termName);
+                devLogText(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                devLogText(npuAsyncLog, "Port %02x: %s upline transparent mode on %.7s\n", pcbp->claPort,
+                           tp->params.fvXInput ? "continue" : "terminate", tp->termName);
+                }
             npuTipInputReset(tp);
             }
         else if ((ch == tp->params.fvUserBreak2) && tp->params.fvEnaXUserBreak)
@@ -1326,47 +1312,22 @@ static void npuAsyncProcessUplineTransparent(Tcb *tp)
             *tp->inBufPtr++      = ch;
             tp->inBuf[BlkOffDbc] = DbcTransparent;
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: User Break2 (%02x) detected on %.7s\n", pcbp->claPort, ch, tp->termName);
-            fprintf(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: User Break2 (%02x) detected on %.7s\n", pcbp->claPort, ch, tp->termName);
+                devLogText(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
             }
         else
             {
             *tp->inBufPtr++ = ch;
             n = (int)(tp->inBufPtr - tp->inBufStart);
-            if ((n >= tp->params.fvXCnt) || (n >= MaxBuffer - BlkOffDbc - 2))
+            if (n >= limit)
                 {
-                if (!tp->params.fvXModeMultiple && (n >= tp->params.fvXCnt))
-                    {
-                    /*
-                    **  Terminate single message transparent mode.
-                    */
-                    tp->params.fvXInput = FALSE;
-                    }
-
-                /*
-                **  Send the upline data.
-                */
-                tp->inBuf[BlkOffDbc] = DbcTransparent;
-                npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-                if (n >= tp->params.fvXCnt)
-                    {
-                    fprintf(npuAsyncLog, "Port %02x: max transparent mode character count (%d) detected on %.7s\n", pcbp->claPort, n, tp->termName);
-                    }
-                fprintf(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
-                        pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-                npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-                npuAsyncLogFlush();
-                fprintf(npuAsyncLog, "Port %02x: %s upline transparent mode on %.7s\n", pcbp->claPort,
-                        tp->params.fvXInput ? "continue" : "terminate", tp->termName);
-#endif
-                npuTipInputReset(tp);
+                npuAsyncSendTransparent(tp, n);
                 }
             }
         }
@@ -1378,12 +1339,55 @@ static void npuAsyncProcessUplineTransparent(Tcb *tp)
         {
         tp->xStartCycle        = cycles;
         tp->xInputTimerRunning = TRUE;
-#if DEBUG
-        fprintf(npuAsyncLog, "Port %02x: start transparent input timer on %.7s\n", pcbp->claPort, tp->termName);
-#endif
+        if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+            {
+            devLogText(npuAsyncLog, "Port %02x: start transparent input timer on %.7s\n", pcbp->claPort, tp->termName);
+            }
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Send accumulated transparent input upline when the
+**                  forwarding character count or the buffer size has
+**                  been reached.
+**
+**  Parameters:     Name        Description.
+**                  tp          TCB pointer
+**                  n           number of characters accumulated
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void npuAsyncSendTransparent(Tcb *tp, int n)
+    {
+    if (!tp->params.fvXModeMultiple && (n >= tp->params.fvXCnt))
+        {
+        /*
+        **  Terminate single message transparent mode.
+        */
+        tp->params.fvXInput = FALSE;
+        }
+
+    /*
+    **  Send the upline data.
+    */
+    tp->inBuf[BlkOffDbc] = DbcTransparent;
+    npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+    if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+        {
+        if (n >= tp->params.fvXCnt)
+            {
+            devLogText(npuAsyncLog, "Port %02x: max transparent mode character count (%d) detected on %.7s\n", tp->pcbp->claPort, n, tp->termName);
+            }
+        devLogText(npuAsyncLog, "Port %02x: send upline transparent data for %.7s, size %ld\n",
+                   tp->pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+        devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+        devLogText(npuAsyncLog, "Port %02x: %s upline transparent mode on %.7s\n", tp->pcbp->claPort,
+                   tp->params.fvXInput ? "continue" : "terminate", tp->termName);
+        }
+    npuTipInputReset(tp);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Process upline data from terminal.
 **
@@ -1459,12 +1463,12 @@ static void npuAsyncProcessUplineAscii(Tcb *tp)
             */
             *tp->inBufPtr++ = ch;
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline ASCII data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline ASCII data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
 
             /*
@@ -1540,12 +1544,12 @@ static void npuAsyncProcessUplineAscii(Tcb *tp)
             */
             tp->inBuf[BlkOffBTBSN] = BtHTBLK | (tp->uplineBsn << BlkShiftBSN);
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline long ASCII data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline long ASCII data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
             }
         }
@@ -1666,12 +1670,12 @@ static void npuAsyncProcessUplineSpecial(Tcb *tp)
             */
             tp->inBuf[BlkOffDbc] = DbcCancel;
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline special data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline special data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
 
             /*
             **  Reset input and echoplex buffers.
@@ -1710,12 +1714,12 @@ static void npuAsyncProcessUplineSpecial(Tcb *tp)
             **  EOL entered - send the input upline.
             */
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline special data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline special data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
 
             /*
@@ -1786,12 +1790,12 @@ static void npuAsyncProcessUplineSpecial(Tcb *tp)
             tp->inBuf[BlkOffBTBSN] = BtHTBLK | (tp->uplineBsn << BlkShiftBSN);
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
             npuTipInputReset(tp);
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline long special data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline long special data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             }
         }
     }
@@ -1858,9 +1862,10 @@ static void npuAsyncProcessUplineNormal(Tcb *tp)
                 */
                 tp->xoff = TRUE;
                 }
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: %s detected on %.7s\n", pcbp->claPort, tp->xoff ? "XOFF" : "XON", tp->termName);
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: %s detected on %.7s\n", pcbp->claPort, tp->xoff ? "XOFF" : "XON", tp->termName);
+                }
             continue;
             }
 
@@ -1902,12 +1907,12 @@ static void npuAsyncProcessUplineNormal(Tcb *tp)
             */
             tp->inBuf[BlkOffDbc] = DbcCancel;
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
 
             /*
             **  Reset input and echoplex buffers.
@@ -1946,12 +1951,12 @@ static void npuAsyncProcessUplineNormal(Tcb *tp)
             **  EOL entered - send the input upline.
             */
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline normal data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
             tp->lastOpWasInput = TRUE;
 
@@ -2044,109 +2049,81 @@ static void npuAsyncProcessUplineNormal(Tcb *tp)
             */
             tp->inBuf[BlkOffBTBSN] = BtHTBLK | (tp->uplineBsn << BlkShiftBSN);
             npuBipRequestUplineCanned(tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
-#if DEBUG
-            fprintf(npuAsyncLog, "Port %02x: send upline long normal data for %.7s, size %ld\n",
-                    pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogBytes(tp->inBuf, tp->inBufPtr - tp->inBuf);
-            npuAsyncLogFlush();
-#endif
+            if (DevLogEnabled(npuAsyncLog, DevLogInfo))
+                {
+                devLogText(npuAsyncLog, "Port %02x: send upline long normal data for %.7s, size %ld\n",
+                           pcbp->claPort, tp->termName, tp->inBufPtr - tp->inBuf);
+                devLogBytes(npuAsyncLog, tp->inBuf, (int)(tp->inBufPtr - tp->inBuf));
+                }
             npuTipInputReset(tp);
             }
         }
     }
 
-#if DEBUG
-
 /*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete data line
+**  Purpose:        Determine the length of the run of plain characters at
+**                  the start of a buffer, i.e. characters which are neither
+**                  of two special characters. Eight characters at a time
+**                  are tested while no special character is found.
 **
 **  Parameters:     Name        Description.
+**                  sp          pointer to characters
+**                  len         number of characters
+**                  c1          first special character or -1 if none
+**                  c2          second special character or -1 if none
 **
-**  Returns:        nothing
+**  Returns:        Number of characters before the first special character,
+**                  or len if there is none.
 **
 **------------------------------------------------------------------------*/
-static void npuAsyncLogFlush(void)
+static int npuAsyncScanPlain(u8 *sp, int len, int c1, int c2)
     {
-    if (npuAsyncLogBytesCol > 0)
+    int i;
+    u64 m1;
+    u64 m2;
+    u8  *p;
+    u64 w;
+
+    if (len <= 0)
         {
-        fputs(npuAsyncLogBuf, npuAsyncLog);
-        fputc('\n', npuAsyncLog);
-        fflush(npuAsyncLog);
+        return (0);
         }
-    npuAsyncLogBytesCol = 0;
-    memset(npuAsyncLogBuf, ' ', LogLineLength);
-    npuAsyncLogBuf[LogLineLength] = '\0';
-    }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of bytes
-**
-**  Parameters:     Name        Description.
-**                  bytes       pointer to sequence of bytes
-**                  len         length of the sequence
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuAsyncLogBytes(u8 *bytes, int len)
-    {
-    u8   ac;
-    int  ascCol;
-    u8   b;
-    char hex[3];
-    int  hexCol;
-    int  i;
+    if (c1 < 0)
+        {
+        c1 = c2;
+        c2 = -1;
+        }
 
-    ascCol = AsciiColumn(npuAsyncLogBytesCol);
-    hexCol = HexColumn(npuAsyncLogBytesCol);
+    if (c1 < 0)
+        {
+        return (len);
+        }
 
-    for (i = 0; i < len; i++)
+    if ((c2 < 0) || (c2 == c1))
         {
-        b  = bytes[i];
-        ac = b & 0x7f;
-        if ((ac < 0x20) || (ac >= 0x7f))
-            {
-            ac = '.';
-            }
-        sprintf(hex, "%02x", b);
-        memcpy(npuAsyncLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        npuAsyncLogBuf[ascCol++] = ac;
-        if (++npuAsyncLogBytesCol >= 16)
+        p = memchr(sp, c1, len);
+
+        return ((p == NULL) ? len : (int)(p - sp));
+        }
+
+    m1 = 0x0101010101010101ULL * (u8)c1;
+    m2 = 0x0101010101010101ULL * (u8)c2;
+    for (i = 0; i + 8 <= len; i += 8)
+        {
+        memcpy(&w, sp + i, sizeof(w));
+        if (HasZeroByte(w ^ m1) | HasZeroByte(w ^ m2))
             {
-            npuAsyncLogFlush();
-            ascCol = AsciiColumn(npuAsyncLogBytesCol);
-            hexCol = HexColumn(npuAsyncLogBytesCol);
+            break;
             }
         }
-    }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a stack trace
-**
-**  Parameters:     none
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuAsyncPrintStackTrace(FILE *fp)
-    {
-#if defined(__APPLE__)
-    void *callstack[128];
-    int  i;
-    int  frames;
-    char **strs;
-
-    frames = backtrace(callstack, 128);
-    strs   = backtrace_symbols(callstack, frames);
-    for (i = 1; i < frames; ++i)
+    while ((i < len) && (sp[i] != c1) && (sp[i] != c2))
         {
-        fprintf(fp, "%s\n", strs[i]);
+        i += 1;
         }
-    free(strs);
-#endif
-    }
 
-#endif // DEBUG
+    return (i);
+    }
 
 /*---------------------------  End Of File  ------------------------------*/
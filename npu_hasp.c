@@ -33,8 +33,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -63,10 +61,6 @@
 #include "proto.h"
 #include "npu.h"
 
-#if defined(__APPLE__)
-#include <execinfo.h>
-#endif
-
 
 /*
 **  -----------------
@@ -100,6 +94,12 @@
 #define DcBlank               055
 #define EbcdicBlank           0x40
 
+#define MaxScbRun             31  // longest run in a duplicate character SCB
+#define MaxScbString          63  // longest string in a non-duplicate SCB
+#define MinBlankRun           3   // shortest blank run worth compressing
+#define MinDupRun             4   // shortest non-blank run worth compressing
+#define RecordChunkSize       252 // record bytes encoded per output call
+
 #define SRCB_GCR              0
 #define SRCB_RTI              1
 #define SRCB_PTI              2
@@ -135,11 +135,9 @@
 **  -----------------------
 */
 #define isPostPrint(tp)    ((tp)->params.fvTC == TcHASP)
-#if DEBUG
-#define HexColumn(x)    (3 * (x) + 4)
-#define AsciiColumn(x)  (HexColumn(16) + 2 + (x))
-#define LogLineLength   (AsciiColumn(16))
-#endif
+#define HexColumn(x)       (3 * (x) + 4)
+#define AsciiColumn(x)     (HexColumn(16) + 2 + (x))
+#define LogLineLength      (AsciiColumn(16))
 
 /*
 **  -----------------------------------------
@@ -155,14 +153,12 @@ typedef enum
     TRANS8
     } FileType;
 
-#if DEBUG
 typedef enum
     {
     ASCII = 0,
     EBCDIC,
     DisplayCode
     } CharEncoding;
-#endif
 
 /*
 **  ---------------------------
@@ -184,6 +180,7 @@ static void npuHaspProcessFormatControl(Pcb *pcbp);
 static void npuHaspReleaseLastBlockSent(Pcb *pcbp);
 static void npuHaspResetScb(Scb *scbp);
 static void npuHaspResetSendDeadline(Tcb *tp);
+static int  npuHaspRunLength(u8 *data, int len);
 static int  npuHaspSend(Pcb *pcbp, u8 *data, int len);
 static int  npuHaspSendBlockHeader(Tcb *tp);
 static int  npuHaspSendBlockTrailer(Tcb *tp);
@@ -199,14 +196,9 @@ static void npuHaspStageUplineData(Scb *scbp, u8 *data, int len);
 static void npuHaspTransmitQueuedBlocks(Tcb *tp);
 static u8   npuHaspTranslateSrcbToFe(u8 cc);
 
-#if DEBUG
 static void npuHaspLogBytes(u8 *bytes, int len, CharEncoding encoding);
 static void npuHaspLogDevParam(Tcb *tp, u8 fn, u8 fv);
 static void npuHaspLogFileParam(Tcb *tp, u8 fn, u8 fv);
-static void npuHaspLogFlush(void);
-static void npuHaspPrintStackTrace(FILE *fp);
-
-#endif
 
 /*
 **  ----------------
@@ -231,11 +223,7 @@ static u8 rtiRecord    [] = { 0x90, 0x80, 0x00 };
 static u8 dcEoi        [] = { 050, 047, 005, 017, 011 }; //  /*EOI
 static u8 dcEor        [] = { 050, 047, 005, 017, 022 }; //  /*EOR
 
-#if DEBUG
-static FILE *npuHaspLog = NULL;
-static char npuHaspLogBuf[LogLineLength + 1];
-static int  npuHaspLogBytesCol = 0;
-#endif
+static DevLogModule *npuHaspLog = NULL;
 
 /*
  **--------------------------------------------------------------------------
@@ -296,14 +284,16 @@ void npuHaspTryOutput(Pcb *pcbp)
             **  from the peer, so take an appropriate action depending
             **  upon the current minor state.
             */
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: receive timeout\n", pcbp->claPort);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                {
+                devLogText(npuHaspLog, "Port %02x: receive timeout\n", pcbp->claPort);
+                }
             if (currentTime - pcbp->controls.hasp.lastRecvTime > DeadPeerTimeout)
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: peer not responding, closing connection\n", pcbp->claPort);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: peer not responding, closing connection\n", pcbp->claPort);
+                    }
                 npuHaspCloseConnection(pcbp);
                 pcbp->controls.hasp.majorState = StHaspMajorInit;
 
@@ -448,10 +438,11 @@ void npuHaspTryOutput(Pcb *pcbp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: invalid stream state %d on stream %u (%.7s)\n",
-                    pcbp->claPort, scbp->state, scbp->tp->streamId, scbp->tp->termName);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogError))
+                {
+                devLogText(npuHaspLog, "Port %02x: invalid stream state %d on stream %u (%.7s)\n",
+                           pcbp->claPort, scbp->state, scbp->tp->streamId, scbp->tp->termName);
+                }
             break;
             }
         break;
@@ -471,9 +462,10 @@ void npuHaspTryOutput(Pcb *pcbp)
             **  Too much time has elapsed without receiving the initial
             **  SOH ENQ sequence from the peer, so close the connection.
             */
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: HASP startup timeout\n", pcbp->claPort);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                {
+                devLogText(npuHaspLog, "Port %02x: HASP startup timeout\n", pcbp->claPort);
+                }
             npuHaspCloseConnection(pcbp);
             pcbp->controls.hasp.majorState = StHaspMajorInit;
 
@@ -545,25 +537,25 @@ void npuHaspProcessDownlineData(Tcb *tp, NpuBuffer *bp, bool last)
     dbc  = *blk++; // extract data block clarifier
     len -= 1;
 
-#if DEBUG
-    blockType = bp->data[BlkOffBTBSN] & BlkMaskBT;
-    fprintf(npuHaspLog, "Port %02x: downline data received from host for stream %u (%.7s), block type %u, block len %d, dbc %02x\n",
-            pcbp->claPort, tp->streamId, tp->termName, blockType, bp->numBytes, dbc);
-    if ((dbc & DbcPRU) != 0)
+    if (DevLogEnabled(npuHaspLog, DevLogDebug))
         {
-        npuHaspLogBytes(bp->data, bp->numBytes,
-                        (tp->scbp != NULL && tp->scbp->params.fvFileType == ASC) ? ASCII : DisplayCode);
-        }
-    else if ((dbc & DbcTransparent) == 0)
-        {
-        npuHaspLogBytes(bp->data, bp->numBytes, ASCII);
-        }
-    else
-        {
-        npuHaspLogBytes(bp->data, bp->numBytes, DisplayCode);
+        blockType = bp->data[BlkOffBTBSN] & BlkMaskBT;
+        devLogText(npuHaspLog, "Port %02x: downline data received from host for stream %u (%.7s), block type %u, block len %d, dbc %02x\n",
+                   pcbp->claPort, tp->streamId, tp->termName, blockType, bp->numBytes, dbc);
+        if ((dbc & DbcPRU) != 0)
+            {
+            npuHaspLogBytes(bp->data, bp->numBytes,
+                            (tp->scbp != NULL && tp->scbp->params.fvFileType == ASC) ? ASCII : DisplayCode);
+            }
+        else if ((dbc & DbcTransparent) == 0)
+            {
+            npuHaspLogBytes(bp->data, bp->numBytes, ASCII);
+            }
+        else
+            {
+            npuHaspLogBytes(bp->data, bp->numBytes, DisplayCode);
+            }
         }
-    npuHaspLogFlush();
-#endif
 
     scbp = tp->scbp;
 
@@ -597,10 +589,11 @@ void npuHaspProcessDownlineData(Tcb *tp, NpuBuffer *bp, bool last)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: invalid device type %u on RTI\n",
-                    pcbp->claPort, tp->deviceType);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogError))
+                {
+                devLogText(npuHaspLog, "Port %02x: invalid device type %u on RTI\n",
+                           pcbp->claPort, tp->deviceType);
+                }
             break;
             }
         blockLen = npuHaspSendBlockHeader(tp);
@@ -772,10 +765,11 @@ void npuHaspProcessDownlineData(Tcb *tp, NpuBuffer *bp, bool last)
         */
         if ((pcbp->controls.hasp.isSignedOn == FALSE) && (pcbp->ncbp->connType == ConnTypeRevHasp))
             {
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: not signed on yet, data discarded from stream %u (%.7s)\n",
-                    pcbp->claPort, tp->streamId, tp->termName);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                {
+                devLogText(npuHaspLog, "Port %02x: not signed on yet, data discarded from stream %u (%.7s)\n",
+                           pcbp->claPort, tp->streamId, tp->termName);
+                }
             npuTipNotifySent(tp, bp->data[BlkOffBTBSN]);
 
             return;
@@ -930,11 +924,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
     dp  = pcbp->inputData;
     len = pcbp->inputCount;
 
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: received from terminal\n", pcbp->claPort);
-    npuHaspLogBytes(dp, len, EBCDIC);
-    npuHaspLogFlush();
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogDebug))
+        {
+        devLogText(npuHaspLog, "Port %02x: received from terminal\n", pcbp->claPort);
+        npuHaspLogBytes(dp, len, EBCDIC);
+        }
 
     if (len > 0)
         {
@@ -990,9 +984,10 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                         }
                     else
                         {
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: maximum retry attempts exceeded\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: maximum retry attempts exceeded\n", pcbp->claPort);
+                            }
                         npuHaspReleaseLastBlockSent(pcbp);
                         npuHaspCloseConnection(pcbp);
                         pcbp->controls.hasp.majorState = StHaspMajorInit;
@@ -1008,10 +1003,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected SYN, DLE, or SOH, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected SYN, DLE, or SOH, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 break;
                 }
             break;
@@ -1034,10 +1030,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected ACK0 or STX, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected ACK0 or STX, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvBOF;
                 break;
                 }
@@ -1060,10 +1057,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected DLE, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected DLE, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 break;
                 }
             break;
@@ -1081,10 +1079,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected ACK0, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected ACK0, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 break;
                 }
             break;
@@ -1125,10 +1124,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 else
                     {
                     pcbp->controls.hasp.minorState = StHaspMinorRecvSOH;
-#if DEBUG
-                    fprintf(npuHaspLog, "Port %02x: port not configured yet, ENQ ignored\n",
-                            pcbp->claPort);
-#endif
+                    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                        {
+                        devLogText(npuHaspLog, "Port %02x: port not configured yet, ENQ ignored\n",
+                                   pcbp->claPort);
+                        }
                     }
                 break;
 
@@ -1159,10 +1159,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                         }
                     else
                         {
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: expected BSN %u, received %u\n",
-                                pcbp->claPort, (pcbp->controls.hasp.uplineBSN + 1) & 0x0f, blockSeqNum);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: expected BSN %u, received %u\n",
+                                       pcbp->claPort, (pcbp->controls.hasp.uplineBSN + 1) & 0x0f, blockSeqNum);
+                            }
                         // TODO: send BAD BCB indication
                         pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                         }
@@ -1178,20 +1179,22 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     break;
 
                 default:
-#if DEBUG
-                    fprintf(npuHaspLog, "Port %02x: unrecognized BCB type: <%02x>\n",
-                            pcbp->claPort, ch);
-#endif
+                    if (DevLogEnabled(npuHaspLog, DevLogError))
+                        {
+                        devLogText(npuHaspLog, "Port %02x: unrecognized BCB type: <%02x>\n",
+                                   pcbp->claPort, ch);
+                        }
                     pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                     break;
                     }
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: invalid BCB byte: <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: invalid BCB byte: <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1212,10 +1215,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: invalid FCS1 byte: <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: invalid FCS1 byte: <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1263,10 +1267,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: invalid FCS2 byte: <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: invalid FCS2 byte: <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1307,10 +1312,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                         break;
 
                     default:
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: unrecognized control info in RCB: %u\n",
-                                pcbp->claPort, (ch >> 4) & 0x07);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: unrecognized control info in RCB: %u\n",
+                                       pcbp->claPort, (ch >> 4) & 0x07);
+                            }
                         pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                         break;
                         }
@@ -1342,10 +1348,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     break;
 
                 default:
-#if DEBUG
-                    fprintf(npuHaspLog, "Port %02x: unrecognized record type in RCB: <%02x>\n",
-                            pcbp->claPort, recordType);
-#endif
+                    if (DevLogEnabled(npuHaspLog, DevLogError))
+                        {
+                        devLogText(npuHaspLog, "Port %02x: unrecognized record type in RCB: <%02x>\n",
+                                   pcbp->claPort, recordType);
+                        }
                     deviceType = 0xff;
                     pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                     continue;
@@ -1385,10 +1392,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                         break;
 
                     default:
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: invalid stream id (%u) or device type (%u) ignored in RTI\n",
-                                pcbp->claPort, streamId, deviceType);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: invalid stream id (%u) or device type (%u) ignored in RTI\n",
+                                       pcbp->claPort, streamId, deviceType);
+                            }
                         scbp = NULL;
                         break;
                         }
@@ -1428,10 +1436,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                         break;
 
                     default:
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: invalid stream id (%u) or device type (%u) ignored in PTI\n",
-                                pcbp->claPort, streamId, deviceType);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: invalid stream id (%u) or device type (%u) ignored in PTI\n",
+                                       pcbp->claPort, streamId, deviceType);
+                            }
                         scbp = NULL;
                         break;
                         }
@@ -1459,10 +1468,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     case 'H': // Diagnostic control record
                     default:
                         pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: unsupported GCR type %c\n",
-                                pcbp->claPort, (char)ebcdicToAscii[ch]);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: unsupported GCR type %c\n",
+                                       pcbp->claPort, (char)ebcdicToAscii[ch]);
+                            }
                         break;
                         }
                     break;
@@ -1472,10 +1482,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     break;
 
                 case SRCB_BAD_BCB:
-#if DEBUG
-                    fprintf(npuHaspLog, "Port %02x: bad BCB sent in last block: %02x\n",
-                            pcbp->claPort, ch);
-#endif
+                    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                        {
+                        devLogText(npuHaspLog, "Port %02x: bad BCB sent in last block: %02x\n",
+                                   pcbp->claPort, ch);
+                        }
                     pcbp->controls.hasp.downlineBSN = ch % 0x0f;
                     // TODO: retransmit last block with expected BSN
                     break;
@@ -1486,10 +1497,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: invalid SRCB byte: <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: invalid SRCB byte: <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1630,10 +1642,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     len -= 1;
                     if (ch != DLE)
                         {
-#if DEBUG
-                        fprintf(npuHaspLog, "Port %02x: expected byte-stuffed DLE, received <%02x>\n",
-                                pcbp->claPort, ch);
-#endif
+                        if (DevLogEnabled(npuHaspLog, DevLogError))
+                            {
+                            devLogText(npuHaspLog, "Port %02x: expected byte-stuffed DLE, received <%02x>\n",
+                                       pcbp->claPort, ch);
+                            }
                         dp  -= 2;
                         len += 2;
                         pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
@@ -1680,9 +1693,7 @@ void npuHaspProcessUplineData(Pcb *pcbp)
         **  RCB) is detected.
         */
         case StHaspMinorRecvSignon:
-#if DEBUG
             i = 0;
-#endif
             while (len > 0)
                 {
                 if (ch == 0)
@@ -1692,31 +1703,31 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                     pcbp->controls.hasp.isSignedOn = TRUE;
                     break;
                     }
-#if DEBUG
                 if (i >= sizeof(buf))
                     {
-                    fprintf(npuHaspLog, "Port %02x: received signon record\n", pcbp->claPort);
-                    npuHaspLogBytes(buf, i, EBCDIC);
-                    npuHaspLogFlush();
+                    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                        {
+                        devLogText(npuHaspLog, "Port %02x: received signon record\n", pcbp->claPort);
+                        npuHaspLogBytes(buf, i, EBCDIC);
+                        }
                     i = 0;
                     }
                 buf[i++] = ch;
-#endif
                 ch   = *dp++;
                 len -= 1;
                 }
-#if DEBUG
-            if (i > 0)
-                {
-                fprintf(npuHaspLog, "Port %02x: received signon record\n", pcbp->claPort);
-                npuHaspLogBytes(buf, i, EBCDIC);
-                npuHaspLogFlush();
-                }
-            if (pcbp->controls.hasp.isSignedOn)
+            if (DevLogEnabled(npuHaspLog, DevLogInfo))
                 {
-                fprintf(npuHaspLog, "Port %02x: signon complete\n", pcbp->claPort);
+                if (i > 0)
+                    {
+                    devLogText(npuHaspLog, "Port %02x: received signon record\n", pcbp->claPort);
+                    npuHaspLogBytes(buf, i, EBCDIC);
+                    }
+                if (pcbp->controls.hasp.isSignedOn)
+                    {
+                    devLogText(npuHaspLog, "Port %02x: signon complete\n", pcbp->claPort);
+                    }
                 }
-#endif
             break;
 
         /*
@@ -1735,10 +1746,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected DLE or <00> after signon record, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected DLE or <00> after signon record, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1753,10 +1765,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected DLE after transmission block terminator, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected DLE after transmission block terminator, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1789,10 +1802,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected ETB, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected ETB, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1843,10 +1857,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: expected ETB, received <%02x>\n",
-                        pcbp->claPort, ch);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogError))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: expected ETB, received <%02x>\n",
+                               pcbp->claPort, ch);
+                    }
                 pcbp->controls.hasp.minorState = StHaspMinorRecvDLE2;
                 }
             break;
@@ -1857,10 +1872,11 @@ void npuHaspProcessUplineData(Pcb *pcbp)
         case StHaspMinorNIL:
             if (pcbp->controls.hasp.majorState == StHaspMajorInit)
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: not configured yet, data discarded\n",
-                        pcbp->claPort);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: not configured yet, data discarded\n",
+                               pcbp->claPort);
+                    }
 
                 return;
                 }
@@ -1893,10 +1909,11 @@ void npuHaspCloseStream(Tcb *tp)
     pcbp     = tp->pcbp;
     streamId = tp->streamId;
 
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: close stream %d (%.7s)\n", pcbp->claPort,
-            streamId, tp->termName);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: close stream %d (%.7s)\n", pcbp->claPort,
+                   streamId, tp->termName);
+        }
 
     switch (tp->deviceType)
         {
@@ -1940,10 +1957,11 @@ void npuHaspCloseStream(Tcb *tp)
 void npuHaspNotifyAck(Tcb *tp, u8 bsn)
     {
     tp->uplineBlockLimit += 1;
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: ack for upline block from %.7s, ubl %d\n",
-            tp->pcbp->claPort, tp->termName, tp->uplineBlockLimit);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: ack for upline block from %.7s, ubl %d\n",
+                   tp->pcbp->claPort, tp->termName, tp->uplineBlockLimit);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -1958,9 +1976,10 @@ void npuHaspNotifyAck(Tcb *tp, u8 bsn)
 **------------------------------------------------------------------------*/
 bool npuHaspNotifyNetConnect(Pcb *pcbp, bool isPassive)
     {
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: network connection indication\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: network connection indication\n", pcbp->claPort);
+        }
     npuHaspResetPcb(pcbp);
 
     return npuSvmConnectTerminal(pcbp);
@@ -1979,9 +1998,10 @@ void npuHaspNotifyNetDisconnect(Pcb *pcbp)
     {
     Tcb *tp;
 
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: network disconnection indication\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: network disconnection indication\n", pcbp->claPort);
+        }
     tp = pcbp->controls.hasp.consoleStream.tp;
     if (tp != NULL)
         {
@@ -2013,20 +2033,27 @@ void npuHaspNotifyStartInput(Tcb *tp, u8 sfc)
         scbp = tp->scbp;
         scbp->isDiscardingRecords = FALSE;
         scbp->isStarted           = TRUE;
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: SI/NONTR command received for stream %d (%.7s)\n",
-                tp->pcbp->claPort, tp->streamId, tp->termName);
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            devLogText(npuHaspLog, "Port %02x: SI/NONTR command received for stream %d (%.7s)\n",
+                       tp->pcbp->claPort, tp->streamId, tp->termName);
+            }
         }
     else if (sfc != SfcNONTR)
         {
-        fprintf(npuHaspLog, "Port %02x: Unexpected SFC %u in SI command received for stream %d (%.7s)\n",
-                tp->pcbp->claPort, sfc, tp->streamId, tp->termName);
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: Unexpected SFC %u in SI command received for stream %d (%.7s)\n",
+                       tp->pcbp->claPort, sfc, tp->streamId, tp->termName);
+            }
         }
     else
         {
-        fprintf(npuHaspLog, "Port %02x: SI/MONTR command received for stream %d (%.7s) that has no SCB\n",
-                tp->pcbp->claPort, tp->streamId, tp->termName);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: SI/MONTR command received for stream %d (%.7s) that has no SCB\n",
+                       tp->pcbp->claPort, tp->streamId, tp->termName);
+            }
         }
     }
 
@@ -2051,18 +2078,20 @@ void npuHaspNotifyTermConnect(Tcb *tp)
     pcbp       = tp->pcbp;
     scbp       = NULL;
 
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: connect stream %d (%.7s)\n", pcbp->claPort,
-            streamId, tp->termName);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: connect stream %d (%.7s)\n", pcbp->claPort,
+                   streamId, tp->termName);
+        }
 
     if (pcbp->connFd <= 0)
         {
         npuSvmSendDiscRequest(tp);
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: no network connection, disconnect stream %d (%.7s)\n",
-                pcbp->claPort, streamId, tp->termName);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            devLogText(npuHaspLog, "Port %02x: no network connection, disconnect stream %d (%.7s)\n",
+                       pcbp->claPort, streamId, tp->termName);
+            }
 
         return;
         }
@@ -2098,29 +2127,32 @@ void npuHaspNotifyTermConnect(Tcb *tp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: attempt to initialize stream for invalid device type %u\n",
-                    pcbp->claPort, deviceType);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogError))
+                {
+                devLogText(npuHaspLog, "Port %02x: attempt to initialize stream for invalid device type %u\n",
+                           pcbp->claPort, deviceType);
+                }
             npuSvmSendDiscRequest(tp);
             break;
             }
         }
     else
         {
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: attempt to initialize invalid stream id %u\n",
-                pcbp->claPort, streamId);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: attempt to initialize invalid stream id %u\n",
+                       pcbp->claPort, streamId);
+            }
         npuSvmSendDiscRequest(tp);
         }
     if (scbp != NULL)
         {
         scbp->tp             = tp;
         tp->uplineBlockLimit = tp->params.fvUBL;
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: upline block limit %d\n", pcbp->claPort, tp->uplineBlockLimit);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            devLogText(npuHaspLog, "Port %02x: upline block limit %d\n", pcbp->claPort, tp->uplineBlockLimit);
+            }
         }
     }
 
@@ -2148,28 +2180,31 @@ void npuHaspNotifyTermDisconnect(Tcb *tp)
             tp2 = pcbp->controls.hasp.readerStreams[i].tp;
             if (tp2 != NULL)
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
-                        tp2->streamId, tp2->termName);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
+                               tp2->streamId, tp2->termName);
+                    }
                 npuSvmSendDiscRequest(tp2);
                 }
             tp2 = pcbp->controls.hasp.printStreams[i].tp;
             if (tp2 != NULL)
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
-                        tp2->streamId, tp2->termName);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
+                               tp2->streamId, tp2->termName);
+                    }
                 npuSvmSendDiscRequest(tp2);
                 }
             tp2 = pcbp->controls.hasp.punchStreams[i].tp;
             if (tp2 != NULL)
                 {
-#if DEBUG
-                fprintf(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
-                        tp2->streamId, tp2->termName);
-#endif
+                if (DevLogEnabled(npuHaspLog, DevLogInfo))
+                    {
+                    devLogText(npuHaspLog, "Port %02x: disconnect stream %d (%.7s)\n", pcbp->claPort,
+                               tp2->streamId, tp2->termName);
+                    }
                 npuSvmSendDiscRequest(tp2);
                 }
             }
@@ -2199,20 +2234,27 @@ void npuHaspNotifyTerminateOutput(Tcb *tp, u8 sfc)
         {
         scbp = tp->scbp;
         scbp->isTerminateRequested = TRUE;
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: TO/MARK command received for stream %d (%.7s)\n",
-                tp->pcbp->claPort, tp->streamId, tp->termName);
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            devLogText(npuHaspLog, "Port %02x: TO/MARK command received for stream %d (%.7s)\n",
+                       tp->pcbp->claPort, tp->streamId, tp->termName);
+            }
         }
     else if (sfc != SfcMARK)
         {
-        fprintf(npuHaspLog, "Port %02x: Unexpected SFC %u in TO command received for stream %d (%.7s)\n",
-                tp->pcbp->claPort, sfc, tp->streamId, tp->termName);
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: Unexpected SFC %u in TO command received for stream %d (%.7s)\n",
+                       tp->pcbp->claPort, sfc, tp->streamId, tp->termName);
+            }
         }
     else
         {
-        fprintf(npuHaspLog, "Port %02x: TO/MARK command received for stream %d (%.7s) that has no SCB\n",
-                tp->pcbp->claPort, tp->streamId, tp->termName);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: TO/MARK command received for stream %d (%.7s) that has no SCB\n",
+                       tp->pcbp->claPort, tp->streamId, tp->termName);
+            }
         }
     }
 
@@ -2233,9 +2275,10 @@ bool npuHaspParseDevParams(u8 *mp, int len, Tcb *tp)
 
     while (len > 0)
         {
-#if DEBUG
-        npuHaspLogDevParam(tp, mp[0], mp[1]);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            npuHaspLogDevParam(tp, mp[0], mp[1]);
+            }
         switch (mp[0])
             {
         case FnDevTbsUpper:
@@ -2259,9 +2302,10 @@ bool npuHaspParseDevParams(u8 *mp, int len, Tcb *tp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuHaspLog, "Unknown device FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogError))
+                {
+                devLogText(npuHaspLog, "Unknown device FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
+                }
             break;
             }
 
@@ -2292,9 +2336,10 @@ bool npuHaspParseFileParams(u8 *mp, int len, Tcb *tp)
 
     while (len > 0)
         {
-#if DEBUG
-        npuHaspLogFileParam(tp, mp[0], mp[1]);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogInfo))
+            {
+            npuHaspLogFileParam(tp, mp[0], mp[1]);
+            }
         switch (mp[0])
             {
         case FnFileType:
@@ -2322,9 +2367,10 @@ bool npuHaspParseFileParams(u8 *mp, int len, Tcb *tp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuHaspLog, "Unknown file FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
-#endif
+            if (DevLogEnabled(npuHaspLog, DevLogError))
+                {
+                devLogText(npuHaspLog, "Unknown file FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
+                }
             break;
             }
 
@@ -2352,18 +2398,10 @@ void npuHaspPresetPcb(Pcb *pcbp)
     int i;
     Scb *scbp;
 
-#if DEBUG
     if (npuHaspLog == NULL)
         {
-        npuHaspLog = fopen("hasplog.txt", "wt");
-        if (npuHaspLog == NULL)
-            {
-            logDtError(LogErrorLocation, "hasplog.txt - aborting\n");
-            exit(1);
-            }
-        npuHaspLogFlush();    // initialize log buffer
+        npuHaspLog = devLogRegister("npuhasp");
         }
-#endif
 
     pcbp->controls.hasp.lastBlockSent = NULL;
     pcbp->controls.hasp.retries       = 0;
@@ -2458,6 +2496,111 @@ void npuHaspResetPcb(Pcb *pcbp)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Encode the content of a record as a sequence of strings,
+**                  each introduced by a String Control Byte (SCB). When
+**                  compression is requested, runs of blanks and runs of
+**                  other duplicate characters are encoded with the blank
+**                  and duplicate character SCB forms. The end-of-record SCB
+**                  is not appended.
+**
+**                  The encoded form is never longer than the uncompressed
+**                  form, so callers may size output space for the latter.
+**
+**  Parameters:     Name        Description.
+**                  dst         pointer to output area
+**                  src         pointer to the content of the record
+**                  len         length of the content
+**                  compress    TRUE if compression is to be applied
+**
+**  Returns:        Number of bytes stored at dst.
+**
+**------------------------------------------------------------------------*/
+int npuHaspEncodeStrings(u8 *dst, u8 *src, int len, bool compress)
+    {
+    u8  *dp;
+    int litLen;
+    u8  *litStart;
+    int n;
+    int run;
+
+    dp = dst;
+
+    if (!compress)
+        {
+        while (len > 0)
+            {
+            n     = (len > MaxScbString) ? MaxScbString : len;
+            *dp++ = 0xc0 | n; // Non-duplicate string
+            memcpy(dp, src, n);
+            dp  += n;
+            src += n;
+            len -= n;
+            }
+
+        return (int)(dp - dst);
+        }
+
+    litStart = src;
+    litLen   = 0;
+    while (len > 0)
+        {
+        run = npuHaspRunLength(src, len);
+        if (run >= ((*src == EbcdicBlank) ? MinBlankRun : MinDupRun))
+            {
+            /*
+            **  Flush pending non-duplicate string, then encode the run in
+            **  segments of at most 31 characters. A short tail of the run
+            **  starts the next non-duplicate string.
+            */
+            while (litLen > 0)
+                {
+                n     = (litLen > MaxScbString) ? MaxScbString : litLen;
+                *dp++ = 0xc0 | n;
+                memcpy(dp, litStart, n);
+                dp       += n;
+                litStart += n;
+                litLen   -= n;
+                }
+            src += run;
+            len -= run;
+            while (run >= ((*litStart == EbcdicBlank) ? MinBlankRun : MinDupRun))
+                {
+                n = (run > MaxScbRun) ? MaxScbRun : run;
+                if (*litStart == EbcdicBlank)
+                    {
+                    *dp++ = 0x80 | n; // Duplicate blanks
+                    }
+                else
+                    {
+                    *dp++ = 0xa0 | n; // Duplicate character
+                    *dp++ = *litStart;
+                    }
+                litStart += n;
+                run      -= n;
+                }
+            litLen = run;
+            }
+        else
+            {
+            src    += run;
+            len    -= run;
+            litLen += run;
+            }
+        }
+    while (litLen > 0)
+        {
+        n     = (litLen > MaxScbString) ? MaxScbString : litLen;
+        *dp++ = 0xc0 | n;
+        memcpy(dp, litStart, n);
+        dp       += n;
+        litStart += n;
+        litLen   -= n;
+        }
+
+    return (int)(dp - dst);
+    }
+
 /*
  **--------------------------------------------------------------------------
  **
@@ -2477,9 +2620,10 @@ void npuHaspResetPcb(Pcb *pcbp)
 **------------------------------------------------------------------------*/
 static void npuHaspCloseConnection(Pcb *pcbp)
     {
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: close connection\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: close connection\n", pcbp->claPort);
+        }
     if (pcbp->controls.hasp.consoleStream.tp != NULL)
         {
         npuSvmSendDiscRequest(pcbp->controls.hasp.consoleStream.tp);
@@ -3622,10 +3766,11 @@ static int npuHaspSendRecordHeader(Tcb *tp, u8 srcb)
         break;
 
     default:
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: invalid HASP output stream type %u\n",
-                tp->pcbp->claPort, tp->deviceType);
-#endif
+        if (DevLogEnabled(npuHaspLog, DevLogError))
+            {
+            devLogText(npuHaspLog, "Port %02x: invalid HASP output stream type %u\n",
+                       tp->pcbp->claPort, tp->deviceType);
+            }
 
         return 0;
         }
@@ -3647,37 +3792,78 @@ static int npuHaspSendRecordHeader(Tcb *tp, u8 srcb)
 **------------------------------------------------------------------------*/
 static int npuHaspSendRecordStrings(Tcb *tp, u8 *data, int len)
     {
-    u8  header[16];
-    int n;
+    u8   buf[RecordChunkSize + (RecordChunkSize / MaxScbString) + 2];
+    bool compress;
+    int  chunk;
+    int  i;
+    int  n;
 
     /*
     **  Send strings comprising of the record. Each string begins with
-    **  an SCB byte definiing the length of the string. The maximum
-    **  length of a string is 63 bytes, so a record longer than 63 bytes
-    **  must be segmented into multiple strings. The record must end with
-    **  an end-of-record SCB.
+    **  an SCB byte defining the length of the string, and the record
+    **  must end with an end-of-record SCB. The record is encoded in
+    **  chunks so that each chunk is handed to the network in one call.
     */
-    n = 0;
-    while (len > 0x3f)
+    compress = tp->pcbp->controls.hasp.isCompressing;
+    n        = 0;
+    while (len > 0)
         {
-        header[0] = (1 << 7) | (1 << 6) | 0x3f; // Non-duplicate string, max length
-        npuNetSend(tp, header, 1);
-        npuNetSend(tp, data, 63);
-        data += 63;
-        len  -= 63;
-        n    += 64;
+        chunk = (len > RecordChunkSize) ? RecordChunkSize : len;
+        i     = npuHaspEncodeStrings(buf, data, chunk, compress);
+        if (chunk == len)
+            {
+            buf[i++] = 0; // End of record
+            }
+        npuNetSend(tp, buf, i);
+        data += chunk;
+        len  -= chunk;
+        n    += i;
         }
-    if (len > 0)
+    if (n == 0)
         {
-        header[0] = (1 << 7) | (1 << 6) | len; // Non-duplicate string, remaining record length
-        npuNetSend(tp, header, 1);
-        npuNetSend(tp, data, len);
-        n += len + 1;
+        buf[0] = 0;
+        npuNetSend(tp, buf, 1);
+        n = 1;
         }
-    header[0] = 0;
-    npuNetSend(tp, header, 1);
 
-    return n + 1;
+    return n;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine the length of the run of identical bytes
+**                  at the start of a buffer. Eight bytes at a time are
+**                  compared while the run continues.
+**
+**  Parameters:     Name        Description.
+**                  data        pointer to the bytes
+**                  len         number of bytes available (at least 1)
+**
+**  Returns:        Length of the run.
+**
+**------------------------------------------------------------------------*/
+static int npuHaspRunLength(u8 *data, int len)
+    {
+    int n;
+    u64 pattern;
+    u64 word;
+
+    pattern = (u64)data[0] * 0x0101010101010101ULL;
+    n       = 1;
+    while (n + 8 <= len)
+        {
+        memcpy(&word, data + n, 8);
+        if (word != pattern)
+            {
+            break;
+            }
+        n += 8;
+        }
+    while ((n < len) && (data[n] == data[0]))
+        {
+        n += 1;
+        }
+
+    return n;
     }
 
 /*--------------------------------------------------------------------------
@@ -3798,12 +3984,12 @@ static void npuHaspSendUplineEoiAcctg(Tcb *tp, u8 sfc)
     scbp->lastSRCB              = 0;
     scbp->pruFragmentSize       = 0;
     scbp->isPruFragmentComplete = tp->deviceType == DtLP;
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: send AD/EI command to host for stream %u (%.7s)\n",
-            tp->pcbp->claPort, tp->streamId, tp->termName);
-    npuHaspLogBytes(command, sizeof(command), ASCII);
-    npuHaspLogFlush();
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: send AD/EI command to host for stream %u (%.7s)\n",
+                   tp->pcbp->claPort, tp->streamId, tp->termName);
+        npuHaspLogBytes(command, sizeof(command), ASCII);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -3836,12 +4022,12 @@ static void npuHaspSendUplineEOS(Tcb *tp)
         tp->uplineBsn = 1;
         }
     npuHaspSendUplineData(tp, commandEOS, sizeof(commandEOS));
-#if DEBUG
-    fprintf(npuHaspLog, "Port %02x: send end of stream command to host for stream %u (%.7s)\n",
-            tp->pcbp->claPort, tp->streamId, tp->termName);
-    npuHaspLogBytes(commandEOS, sizeof(commandEOS), ASCII);
-    npuHaspLogFlush();
-#endif
+    if (DevLogEnabled(npuHaspLog, DevLogInfo))
+        {
+        devLogText(npuHaspLog, "Port %02x: send end of stream command to host for stream %u (%.7s)\n",
+                   tp->pcbp->claPort, tp->streamId, tp->termName);
+        npuHaspLogBytes(commandEOS, sizeof(commandEOS), ASCII);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -3857,7 +4043,6 @@ static void npuHaspSendUplineEOS(Tcb *tp)
 **------------------------------------------------------------------------*/
 static void npuHaspStageUplineData(Scb *scbp, u8 *data, int len)
     {
-    int i;
     Ncb *ncbp;
     Tcb *tp;
 
@@ -3866,20 +4051,9 @@ static void npuHaspStageUplineData(Scb *scbp, u8 *data, int len)
 
     if (ncbp->connType == ConnTypeHasp)
         {
-        if (tp->deviceType == DtCONSOLE)
-            {
-            for (i = 0; i < len; i++)
-                {
-                *tp->inBufPtr++ = ebcdicToAscii[*data++];
-                }
-            }
-        else
-            {
-            for (i = 0; i < len; i++)
-                {
-                *tp->inBufPtr++ = asciiToCdc[ebcdicToAscii[*data++]];
-                }
-            }
+        charsetTranslate(tp->inBufPtr, data, len,
+                         (tp->deviceType == DtCONSOLE) ? ebcdicToAscii : ebcdicToCdc);
+        tp->inBufPtr += len;
         }
     else // ncbp->connType == ConnTypeRevHasp
         {
@@ -3887,10 +4061,8 @@ static void npuHaspStageUplineData(Scb *scbp, u8 *data, int len)
             {
             tp->inBufPtr += 1; // reserve byte for transparent record length
             }
-        for (i = 0; i < len; i++)
-            {
-            *tp->inBufPtr++ = *data++;
-            }
+        memcpy(tp->inBufPtr, data, len);
+        tp->inBufPtr += len;
         }
     }
 
@@ -3982,20 +4154,20 @@ static void npuHaspTransmitQueuedBlocks(Tcb *tp)
             {
             tp->uplineBlockLimit -= 1;
             npuBipRequestUplineTransfer(bp);
-#if DEBUG
-            fprintf(npuHaspLog, "Port %02x: send upline data to host for stream %u (%.7s), block type %u, block len %d, dbc %02x\n",
-                    tp->pcbp->claPort, tp->streamId, tp->termName, bp->data[BlkOffBTBSN] & BlkMaskBT, bp->numBytes,
-                    bp->data[BlkOffDbc]);
-            if (tp->pcbp->ncbp->connType == ConnTypeHasp)
+            if (DevLogEnabled(npuHaspLog, DevLogDebug))
                 {
-                npuHaspLogBytes(bp->data, bp->numBytes, (tp->deviceType == DtCONSOLE) ? ASCII : DisplayCode);
-                }
-            else
-                {
-                npuHaspLogBytes(bp->data, bp->numBytes, EBCDIC);
+                devLogText(npuHaspLog, "Port %02x: send upline data to host for stream %u (%.7s), block type %u, block len %d, dbc %02x\n",
+                           tp->pcbp->claPort, tp->streamId, tp->termName, bp->data[BlkOffBTBSN] & BlkMaskBT, bp->numBytes,
+                           bp->data[BlkOffDbc]);
+                if (tp->pcbp->ncbp->connType == ConnTypeHasp)
+                    {
+                    npuHaspLogBytes(bp->data, bp->numBytes, (tp->deviceType == DtCONSOLE) ? ASCII : DisplayCode);
+                    }
+                else
+                    {
+                    npuHaspLogBytes(bp->data, bp->numBytes, EBCDIC);
+                    }
                 }
-            npuHaspLogFlush();
-#endif
             }
         }
     }
@@ -4090,48 +4262,25 @@ static int npuHaspSend(Pcb *pcbp, u8 *data, int len)
     n = send(pcbp->connFd, data, len, 0);
     if (n >= 0)
         {
+        pcbp->bytesOut                  += n;
         pcbp->controls.hasp.recvDeadline = getMilliseconds() + RecvTimeout;
-#if DEBUG
-        fprintf(npuHaspLog, "Port %02x: sent to terminal\n", pcbp->claPort);
-        npuHaspLogBytes(data, n, EBCDIC);
-        npuHaspLogFlush();
+        if (DevLogEnabled(npuHaspLog, DevLogDebug))
+            {
+            devLogText(npuHaspLog, "Port %02x: sent to terminal\n", pcbp->claPort);
+            npuHaspLogBytes(data, n, EBCDIC);
+            }
         }
-    else
+    else if (DevLogEnabled(npuHaspLog, DevLogError))
         {
-        fprintf(npuHaspLog, "Port %02x: send failed, rc=%d\n", pcbp->claPort, errno);
+        devLogText(npuHaspLog, "Port %02x: send failed, rc=%d\n", pcbp->claPort, errno);
         npuHaspLogBytes(data, len, EBCDIC);
-        npuHaspLogFlush();
-#endif
         }
 
     return n;
     }
 
-#if DEBUG
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuHaspLogFlush(void)
-    {
-    if (npuHaspLogBytesCol > 0)
-        {
-        fputs(npuHaspLogBuf, npuHaspLog);
-        fputc('\n', npuHaspLog);
-        fflush(npuHaspLog);
-        }
-    npuHaspLogBytesCol = 0;
-    memset(npuHaspLogBuf, ' ', LogLineLength);
-    npuHaspLogBuf[LogLineLength] = '\0';
-    }
-
 /*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of ASCII or EBCDIC bytes
+**  Purpose:        Log a sequence of ASCII, EBCDIC or display code bytes
 **
 **  Parameters:     Name        Description.
 **                  bytes       pointer to sequence of bytes
@@ -4146,16 +4295,23 @@ static void npuHaspLogBytes(u8 *bytes, int len, CharEncoding encoding)
     u8   ac;
     int  ascCol;
     u8   b;
+    int  col;
     char hex[3];
     int  hexCol;
     int  i;
+    char line[LogLineLength + 1];
 
-    ascCol = AsciiColumn(npuHaspLogBytesCol);
-    hexCol = HexColumn(npuHaspLogBytesCol);
-
+    col = 0;
     for (i = 0; i < len; i++)
         {
-        b = bytes[i];
+        if (col == 0)
+            {
+            memset(line, ' ', LogLineLength);
+            line[LogLineLength] = '\0';
+            }
+        ascCol = AsciiColumn(col);
+        hexCol = HexColumn(col);
+        b      = bytes[i];
         switch (encoding)
             {
         default:
@@ -4176,16 +4332,18 @@ static void npuHaspLogBytes(u8 *bytes, int len, CharEncoding encoding)
             ac = '.';
             }
         sprintf(hex, "%02x", b);
-        memcpy(npuHaspLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        npuHaspLogBuf[ascCol++] = ac;
-        if (++npuHaspLogBytesCol >= 16)
+        memcpy(line + hexCol, hex, 2);
+        line[ascCol] = ac;
+        if (++col >= 16)
             {
-            npuHaspLogFlush();
-            ascCol = AsciiColumn(npuHaspLogBytesCol);
-            hexCol = HexColumn(npuHaspLogBytesCol);
+            devLogText(npuHaspLog, "%s\n", line);
+            col = 0;
             }
         }
+    if (col > 0)
+        {
+        devLogText(npuHaspLog, "%s\n", line);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -4233,7 +4391,7 @@ static void npuHaspLogDevParam(Tcb *tp, u8 fn, u8 fv)
         kw = kbuf;
         break;
         }
-    fprintf(npuHaspLog, "Set batch device parameter, connection %u (%.7s), %s=<%02x>\n", tp->cn, tp->termName, kw, fv);
+    devLogText(npuHaspLog, "Set batch device parameter, connection %u (%.7s), %s=<%02x>\n", tp->cn, tp->termName, kw, fv);
     }
 
 /*--------------------------------------------------------------------------
@@ -4285,35 +4443,7 @@ static void npuHaspLogFileParam(Tcb *tp, u8 fn, u8 fv)
         kw = kbuf;
         break;
         }
-    fprintf(npuHaspLog, "Set batch file parameter, connection %u (%.7s), %s=<%02x>\n", tp->cn, tp->termName, kw, fv);
+    devLogText(npuHaspLog, "Set batch file parameter, connection %u (%.7s), %s=<%02x>\n", tp->cn, tp->termName, kw, fv);
     }
 
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a stack trace
-**
-**  Parameters:     none
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuHaspPrintStackTrace(FILE *fp)
-    {
-#if defined(__APPLE__)
-    void *callstack[128];
-    int  i;
-    int  frames;
-    char **strs;
-
-    frames = backtrace(callstack, 128);
-    strs   = backtrace_symbols(callstack, frames);
-    for (i = 1; i < frames; ++i)
-        {
-        fprintf(fp, "%s\n", strs[i]);
-        }
-    free(strs);
-#endif
-    }
-
-#endif // DEBUG
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -24,8 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -120,12 +118,6 @@
 #define CyclesOneSecond            100000
 #define ReportInitCount            4
 
-#if DEBUG
-#define HexColumn(x)      (4 * (x) + 1 + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
-
 /*
 **  -----------------------
 **  Private Macro Functions
@@ -163,12 +155,6 @@ static bool npuHipDownlineBlockImpl(NpuBuffer *bp);
 static bool npuHipUplineBlockImpl(NpuBuffer *bp);
 static char *npuHipFunc2String(PpWord funcCode);
 
-#if DEBUG
-static void npuLogFlush(void);
-static void npuLogByte(int b);
-
-#endif
-
 /*
 **  ----------------
 **  Public Variables
@@ -178,9 +164,7 @@ bool (*npuHipDownlineBlockFunc)(NpuBuffer *bp);
 void (*npuHipResetFunc)(void);
 bool (*npuHipUplineBlockFunc)(NpuBuffer *bp);
 
-#if DEBUG
-FILE *npuLog = NULL;
-#endif
+DevLogModule *npuLog = NULL;
 
 /*
 **  -----------------
@@ -199,11 +183,6 @@ static enum
     }
 hipState = StHipInit;
 
-#if DEBUG
-static char npuLogBuf[LogLineLength + 1];
-static int  npuLogCol = 0;
-#endif
-
 /*
  **--------------------------------------------------------------------------
  **
@@ -230,12 +209,7 @@ void npuInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     (void)unitNo;
     (void)deviceName;
 
-#if DEBUG
-    if (npuLog == NULL)
-        {
-        npuLog = fopen("npulog.txt", "wt");
-        }
-#endif
+    npuLog = devLogRegister("npu");
 
     /*
     ** set HCP software type, exit if npuSw is not SwUndefined
@@ -255,6 +229,7 @@ void npuInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName)
     dp->disconnect   = npuHipDisconnect;
     dp->func         = npuHipFunc;
     dp->io           = npuHipIo;
+    dp->blockIo      = TRUE;
     dp->selectedUnit = unitNo;
     activeDevice     = dp;
 
@@ -399,16 +374,21 @@ bool npuHipDownlineBlockImpl(NpuBuffer *bp)
 **------------------------------------------------------------------------*/
 void npuLogMessage(char *format, ...)
     {
-#if DEBUG
     va_list args;
+    char    buf[512];
+
+    /*
+    **  Also called by modules shared with the CCI, which has no NPU log.
+    */
+    if ((npuLog == NULL) || !DevLogEnabled(npuLog, DevLogInfo))
+        {
+        return;
+        }
 
-    npuLogFlush();
-    fprintf(npuLog, "\n\n");
     va_start(args, format);
-    vfprintf(npuLog, format, args);
+    vsnprintf(buf, sizeof(buf), format, args);
     va_end(args);
-    fprintf(npuLog, "\n");
-#endif
+    devLogText(npuLog, "\n\n%s\n", buf);
     }
 
 /*
@@ -460,25 +440,23 @@ static FcStatus npuHipFunc(PpWord funcCode)
 
     funcCode &= ~FcNpuEqMask;
 
-#if DEBUG
-    npuLogFlush();
-    if (funcCode != FcNpuInCouplerStatus)
+    if ((funcCode != FcNpuInCouplerStatus) && DevLogEnabled(npuLog, DevLogDebug))
         {
-        fprintf(npuLog, "\n(npu_hip) %06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
-                traceSequenceNo,
-                activePpu->id,
-                activeChannel->id,
-                funcCode,
-                npuHipFunc2String(funcCode));
+        devLogText(npuLog, "\n(npu_hip) %06d PP:%02o CH:%02o f:%04o T:%-25s  >   ",
+                   traceSequenceNo,
+                   activePpu->id,
+                   activeChannel->id,
+                   funcCode,
+                   npuHipFunc2String(funcCode));
         }
-#endif
 
     switch (funcCode)
         {
     default:
-#if DEBUG
-        fprintf(npuLog, " FUNC not implemented & declined!");
-#endif
+        if (DevLogEnabled(npuLog, DevLogDebug))
+            {
+            devLogText(npuLog, " FUNC not implemented & declined!");
+            }
 
         return (FcDeclined);
 
@@ -622,34 +600,34 @@ static void npuHipIo(void)
     case FcNpuInNpuStatus:
         activeChannel->data = npuHipReadNpuStatus();
         activeChannel->full = TRUE;
-#if DEBUG
-        fprintf(npuLog, " %03X", activeChannel->data);
-#endif
+        if (DevLogEnabled(npuLog, DevLogDebug))
+            {
+            devLogText(npuLog, " %03X", activeChannel->data);
+            }
         break;
 
     case FcNpuInCouplerStatus:
         activeChannel->data = npu->regCouplerStatus;
         activeChannel->full = TRUE;
-#if DEBUG
-        if (npu->regCouplerStatus != 0)
+        if ((npu->regCouplerStatus != 0) && DevLogEnabled(npuLog, DevLogDebug))
             {
-            fprintf(npuLog, "\n(npu_hip) %06d PP:%02o CH:%02o f:%04o T:%-25s  >    %03X",
-                    traceSequenceNo,
-                    activePpu->id,
-                    activeChannel->id,
-                    FcNpuInCouplerStatus,
-                    npuHipFunc2String(FcNpuInCouplerStatus),
-                    activeChannel->data);
+            devLogText(npuLog, "\n(npu_hip) %06d PP:%02o CH:%02o f:%04o T:%-25s  >    %03X",
+                       traceSequenceNo,
+                       activePpu->id,
+                       activeChannel->id,
+                       FcNpuInCouplerStatus,
+                       npuHipFunc2String(FcNpuInCouplerStatus),
+                       activeChannel->data);
             }
-#endif
         break;
 
     case FcNpuInNpuOrder:
         activeChannel->data = npu->regOrder;
         activeChannel->full = TRUE;
-#if DEBUG
-        fprintf(npuLog, " %03X", activeChannel->data);
-#endif
+        if (DevLogEnabled(npuLog, DevLogDebug))
+            {
+            devLogText(npuLog, " %03X", activeChannel->data);
+            }
         break;
 
     case FcNpuInData:
@@ -675,9 +653,10 @@ static void npuHipIo(void)
                 hipState = StHipIdle;
                 npuBipNotifyUplineSent();
                 }
-#if DEBUG
-            npuLogByte(activeChannel->data);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                devLogWords(npuLog, &activeChannel->data, 1);
+                }
             }
 
         break;
@@ -685,9 +664,11 @@ static void npuHipIo(void)
     case FcNpuOutData:
         if (activeChannel->full)
             {
-#if DEBUG
-            npuLogByte(activeChannel->data);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                devLogWords(npuLog, &activeChannel->data, 1);
+                }
+
             activeChannel->full = FALSE;
             if (activeDevice->recordLength < MaxBuffer)
                 {
@@ -720,7 +701,6 @@ static void npuHipIo(void)
     case FcNpuOutNpuOrder:
         if (activeChannel->full)
             {
-#if DEBUG
             static char *orderCode[] =
                 {
                 "",
@@ -733,9 +713,12 @@ static void npuHipIo(void)
                 ""
                 };
 
-            fprintf(npuLog, " Order word %03X - function %02X : %s",
-                    activeChannel->data, activeChannel->data >> 8, orderCode[(activeChannel->data >> 8) & 7]);
-#endif
+            if (DevLogEnabled(npuLog, DevLogDebug))
+                {
+                devLogText(npuLog, " Order word %03X - function %02X : %s",
+                           activeChannel->data, activeChannel->data >> 8, orderCode[(activeChannel->data >> 8) & 7]);
+                }
+
             npu->regOrder       = activeChannel->data;
             orderType           = activeChannel->data & OrdMaskType;
             orderValue          = (u8)(activeChannel->data & OrdMaskValue);
@@ -879,7 +862,6 @@ static char *npuHipFunc2String(PpWord funcCode)
     {
     static char buf[40];
 
-#if DEBUG
     switch (funcCode)
         {
     case FcNpuInData:
@@ -924,66 +906,10 @@ static char *npuHipFunc2String(PpWord funcCode)
     case FcNpuClearCoupler:
         return "FcNpuClearCoupler";
         }
-#endif
+
     sprintf(buf, "(npu_hip) Unknown Function: %04o", funcCode);
 
     return (buf);
     }
 
-#if DEBUG
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete numeric/ascii data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuLogFlush(void)
-    {
-    if (npuLogCol != 0)
-        {
-        fputs(npuLogBuf, npuLog);
-        }
-
-    npuLogCol = 0;
-    memset(npuLogBuf, ' ', LogLineLength);
-    npuLogBuf[0]             = '\n';
-    npuLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a byte in hex/ascii form
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuLogByte(int b)
-    {
-    char hex[5];
-    int  col;
-
-    col = HexColumn(npuLogCol);
-    sprintf(hex, "%03X ", b);
-    memcpy(npuLogBuf + col, hex, 4);
-
-    col = AsciiColumn(npuLogCol);
-    b  &= 0x7f;
-    if ((b < 0x20) || (b >= 0x7f))
-        {
-        b = '.';
-        }
-
-    npuLogBuf[col] = b;
-    if (++npuLogCol == 16)
-        {
-        npuLogFlush();
-        }
-    }
-
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
@@ -28,8 +28,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -63,10 +61,6 @@
 #include <strings.h>
 #endif
 
-#if defined(__APPLE__)
-#include <execinfo.h>
-#endif
-
 /*
 **  -----------------
 **  Private Constants
@@ -80,11 +74,6 @@
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG
-#define HexColumn(x)      (3 * (x) + 4)
-#define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
 
 /*
 **  -----------------------------------------
@@ -104,13 +93,6 @@ static bool npuLipProcessConnectResponse(Pcb *pcbp);
 static bool npuLipSendConnectRequest(Pcb *pcbp);
 static void npuLipSendQueuedData(Pcb *pcbp);
 
-#if DEBUG
-static void npuLipLogBytes(u8 *bytes, int len);
-static void npuLipLogFlush(void);
-static void npuLipPrintStackTrace(FILE *fp);
-
-#endif
-
 /*
 **  ----------------
 **  Public Variables
@@ -123,11 +105,7 @@ u8 npuLipTrunkCount = 0;
 **  Private Variables
 **  -----------------
 */
-#if DEBUG
-static FILE *npuLipLog = NULL;
-static char npuLipLogBuf[LogLineLength + 1];
-static int  npuLipLogBytesCol = 0;
-#endif
+static DevLogModule *npuLipLog = NULL;
 
 /*
  **--------------------------------------------------------------------------
@@ -154,16 +132,18 @@ bool npuLipNotifyNetConnect(Pcb *pcbp, bool isPassive)
     if (isPassive)
         {
         pcbp->controls.lip.state = StTrunkRcvConnReq;
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: trunk connection indication\n", pcbp->claPort);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: trunk connection indication\n", pcbp->claPort);
+            }
         }
     else
         {
         pcbp->controls.lip.state = StTrunkSndConnReq;
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: trunk connection request completed\n", pcbp->claPort);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: trunk connection request completed\n", pcbp->claPort);
+            }
         }
 
     return TRUE;
@@ -186,9 +166,10 @@ void npuLipNotifyNetDisconnect(Pcb *pcbp)
         }
     npuNetCloseConnection(pcbp);
     pcbp->controls.lip.state = StTrunkDisconnected;
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: trunk disconnection indication\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: trunk disconnection indication\n", pcbp->claPort);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -202,18 +183,10 @@ void npuLipNotifyNetDisconnect(Pcb *pcbp)
 **------------------------------------------------------------------------*/
 void npuLipPresetPcb(Pcb *pcbp)
     {
-#if DEBUG
     if (npuLipLog == NULL)
         {
-        npuLipLog = fopen("liplog.txt", "wt");
-        if (npuLipLog == NULL)
-            {
-            logDtError(LogErrorLocation, "liplog.txt - aborting\n");
-            exit(1);
-            }
-        npuLipLogFlush(); // initialize log buffer
+        npuLipLog = devLogRegister("npulip");
         }
-#endif
     pcbp->controls.lip.stagingBuf = (u8 *)malloc(MaxBuffer);
     if (pcbp->controls.lip.stagingBuf == NULL)
         {
@@ -239,11 +212,11 @@ void npuLipProcessUplineData(Pcb *pcbp)
     int n;
     int stagingCount;
 
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: received data\n", pcbp->claPort);
-    npuLipLogBytes(pcbp->inputData, pcbp->inputCount);
-    npuLipLogFlush();
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: received data\n", pcbp->claPort);
+        devLogBytes(npuLipLog, pcbp->inputData, pcbp->inputCount);
+        }
 
     pcbp->controls.lip.lastExchange = getSeconds();
     pcbp->controls.lip.inputIndex   = 0;
@@ -320,19 +293,21 @@ void npuLipProcessUplineData(Pcb *pcbp)
                 {
                 logDtError(LogErrorLocation, "Invalid block length %d received from %s\n",
                            pcbp->controls.lip.blockLength, pcbp->ncbp->hostName);
-#if DEBUG
-                fprintf(npuLipLog, "Port %02x: invalid block length %d received from %s\n", pcbp->claPort,
-                        pcbp->controls.lip.blockLength, pcbp->ncbp->hostName);
-#endif
+                if (DevLogEnabled(npuLipLog, DevLogInfo))
+                    {
+                    devLogText(npuLipLog, "Port %02x: invalid block length %d received from %s\n", pcbp->claPort,
+                               pcbp->controls.lip.blockLength, pcbp->ncbp->hostName);
+                    }
                 npuLipNotifyNetDisconnect(pcbp);
 
                 return;
                 }
             else if (pcbp->controls.lip.blockLength < 1)
                 {
-#if DEBUG
-                fprintf(npuLipLog, "Port %02x: received ping from %s\n", pcbp->claPort, pcbp->ncbp->hostName);
-#endif
+                if (DevLogEnabled(npuLipLog, DevLogInfo))
+                    {
+                    devLogText(npuLipLog, "Port %02x: received ping from %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+                    }
                 pcbp->controls.lip.state = StTrunkRcvBlockLengthHi;
                 }
             break;
@@ -353,9 +328,10 @@ void npuLipProcessUplineData(Pcb *pcbp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuLipLog, "Port %02x: invalid LIP state: %d\n", pcbp->claPort, pcbp->controls.lip.state);
-#endif
+            if (DevLogEnabled(npuLipLog, DevLogInfo))
+                {
+                devLogText(npuLipLog, "Port %02x: invalid LIP state: %d\n", pcbp->claPort, pcbp->controls.lip.state);
+                }
             break;
             }
         }
@@ -383,9 +359,10 @@ void npuLipResetPcb(Pcb *pcbp)
         {
         npuBipBufRelease(bp);
         }
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: trunk PCB reset\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: trunk PCB reset\n", pcbp->claPort);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -410,10 +387,11 @@ void npuLipTryOutput(Pcb *pcbp)
         if ((pcbp->controls.lip.lastExchange > 0)
             && ((getSeconds() - pcbp->controls.lip.lastExchange) > MaxIdleTime))
             {
-#if DEBUG
-            fprintf(npuLipLog, "Port %02x: timeout while establishing connection with %s\n",
-                    pcbp->claPort, pcbp->ncbp->hostName);
-#endif
+            if (DevLogEnabled(npuLipLog, DevLogInfo))
+                {
+                devLogText(npuLipLog, "Port %02x: timeout while establishing connection with %s\n",
+                           pcbp->claPort, pcbp->ncbp->hostName);
+                }
             npuNetCloseConnection(pcbp);
             pcbp->controls.lip.state = StTrunkDisconnected;
             }
@@ -473,9 +451,10 @@ void npuLipProcessDownlineData(NpuBuffer *bp)
                 }
             }
         logDtError(LogErrorLocation, "Block received for unknown or disconnected node %02x\n", dn);
-#if DEBUG
-        fprintf(npuLipLog, "Block received for unknown or disconnected node: %02x\n", dn);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Block received for unknown or disconnected node: %02x\n", dn);
+            }
         npuBipBufRelease(bp);
         }
     }
@@ -516,17 +495,19 @@ static bool npuLipSendConnectRequest(Pcb *pcbp)
     n   = send(pcbp->connFd, request, len, 0);
     if (n == len)
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: connect request sent to %s: %s", pcbp->claPort, pcbp->ncbp->hostName, request);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: connect request sent to %s: %s", pcbp->claPort, pcbp->ncbp->hostName, request);
+            }
 
         return TRUE;
         }
     else
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: failed to send connect request to %s: %s", pcbp->claPort, pcbp->ncbp->hostName, request);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: failed to send connect request to %s: %s", pcbp->claPort, pcbp->ncbp->hostName, request);
+            }
 
         return FALSE;
         }
@@ -563,9 +544,10 @@ static bool npuLipProcessConnectRequest(Pcb *pcbp)
     Pcb  *trunkPcbp;
     long value;
 
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: connect request received: %s\n", pcbp->claPort, pcbp->controls.lip.stagingBuf);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: connect request received: %s\n", pcbp->claPort, pcbp->controls.lip.stagingBuf);
+        }
 
     /*
     **  Parse CONNECT request
@@ -676,9 +658,10 @@ static bool npuLipProcessConnectRequest(Pcb *pcbp)
             {
             if (trunkPcbp != pcbp)
                 {
-#if DEBUG
-                fprintf(npuLipLog, "Port %02x: connection reassigned to port %02x\n", pcbp->claPort, trunkPcbp->claPort);
-#endif
+                if (DevLogEnabled(npuLipLog, DevLogInfo))
+                    {
+                    devLogText(npuLipLog, "Port %02x: connection reassigned to port %02x\n", pcbp->claPort, trunkPcbp->claPort);
+                    }
                 npuLipResetPcb(trunkPcbp);
                 trunkPcbp->connFd = pcbp->connFd;
                 pcbp->connFd      = 0;
@@ -686,26 +669,29 @@ static bool npuLipProcessConnectRequest(Pcb *pcbp)
                 }
             pcbp->controls.lip.state = StTrunkRcvBlockLengthHi;
             pcbp->ncbp->state        = StConnConnected;
-#if DEBUG
-            fprintf(npuLipLog, "Port %02x: connect response sent: %s", pcbp->claPort, response);
-#endif
+            if (DevLogEnabled(npuLipLog, DevLogInfo))
+                {
+                devLogText(npuLipLog, "Port %02x: connect response sent: %s", pcbp->claPort, response);
+                }
 
             return TRUE;
             }
         else
             {
-#if DEBUG
-            fprintf(npuLipLog, "Port %02x: connect response sent: %s", pcbp->claPort, response);
-#endif
+            if (DevLogEnabled(npuLipLog, DevLogInfo))
+                {
+                devLogText(npuLipLog, "Port %02x: connect response sent: %s", pcbp->claPort, response);
+                }
 
             return FALSE;
             }
         }
     else
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: failed to send connect response\n", pcbp->claPort);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: failed to send connect response\n", pcbp->claPort);
+            }
 
         return FALSE;
         }
@@ -725,10 +711,11 @@ static bool npuLipProcessConnectResponse(Pcb *pcbp)
     char *token;
     long value;
 
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: received connect response from %s\n", pcbp->claPort, pcbp->ncbp->hostName);
-    fprintf(npuLipLog, "  %s", pcbp->controls.lip.stagingBuf);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: received connect response from %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+        devLogText(npuLipLog, "  %s", pcbp->controls.lip.stagingBuf);
+        }
 
     token = strtok((char *)pcbp->controls.lip.stagingBuf, " \r\n");
     if (token == NULL)
@@ -753,10 +740,11 @@ static bool npuLipProcessConnectResponse(Pcb *pcbp)
 
     if (strcasecmp(token, pcbp->ncbp->hostName) != 0)
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: received incorrect host ID '%s' from %s\n", pcbp->claPort,
-                token, pcbp->ncbp->hostName);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: received incorrect host ID '%s' from %s\n", pcbp->claPort,
+                       token, pcbp->ncbp->hostName);
+            }
 
         return FALSE;
         }
@@ -773,10 +761,11 @@ static bool npuLipProcessConnectResponse(Pcb *pcbp)
     value = strtol(token, NULL, 10);
     if (value != pcbp->controls.lip.remoteNode)
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: received incorrect remote node number %ld from %s, expected %d\n", pcbp->claPort,
-                value, pcbp->ncbp->hostName, pcbp->controls.lip.remoteNode);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: received incorrect remote node number %ld from %s, expected %d\n", pcbp->claPort,
+                       value, pcbp->ncbp->hostName, pcbp->controls.lip.remoteNode);
+            }
 
         return FALSE;
         }
@@ -793,20 +782,22 @@ static bool npuLipProcessConnectResponse(Pcb *pcbp)
     value = strtol(token, NULL, 10);
     if (value != npuSvmCouplerNode)
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: received incorrect local node number %ld from %s, expected %d\n", pcbp->claPort,
-                value, pcbp->ncbp->hostName, npuSvmCouplerNode);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: received incorrect local node number %ld from %s, expected %d\n", pcbp->claPort,
+                       value, pcbp->ncbp->hostName, npuSvmCouplerNode);
+            }
 
         return FALSE;
         }
 
     if (npuLipActivateTrunk(pcbp) == FALSE)
         {
-#if DEBUG
-        fprintf(npuLipLog, "Port %02x: resource exhaustion prevented activation of trunk to %s\n", pcbp->claPort,
-                pcbp->ncbp->hostName);
-#endif
+        if (DevLogEnabled(npuLipLog, DevLogInfo))
+            {
+            devLogText(npuLipLog, "Port %02x: resource exhaustion prevented activation of trunk to %s\n", pcbp->claPort,
+                       pcbp->ncbp->hostName);
+            }
 
         return FALSE;
         }
@@ -849,9 +840,10 @@ static bool npuLipActivateTrunk(Pcb *pcbp)
 
     npuBipRequestUplineTransfer(bp);
 
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: trunk to %s activated\n", pcbp->claPort, pcbp->ncbp->hostName);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: trunk to %s activated\n", pcbp->claPort, pcbp->ncbp->hostName);
+        }
 
     return TRUE;
     }
@@ -891,9 +883,10 @@ static bool npuLipDeactivateTrunk(Pcb *pcbp)
 
     npuBipRequestUplineTransfer(bp);
 
-#if DEBUG
-    fprintf(npuLipLog, "Port %02x: trunk to %s deactivated\n", pcbp->claPort, pcbp->ncbp->hostName);
-#endif
+    if (DevLogEnabled(npuLipLog, DevLogInfo))
+        {
+        devLogText(npuLipLog, "Port %02x: trunk to %s deactivated\n", pcbp->claPort, pcbp->ncbp->hostName);
+        }
 
     return TRUE;
     }
@@ -940,9 +933,10 @@ static void npuLipSendQueuedData(Pcb *pcbp)
             if (send(pcbp->connFd, ping, sizeof(ping), 0) == sizeof(ping))
                 {
                 pcbp->controls.lip.lastExchange = currentTime;
-#if DEBUG
-                fprintf(npuLipLog, "Port %02x: sent ping to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
-#endif
+                if (DevLogEnabled(npuLipLog, DevLogInfo))
+                    {
+                    devLogText(npuLipLog, "Port %02x: sent ping to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+                    }
                 }
             else
                 {
@@ -968,24 +962,19 @@ static void npuLipSendQueuedData(Pcb *pcbp)
                 {
                 n = -1;
                 }
-#if DEBUG
-            else
+            else if (DevLogEnabled(npuLipLog, DevLogInfo))
                 {
-                fprintf(npuLipLog, "Port %02x: sent data to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
-                npuLipLogBytes(blockLen, 2);
+                devLogText(npuLipLog, "Port %02x: sent data to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+                devLogBytes(npuLipLog, blockLen, 2);
                 }
-#endif
             }
         if (n >= 0)
             {
             n = send(pcbp->connFd, bp->data + bp->offset, bp->numBytes - bp->offset, 0);
-#if DEBUG
-            if (n > 0)
+            if ((n > 0) && DevLogEnabled(npuLipLog, DevLogInfo))
                 {
-                npuLipLogBytes(bp->data + bp->offset, bp->numBytes - bp->offset);
-                npuLipLogFlush();
+                devLogBytes(npuLipLog, bp->data + bp->offset, bp->numBytes - bp->offset);
                 }
-#endif
             }
 #else
         /*
@@ -1004,15 +993,12 @@ static void npuLipSendQueuedData(Pcb *pcbp)
         vec[i++].iov_len = n;
 
         n = (n > 0) ? writev(pcbp->connFd, vec, i) : 0;
-#if DEBUG
-        if (n > 0)
+        if ((n > 0) && DevLogEnabled(npuLipLog, DevLogInfo))
             {
-            fprintf(npuLipLog, "Port %02x: sent data to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
-            npuLipLogBytes(blockLen, 2);
-            npuLipLogBytes(vec[1].iov_base, vec[1].iov_len);
-            npuLipLogFlush();
+            devLogText(npuLipLog, "Port %02x: sent data to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+            devLogBytes(npuLipLog, blockLen, 2);
+            devLogBytes(npuLipLog, vec[1].iov_base, (int)vec[1].iov_len);
             }
-#endif
 #endif
         if (n < 0)
             {
@@ -1042,7 +1028,8 @@ static void npuLipSendQueuedData(Pcb *pcbp)
             }
 #endif
 
-        bp->offset += n;
+        bp->offset     += n;
+        pcbp->bytesOut += n;
 
         if (bp->offset >= bp->numBytes)
             {
@@ -1058,92 +1045,4 @@ static void npuLipSendQueuedData(Pcb *pcbp)
         }
     }
 
-#if DEBUG
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete numeric/ascii data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuLipLogFlush(void)
-    {
-    if (npuLipLogBytesCol > 0)
-        {
-        fputs(npuLipLogBuf, npuLipLog);
-        fputc('\n', npuLipLog);
-        fflush(npuLipLog);
-        }
-    npuLipLogBytesCol = 0;
-    memset(npuLipLogBuf, ' ', LogLineLength);
-    npuLipLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of EBCDIC bytes in ASCII form
-**
-**  Parameters:     Name        Description.
-**                  bytes       pointer to sequence of bytes
-**                  len         length of the sequence
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuLipLogBytes(u8 *bytes, int len)
-    {
-    int  ascCol;
-    u8   b;
-    char hex[3];
-    int  hexCol;
-    int  i;
-
-    ascCol = AsciiColumn(npuLipLogBytesCol);
-    hexCol = HexColumn(npuLipLogBytesCol);
-
-    for (i = 0; i < len; i++)
-        {
-        b = bytes[i];
-        sprintf(hex, "%02x", b);
-        memcpy(npuLipLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        npuLipLogBuf[ascCol++] = (b < 0x20 || b >= 0x7f) ? '.' : b;
-        if (++npuLipLogBytesCol >= 16)
-            {
-            npuLipLogFlush();
-            ascCol = AsciiColumn(npuLipLogBytesCol);
-            hexCol = HexColumn(npuLipLogBytesCol);
-            }
-        }
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a stack trace
-**
-**  Parameters:     none
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuLipPrintStackTrace(FILE *fp)
-    {
-#if defined(__APPLE__)
-    void *callstack[128];
-    int  i;
-    int  frames;
-    char **strs;
-
-    frames = backtrace(callstack, 128);
-    strs   = backtrace_symbols(callstack, frames);
-    for (i = 1; i < frames; ++i)
-        {
-        fprintf(fp, "%s\n", strs[i]);
-        }
-    free(strs);
-#endif
-    }
-
-#endif // DEBUG
-
 /*---------------------------  End Of File  ------------------------------*/
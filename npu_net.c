@@ -59,18 +59,32 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <sys/uio.h>
 #endif
 
-#define DEBUG             0
-
 /*
 **  -----------------
 **  Private Constants
 **  -----------------
 */
 #define MaxClaPorts       255
+#define MaxGatherBuffers  64
 #define NamStartupTime    30
 
+/*
+**  Network scheduler parameters. Interactive connections are polled
+**  BulkPollRatio times for each poll of a bulk (HASP, NJE, trunk)
+**  connection. Bulk connections stop receiving when fewer than
+**  BulkBufReserve NPU buffers are free, so that interactive users can
+**  still be served, and no connection receives when fewer than
+**  MinBufReserve are free. Rate limits are applied in slices of
+**  RateSliceMs milliseconds.
+*/
+#define BulkPollRatio     4
+#define BulkBufReserve    200
+#define MinBufReserve     32
+#define RateSliceMs       100
+
 /*
 **  -----------------------
 **  Private Macro Functions
@@ -93,7 +107,12 @@ static int npuNetCreateConnections(void);
 static bool npuNetCreateListeningSocket(Ncb *ncbp);
 static void npuNetCreateThread(void);
 static bool npuNetProcessNewConnection(int connFd, Ncb *ncbp, bool isPassive);
+static bool npuNetIsBulk(Pcb *pcbp);
+static Pcb *npuNetNextPcb(int *index, bool isBulk);
+static void npuNetPollPcb(Pcb *pcbp);
+static void npuNetPollStatus(void);
 static int npuNetRegisterClaPort(Ncb *ncbp);
+static int npuNetUplineBudget(Pcb *pcbp);
 static void npuNetSendConsoleMsg(int connFd, int connType, char *msg);
 static void npuNetTryOutput(Pcb *pcbp);
 
@@ -114,6 +133,8 @@ char npuNetHostID[HostIdSize];
 u32  npuNetHostIP     = 0;
 u8   npuNetMaxClaPort = 0;
 u8   npuNetMaxCN      = 0;
+u32  npuNetBulkRate        = 0;
+u32  npuNetInteractiveRate = 0;
 
 /*
 **  -----------------
@@ -158,7 +179,9 @@ static bool isPcbsPreset = FALSE;
 static Ncb ncbs[MaxTermDefs];
 static int numNcbs = 0;
 
-static int pollIndex = 0;
+static int bulkPollIndex = 0;
+static int pollCount     = 0;
+static int pollIndex     = 0;
 
 /*
 **  Table of functions that queue data for sending to the network,
@@ -473,7 +496,9 @@ void npuNetInit(bool startup)
     /*
     **  Setup for input data processing.
     */
-    pollIndex = 0;
+    bulkPollIndex = 0;
+    pollCount     = 0;
+    pollIndex     = 0;
 
     /*
     **  Only do the following when the emulator starts up.
@@ -556,6 +581,30 @@ void npuNetReset(void)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Count terminals currently connected to the network.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Number of connected CLA ports.
+**
+**------------------------------------------------------------------------*/
+int npuNetConnectionCount(void)
+    {
+    int count = 0;
+    int i;
+
+    for (i = 0; i < MaxClaPorts; i++)
+        {
+        if ((pcbs[i].ncbp != NULL) && (pcbs[i].connFd > 0))
+            {
+            count += 1;
+            }
+        }
+
+    return (count);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Signal from host that connection has been established.
 **
@@ -652,87 +701,150 @@ void npuNetQueueAck(Tcb *tp, u8 blockSeqNo)
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Check for network status.
+**  Purpose:        Send as much of a terminal's queued output as the socket
+**                  will accept, gathering all queued buffers into a single
+**                  write. Completely sent buffers are released and their
+**                  block sequence numbers reported to the TIP; a partially
+**                  sent buffer has its offset advanced.
 **
 **  Parameters:     Name        Description.
+**                  tp          TCB pointer
+**                  notifySent  function to call with the block sequence
+**                              number of each completed buffer, or NULL
+**                  logSent     function to call with each piece of data
+**                              the socket took, or NULL
 **
-**  Returns:        Nothing.
+**  Returns:        Number of bytes sent, or -1 if the socket reported an
+**                  error (typically "would block").
 **
 **------------------------------------------------------------------------*/
-void npuNetCheckStatus(void)
+int npuNetSendQueue(Tcb *tp, void (*notifySent)(Tcb *tp, u8 blockSeqNo), void (*logSent)(Tcb *tp, u8 *data, int len))
     {
-    Pcb            *pcbp;
-    fd_set         readFds;
-    int            readySockets = 0;
-    struct timeval timeout;
-    fd_set         writeFds;
+    NpuBuffer *bp;
+    int       count;
+    int       len;
+    int       n;
+    int       result;
+    int       sent;
 
-    timeout.tv_sec  = 0;
-    timeout.tv_usec = 0;
+#if defined(_WIN32)
+    struct
+        {
+        u8  *base;
+        int len;
+        } vec[MaxGatherBuffers];
+#else
+    struct iovec vec[MaxGatherBuffers];
+#endif
 
-    while (pollIndex <= npuNetMaxClaPort)
+    /*
+    **  Gather the unsent parts of the queued buffers.
+    */
+    count = 0;
+    for (bp = tp->outputQ.first; bp != NULL && count < MaxGatherBuffers; bp = bp->next)
         {
-        pcbp = &pcbs[pollIndex++];
-        if (pcbp->connFd <= 0)
+        len = bp->numBytes - bp->offset;
+        if (len > 0)
             {
-            continue;
+#if defined(_WIN32)
+            vec[count].base  = bp->data + bp->offset;
+            vec[count++].len = len;
+#else
+            vec[count].iov_base  = bp->data + bp->offset;
+            vec[count++].iov_len = len;
+#endif
             }
-        if (pcbp->cciWaitForTcb)
+        }
+
+    /*
+    **  Don't call into TCP if there is no data to send.
+    */
+    result = 0;
+    if (count > 0)
+        {
+#if defined(_WIN32)
+        for (n = 0; n < count; n++)
             {
-            if (getSeconds() - pcbp->cciTcbWaitStart > CciWaitForTcbTimeout)
+            len = send(tp->pcbp->connFd, vec[n].base, vec[n].len, 0);
+            if (len < 0)
                 {
-                npuNetSendConsoleMsg((int)pcbp->connFd, pcbp->ncbp->connType, tcbNotConfiguredMsg);
-                netCloseConnection(pcbp->connFd);
-                pcbp->connFd      = 0;
-                pcbp->ncbp->state = StConnInit;
+                if (result == 0)
+                    {
+                    result = -1;
+                    }
+                break;
                 }
-            continue;
-            }
-
-        /*
-        **  Handle network traffic.
-        */
-        FD_ZERO(&readFds);
-        FD_ZERO(&writeFds);
-        FD_SET(pcbp->connFd, &readFds);
-        readySockets = select((int)(pcbp->connFd + 1), &readFds, NULL, NULL, &timeout);
-
-        if ((readySockets > 0) && FD_ISSET(pcbp->connFd, &readFds))
-            {
-            /*
-            **  Receive a block of data.
-            */
-            pcbp->inputCount = recv(pcbp->connFd, pcbp->inputData, MaxBuffer, 0);
-            if (pcbp->inputCount <= 0)
+            result += len;
+            if (len < vec[n].len)
                 {
-                notifyNetDisconnect[pcbp->ncbp->connType](pcbp);
-                continue;
+                break;
                 }
-            processUplineData[pcbp->ncbp->connType](pcbp);
             }
+#else
+        result = writev(tp->pcbp->connFd, vec, count);
+#endif
+        }
 
-        if (pcbp->connFd > 0)
+    /*
+    **  Release the buffers the socket took completely and let TIP know which
+    **  block sequence numbers were processed. Empty buffers carrying only a
+    **  sequence number at the head of the queue are released even on error.
+    */
+    sent = (result > 0) ? result : 0;
+    tp->pcbp->bytesOut += sent;
+    if ((logSent != NULL) && (sent > 0))
+        {
+        for (n = 0, len = sent; n < count && len > 0; n++)
             {
-            FD_ZERO(&writeFds);
-            FD_SET(pcbp->connFd, &writeFds);
-            readySockets = select((int)(pcbp->connFd + 1), NULL, &writeFds, NULL, &timeout);
-            if ((readySockets > 0) && FD_ISSET(pcbp->connFd, &writeFds))
-                {
-                /*
-                **  Try sending data if any is pending.
-                */
-                npuNetTryOutput(pcbp);
-                }
+#if defined(_WIN32)
+            logSent(tp, vec[n].base, (len < vec[n].len) ? len : vec[n].len);
+            len -= vec[n].len;
+#else
+            logSent(tp, vec[n].iov_base, (len < (int)vec[n].iov_len) ? len : (int)vec[n].iov_len);
+            len -= (int)vec[n].iov_len;
+#endif
+            }
+        }
+    while ((bp = tp->outputQ.first) != NULL)
+        {
+        len = bp->numBytes - bp->offset;
+        if (len > sent)
+            {
+            bp->offset += sent;
+            break;
+            }
+        sent -= len;
+        npuBipQueueExtract(&tp->outputQ);
+        if ((bp->blockSeqNo != 0) && (notifySent != NULL))
+            {
+            notifySent(tp, bp->blockSeqNo);
             }
+        npuBipBufRelease(bp);
+        }
 
-        /*
-        **  The following return ensures that we resume with polling the next
-        **  connection in sequence otherwise low-numbered connections would get
-        **  preferential treatment.
-        */
-        return;
+    return (result);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Check for network status.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void npuNetCheckStatus(void)
+    {
+    if (latencyActive)
+        {
+        latencyEnter();
+        npuNetPollStatus();
+        latencyLeave(LatPhaseNetCheck, 0);
+        }
+    else
+        {
+        npuNetPollStatus();
         }
-    pollIndex = 0;
     }
 
 /*--------------------------------------------------------------------------
@@ -844,6 +956,10 @@ void npuNetShowStatus()
                     netGetPeerTcpAddress(pcbp->connFd), connTypes[pcbp->ncbp->connType], connStates[pcbp->ncbp->state]),
             opDisplay(outBuf);
             chEqStr[0] = '\0';
+            sprintf(outBuf, "    >   %-8s %-7s     in %llu, out %llu bytes, %u deferred receives%s\n", "", "",
+                    (unsigned long long)pcbp->bytesIn, (unsigned long long)pcbp->bytesOut, pcbp->deferrals,
+                    npuNetIsBulk(pcbp) ? " (bulk)" : "");
+            opDisplay(outBuf);
             }
         }
     }
@@ -856,6 +972,276 @@ void npuNetShowStatus()
  **--------------------------------------------------------------------------
  */
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether a connection carries bulk (batch or
+**                  trunk) traffic rather than interactive traffic.
+**
+**  Parameters:     Name        Description.
+**                  pcbp        PCB pointer
+**
+**  Returns:        TRUE if bulk connection.
+**
+**------------------------------------------------------------------------*/
+static bool npuNetIsBulk(Pcb *pcbp)
+    {
+    switch (pcbp->ncbp->connType)
+        {
+    case ConnTypeHasp:
+    case ConnTypeRevHasp:
+    case ConnTypeNje:
+    case ConnTypeTrunk:
+        return (TRUE);
+
+    default:
+        return (FALSE);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Find the next active connection of a given class in
+**                  round-robin order.
+**
+**  Parameters:     Name        Description.
+**                  index       pointer to poll index of the class
+**                  isBulk      TRUE to find bulk connections, FALSE to
+**                              find interactive connections
+**
+**  Returns:        PCB pointer, or NULL when the class has no active
+**                  connection.
+**
+**------------------------------------------------------------------------*/
+static Pcb *npuNetNextPcb(int *index, bool isBulk)
+    {
+    int n;
+    Pcb *pcbp;
+
+    /*
+    **  Scan the port range at most once, wrapping around at its end.
+    */
+    for (n = 0; n <= npuNetMaxClaPort; n++)
+        {
+        if (*index > npuNetMaxClaPort)
+            {
+            *index = 0;
+            }
+
+        pcbp = &pcbs[(*index)++];
+        if ((pcbp->connFd > 0) && (pcbp->ncbp != NULL) && (npuNetIsBulk(pcbp) == isBulk))
+            {
+            return (pcbp);
+            }
+        }
+
+    return (NULL);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Poll the next connection for network status.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void npuNetPollStatus(void)
+    {
+    Pcb *pcbp;
+
+    /*
+    **  Interactive connections get BulkPollRatio turns for each turn of a
+    **  bulk connection, so that a large file transfer does not slow down
+    **  terminal users. A class without active connections gives its turn
+    **  to the other class. Each class is served round-robin, otherwise
+    **  low-numbered connections would get preferential treatment.
+    */
+    if (pollCount >= BulkPollRatio)
+        {
+        pollCount = 0;
+        pcbp      = npuNetNextPcb(&bulkPollIndex, TRUE);
+        if (pcbp == NULL)
+            {
+            pcbp = npuNetNextPcb(&pollIndex, FALSE);
+            }
+        }
+    else
+        {
+        pollCount += 1;
+        pcbp       = npuNetNextPcb(&pollIndex, FALSE);
+        if (pcbp == NULL)
+            {
+            pcbp = npuNetNextPcb(&bulkPollIndex, TRUE);
+            }
+        }
+
+    if (pcbp != NULL)
+        {
+        npuNetPollPcb(pcbp);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Handle network traffic of one connection.
+**
+**  Parameters:     Name        Description.
+**                  pcbp        PCB pointer
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void npuNetPollPcb(Pcb *pcbp)
+    {
+    int            budget;
+    fd_set         readFds;
+    int            readySockets = 0;
+    struct timeval timeout;
+    fd_set         writeFds;
+
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = 0;
+
+    if (pcbp->cciWaitForTcb)
+        {
+        if (getSeconds() - pcbp->cciTcbWaitStart > CciWaitForTcbTimeout)
+            {
+            npuNetSendConsoleMsg((int)pcbp->connFd, pcbp->ncbp->connType, tcbNotConfiguredMsg);
+            netCloseConnection(pcbp->connFd);
+            pcbp->connFd      = 0;
+            pcbp->ncbp->state = StConnInit;
+            }
+
+        return;
+        }
+
+    /*
+    **  Handle network traffic. Input is left in the socket while the
+    **  connection has used up its upline budget.
+    */
+    FD_ZERO(&readFds);
+    FD_SET(pcbp->connFd, &readFds);
+    readySockets = select((int)(pcbp->connFd + 1), &readFds, NULL, NULL, &timeout);
+
+    if ((readySockets > 0) && FD_ISSET(pcbp->connFd, &readFds))
+        {
+        budget = npuNetUplineBudget(pcbp);
+        if (budget > 0)
+            {
+            /*
+            **  Receive a block of data.
+            */
+            pcbp->inputCount = recv(pcbp->connFd, pcbp->inputData, budget, 0);
+            if (pcbp->inputCount <= 0)
+                {
+                notifyNetDisconnect[pcbp->ncbp->connType](pcbp);
+
+                return;
+                }
+            pcbp->bytesIn += pcbp->inputCount;
+            if (pcbp->uplineTokens > (u32)pcbp->inputCount)
+                {
+                pcbp->uplineTokens -= pcbp->inputCount;
+                }
+            else
+                {
+                pcbp->uplineTokens = 0;
+                }
+            processUplineData[pcbp->ncbp->connType](pcbp);
+            }
+        else
+            {
+            pcbp->deferrals += 1;
+            }
+        }
+
+    if (pcbp->connFd > 0)
+        {
+        FD_ZERO(&writeFds);
+        FD_SET(pcbp->connFd, &writeFds);
+        readySockets = select((int)(pcbp->connFd + 1), NULL, &writeFds, NULL, &timeout);
+        if ((readySockets > 0) && FD_ISSET(pcbp->connFd, &writeFds))
+            {
+            /*
+            **  Try sending data if any is pending.
+            */
+            npuNetTryOutput(pcbp);
+            }
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine how many bytes may be received from a
+**                  connection now.
+**
+**                  Each connection has a token bucket which is refilled
+**                  at the configured rate of its class and holds at most
+**                  one time slice worth of bytes. Independently of the
+**                  rate, bulk connections are held back when the NPU
+**                  buffer pool runs low.
+**
+**  Parameters:     Name        Description.
+**                  pcbp        PCB pointer
+**
+**  Returns:        Maximum number of bytes to receive, 0 if input must
+**                  be deferred.
+**
+**------------------------------------------------------------------------*/
+static int npuNetUplineBudget(Pcb *pcbp)
+    {
+    u64  burst;
+    u64  credit;
+    u64  elapsed;
+    bool isBulk;
+    u64  now;
+    u32  rate;
+    u64  tokens;
+
+    isBulk = npuNetIsBulk(pcbp);
+    if (npuBipBufCount() < (isBulk ? BulkBufReserve : MinBufReserve))
+        {
+        return (0);
+        }
+
+    rate = isBulk ? npuNetBulkRate : npuNetInteractiveRate;
+    if (rate == 0)
+        {
+        return (MaxBuffer);
+        }
+
+    /*
+    **  Idle time beyond one second earns no credit.
+    */
+    now     = getMilliseconds();
+    elapsed = now - pcbp->uplineRefill;
+    if (elapsed > 1000)
+        {
+        elapsed            = 1000;
+        pcbp->uplineRefill = now - 1000;
+        }
+
+    if (elapsed >= RateSliceMs)
+        {
+        credit = (elapsed * rate) / 1000;
+        if (credit > 0)
+            {
+            burst = ((u64)rate * RateSliceMs) / 1000;
+            if (burst < 1)
+                {
+                burst = 1;
+                }
+            tokens             = pcbp->uplineTokens + credit;
+            pcbp->uplineTokens = (u32)((tokens < burst) ? tokens : burst);
+
+            /*
+            **  Advance the refill time only by the time it took to earn
+            **  the credit, so that the fraction of a byte left over is
+            **  carried into the next refill.
+            */
+            pcbp->uplineRefill += (credit * 1000) / rate;
+            }
+        }
+
+    return ((pcbp->uplineTokens < MaxBuffer) ? (int)pcbp->uplineTokens : MaxBuffer);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Register CLA port numbers and associated connection types
 **
@@ -1212,10 +1598,7 @@ static bool npuNetCreateListeningSocket(Ncb *ncbp)
         }
     ncbp->lstnFd = sd;
 
-#if DEBUG >= 2
-    logDtError(LogErrorLocation, "Created listener for port %d\n", ncbp->tcpPort);
-#endif
-
+    npuLogMessage("(npu_net) Created listener for port %d", ncbp->tcpPort);
 
     return TRUE;
     }
@@ -1297,14 +1680,12 @@ static void *npuNetThread(void *param)
 
     FD_ZERO(&listenFds);
 
-#if DEBUG >= 2
-    logDtError(LogErrorLocation, "npuNetThread has %d Ncbs to check\n", numNcbs);
+    npuLogMessage("(npu_net) npuNetThread has %d Ncbs to check", numNcbs);
     for (i = 0; i < numNcbs; i++)
         {
         ncbp = &ncbs[i];
-        logDtError(LogErrorLocation, "npuNetThread .. (%d), type %d, port %d\n", i, ncbp->connType, ncbp->tcpPort);
+        npuLogMessage("(npu_net) npuNetThread .. (%d), type %d, port %d", i, ncbp->connType, ncbp->tcpPort);
         }
-#endif
 
     /*
     **  Create a listening socket for every configured connection type that listens
@@ -1313,9 +1694,7 @@ static void *npuNetThread(void *param)
     for (i = 0; i < numNcbs; i++)
         {
         ncbp = &ncbs[i];
-#if DEBUG >= 2
-        logDtError(LogErrorLocation, "npuNetThread checking Ncb %d, type %d, port %d\n", i, ncbp->connType, ncbp->tcpPort);
-#endif
+        npuLogMessage("(npu_net) npuNetThread checking Ncb %d, type %d, port %d", i, ncbp->connType, ncbp->tcpPort);
         switch (ncbp->connType)
             {
         case ConnTypeTrunk:
@@ -1498,7 +1877,12 @@ static bool npuNetProcessNewConnection(int connFd, Ncb *ncbp, bool isPassive)
     /*
     **  Initialize the connection and mark it as active.
     */
-    pcbp->connFd = connFd;
+    pcbp->connFd       = connFd;
+    pcbp->uplineTokens = 0;
+    pcbp->uplineRefill = 0;
+    pcbp->bytesIn      = 0;
+    pcbp->bytesOut     = 0;
+    pcbp->deferrals    = 0;
     if (pcbp->cciWaitForTcb)
         {
         pcbp->cciTcbWaitStart = getSeconds();
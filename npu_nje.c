@@ -43,8 +43,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -73,10 +71,6 @@
 #include "proto.h"
 #include "npu.h"
 
-#if defined(__APPLE__)
-#include <execinfo.h>
-#endif
-
 
 /*
 **  -----------------
@@ -86,6 +80,7 @@
 
 #define MaxRetries                   8
 #define MaxUplineBlockSize           640
+#define MaxUplineRecord              255
 #define MaxWaitTime                  15
 
 /*
@@ -201,7 +196,6 @@
 #define CrNakAttemptingActiveOpen    0x03
 #define CrNakTemporaryFailure        0x04
 
-#if DEBUG
 static char *NjeConnStates[] =
     {
     "StNjeDisconnected",
@@ -221,18 +215,15 @@ static char *CrNakReasons[] =
     "Link attempting active open",
     "Temporary failure"
     };
-#endif
 
 /*
 **  -----------------------
 **  Private Macro Functions
 **  -----------------------
 */
-#if DEBUG
 #define HexColumn(x)      (3 * (x) + 4)
 #define AsciiColumn(x)    (HexColumn(16) + 2 + (x))
-#define LogLineLength    (AsciiColumn(16))
-#endif
+#define LogLineLength     (AsciiColumn(16))
 
 /*
 **  -----------------------------------------
@@ -240,14 +231,12 @@ static char *CrNakReasons[] =
 **  -----------------------------------------
 */
 
-#if DEBUG
 typedef enum
     {
     ASCII = 0,
     EBCDIC,
     DisplayCode
     } CharEncoding;
-#endif
 
 /*
 **  ---------------------------
@@ -262,6 +251,7 @@ static u8 *npuNjeCloseDownlineBlock(Pcb *pcbp, u8 *dp);
 static u8 *npuNjeCollectBlock(Pcb *pcbp, u8 *start, u8 *limit, bool *isComplete, int *size, int *status);
 static bool npuNjeConnectTerminal(Pcb *pcbp);
 static void npuNjeEbcdicToAscii(u8 *ebcdic, u8 *ascii, int len);
+static int npuNjeExpandRecord(u8 **ibpp, u8 *ibLimit, u8 *dst, int *recLen);
 static Pcb *npuNjeFindPcbForCr(char *rhost, u32 rip, char *ohost, u32 oip);
 static Tcb *npuNjeFindTcb(Pcb *pcbp);
 static void npuNjeFlushOutput(Pcb *pcbp);
@@ -275,12 +265,8 @@ static void npuNjeTransmitQueuedBlocks(Pcb *pcbp);
 static void npuNjeTrim(char *str);
 static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb);
 
-#if DEBUG
 static void npuNjeLogBytes(u8 *bytes, int len, CharEncoding encoding);
-static void npuNjeLogFlush(void);
-static void npuNjePrintStackTrace(FILE *fp);
-
-#endif
+static void npuNjeLogSent(Tcb *tp, u8 *data, int len);
 
 /*
 **  ----------------
@@ -294,11 +280,7 @@ static void npuNjePrintStackTrace(FILE *fp);
 **  -----------------
 */
 
-#if DEBUG
-static FILE *npuNjeLog = NULL;
-static char npuNjeLogBuf[LogLineLength + 1];
-static int  npuNjeLogBytesCol = 0;
-#endif
+static DevLogModule *npuNjeLog = NULL;
 
 /*
 **  NJE/TCP Control Record Type strings (EBCDIC)
@@ -368,10 +350,9 @@ static char *LoggedOut               = "LOGGED OUT.";
 **------------------------------------------------------------------------*/
 void npuNjeTryOutput(Pcb *pcbp)
     {
-    NpuBuffer *bp;
-    time_t    currentTime;
-    int       n;
-    Tcb       *tcbp;
+    time_t currentTime;
+    int    n;
+    Tcb    *tcbp;
 
     currentTime = getSeconds();
     tcbp        = npuNjeFindTcb(pcbp);
@@ -385,9 +366,10 @@ void npuNjeTryOutput(Pcb *pcbp)
     case StNjeRcvResponseSignon:
         if (currentTime - pcbp->controls.nje.lastXmit > MaxWaitTime)
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: timeout in state %s\n", pcbp->claPort, NjeConnStates[pcbp->controls.nje.state]);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: timeout in state %s\n", pcbp->claPort, NjeConnStates[pcbp->controls.nje.state]);
+                }
             npuNjeCloseConnection(pcbp);
 
             return;
@@ -416,21 +398,16 @@ void npuNjeTryOutput(Pcb *pcbp)
 
     if (tcbp != NULL)
         {
-        while ((bp = npuBipQueueExtract(&tcbp->outputQ)) != NULL)
+        if (npuBipQueueNotEmpty(&tcbp->outputQ))
             {
-            n = npuNjeSend(pcbp, bp->data + bp->offset, bp->numBytes - bp->offset);
+            n = npuNetSendQueue(tcbp, NULL, npuNjeLogSent);
             if (n > 0)
                 {
-                bp->offset += n;
-                }
-            if (bp->offset >= bp->numBytes)
-                {
-                npuBipBufRelease(bp);
-                }
-            else
-                {
-                npuBipQueuePrepend(bp, &tcbp->outputQ);
-                break;
+                if (DevLogEnabled(npuNjeLog, DevLogDebug))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: TCP data sent to %s (%d bytes)\n", pcbp->claPort, pcbp->ncbp->hostName, n);
+                    }
+                pcbp->controls.nje.lastXmit = currentTime;
                 }
             }
         if (tcbp->state == StTermConnected)
@@ -469,12 +446,12 @@ void npuNjeProcessDownlineData(Tcb *tcbp, NpuBuffer *bp, bool last)
     dbc       = *dp++; // extract data block clarifier
     len      -= 1;
 
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: downline data received for %.7s, size %d, block type %u, dbc %02x\n",
-            pcbp->claPort, tcbp->termName, len, blockType, dbc);
-    npuNjeLogBytes(bp->data, bp->numBytes, (dbc & DbcTransparent) != 0 ? EBCDIC : ASCII);
-    npuNjeLogFlush();
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogDebug))
+        {
+        devLogText(npuNjeLog, "Port %02x: downline data received for %.7s, size %d, block type %u, dbc %02x\n",
+                   pcbp->claPort, tcbp->termName, len, blockType, dbc);
+        npuNjeLogBytes(bp->data, bp->numBytes, (dbc & DbcTransparent) != 0 ? EBCDIC : ASCII);
+        }
 
     if ((dbc & DbcTransparent) != 0)
         {
@@ -507,9 +484,10 @@ void npuNjeProcessDownlineData(Tcb *tcbp, NpuBuffer *bp, bool last)
                 || ((len > ApplicationBusyLen) && (memcmp(ApplicationBusy, start + 1, ApplicationBusyLen) == 0))
                 || ((len > LoggedOutLen) && (memcmp(LoggedOut, start + 1, LoggedOutLen) == 0)))
                 {
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: %.7s disconnected from NJF\n", pcbp->claPort, tcbp->termName);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: %.7s disconnected from NJF\n", pcbp->claPort, tcbp->termName);
+                    }
                 npuTipNotifySent(tcbp, bp->data[BlkOffBTBSN]);
                 npuNjeCloseConnection(pcbp);
 
@@ -550,20 +528,20 @@ void npuNjeProcessUplineData(Pcb *pcbp)
     int    status;
     Tcb    *tcbp;
 
-#if DEBUG
-    if (pcbp->controls.nje.state > StNjeRcvOpen)
+    if (DevLogEnabled(npuNjeLog, DevLogDebug))
         {
-        fprintf(npuNjeLog, "Port %02x: TCP data received from %s, state %s\n",
-                pcbp->claPort, pcbp->ncbp->hostName, NjeConnStates[pcbp->controls.nje.state]);
-        }
-    else
-        {
-        fprintf(npuNjeLog, "Port %02x: TCP data received, state %s\n",
-                pcbp->claPort, NjeConnStates[pcbp->controls.nje.state]);
+        if (pcbp->controls.nje.state > StNjeRcvOpen)
+            {
+            devLogText(npuNjeLog, "Port %02x: TCP data received from %s, state %s\n",
+                       pcbp->claPort, pcbp->ncbp->hostName, NjeConnStates[pcbp->controls.nje.state]);
+            }
+        else
+            {
+            devLogText(npuNjeLog, "Port %02x: TCP data received, state %s\n",
+                       pcbp->claPort, NjeConnStates[pcbp->controls.nje.state]);
+            }
+        npuNjeLogBytes(pcbp->inputData, pcbp->inputCount, EBCDIC);
         }
-    npuNjeLogBytes(pcbp->inputData, pcbp->inputCount, EBCDIC);
-    npuNjeLogFlush();
-#endif
 
     sp = pcbp->inputData;
     dp = pcbp->controls.nje.inputBufPtr;
@@ -588,9 +566,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
             {
         case StNjeDisconnected:
             // discard any data received while disconnected
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: disconnected, data discarded\n", pcbp->claPort);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: disconnected, data discarded\n", pcbp->claPort);
+                }
             dp = limit;
             break;
 
@@ -625,17 +604,19 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                     r = CrNakLinkActive;
                     if ((getSeconds() - pcbp2->controls.nje.lastXmit) >= 600)
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: close connection due to inactivity and active link conflict\n", pcbp2->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: close connection due to inactivity and active link conflict\n", pcbp2->claPort);
+                            }
                         npuNetCloseConnection(pcbp2);
                         }
                     }
                 else
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: connection reassigned to port %02x\n", pcbp->claPort, pcbp2->claPort);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: connection reassigned to port %02x\n", pcbp->claPort, pcbp2->claPort);
+                        }
                     npuNjeResetPcb(pcbp2);
                     pcbp2->connFd                 = pcbp->connFd;
                     pcbp2->controls.nje.state     = pcbp->controls.nje.state;
@@ -651,18 +632,20 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                     }
                 if (r == 0)
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
+                        }
                     if (npuNjeConnectTerminal(pcbp))
                         {
                         pcbp->controls.nje.state = StNjeRcvSOH_ENQ;
                         }
                     else
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
+                            }
                         r = CrNakTemporaryFailure;
                         }
                     }
@@ -675,9 +658,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: expecting OPEN\n", pcbp->claPort);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: expecting OPEN\n", pcbp->claPort);
+                    }
                 npuNjeCloseConnection(pcbp);
                 dp = limit;
                 }
@@ -710,9 +694,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                     case NjeStatusSYN_NAK:
                         if (npuNjeSend(pcbp, SOH_ENQ, sizeof(SOH_ENQ)) == sizeof(SOH_ENQ))
                             {
-#if DEBUG
-                            fprintf(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
-#endif
+                            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                                {
+                                devLogText(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
+                                }
                             if (npuNjeConnectTerminal(pcbp))
                                 {
                                 /*
@@ -725,9 +710,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                                 }
                             else
                                 {
-#if DEBUG
-                                fprintf(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
-#endif
+                                if (DevLogEnabled(npuNjeLog, DevLogError))
+                                    {
+                                    devLogText(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
+                                    }
                                 npuNjeCloseConnection(pcbp);
                                 dp = limit;
                                 }
@@ -748,10 +734,11 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                         break;
 
                     default:
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: expecting <SOH><ENQ> or <SYN><NAK>, received status %d\n",
-                                pcbp->claPort, status);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: expecting <SOH><ENQ> or <SYN><NAK>, received status %d\n",
+                                       pcbp->claPort, status);
+                            }
                         npuNjeCloseConnection(pcbp);
                         dp = limit;
                         break;
@@ -759,9 +746,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                     }
                 else
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: block collection error %d\n", pcbp->claPort, status);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: block collection error %d\n", pcbp->claPort, status);
+                        }
                     npuNjeCloseConnection(pcbp);
                     dp = limit;
                     }
@@ -785,9 +773,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                 dp += CrLength;
                 if (npuNjeSend(pcbp, SOH_ENQ, sizeof(SOH_ENQ)) == sizeof(SOH_ENQ))
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: send upline request to connect terminal\n", pcbp->claPort);
+                        }
                     if (npuNjeConnectTerminal(pcbp))
                         {
                         /*
@@ -800,9 +789,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                         }
                     else
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: failed to issue terminal connection request\n", pcbp->claPort);
+                            }
                         npuNjeCloseConnection(pcbp);
                         dp = limit;
                         }
@@ -817,23 +807,26 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                 {
                 npuNjeParseControlRecord(dp + 8, rhost, &rip, ohost, &oip, &r);
                 dp += CrLength;
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: OPEN request denied: %s\n", pcbp->claPort, CrNakReasons[r]);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: OPEN request denied: %s\n", pcbp->claPort, CrNakReasons[r]);
+                    }
                 npuNjeCloseConnection(pcbp);
                 dp    = limit;
                 delay = (time_t)((getMilliseconds() % 5) + 3);
                 // Arrange to attempt reconnection after a relatively short and random-ish interval
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: delay %ld secs before attempting reconnection\n", pcbp->claPort, delay);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: delay %ld secs before attempting reconnection\n", pcbp->claPort, delay);
+                    }
                 pcbp->ncbp->nextConnectionAttempt = getSeconds() + delay;
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: expecting ACK or NAK\n", pcbp->claPort);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: expecting ACK or NAK\n", pcbp->claPort);
+                    }
                 npuNjeCloseConnection(pcbp);
                 dp = limit;
                 }
@@ -858,25 +851,28 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                         **  stream-related blocks.
                         */
                         pcbp->controls.nje.state = StNjeExchangeData;
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: enter data exchange state with ping interval %d secs\n",
-                                pcbp->claPort, pcbp->controls.nje.pingInterval);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: enter data exchange state with ping interval %d secs\n",
+                                       pcbp->claPort, pcbp->controls.nje.pingInterval);
+                            }
                         }
                     else if ((status != NjeStatusNothingUploaded) && (status != NjeStatusDLE_ACK0))
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: expecting initial signon\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: expecting initial signon\n", pcbp->claPort);
+                            }
                         npuNjeCloseConnection(pcbp);
                         dp = limit;
                         }
                     }
                 else
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: expecting initial signon\n", pcbp->claPort);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: expecting initial signon\n", pcbp->claPort);
+                        }
                     npuNjeCloseConnection(pcbp);
                     dp = limit;
                     }
@@ -901,25 +897,28 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                         {
                         npuNetSend(npuNjeFindTcb(pcbp), DLE_ACK0, sizeof(DLE_ACK0));
                         pcbp->controls.nje.state = StNjeExchangeData;
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: enter data exchange state with ping interval %d secs\n",
-                                pcbp->claPort, pcbp->controls.nje.pingInterval);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: enter data exchange state with ping interval %d secs\n",
+                                       pcbp->claPort, pcbp->controls.nje.pingInterval);
+                            }
                         }
                     else if ((status != NjeStatusNothingUploaded) && (status != NjeStatusDLE_ACK0))
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: expecting response signon\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: expecting response signon\n", pcbp->claPort);
+                            }
                         npuNjeCloseConnection(pcbp);
                         dp = limit;
                         }
                     }
                 else
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: expecting response signon\n", pcbp->claPort);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: expecting response signon\n", pcbp->claPort);
+                        }
                     npuNjeCloseConnection(pcbp);
                     dp = limit;
                     }
@@ -942,20 +941,22 @@ void npuNjeProcessUplineData(Pcb *pcbp)
                     status = npuNjeUploadBlock(pcbp, pcbp->controls.nje.inputBuf, size, &rcb, &srcb);
                     if ((status != NjeStatusOk) && (status != NjeStatusNothingUploaded) && (status != NjeStatusDLE_ACK0))
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: expecting normal data exchange, detected status %d\n",
-                                pcbp->claPort, status);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogError))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: expecting normal data exchange, detected status %d\n",
+                                       pcbp->claPort, status);
+                            }
                         npuNjeCloseConnection(pcbp);
                         dp = limit;
                         }
                     }
                 else
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: expecting normal data exchange, detected status %d\n",
-                            pcbp->claPort, status);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: expecting normal data exchange, detected status %d\n",
+                                   pcbp->claPort, status);
+                        }
                     npuNjeCloseConnection(pcbp);
                     dp = limit;
                     }
@@ -967,9 +968,10 @@ void npuNjeProcessUplineData(Pcb *pcbp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuNjeLog, "Invalid NJE state: %d\n", pcbp->controls.nje.state);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogError))
+                {
+                devLogText(npuNjeLog, "Invalid NJE state: %d\n", pcbp->controls.nje.state);
+                }
             dp = limit;
             break;
             }
@@ -1011,10 +1013,11 @@ void npuNjeProcessUplineData(Pcb *pcbp)
 void npuNjeNotifyAck(Tcb *tcbp, u8 bsn)
     {
     tcbp->uplineBlockLimit += 1;
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: ack for upline block from %.7s, ubl %d\n",
-            tcbp->pcbp->claPort, tcbp->termName, tcbp->uplineBlockLimit);
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogDebug))
+        {
+        devLogText(npuNjeLog, "Port %02x: ack for upline block from %.7s, ubl %d\n",
+                   tcbp->pcbp->claPort, tcbp->termName, tcbp->uplineBlockLimit);
+        }
     }
 
 /*--------------------------------------------------------------------------
@@ -1029,10 +1032,11 @@ void npuNjeNotifyAck(Tcb *tcbp, u8 bsn)
 **------------------------------------------------------------------------*/
 bool npuNjeNotifyNetConnect(Pcb *pcbp, bool isPassive)
     {
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: %s network connection indication\n", pcbp->claPort,
-            isPassive ? "passive" : "active");
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+        {
+        devLogText(npuNjeLog, "Port %02x: %s network connection indication\n", pcbp->claPort,
+                   isPassive ? "passive" : "active");
+        }
     if (isPassive)
         {
         npuNjeResetPcb(pcbp);
@@ -1049,10 +1053,11 @@ bool npuNjeNotifyNetConnect(Pcb *pcbp, bool isPassive)
         */
         if (pcbp->controls.nje.state != StNjeDisconnected)
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: port is already connected in state %s\n", pcbp->claPort,
-                    NjeConnStates[pcbp->controls.nje.state]);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: port is already connected in state %s\n", pcbp->claPort,
+                           NjeConnStates[pcbp->controls.nje.state]);
+                }
             pcbp->ncbp->nextConnectionAttempt = getSeconds() + (time_t)(24 * 60 * 60);
 
             return FALSE;
@@ -1076,9 +1081,10 @@ bool npuNjeNotifyNetConnect(Pcb *pcbp, bool isPassive)
 **------------------------------------------------------------------------*/
 void npuNjeNotifyNetDisconnect(Pcb *pcbp)
     {
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: network disconnection indication\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+        {
+        devLogText(npuNjeLog, "Port %02x: network disconnection indication\n", pcbp->claPort);
+        }
     npuNjeCloseConnection(pcbp);
     }
 
@@ -1093,22 +1099,25 @@ void npuNjeNotifyNetDisconnect(Pcb *pcbp)
 **------------------------------------------------------------------------*/
 void npuNjeNotifyTermConnect(Tcb *tcbp)
     {
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: connect terminal %.7s\n", tcbp->pcbp->claPort, tcbp->termName);
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+        {
+        devLogText(npuNjeLog, "Port %02x: connect terminal %.7s\n", tcbp->pcbp->claPort, tcbp->termName);
+        }
 
     if (tcbp->pcbp->connFd > 0)
         {
         tcbp->uplineBlockLimit = tcbp->params.fvUBL;
-#if DEBUG
-        fprintf(npuNjeLog, "Port %02x: upline block limit %d\n", tcbp->pcbp->claPort, tcbp->uplineBlockLimit);
-#endif
+        if (DevLogEnabled(npuNjeLog, DevLogDebug))
+            {
+            devLogText(npuNjeLog, "Port %02x: upline block limit %d\n", tcbp->pcbp->claPort, tcbp->uplineBlockLimit);
+            }
         }
     else
         {
-#if DEBUG
-        fprintf(npuNjeLog, "Port %02x: no network connection, disconnect terminal %.7s\n", tcbp->pcbp->claPort, tcbp->termName);
-#endif
+        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+            {
+            devLogText(npuNjeLog, "Port %02x: no network connection, disconnect terminal %.7s\n", tcbp->pcbp->claPort, tcbp->termName);
+            }
         npuSvmSendDiscRequest(tcbp);
         }
     }
@@ -1138,18 +1147,10 @@ void npuNjeNotifyTermDisconnect(Tcb *tcbp)
 **------------------------------------------------------------------------*/
 void npuNjePresetPcb(Pcb *pcbp)
     {
-#if DEBUG
     if (npuNjeLog == NULL)
         {
-        npuNjeLog = fopen("njelog.txt", "wt");
-        if (npuNjeLog == NULL)
-            {
-            logDtError(LogErrorLocation, "njelog.txt - aborting\n");
-            exit(1);
-            }
-        npuNjeLogFlush();    // initialize log buffer
+        npuNjeLog = devLogRegister("npunje");
         }
-#endif
     pcbp->controls.nje.maxRecordSize = 1024; // renegotiated during signon
     pcbp->controls.nje.uplineQ.first = NULL;
     pcbp->controls.nje.uplineQ.last  = NULL;
@@ -1197,9 +1198,10 @@ void npuNjeResetPcb(Pcb *pcbp)
     pcbp->controls.nje.outputBufPtr     = pcbp->controls.nje.outputBuf;
     pcbp->controls.nje.ttrp             = NULL;
 
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: reset PCB\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+        {
+        devLogText(npuNjeLog, "Port %02x: reset PCB\n", pcbp->claPort);
+        }
     }
 
 /*
@@ -1259,7 +1261,6 @@ static int npuNjeAppendRecords(Pcb *pcbp, u8 *bp, int len, u8 blockType)
     u8  *dp;
     u8  *limit;
     int maxBytesNeeded;
-    int nBytes;
     u8  ncc;
     u8  rcb;
     u8  *recLimit;
@@ -1278,25 +1279,28 @@ static int npuNjeAppendRecords(Pcb *pcbp, u8 *bp, int len, u8 blockType)
                 {
             case SRCB_CMDXBZ:
                 pcbp->controls.nje.maxRecordSize = (*bp << 8) | *(bp + 1);
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: TIP command, set transmission block size to %d\n",
-                        pcbp->claPort, pcbp->controls.nje.maxRecordSize);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: TIP command, set transmission block size to %d\n",
+                               pcbp->claPort, pcbp->controls.nje.maxRecordSize);
+                    }
                 bp += 2;
                 break;
 
             case SRCB_CMDABT:
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: TIP command, abort transmission, stream %d, sub-record control byte %02x\n",
-                        pcbp->claPort, *bp, *(bp + 1));
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: TIP command, abort transmission, stream %d, sub-record control byte %02x\n",
+                               pcbp->claPort, *bp, *(bp + 1));
+                    }
                 bp += 2;
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: unrecognized TIP command %02x\n", pcbp->claPort, srcb);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: unrecognized TIP command %02x\n", pcbp->claPort, srcb);
+                    }
                 bp = limit;
                 break;
                 }
@@ -1310,10 +1314,11 @@ static int npuNjeAppendRecords(Pcb *pcbp, u8 *bp, int len, u8 blockType)
         */
         if ((rcb == RCB_GCR) && (srcb == SRCB_InitialSignon) && pcbp->controls.nje.isPassive)
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: downline initial signon detected and discarded while connection is in passive state\n",
-                    pcbp->claPort);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: downline initial signon detected and discarded while connection is in passive state\n",
+                           pcbp->claPort);
+                }
 
             return NjeStatusOk;
             }
@@ -1391,19 +1396,8 @@ static int npuNjeAppendRecords(Pcb *pcbp, u8 *bp, int len, u8 blockType)
             }
         else
             {
-            while (bp < recLimit)
-                {
-                nBytes = (int)(recLimit - bp);
-                if (nBytes > 63)
-                    {
-                    nBytes = 63;
-                    }
-                *dp++ = 0xc0 + nBytes; // SCB
-                while (nBytes-- > 0)
-                    {
-                    *dp++ = *bp++;
-                    }
-                }
+            dp   += npuHaspEncodeStrings(dp, bp, ncc, pcbp->controls.nje.isCompressing);
+            bp    = recLimit;
             *dp++ = 0x00; // end of record SCB
             }
         }
@@ -1440,10 +1434,7 @@ static int npuNjeAppendRecords(Pcb *pcbp, u8 *bp, int len, u8 blockType)
 **------------------------------------------------------------------------*/
 static void npuNjeAsciiToEbcdic(u8 *ascii, u8 *ebcdic, int len)
     {
-    while (len-- > 0)
-        {
-        *ebcdic++ = asciiToEbcdic[*ascii++];
-        }
+    charsetTranslate(ebcdic, ascii, len, asciiToEbcdic);
     }
 
 /*--------------------------------------------------------------------------
@@ -1459,9 +1450,10 @@ static void npuNjeCloseConnection(Pcb *pcbp)
     {
     Tcb *tcbp;
 
-#if DEBUG
-    fprintf(npuNjeLog, "Port %02x: close connection\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+        {
+        devLogText(npuNjeLog, "Port %02x: close connection\n", pcbp->claPort);
+        }
     tcbp = npuNjeFindTcb(pcbp);
     if ((tcbp != NULL) && (tcbp->state == StTermConnected))
         {
@@ -1553,10 +1545,11 @@ static u8 *npuNjeCollectBlock(Pcb *pcbp, u8 *start, u8 *limit, bool *isComplete,
                    | *(pcbp->controls.nje.inputBuf + TtbOffLength + 1);
     if (njeBlockSize > pcbp->controls.nje.blockSize)
         {
-#if DEBUG
-        fprintf(npuNjeLog, "Port %02x: block size received in TTB (%d) exceeds configured max block size (%d)\n",
-                pcbp->claPort, njeBlockSize, pcbp->controls.nje.blockSize);
-#endif
+        if (DevLogEnabled(npuNjeLog, DevLogError))
+            {
+            devLogText(npuNjeLog, "Port %02x: block size received in TTB (%d) exceeds configured max block size (%d)\n",
+                       pcbp->claPort, njeBlockSize, pcbp->controls.nje.blockSize);
+            }
         *status     = NjeErrBlockTooLong;
         *isComplete = TRUE;
 
@@ -1619,9 +1612,10 @@ static bool npuNjeConnectTerminal(Pcb *pcbp)
         }
     else
         {
-#if DEBUG
-        fprintf(npuNjeLog, "Port %02x: already associated with a TCB\n", pcbp->claPort);
-#endif
+        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+            {
+            devLogText(npuNjeLog, "Port %02x: already associated with a TCB\n", pcbp->claPort);
+            }
 
         return FALSE;
         }
@@ -1640,10 +1634,107 @@ static bool npuNjeConnectTerminal(Pcb *pcbp)
 **------------------------------------------------------------------------*/
 static void npuNjeEbcdicToAscii(u8 *ebcdic, u8 *ascii, int len)
     {
-    while (len-- > 0)
+    charsetTranslate(ascii, ebcdic, len, ebcdicToAscii);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Expand the SCB-encoded substrings of an upline record.
+**
+**                  Substrings are traversed until an SCB with value 0x00 is
+**                  encountered, which indicates end of record. At most
+**                  MaxUplineRecord bytes are stored; the remainder of a
+**                  longer record is discarded.
+**
+**  Parameters:     Name        Description.
+**                  ibpp        pointer to input pointer, advanced past the
+**                              end of record SCB on success, or past the
+**                              offending SCB on error
+**                  ibLimit     input limit
+**                  dst         pointer to output area
+**                  recLen      pointer to uncompressed record length
+**
+**  Returns:        NjeStatusOk, NjeErrBadSCB, or NjeErrProtocolError if
+**                  the end of record SCB is missing.
+**
+**------------------------------------------------------------------------*/
+static int npuNjeExpandRecord(u8 **ibpp, u8 *ibLimit, u8 *dst, int *recLen)
+    {
+    u8  fill;
+    u8  *ibp;
+    int len;
+    int n;
+    u8  scb;
+    int total;
+
+    ibp   = *ibpp;
+    total = 0;
+    while (ibp < ibLimit && *ibp != 0x00)
+        {
+        scb = *ibp++;
+        switch (scb & 0xc0)
+            {
+        case 0x40: // terminate stream transmission
+            break;
+
+        case 0x80: // compressed string
+            len = scb & 0x1f;
+            if ((scb & 0x20) == 0x20)
+                {
+                fill = (ibp < ibLimit) ? *ibp : 0;
+                ibp += 1;
+                }
+            else
+                {
+                fill = EbcdicBlank;
+                }
+            n = MaxUplineRecord - total;
+            if (n > len)
+                {
+                n = len;
+                }
+            if (n > 0)
+                {
+                memset(dst + total, fill, n);
+                }
+            total += len;
+            break;
+
+        case 0xc0: // non-compressed string
+            len = scb & 0x3f;
+            n   = MaxUplineRecord - total;
+            if (n > len)
+                {
+                n = len;
+                }
+            if (n > (int)(ibLimit - ibp))
+                {
+                n = (int)(ibLimit - ibp);
+                }
+            if (n > 0)
+                {
+                memcpy(dst + total, ibp, n);
+                }
+            ibp   += len;
+            total += len;
+            break;
+
+        default:
+            *ibpp = ibp;
+
+            return NjeErrBadSCB;
+            }
+        }
+    if (ibp >= ibLimit)
         {
-        *ascii++ = ebcdicToAscii[*ebcdic++];
+        *ibpp = ibp;
+
+        return NjeErrProtocolError;
         }
+
+    *ibpp   = ibp + 1; // advance past end of record SCB (0x00)
+    *recLen = total;
+
+    return NjeStatusOk;
     }
 
 /*--------------------------------------------------------------------------
@@ -1704,7 +1795,7 @@ static Tcb *npuNjeFindTcb(Pcb *pcbp)
         return tcbp;
         }
 
-    for (i = 1; i < MaxTcbs; i++)
+    for (i = 1; i <= npuNetMaxCN; i++)
         {
         tcbp = &npuTcbs[i];
         if ((tcbp->state != StTermIdle) && (tcbp->pcbp == pcbp))
@@ -1819,23 +1910,30 @@ static int npuNjeSend(Pcb *pcbp, u8 *dp, int len)
 
     n = send(pcbp->connFd, dp, len, 0);
     pcbp->controls.nje.lastXmit = getSeconds();
+    if (n > 0)
+        {
+        pcbp->bytesOut += n;
+        }
 
-#if DEBUG
     if (n > 0)
         {
-        fprintf(npuNjeLog, "Port %02x: TCP data sent to %s (%d/%d bytes)\n", pcbp->claPort, pcbp->ncbp->hostName, n, len);
-        npuNjeLogBytes(dp, n, EBCDIC);
-        npuNjeLogFlush();
+        if (DevLogEnabled(npuNjeLog, DevLogDebug))
+            {
+            devLogText(npuNjeLog, "Port %02x: TCP data sent to %s (%d/%d bytes)\n", pcbp->claPort, pcbp->ncbp->hostName, n, len);
+            npuNjeLogBytes(dp, n, EBCDIC);
+            }
         }
     else if (n == 0)
         {
-        fprintf(npuNjeLog, "Port %02x: TCP congested, no data sent to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+            {
+            devLogText(npuNjeLog, "Port %02x: TCP congested, no data sent to %s\n", pcbp->claPort, pcbp->ncbp->hostName);
+            }
         }
-    else
+    else if (DevLogEnabled(npuNjeLog, DevLogError))
         {
-        fprintf(npuNjeLog, "Port %02x: failed to send TCP data to %s (errno=%d)\n", pcbp->claPort, pcbp->ncbp->hostName, errno);
+        devLogText(npuNjeLog, "Port %02x: failed to send TCP data to %s (errno=%d)\n", pcbp->claPort, pcbp->ncbp->hostName, errno);
         }
-#endif
 
     return n;
     }
@@ -1970,13 +2068,13 @@ static void npuNjeTransmitQueuedBlocks(Pcb *pcbp)
                 }
             tcbp->uplineBlockLimit -= 1;
             npuBipRequestUplineTransfer(bp);
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: upline data sent from %.7s, size %d, block type %u, ubl %d, dbc %02x\n",
-                    pcbp->claPort, tcbp->termName, bp->numBytes - (BlkOffDbc + 1), bp->data[BlkOffBTBSN] & BlkMaskBT,
-                    tcbp->uplineBlockLimit, bp->data[BlkOffDbc]);
-            npuNjeLogBytes(bp->data, bp->numBytes, EBCDIC);
-            npuNjeLogFlush();
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: upline data sent from %.7s, size %d, block type %u, ubl %d, dbc %02x\n",
+                           pcbp->claPort, tcbp->termName, bp->numBytes - (BlkOffDbc + 1), bp->data[BlkOffBTBSN] & BlkMaskBT,
+                           tcbp->uplineBlockLimit, bp->data[BlkOffDbc]);
+                npuNjeLogBytes(bp->data, bp->numBytes, EBCDIC);
+                }
             }
         }
     }
@@ -2034,9 +2132,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
     int       len;
     u8        *obLimit;
     u8        *obp;
+    u8        *dst;
     int       recLen;
-    u8        scb;
-    u8        *start;
+    u8        scratch[MaxUplineRecord + 3];
+    int       status;
 
     *rcb             = *srcb = 0;
     ibp              = blkp;
@@ -2052,9 +2151,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
         len = (int)(ibLimit - ibp);
         if (len < 2)
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: block too short\n", pcbp->claPort);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: block too short\n", pcbp->claPort);
+                }
             npuBipBufRelease(bp);
 
             return NjeErrBlockTooShort;
@@ -2081,9 +2181,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 }
             if (*(ibp + 1) != STX)
                 {
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: bad block leader\n", pcbp->claPort);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: bad block leader\n", pcbp->claPort);
+                    }
                 npuBipBufRelease(bp);
 
                 return NjeErrBadLeader;
@@ -2096,9 +2197,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
         */
         if (len < 7)
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: block too short, %d < min 7\n", pcbp->claPort, len);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                {
+                devLogText(npuNjeLog, "Port %02x: block too short, %d < min 7\n", pcbp->claPort, len);
+                }
             npuBipBufRelease(bp);
 
             return NjeErrBlockTooShort;
@@ -2121,15 +2223,17 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 {
                 // Continue to validate the block, and then discard it
                 pcbp->controls.nje.retries += 1;
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: retransmission (%d) detected (bsn %02x), block will be discarded\n",
-                        pcbp->claPort, pcbp->controls.nje.retries, bsn);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: retransmission (%d) detected (bsn %02x), block will be discarded\n",
+                               pcbp->claPort, pcbp->controls.nje.retries, bsn);
+                    }
                 if (pcbp->controls.nje.retries > MaxRetries)
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: retransmission limit (%d) exceeded\n", pcbp->claPort, MaxRetries);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: retransmission limit (%d) exceeded\n", pcbp->claPort, MaxRetries);
+                        }
 
                     return NjeErrTooManyRetries;
                     }
@@ -2137,10 +2241,11 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 }
             else
                 {
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: invalid sequence number in BCB (%02x) of data block (expected bsn %02x)\n",
-                        pcbp->claPort, *ibp, (pcbp->controls.nje.uplineBSN + 1) & 0x0f);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: invalid sequence number in BCB (%02x) of data block (expected bsn %02x)\n",
+                               pcbp->claPort, *ibp, (pcbp->controls.nje.uplineBSN + 1) & 0x0f);
+                    }
                 npuBipBufRelease(bp);
 
                 return NjeErrBadBSN;
@@ -2166,9 +2271,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
         **  BCB: invalid
         */
         default:
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: invalid BCB (%02x)\n", pcbp->claPort, *ibp);
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogError))
+                {
+                devLogText(npuNjeLog, "Port %02x: invalid BCB (%02x)\n", pcbp->claPort, *ibp);
+                }
             npuBipBufRelease(bp);
 
             return NjeErrBadBCB;
@@ -2180,9 +2286,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
         ibp += 1;
         if (((*ibp & 0x80) == 0x00) || ((*(ibp + 1) & 0x80) == 0x00))
             {
-#if DEBUG
-            fprintf(npuNjeLog, "Port %02x: invalid FCS (%02x%02x) in data block\n", pcbp->claPort, *ibp, *(ibp + 1));
-#endif
+            if (DevLogEnabled(npuNjeLog, DevLogError))
+                {
+                devLogText(npuNjeLog, "Port %02x: invalid FCS (%02x%02x) in data block\n", pcbp->claPort, *ibp, *(ibp + 1));
+                }
             npuBipBufRelease(bp);
 
             return NjeErrBadFCS;
@@ -2215,9 +2322,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 case SRCB_RespSignon:
                     if (obp != bp->data + BlkOffDbc + 1)
                         {
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: GCR is not first record in block\n", pcbp->claPort);
-#endif
+                        if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                            {
+                            devLogText(npuNjeLog, "Port %02x: GCR is not first record in block\n", pcbp->claPort);
+                            }
                         npuBipBufRelease(bp);
 
                         return NjeErrProtocolError;
@@ -2230,9 +2338,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 case SRCB_AddConnection:
                 case SRCB_DeleteConnection:
                 default:
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: unsupported GCR type %02x\n", pcbp->claPort, *srcb);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: unsupported GCR type %02x\n", pcbp->claPort, *srcb);
+                        }
                     npuBipBufRelease(bp);
 
                     return NjeErrProtocolError;
@@ -2297,9 +2406,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
             case 0x9a:                  // command or message record
                 if (ibLimit - ibp <= 0) // must be at least long enough to have an SCB
                     {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: block too short for RCB (%02x)\n", pcbp->claPort, *rcb);
-#endif
+                    if (DevLogEnabled(npuNjeLog, DevLogInfo))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: block too short for RCB (%02x)\n", pcbp->claPort, *rcb);
+                        }
                     npuBipBufRelease(bp);
 
                     return NjeErrBlockTooShort;
@@ -2322,125 +2432,62 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                     }
 
                 /*
-                **  Make two passes across the record. Calculate the total uncompressed
-                **  length of the record in the first pass, and copy the uncompressed
-                **  data to the output buffer in the second pass.  If the record won't
-                **  fit into the current upline buffer, queue the buffer and start a new
-                **  one.
-                **
-                **  Substrings are traversed until an SCB with value 0x00 is encountered.
-                **  A 0x00 SCB indicates end of record.
+                **  Expand the substrings of the record in a single pass. When there is
+                **  room in the current upline buffer for a record of maximum length, the
+                **  record is expanded in place. Otherwise, it is expanded into a scratch
+                **  area, and the upline buffer is queued and a new one started if the
+                **  record turns out not to fit.
                 */
-
-                /*  Pass 1: calculate total uncompressed record length */
-                start  = ibp;
-                recLen = 0;
-                while (ibp < ibLimit && *ibp != 0x00)
+                dst    = (obLimit - obp >= MaxUplineRecord + 3) ? obp : scratch;
+                status = npuNjeExpandRecord(&ibp, ibLimit, dst + 3, &recLen);
+                if (status != NjeStatusOk)
                     {
-                    scb = *ibp++;
-                    switch (scb & 0xc0)
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
                         {
-                    case 0x40: // terminate stream transmission
-                        break;
-
-                    case 0x80: // compressed string
-                        recLen += scb & 0x1f;
-                        if ((scb & 0x20) == 0x20)
+                        if (status == NjeErrBadSCB)
                             {
-                            ibp += 1;
+                            devLogText(npuNjeLog, "Port %02x: bad SCB (%02x) for RCB (%02x)\n", pcbp->claPort, *(ibp - 1), *rcb);
+                            }
+                        else
+                            {
+                            devLogText(npuNjeLog, "Port %02x: end of record SCB (00) missing for RCB (%02x)\n", pcbp->claPort, *rcb);
                             }
-                        break;
-
-                    case 0xc0: // non-compressed string
-                        recLen += scb & 0x3f;
-                        ibp    += scb & 0x3f;
-                        break;
-
-                    default:
-#if DEBUG
-                        fprintf(npuNjeLog, "Port %02x: bad SCB (%02x) for RCB (%02x)\n", pcbp->claPort, scb, *rcb);
-#endif
-                        npuBipBufRelease(bp);
-
-                        return NjeErrBadSCB;
                         }
-                    }
-                if (ibp >= ibLimit)
-                    {
-#if DEBUG
-                    fprintf(npuNjeLog, "Port %02x: end of record SCB (00) missing for RCB (%02x)\n", pcbp->claPort, *rcb);
-#endif
                     npuBipBufRelease(bp);
 
-                    return NjeErrProtocolError;
-                    }
-                if (obp + recLen + 3 > obLimit)
-                    {
-                    if (isRetransmission == FALSE)
-                        {
-                        npuNjeSendUplineBlock(pcbp, bp, obp, BtHTBLK);
-                        blocksUploaded += 1;
-                        bp              = npuBipBufGet();
-                        }
-                    obp     = bp->data + BlkOffDbc + 1;
-                    obLimit = bp->data + MaxUplineBlockSize;
+                    return status;
                     }
                 if (recLen == 0) // end of stream
                     {
                     blockType = BtHTMSG;
                     }
-#if DEBUG
-                if (recLen > 255)
+                if (recLen > MaxUplineRecord)
                     {
-                    fprintf(npuNjeLog, "Port %02x: upline record too long (%d > 255), will be truncated\n", pcbp->claPort, recLen);
+                    if (DevLogEnabled(npuNjeLog, DevLogError))
+                        {
+                        devLogText(npuNjeLog, "Port %02x: upline record too long (%d > 255), will be truncated\n", pcbp->claPort, recLen);
+                        }
+                    recLen = MaxUplineRecord;
                     }
-#endif
-                /*  Pass 2: copy substrings to output buffer */
-                ibp    = start;
-                *obp++ = (recLen < 256) ? (u8)recLen : 255;
-                *obp++ = *rcb;
-                *obp++ = *srcb;
-                recLen = 0;
-                while (ibp < ibLimit && *ibp != 0x00)
+                dst[0] = (u8)recLen;
+                dst[1] = *rcb;
+                dst[2] = *srcb;
+                if (dst == scratch)
                     {
-                    scb = *ibp++;
-                    switch (scb & 0xc0)
+                    if (obp + recLen + 3 > obLimit)
                         {
-                    case 0x80: // compressed string
-                        len = scb & 0x1f;
-                        if ((scb & 0x20) == 0x20)
+                        if (isRetransmission == FALSE)
                             {
-                            while (len-- > 0 && recLen++ < 255)
-                                {
-                                *obp++ = *ibp;
-                                }
-                            ibp += 1;
-                            }
-                        else
-                            {
-                            while (len-- > 0 && recLen++ < 255)
-                                {
-                                *obp++ = EbcdicBlank;
-                                }
-                            }
-                        break;
-
-                    case 0xc0: // non-compressed string
-                        len = scb & 0x3f;
-                        while (len > 0 && recLen < 255)
-                            {
-                            *obp++  = *ibp++;
-                            len    -= 1;
-                            recLen += 1;
+                            npuNjeSendUplineBlock(pcbp, bp, obp, BtHTBLK);
+                            blocksUploaded += 1;
+                            bp              = npuBipBufGet();
                             }
-                        ibp += len;
-                        break;
-
-                    default:
-                        break;
+                        obp     = bp->data + BlkOffDbc + 1;
+                        obLimit = bp->data + MaxUplineBlockSize;
                         }
+                    memcpy(obp, scratch, recLen + 3);
                     }
-                ibp += 1; // advance past end of record SCB (0x00)
+                obp += recLen + 3;
 
                 /*
                 **  If the block is type BtHTMSG, flush it upline.
@@ -2459,9 +2506,10 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
                 break;
 
             default:
-#if DEBUG
-                fprintf(npuNjeLog, "Port %02x: invalid RCB (%02x)\n", pcbp->claPort, *ibp);
-#endif
+                if (DevLogEnabled(npuNjeLog, DevLogError))
+                    {
+                    devLogText(npuNjeLog, "Port %02x: invalid RCB (%02x)\n", pcbp->claPort, *ibp);
+                    }
                 npuBipBufRelease(bp);
 
                 return NjeErrBadRCB;
@@ -2497,31 +2545,8 @@ static int npuNjeUploadBlock(Pcb *pcbp, u8 *blkp, int size, u8 *rcb, u8 *srcb)
     return (blocksUploaded > 0) ? NjeStatusOk : NjeStatusNothingUploaded;
     }
 
-#if DEBUG
-
 /*--------------------------------------------------------------------------
-**  Purpose:        Flush incomplete data line
-**
-**  Parameters:     Name        Description.
-**
-**  Returns:        nothing
-**
-**------------------------------------------------------------------------*/
-static void npuNjeLogFlush(void)
-    {
-    if (npuNjeLogBytesCol > 0)
-        {
-        fputs(npuNjeLogBuf, npuNjeLog);
-        fputc('\n', npuNjeLog);
-        fflush(npuNjeLog);
-        }
-    npuNjeLogBytesCol = 0;
-    memset(npuNjeLogBuf, ' ', LogLineLength);
-    npuNjeLogBuf[LogLineLength] = '\0';
-    }
-
-/*--------------------------------------------------------------------------
-**  Purpose:        Log a sequence of ASCII or EBCDIC bytes
+**  Purpose:        Log a sequence of ASCII, EBCDIC or display code bytes
 **
 **  Parameters:     Name        Description.
 **                  bytes       pointer to sequence of bytes
@@ -2536,16 +2561,23 @@ static void npuNjeLogBytes(u8 *bytes, int len, CharEncoding encoding)
     u8   ac;
     int  ascCol;
     u8   b;
+    int  col;
     char hex[3];
     int  hexCol;
     int  i;
+    char line[LogLineLength + 1];
 
-    ascCol = AsciiColumn(npuNjeLogBytesCol);
-    hexCol = HexColumn(npuNjeLogBytesCol);
-
+    col = 0;
     for (i = 0; i < len; i++)
         {
-        b = bytes[i];
+        if (col == 0)
+            {
+            memset(line, ' ', LogLineLength);
+            line[LogLineLength] = '\0';
+            }
+        ascCol = AsciiColumn(col);
+        hexCol = HexColumn(col);
+        b      = bytes[i];
         switch (encoding)
             {
         default:
@@ -2566,44 +2598,37 @@ static void npuNjeLogBytes(u8 *bytes, int len, CharEncoding encoding)
             ac = '.';
             }
         sprintf(hex, "%02x", b);
-        memcpy(npuNjeLogBuf + hexCol, hex, 2);
-        hexCol += 3;
-        npuNjeLogBuf[ascCol++] = ac;
-        if (++npuNjeLogBytesCol >= 16)
+        memcpy(line + hexCol, hex, 2);
+        line[ascCol] = ac;
+        if (++col >= 16)
             {
-            npuNjeLogFlush();
-            ascCol = AsciiColumn(npuNjeLogBytesCol);
-            hexCol = HexColumn(npuNjeLogBytesCol);
+            devLogText(npuNjeLog, "%s\n", line);
+            col = 0;
             }
         }
+    if (col > 0)
+        {
+        devLogText(npuNjeLog, "%s\n", line);
+        }
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Log a stack trace
+**  Purpose:        Log data the socket took from a terminal's output queue.
 **
-**  Parameters:     none
+**  Parameters:     Name        Description.
+**                  tp          pointer to TCB
+**                  data        pointer to data sent
+**                  len         length of data sent
 **
 **  Returns:        nothing
 **
 **------------------------------------------------------------------------*/
-static void npuNjePrintStackTrace(FILE *fp)
+static void npuNjeLogSent(Tcb *tp, u8 *data, int len)
     {
-#if defined(__APPLE__)
-    void *callstack[128];
-    int  i;
-    int  frames;
-    char **strs;
-
-    frames = backtrace(callstack, 128);
-    strs   = backtrace_symbols(callstack, frames);
-    for (i = 1; i < frames; ++i)
+    if (DevLogEnabled(npuNjeLog, DevLogDebug))
         {
-        fprintf(fp, "%s\n", strs[i]);
+        npuNjeLogBytes(data, len, EBCDIC);
         }
-    free(strs);
-#endif
     }
 
-#endif // DEBUG
-
 /*---------------------------  End Of File  ------------------------------*/
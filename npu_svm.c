@@ -24,8 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG 0
-
 /*
 **  -------------
 **  Include Files
@@ -290,9 +288,7 @@ static void (*notifyTermDisconnect[])(Tcb *tp) =
     NULL                           // ConnTypeTrunk
     };
 
-#if DEBUG
-static FILE *npuSvmLog = NULL;
-#endif
+static DevLogModule *npuSvmLog;
 
 /*
  **--------------------------------------------------------------------------
@@ -335,14 +331,7 @@ void npuSvmInit(void)
     blockTerminateConnection[BlkOffDN] = npuSvmCouplerNode;
     blockTerminateConnection[BlkOffSN] = npuSvmNpuNode;
 
-#if DEBUG
-    npuSvmLog = fopen("svmlog.txt", "wt");
-    if (npuSvmLog == NULL)
-        {
-        logDtError(LogErrorLocation, "svmlog.txt - aborting\n");
-        exit(1);
-        }
-#endif
+    npuSvmLog = devLogRegister("npusvm");
     }
 
 /*--------------------------------------------------------------------------
@@ -373,9 +362,10 @@ void npuSvmReset(void)
 **------------------------------------------------------------------------*/
 void npuSvmNotifyTermDisconnect(Tcb *tp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Notify TIP of %.7s disconnect in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Notify TIP of %.7s disconnect in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+        }
 
     notifyTermDisconnect[tp->pcbp->ncbp->connType](tp);
     }
@@ -391,9 +381,10 @@ void npuSvmNotifyTermDisconnect(Tcb *tp)
 **------------------------------------------------------------------------*/
 void npuSvmNotifyHostRegulation(u8 regLevel)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Regulation level %02x, SVM state is %d\n", regLevel, svmState);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Regulation level %02x, SVM state is %d\n", regLevel, svmState);
+        }
 
     if ((svmState == StIdle) || (regLevel != oldRegLevel))
         {
@@ -420,9 +411,10 @@ void npuSvmNotifyHostRegulation(u8 regLevel)
 **------------------------------------------------------------------------*/
 bool npuSvmConnectTerminal(Pcb *pcbp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Connect terminal on CLA port %02x\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Connect terminal on CLA port %02x\n", pcbp->claPort);
+        }
 
     if (npuSvmRequestTerminalConfig(pcbp))
         {
@@ -535,9 +527,10 @@ void npuSvmProcessBuffer(NpuBuffer *bp)
     /*
     **  Process message.
     */
-#if DEBUG
-    fprintf(npuSvmLog, "Process downline message PFC %02x SFC %02x for CN %02x\n", block[BlkOffPfc], block[BlkOffSfc], block[BlkOffCN]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Process downline message PFC %02x SFC %02x for CN %02x\n", block[BlkOffPfc], block[BlkOffSfc], block[BlkOffCN]);
+        }
 
     switch (block[BlkOffPfc])
         {
@@ -662,9 +655,10 @@ void npuSvmProcessBuffer(NpuBuffer *bp)
     case PfcTCN:
         if (block[BlkOffSfc] == SfcTA)
             {
-#if DEBUG
-            fprintf(npuSvmLog, "TCN/TA/R received for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+            if (DevLogEnabled(npuSvmLog, DevLogInfo))
+                {
+                devLogText(npuSvmLog, "TCN/TA/R received for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+                }
 
             /*
             **  Host requests terminal disconnection.
@@ -684,9 +678,10 @@ void npuSvmProcessBuffer(NpuBuffer *bp)
             }
         else if (block[BlkOffSfc] == (SfcTA | SfcResp))
             {
-#if DEBUG
-            fprintf(npuSvmLog, "TCN/TA/N received for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+            if (DevLogEnabled(npuSvmLog, DevLogInfo))
+                {
+                devLogText(npuSvmLog, "TCN/TA/N received for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+                }
             if (tp->state == StTermNpuRequestDisconnect)
                 {
                 npuSvmNotifyTermDisconnect(tp);
@@ -741,9 +736,10 @@ void npuSvmProcessBuffer(NpuBuffer *bp)
 **------------------------------------------------------------------------*/
 void npuSvmProcessTermBlock(Tcb *tp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Process TERM block for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Process TERM block for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+        }
 
     if (tp->state == StTermHostRequestDisconnect)
         {
@@ -766,12 +762,10 @@ void npuSvmProcessTermBlock(Tcb *tp)
         */
         npuSvmSendTermBlock(tp);
         }
-#if DEBUG
-    else
+    else if (DevLogEnabled(npuSvmLog, DevLogInfo))
         {
-        fputs("TERM block ignored.\n", npuSvmLog);
+        devLogText(npuSvmLog, "TERM block ignored.\n");
         }
-#endif
     }
 
 /*--------------------------------------------------------------------------
@@ -785,9 +779,10 @@ void npuSvmProcessTermBlock(Tcb *tp)
 **------------------------------------------------------------------------*/
 void npuSvmSendDiscReply(Tcb *tp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Send TCN/TA/N for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Send TCN/TA/N for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+        }
 
     responseTerminateConnection[BlkOffP3] = tp->cn;
     npuBipRequestUplineCanned(responseTerminateConnection, sizeof(responseTerminateConnection));
@@ -804,9 +799,10 @@ void npuSvmSendDiscReply(Tcb *tp)
 **------------------------------------------------------------------------*/
 void npuSvmSendDiscRequest(Tcb *tp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Send TCN/TA/R for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Send TCN/TA/R for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+        }
 
     switch (tp->state)
         {
@@ -866,9 +862,10 @@ bool npuSvmIsReady(void)
 **------------------------------------------------------------------------*/
 void npuSvmSendTermBlock(Tcb *tp)
     {
-#if DEBUG
-    fprintf(npuSvmLog, "Send TERM block for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Send TERM block for %.7s in state %s\n", tp->termName, npuSvmTermStates[tp->state]);
+        }
 
     blockTerminateConnection[BlkOffCN] = tp->cn;
     npuBipRequestUplineCanned(blockTerminateConnection, sizeof(blockTerminateConnection));
@@ -896,9 +893,10 @@ static bool npuSvmRequestTerminalConfig(Pcb *pcbp)
     NpuBuffer *bp;
     u8        *mp;
 
-#if DEBUG
-    fprintf(npuSvmLog, "Request terminal configuration for CLA port %02x\n", pcbp->claPort);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Request terminal configuration for CLA port %02x\n", pcbp->claPort);
+        }
 
     bp = npuBipBufGet();
     if (bp == NULL)
@@ -994,25 +992,28 @@ static Tcb *npuSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp)
     u8  lastResp;
     u8  codeSet;
 
-#if DEBUG
-    fprintf(npuSvmLog, "Process terminal configuration reply for CLA port %02x\n", claPort);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Process terminal configuration reply for CLA port %02x\n", claPort);
+        }
 
     pcbp = npuNetFindPcb(claPort);
     if (pcbp == NULL)
         {
-#if DEBUG
-        fprintf(npuSvmLog, "PCB not found for port 0x%02x\n", claPort);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "PCB not found for port 0x%02x\n", claPort);
+            }
 
         return NULL;
         }
 
     if (pcbp->connFd <= 0)
         {
-#if DEBUG
-        fprintf(npuSvmLog, "TCB not allocated for port 0x%02x because network connection is closed\n", claPort);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "TCB not allocated for port 0x%02x because network connection is closed\n", claPort);
+            }
 
         return NULL;
         }
@@ -1020,9 +1021,10 @@ static Tcb *npuSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp)
     tp = npuTipFindFreeTcb();
     if (tp == NULL)
         {
-#if DEBUG
-        fprintf(npuSvmLog, "No free TCB available for port 0x%02x\n", claPort);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "No free TCB available for port 0x%02x\n", claPort);
+            }
 
         return NULL;
         }
@@ -1052,9 +1054,10 @@ static Tcb *npuSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp)
     len -= (int)(mp - bp->data);
     if (len < 0)
         {
-#if DEBUG
-        fprintf(npuSvmLog, "Short Terminal Configuration response with length %d\n", bp->numBytes);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "Short Terminal Configuration response with length %d\n", bp->numBytes);
+            }
 
         return NULL;
         }
@@ -1096,10 +1099,11 @@ static Tcb *npuSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp)
         break;
 
     default:
-#if DEBUG
-        fprintf(npuSvmLog, "Invalid connection type for terminal configuration: %d\n",
-                tp->pcbp->ncbp->connType);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "Invalid connection type for terminal configuration: %d\n",
+                       tp->pcbp->ncbp->connType);
+            }
 
         return NULL;
         }
@@ -1121,9 +1125,10 @@ static Tcb *npuSvmProcessTerminalConfig(u8 claPort, NpuBuffer *bp)
     tp->owningConsole = npuSvmFindOwningConsole(tp);
     if (tp->owningConsole == NULL)
         {
-#if DEBUG
-        fprintf(npuSvmLog, "Failed to find owning console for %.7s, port 0x%02x\n", tp->termName, claPort);
-#endif
+        if (DevLogEnabled(npuSvmLog, DevLogError))
+            {
+            devLogText(npuSvmLog, "Failed to find owning console for %.7s, port 0x%02x\n", tp->termName, claPort);
+            }
 
         return NULL;
         }
@@ -1212,9 +1217,10 @@ static bool npuSvmRequestTerminalConnection(Tcb *tp)
     NpuBuffer *bp;
     u8        *mp;
 
-#if DEBUG
-    fprintf(npuSvmLog, "Request connection %02x for terminal %.7s\n", tp->cn, tp->termName);
-#endif
+    if (DevLogEnabled(npuSvmLog, DevLogInfo))
+        {
+        devLogText(npuSvmLog, "Request connection %02x for terminal %.7s\n", tp->cn, tp->termName);
+        }
 
     bp = npuBipBufGet();
     if (bp == NULL)
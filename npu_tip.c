@@ -24,8 +24,6 @@
 **--------------------------------------------------------------------------
 */
 
-#define DEBUG    0
-
 /*
 **  -------------
 **  Include Files
@@ -148,18 +146,15 @@ static void npuTipSetupDefaultTc9(void);
 static void npuTipSetupDefaultTc14(void);
 static void npuTipSetupDefaultTc28(void);
 static void npuTipSetupDefaultTc29(void);
-
-#if DEBUG
 static void npuTipLogFnFv(Tcb *tp, u8 fn, u8 fv);
 
-#endif
-
 /*
 **  ----------------
 **  Public Variables
 **  ----------------
 */
-Tcb npuTcbs[MaxTcbs];
+int npuTcbCount = MaxTcbs;
+Tcb *npuTcbs    = NULL;
 
 /*
 **  -----------------
@@ -229,9 +224,7 @@ static void (*notifyAck[])(Tcb *tp, u8 bsn) =
     npuTipNotifyAck   // ConnTypeTrunk
     };
 
-#if DEBUG
-static FILE *npuTipLog = NULL;
-#endif
+static DevLogModule *npuTipLog;
 
 /*
  **--------------------------------------------------------------------------
@@ -241,6 +234,31 @@ static FILE *npuTipLog = NULL;
  **--------------------------------------------------------------------------
  */
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Allocate the TCB table, sized by the 'maxConnections'
+**                  entry of the NPU section. Connection number 0 is not
+**                  used, so the table has one more entry than that.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void npuTipAllocTcbs(void)
+    {
+    if (npuTcbs != NULL)
+        {
+        return;
+        }
+
+    npuTcbs = (Tcb *)calloc(npuTcbCount, sizeof(Tcb));
+    if (npuTcbs == NULL)
+        {
+        logDtError(LogErrorLocation, "Failed to allocate %d NPU terminal control blocks\n", npuTcbCount);
+        exit(1);
+        }
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Initialize TIP.
 **
@@ -283,7 +301,8 @@ void npuTipInit(void)
     /*
     **  Initialise TCBs.
     */
-    for (i = 0; i < MaxTcbs; i++)
+    npuTipAllocTcbs();
+    for (i = 0; i < npuTcbCount; i++)
         {
         tp = &npuTcbs[i];
         memset(tp, 0, sizeof(Tcb));
@@ -297,14 +316,7 @@ void npuTipInit(void)
     */
     npuNetInit(TRUE);
 
-#if DEBUG
-    npuTipLog = fopen("tiplog.txt", "wt");
-    if (npuTipLog == NULL)
-        {
-        logDtError(LogErrorLocation, "tiplog.txt - aborting\n");
-        exit(1);
-        }
-#endif
+    npuTipLog = devLogRegister("nputip");
     }
 
 /*--------------------------------------------------------------------------
@@ -323,7 +335,7 @@ void npuTipReset(void)
     /*
     **  Initialise TCBs.
     */
-    for (i = 0; i < MaxTcbs; i++)
+    for (i = 0; i < npuTcbCount; i++)
         {
         tp = &npuTcbs[i];
         memset(tp, 0, sizeof(Tcb));
@@ -350,7 +362,7 @@ Tcb *npuTipFindFreeTcb(void)
     {
     int i;
 
-    for (i = 1; i < MaxTcbs; i++)
+    for (i = 1; i < npuTcbCount; i++)
         {
         if (npuTcbs[i].state == StTermIdle)
             {
@@ -372,6 +384,11 @@ Tcb *npuTipFindFreeTcb(void)
 **------------------------------------------------------------------------*/
 Tcb *npuTipFindTcbForCN(u8 cn)
     {
+    if (cn >= npuTcbCount)
+        {
+        return NULL;
+        }
+
     return &npuTcbs[cn];
     }
 
@@ -400,25 +417,20 @@ void npuTipProcessBuffer(NpuBuffer *bp, int priority)
     tp = npuTipFindTcbForCN(cn);
     if (tp == NULL)
         {
-#if DEBUG
-        fprintf(npuTipLog, "Unexpected connection number %u in message, PFC/SFC %02x/%02x\n", cn,
-                block[BlkOffPfc], block[BlkOffSfc]);
-#endif
+        if (DevLogEnabled(npuTipLog, DevLogError))
+            {
+            devLogText(npuTipLog, "Unexpected connection number %u in message, PFC/SFC %02x/%02x\n", cn,
+                       block[BlkOffPfc], block[BlkOffSfc]);
+            }
 
         return;
         }
-#if DEBUG
+    if (DevLogEnabled(npuTipLog, DevLogInfo))
         {
-        int i;
-        fprintf(npuTipLog, "Connection %u received block type %02x, PFC %02x, SFC %02x\n   ",
-                cn, block[BlkOffBTBSN] & BlkMaskBT, block[BlkOffPfc], block[BlkOffSfc]);
-        for (i = 0; i < bp->numBytes; i++)
-            {
-            fprintf(npuTipLog, " %02x", bp->data[i]);
-            }
-        fputs("\n", npuTipLog);
+        devLogText(npuTipLog, "Connection %u received block type %02x, PFC %02x, SFC %02x\n",
+                   cn, block[BlkOffBTBSN] & BlkMaskBT, block[BlkOffPfc], block[BlkOffSfc]);
+        devLogBytes(npuTipLog, bp->data, bp->numBytes);
         }
-#endif
 
     switch (block[BlkOffBTBSN] & BlkMaskBT)
         {
@@ -492,12 +504,10 @@ void npuTipProcessBuffer(NpuBuffer *bp, int priority)
                 {
                 npuHaspNotifyTerminateOutput(tp, block[BlkOffSfc]);
                 }
-#if DEBUG
-            else
+            else if (DevLogEnabled(npuTipLog, DevLogError))
                 {
-                fputs("Unexpected TO command for non-HASP connection\n", npuTipLog);
+                devLogText(npuTipLog, "Unexpected TO command for non-HASP connection\n");
                 }
-#endif
             break;
 
         case PfcSI:
@@ -509,18 +519,17 @@ void npuTipProcessBuffer(NpuBuffer *bp, int priority)
                 {
                 npuHaspNotifyStartInput(tp, block[BlkOffSfc]);
                 }
-#if DEBUG
-            else
+            else if (DevLogEnabled(npuTipLog, DevLogError))
                 {
-                fputs("Unexpected SI command for non-HASP connection\n", npuTipLog);
+                devLogText(npuTipLog, "Unexpected SI command for non-HASP connection\n");
                 }
-#endif
             break;
 
         default:
-#if DEBUG
-            fputs("Unrecognized TIP command\n", npuTipLog);
-#endif
+            if (DevLogEnabled(npuTipLog, DevLogError))
+                {
+                devLogText(npuTipLog, "Unrecognized TIP command\n");
+                }
             break;
             }
 
@@ -615,9 +624,10 @@ void npuTipProcessBuffer(NpuBuffer *bp, int priority)
         break;
 
     default:
-#if DEBUG
-        fputs("Unrecognized block type\n", npuTipLog);
-#endif
+        if (DevLogEnabled(npuTipLog, DevLogError))
+            {
+            devLogText(npuTipLog, "Unrecognized block type\n");
+            }
         break;
         }
 
@@ -639,9 +649,10 @@ void npuTipProcessBuffer(NpuBuffer *bp, int priority)
 **------------------------------------------------------------------------*/
 void npuTipSetupTerminalClass(Tcb *tp, u8 tc)
     {
-#if DEBUG
-    fprintf(npuTipLog, "Connection %u set terminal class to %u\n", tp->cn, tc);
-#endif
+    if (DevLogEnabled(npuTipLog, DevLogInfo))
+        {
+        devLogText(npuTipLog, "Connection %u set terminal class to %u\n", tp->cn, tc);
+        }
 
     switch (tc)
         {
@@ -713,9 +724,11 @@ bool npuTipParseFnFv(u8 *mp, int len, Tcb *tp)
 
     while (len > 0)
         {
-#if DEBUG
-        npuTipLogFnFv(tp, mp[0], mp[1]);
-#endif
+        if (DevLogEnabled(npuTipLog, DevLogInfo))
+            {
+            npuTipLogFnFv(tp, mp[0], mp[1]);
+            }
+
         switch (mp[0])
             {
         case FnTdAbortBlock:     // Abort block character
@@ -982,9 +995,10 @@ bool npuTipParseFnFv(u8 *mp, int len, Tcb *tp)
             break;
 
         default:
-#if DEBUG
-            fprintf(npuTipLog, "Unknown FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
-#endif
+            if (DevLogEnabled(npuTipLog, DevLogError))
+                {
+                devLogText(npuTipLog, "Unknown FN/FV (%d/%d)[%02x/%02x]\n", mp[0], mp[1], mp[0], mp[1]);
+                }
             break;
             }
 
@@ -1663,7 +1677,6 @@ static void npuTipSetupDefaultTc29(void)
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-#if DEBUG
 static void npuTipLogFnFv(Tcb *tp, u8 fn, u8 fv)
     {
     char kbuf[5];
@@ -1914,9 +1927,7 @@ static void npuTipLogFnFv(Tcb *tp, u8 fn, u8 fv)
         kw = kbuf;
         break;
         }
-    fprintf(npuTipLog, "Connection %u set terminal parameter %s=<%02x>\n", tp->cn, kw, fv);
+    devLogText(npuTipLog, "Connection %u set terminal parameter %s=<%02x>\n", tp->cn, kw, fv);
     }
 
-#endif
-
 /*---------------------------  End Of File  ------------------------------*/
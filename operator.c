@@ -66,6 +66,7 @@
 #define CwdPathSize      256
 #define MaxCardParams    10
 #define MaxCmdStkSize    10
+#define OpKeyQueueSize   256
 
 /*
 **  -----------------------
@@ -137,9 +138,15 @@ static void opCmdDumpEM(int fwa, int count);
 static void opCmdDumpPP(int pp, int fwa, int count);
 static void opHelpDumpMemory(void);
 
+static void opCmdCommitDisk(bool help, char *cmdParams);
+static void opHelpCommitDisk(void);
+
+static void opCmdDiscardDisk(bool help, char *cmdParams);
+static void opHelpDiscardDisk(void);
+
 static void opCmdEnterKeys(bool help, char *cmdParams);
 static void opHelpEnterKeys(void);
-static void opWaitKeyConsume();
+static void opWaitKeyConsume(void);
 
 static void opCmdHelp(bool help, char *cmdParams);
 static void opHelpHelp(void);
@@ -172,6 +179,9 @@ static void opHelpRemoveCards(void);
 static void opCmdRemovePaper(bool help, char *cmdParams);
 static void opHelpRemovePaper(void);
 
+static void opCmdSetDeviceLog(bool help, char *cmdParams);
+static void opHelpSetDeviceLog(void);
+
 static void opCmdSetKeyInterval(bool help, char *cmdParams);
 static void opHelpSetKeyInterval(void);
 
@@ -190,6 +200,12 @@ static void opHelpShowDisk(void);
 static void opCmdShowEquipment(bool help, char *cmdParams);
 static void opHelpShowEquipment(void);
 
+static void opCmdShowLatency(bool help, char *cmdParams);
+static void opHelpShowLatency(void);
+
+static void opCmdShowMetrics(bool help, char *cmdParams);
+static void opHelpShowMetrics(void);
+
 static void opCmdShowNetwork(bool help, char *cmdParams);
 static void opHelpShowNetwork(void);
 
@@ -240,6 +256,7 @@ volatile bool opPaused = FALSE;
 static OpCmd decode[] =
     {
     "ccw",                   opCmdCloseConsoleWindow,
+    "cd",                    opCmdCommitDisk,
     "d",                     opCmdDumpMemory,
     "drc",                   opCmdDiscRemoteConsole,
     "dm",                    opCmdDumpMemory,
@@ -255,6 +272,9 @@ static OpCmd decode[] =
     "sa",                    opCmdShowAll,
     "sd",                    opCmdShowDisk,
     "se",                    opCmdShowEquipment,
+    "sl",                    opCmdShowLatency,
+    "sm",                    opCmdShowMetrics,
+    "sdl",                   opCmdSetDeviceLog,
     "ski",                   opCmdSetKeyInterval,
     "skwi",                  opCmdSetKeyWaitInterval,
     "sn",                    opCmdShowNetwork,
@@ -267,7 +287,10 @@ static OpCmd decode[] =
     "sv",                    opCmdShowVersion,
     "ud",                    opCmdUnloadDisk,
     "ut",                    opCmdUnloadTape,
+    "xd",                    opCmdDiscardDisk,
     "close_console_window",  opCmdCloseConsoleWindow,
+    "commit_disk",           opCmdCommitDisk,
+    "discard_disk",          opCmdDiscardDisk,
     "disconnect_remote_console", opCmdDiscRemoteConsole,
     "dump_memory",           opCmdDumpMemory,
     "enter_keys",            opCmdEnterKeys,
@@ -277,12 +300,15 @@ static OpCmd decode[] =
     "open_console_window",   opCmdOpenConsoleWindow,
     "remove_cards",          opCmdRemoveCards,
     "remove_paper",          opCmdRemovePaper,
+    "set_device_log",        opCmdSetDeviceLog,
     "set_key_interval",      opCmdSetKeyInterval,
     "set_key_wait_interval", opCmdSetKeyWaitInterval,
     "set_operator_port",     opCmdSetOperatorPort,
     "show_all",              opCmdShowAll,
     "show_disk",             opCmdShowDisk,
     "show_equipment",        opCmdShowEquipment,
+    "show_latency",          opCmdShowLatency,
+    "show_metrics",          opCmdShowMetrics,
     "show_network",          opCmdShowNetwork,
     "show_state",            opCmdShowState,
     "show_tape",             opCmdShowTape,
@@ -327,6 +353,17 @@ static int opListenHandle = 0;
 #endif
 static int opListenPort = 0;
 
+/*
+**  Keys entered by enter_keys waiting to be read by the console.
+*/
+static char         opKeyQueue[OpKeyQueueSize];
+static volatile int opKeyQueueIn  = 0;
+static volatile int opKeyQueueOut = 0;
+#if !defined(_WIN32)
+static pthread_mutex_t opKeyMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  opKeyCond  = PTHREAD_COND_INITIALIZER;
+#endif
+
 static char opInBuf[256];
 static int  opInIdx = 0;
 static char opOutBuf[MaxFSPath * 2 + 128];
@@ -350,6 +387,31 @@ static int  opOutIdx = 0;
 **------------------------------------------------------------------------*/
 void opInit(void)
     {
+    OpCmdStackEntry *ep;
+
+    /*
+    **  In benchmark mode commands come from the benchmark script and are
+    **  executed by the main emulation thread, so there is no operator
+    **  thread and no command input.
+    */
+    if (benchActive)
+        {
+        ep          = &opCmdStack[opCmdStackPtr];
+        ep->in      = -1;
+        ep->out     = fileno(stdout);
+        ep->netConn = 0;
+        if (getcwd(ep->cwd, CwdPathSize) == NULL)
+            {
+            fputs("    > Failed to get current working directory path\n", stderr);
+            exit(1);
+            }
+#if defined(_WIN32)
+        opToUnixPath(ep->cwd);
+#endif
+
+        return;
+        }
+
     /*
     **  Create the operator thread which accepts command input.
     */
@@ -409,6 +471,38 @@ void opDisplay(char *msg)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Hand the next key entered by enter_keys to the console.
+**                  Called by the console whenever the PP reads the keyboard.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        ASCII key, or 0 if no key is waiting.
+**
+**------------------------------------------------------------------------*/
+char opGetKey(void)
+    {
+    char key;
+
+    if (opKeyQueueOut == opKeyQueueIn)
+        {
+        return (0);
+        }
+
+#if defined(_WIN32)
+    key           = opKeyQueue[opKeyQueueOut];
+    opKeyQueueOut = (opKeyQueueOut + 1) % OpKeyQueueSize;
+#else
+    pthread_mutex_lock(&opKeyMutex);
+    key           = opKeyQueue[opKeyQueueOut];
+    opKeyQueueOut = (opKeyQueueOut + 1) % OpKeyQueueSize;
+    pthread_cond_signal(&opKeyCond);
+    pthread_mutex_unlock(&opKeyMutex);
+#endif
+
+    return (key);
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Reports whether operator input is currently being taken
 **                  from the console.
@@ -445,6 +539,189 @@ void opRequest(void)
         }
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Execute an operator command on the calling thread.
+**                  Used by the benchmark script, which runs on the main
+**                  emulation thread.
+**
+**  Parameters:     Name        Description.
+**                  cmd         command line
+**
+**  Returns:        FALSE if the command is not recognised.
+**
+**------------------------------------------------------------------------*/
+bool opExecute(char *cmd)
+    {
+    OpCmd *cp;
+    char  name[80];
+    char  *params;
+
+    params = opGetString(cmd, name, sizeof(name));
+    for (cp = decode; cp->name != NULL; cp++)
+        {
+        if (strcasecmp(cp->name, name) == 0)
+            {
+            strcpy(opCmdParams, params);
+            cp->handler(FALSE, opCmdParams);
+
+            return (TRUE);
+            }
+        }
+
+    return (FALSE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Substitute the values of %keyword% references in an
+**                  enter_keys key sequence.
+**
+**  Parameters:     Name        Description.
+**                  cmdParams   key sequence as entered
+**                  keybuf      buffer for the edited sequence
+**                  size        size of keybuf
+**
+**  Returns:        FALSE if the sequence is invalid.
+**
+**------------------------------------------------------------------------*/
+bool opExpandKeys(char *cmdParams, char *keybuf, int size)
+    {
+    char      *bp;
+    time_t    clock;
+    char      *cp;
+    char      *kp;
+    char      *limit;
+    char      timestamp[20];
+    struct tm *tmp;
+
+    /*
+     *  Keywords are delimited by '%'.
+     */
+    clock = time(NULL);
+    tmp   = localtime(&clock);
+    sprintf(timestamp, "%02d%02d%02d%02d%02d%02d",
+            (u8)tmp->tm_year - 100, (u8)tmp->tm_mon + 1, (u8)tmp->tm_mday,
+            (u8)tmp->tm_hour, (u8)tmp->tm_min, (u8)tmp->tm_sec);
+    cp    = cmdParams;
+    bp    = keybuf;
+    limit = bp + size - 2;
+    while (*cp != '\0' && bp < limit)
+        {
+        if (*cp == '%')
+            {
+            kp = ++cp;
+            while (*cp != '%' && *cp != '\0')
+                {
+                cp += 1;
+                }
+            if (*cp == '%')
+                {
+                *cp++ = '\0';
+                }
+            if (strcasecmp(kp, "year") == 0)
+                {
+                memcpy(bp, timestamp, 2);
+                bp += 2;
+                }
+            else if (strcasecmp(kp, "mon") == 0)
+                {
+                memcpy(bp, timestamp + 2, 2);
+                bp += 2;
+                }
+            else if (strcasecmp(kp, "day") == 0)
+                {
+                memcpy(bp, timestamp + 4, 2);
+                bp += 2;
+                }
+            else if (strcasecmp(kp, "hour") == 0)
+                {
+                memcpy(bp, timestamp + 6, 2);
+                bp += 2;
+                }
+            else if (strcasecmp(kp, "min") == 0)
+                {
+                memcpy(bp, timestamp + 8, 2);
+                bp += 2;
+                }
+            else if (strcasecmp(kp, "sec") == 0)
+                {
+                memcpy(bp, timestamp + 10, 2);
+                bp += 2;
+                }
+            else
+                {
+                sprintf(opOutBuf, "Unrecognized keyword: %%%s%%\n", kp);
+                opDisplay(opOutBuf);
+
+                return (FALSE);
+                }
+            }
+        else
+            {
+            *bp++ = *cp++;
+            }
+        }
+    if (bp > limit)
+        {
+        opDisplay("Key sequence is too long\n");
+
+        return (FALSE);
+        }
+    *bp = '\0';
+
+    return (TRUE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Reports whether keys queued by enter_keys are still
+**                  waiting to be read by the console.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        TRUE if keys are pending.
+**
+**------------------------------------------------------------------------*/
+bool opKeysPending(void)
+    {
+    return (opKeyQueueOut != opKeyQueueIn);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Queue a key for the console, waiting for room if the
+**                  console has not caught up yet.
+**
+**  Parameters:     Name        Description.
+**                  key         ASCII key
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+void opPutKey(char key)
+    {
+    int next;
+
+    next = (opKeyQueueIn + 1) % OpKeyQueueSize;
+
+#if defined(_WIN32)
+    while (next == opKeyQueueOut)
+        {
+        sleepMsec(opKeyWaitInterval);
+        }
+
+    opKeyQueue[opKeyQueueIn] = key;
+    opKeyQueueIn = next;
+#else
+    pthread_mutex_lock(&opKeyMutex);
+    while (next == opKeyQueueOut)
+        {
+        pthread_cond_wait(&opKeyCond, &opKeyMutex);
+        }
+
+    opKeyQueue[opKeyQueueIn] = key;
+    opKeyQueueIn = next;
+    pthread_mutex_unlock(&opKeyMutex);
+#endif
+    }
+
 /*
  **--------------------------------------------------------------------------
  **
@@ -1423,21 +1700,14 @@ static void opHelpDumpMemory(void)
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-char opKeyIn           = 0;
 long opKeyInterval     = 250;
 long opKeyWaitInterval = 100;
 
 static void opCmdEnterKeys(bool help, char *cmdParams)
     {
-    char      *bp;
-    time_t    clock;
-    char      *cp;
-    char      keybuf[256];
-    char      *kp;
-    char      *limit;
-    long      msec;
-    char      timestamp[20];
-    struct tm *tmp;
+    char *cp;
+    char keybuf[256];
+    long msec;
 
     /*
     **  Process help request.
@@ -1451,79 +1721,12 @@ static void opCmdEnterKeys(bool help, char *cmdParams)
 
     /*
      *  First, edit the parameter string to subtitute values
-     *  for keywords. Keywords are delimited by '%'.
+     *  for keywords.
      */
-    clock = time(NULL);
-    tmp   = localtime(&clock);
-    sprintf(timestamp, "%02d%02d%02d%02d%02d%02d",
-            (u8)tmp->tm_year - 100, (u8)tmp->tm_mon + 1, (u8)tmp->tm_mday,
-            (u8)tmp->tm_hour, (u8)tmp->tm_min, (u8)tmp->tm_sec);
-    cp    = cmdParams;
-    bp    = keybuf;
-    limit = bp + sizeof(keybuf) - 2;
-    while (*cp != '\0' && bp < limit)
+    if (!opExpandKeys(cmdParams, keybuf, sizeof(keybuf)))
         {
-        if (*cp == '%')
-            {
-            kp = ++cp;
-            while (*cp != '%' && *cp != '\0')
-                {
-                cp += 1;
-                }
-            if (*cp == '%')
-                {
-                *cp++ = '\0';
-                }
-            if (strcasecmp(kp, "year") == 0)
-                {
-                memcpy(bp, timestamp, 2);
-                bp += 2;
-                }
-            else if (strcasecmp(kp, "mon") == 0)
-                {
-                memcpy(bp, timestamp + 2, 2);
-                bp += 2;
-                }
-            else if (strcasecmp(kp, "day") == 0)
-                {
-                memcpy(bp, timestamp + 4, 2);
-                bp += 2;
-                }
-            else if (strcasecmp(kp, "hour") == 0)
-                {
-                memcpy(bp, timestamp + 6, 2);
-                bp += 2;
-                }
-            else if (strcasecmp(kp, "min") == 0)
-                {
-                memcpy(bp, timestamp + 8, 2);
-                bp += 2;
-                }
-            else if (strcasecmp(kp, "sec") == 0)
-                {
-                memcpy(bp, timestamp + 10, 2);
-                bp += 2;
-                }
-            else
-                {
-                sprintf(opOutBuf, "Unrecognized keyword: %%%s%%\n", kp);
-                opDisplay(opOutBuf);
-
-                return;
-                }
-            }
-        else
-            {
-            *bp++ = *cp++;
-            }
-        }
-    if (bp > limit)
-        {
-        opDisplay("Key sequence is too long\n");
-
         return;
         }
-    *bp = '\0';
 
     /*
      *  Next, traverse the key sequence, supplying keys to the console
@@ -1544,19 +1747,19 @@ static void opCmdEnterKeys(bool help, char *cmdParams)
         switch (*cp)
             {
         default:
-            opKeyIn = *cp;
+            opPutKey(*cp);
             break;
 
         case ';':
-            opKeyIn = '\r';
+            opPutKey('\r');
             break;
 
         case '_':
-            opKeyIn = ' ';
+            opPutKey(' ');
             break;
 
         case '^':
-            opKeyIn = '\b';
+            opPutKey('\b');
             break;
 
         case '#':
@@ -1570,17 +1773,17 @@ static void opCmdEnterKeys(bool help, char *cmdParams)
                 {
                 cp -= 1;
                 }
+            opWaitKeyConsume();
             sleepMsec(msec);
             break;
             }
         cp += 1;
-        opWaitKeyConsume();
         }
     if (*cp != '!')
         {
-        opKeyIn = '\r';
-        opWaitKeyConsume();
+        opPutKey('\r');
         }
+    opWaitKeyConsume();
     }
 
 static void opHelpEnterKeys(void)
@@ -1601,12 +1804,86 @@ static void opHelpEnterKeys(void)
     opDisplay("    >        # - delimiter for milliseconds pause value (e.g., #500#)\n");
     }
 
-static void opWaitKeyConsume()
+/*--------------------------------------------------------------------------
+**  Purpose:        Wait until the console has read all queued keys.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opWaitKeyConsume(void)
     {
-    while (opKeyIn != 0)
+#if defined(_WIN32)
+    while (opKeyQueueOut != opKeyQueueIn)
         {
         sleepMsec(opKeyWaitInterval);
         }
+#else
+    pthread_mutex_lock(&opKeyMutex);
+    while (opKeyQueueOut != opKeyQueueIn)
+        {
+        pthread_cond_wait(&opKeyCond, &opKeyMutex);
+        }
+    pthread_mutex_unlock(&opKeyMutex);
+#endif
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Set device log level.
+**
+**  Parameters:     Name        Description.
+**                  help        Request only help on this command.
+**                  cmdParams   Command parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opCmdSetDeviceLog(bool help, char *cmdParams)
+    {
+    char level[16];
+    char module[16];
+    int  numParam;
+
+    /*
+    **  Process help request.
+    */
+    if (help)
+        {
+        opHelpSetDeviceLog();
+
+        return;
+        }
+
+    if (strlen(cmdParams) == 0)
+        {
+        devLogShow();
+
+        return;
+        }
+
+    numParam = sscanf(cmdParams, "%15[^,],%15s", module, level);
+    if (numParam != 2)
+        {
+        opDisplay("    > Missing or invalid parameter\n");
+        opHelpSetDeviceLog();
+
+        return;
+        }
+
+    if (!devLogSetLevel(module, level))
+        {
+        opDisplay("    > Unknown module or level\n");
+        devLogShow();
+        }
+    }
+
+static void opHelpSetDeviceLog(void)
+    {
+    opDisplay("    > 'set_device_log <module>,<level>' set the log level of a device module.\n");
+    opDisplay("    >     <module> module name as listed by set_device_log without parameters, or 'all'\n");
+    opDisplay("    >     <level>  one of 'off', 'error', 'info' or 'debug'\n");
+    opDisplay("    >     Records are written to <module>log.txt in the current directory.\n");
     }
 
 /*--------------------------------------------------------------------------
@@ -1688,7 +1965,7 @@ static void opCmdSetKeyWaitInterval(bool help, char *cmdParams)
 
 static void opHelpSetKeyWaitInterval(void)
     {
-    opDisplay("    > 'set_keywait_interval <millisecs>' set the interval between keyboard scans of the emulated system console.\n");
+    opDisplay("    > 'set_keywait_interval <millisecs>' set the interval between checks whether the emulated system console has read the entered keys (Windows only).\n");
     sprintf(opOutBuf, "    > [Current key wait interval is %ld msec.]\n", opKeyWaitInterval);
     opDisplay(opOutBuf);
     }
@@ -2681,6 +2958,90 @@ static void opCmdLoadDisk(bool help, char *cmdParams)
 static void opHelpLoadDisk(void)
     {
     opDisplay("    > 'load_disk <channel>,<equipment>,<unit>,<filename>' load specified disk.\n");
+    opDisplay("    > '<filename>' may be '<base>+<delta>' to load a copy-on-write overlay of disk image <base>.\n");
+    opDisplay("    > <delta> is a file name in the directory of <base>.\n");
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Commit the changes of an overlay disk into its base
+**
+**  Parameters:     Name        Description.
+**                  help        Request only help on this command.
+**                  cmdParams   Command parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opCmdCommitDisk(bool help, char *cmdParams)
+    {
+    /*
+    **  Process help request.
+    */
+    if (help)
+        {
+        opHelpCommitDisk();
+
+        return;
+        }
+
+    /*
+    **  Check parameters and process command.
+    */
+    if (strlen(cmdParams) == 0)
+        {
+        opDisplay("    > No parameters supplied\n");
+        opHelpCommitDisk();
+
+        return;
+        }
+
+    dd8xxCommitDisk(cmdParams);
+    }
+
+static void opHelpCommitDisk(void)
+    {
+    opDisplay("    > 'commit_disk <channel>,<equipment>,<unit>' merge overlay of specified disk unit into its base image.\n");
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Discard the changes of an overlay disk
+**
+**  Parameters:     Name        Description.
+**                  help        Request only help on this command.
+**                  cmdParams   Command parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opCmdDiscardDisk(bool help, char *cmdParams)
+    {
+    /*
+    **  Process help request.
+    */
+    if (help)
+        {
+        opHelpDiscardDisk();
+
+        return;
+        }
+
+    /*
+    **  Check parameters and process command.
+    */
+    if (strlen(cmdParams) == 0)
+        {
+        opDisplay("    > No parameters supplied\n");
+        opHelpDiscardDisk();
+
+        return;
+        }
+
+    dd8xxDiscardDisk(cmdParams);
+    }
+
+static void opHelpDiscardDisk(void)
+    {
+    opDisplay("    > 'discard_disk <channel>,<equipment>,<unit>' throw away overlay changes of specified disk unit.\n");
     }
 
 /*--------------------------------------------------------------------------
@@ -3429,6 +3790,119 @@ static void opHelpShowEquipment(void)
     opDisplay("    > 'show_equipment' show status of all attached equipment.\n");
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Show major cycle latency histogram and stalls, or
+**                  control latency tracking.
+**
+**  Parameters:     Name        Description.
+**                  help        Request only help on this command.
+**                  cmdParams   Command parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opCmdShowLatency(bool help, char *cmdParams)
+    {
+    char *end;
+    long usec;
+
+    /*
+    **  Process help request.
+    */
+    if (help)
+        {
+        opHelpShowLatency();
+
+        return;
+        }
+
+    /*
+    **  Check parameters and process command.
+    */
+    if (strlen(cmdParams) == 0)
+        {
+        latencyShow();
+        }
+    else if (strcasecmp(cmdParams, "on") == 0)
+        {
+        latencyEnable(TRUE);
+        opDisplay("    > Cycle latency tracking on\n");
+        }
+    else if (strcasecmp(cmdParams, "off") == 0)
+        {
+        latencyEnable(FALSE);
+        opDisplay("    > Cycle latency tracking off\n");
+        }
+    else if (strcasecmp(cmdParams, "reset") == 0)
+        {
+        latencyReset();
+        opDisplay("    > Cycle latency statistics cleared\n");
+        }
+    else
+        {
+        usec = strtol(cmdParams, &end, 10);
+        if ((*end != '\0') || (usec <= 0) || (usec > 10000000))
+            {
+            opDisplay("    > Invalid parameter\n");
+            opHelpShowLatency();
+
+            return;
+            }
+
+        latencySetThreshold((u32)usec);
+        opDisplay("    > Stall threshold set\n");
+        }
+    }
+
+static void opHelpShowLatency(void)
+    {
+    opDisplay("    > 'show_latency' show major cycle latency histogram and stall attribution.\n");
+    opDisplay("    > 'show_latency on|off' turn cycle latency tracking on or off.\n");
+    opDisplay("    > 'show_latency reset' discard collected statistics.\n");
+    opDisplay("    > 'show_latency <usec>' set the cycle time above which a cycle is a stall.\n");
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Show emulator performance metrics
+**
+**  Parameters:     Name        Description.
+**                  help        Request only help on this command.
+**                  cmdParams   Command parameters
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void opCmdShowMetrics(bool help, char *cmdParams)
+    {
+    /*
+    **  Process help request.
+    */
+    if (help)
+        {
+        opHelpShowMetrics();
+
+        return;
+        }
+
+    /*
+    **  Check parameters and process command.
+    */
+    if (strlen(cmdParams) != 0)
+        {
+        opDisplay("    > No parameters expected\n");
+        opHelpShowMetrics();
+
+        return;
+        }
+
+    metricsShow();
+    }
+
+static void opHelpShowMetrics(void)
+    {
+    opDisplay("    > 'show_metrics' show emulator throughput since the previous show_metrics.\n");
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Show status of data communication interfaces
 **
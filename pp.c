@@ -44,6 +44,12 @@
 **  -----------------
 */
 
+/*
+**  Spin loop detection limits.
+*/
+#define PpSpinMaxBody    8
+#define PpSpinMinHits    2
+
 /*
 **  -----------------------
 **  Private Macro Functions
@@ -202,6 +208,14 @@ static void ppOpOAPM(void);   // 1073
 static u32 ppAdd18(u32 op1, u32 op2);
 static u32 ppSubtract18(u32 op1, u32 op2);
 static void ppInterlock(PpWord func);
+static bool ppIsBlockIo(void);
+static void ppJumpShort(bool taken);
+static void ppParkOnChannel(u8 kind, bool state);
+static bool ppParkStep(void);
+static void ppSpinDetect(PpWord jump);
+static bool ppSpinIsPure(PpWord first, PpWord jump);
+static void ppStep170(void);
+static void ppStep180(void);
 
 #if PPDEBUG
 static void ppValidateCmWrite(char *inst, u32 address, CpWord data);
@@ -216,9 +230,12 @@ static void ppValidateCmWrite(char *inst, u32 address, CpWord data);
 PpSlot *ppu;
 PpSlot *activePpu;
 u8     ppuCount;
+bool   ppBlockIo               = FALSE;
+bool   ppSpinPark              = FALSE;
 u32    ppuOsBoundary           = 0;
 bool   ppuOsBoundsCheckEnabled = FALSE;
 bool   ppuStopEnabled          = FALSE;
+void   (*ppStep)(void);
 
 /*
 **  -----------------
@@ -233,6 +250,12 @@ static PpWord location;
 static u32    acc18;
 static bool   noHang;
 
+/*
+**  Sign18 if the model has a relocation register, zero otherwise, so the
+**  relocation test in the CM access instructions is a single mask.
+*/
+static u32 ppRelocSign;
+
 static void (*ppOp170[])(void) =
     {
     ppOpPSN,    // 00
@@ -402,6 +425,12 @@ void ppInit(u8 count)
         exit(1);
         }
 
+    /*
+    **  Select the step variant and relocation mask for this model.
+    */
+    ppStep      = ((features & IsCyber180) != 0) ? ppStep180 : ppStep170;
+    ppRelocSign = ((features & HasRelocationReg) != 0) ? Sign18 : 0;
+
     /*
     **  Optionally read in persistent CM and ECS contents.
     */
@@ -447,6 +476,8 @@ void ppInit(u8 count)
         {
         ppu[pp].id            = pp;
         ppu[pp].exchangingCpu = -1;
+        ppu[pp].park          = PpParkNone;
+        ppu[pp].spinP         = PpNoSpin;
         }
 
     pp = 0;
@@ -495,17 +526,23 @@ void ppTerminate(void)
     }
 
 /*--------------------------------------------------------------------------
-**  Purpose:        Execute one instruction in an active PPU.
+**  Purpose:        Execute one instruction in each active PPU.
+**
+**                  This is the common body of ppStep170 and ppStep180;
+**                  isCyber180 is a constant in each caller so the opcode
+**                  decode is specialised per model.
 **
 **  Parameters:     Name        Description.
+**                  isCyber180  TRUE if the PPs have the Cyber 180 opcode set.
 **
 **  Returns:        Nothing.
 **
 **------------------------------------------------------------------------*/
-void ppStep(void)
+static inline void ppStepModel(bool isCyber180)
     {
     u8     i;
     PpWord opCode;
+    bool   timed = latencyActive;
 
     /*
     **  Exercise each PP in the barrel.
@@ -513,9 +550,14 @@ void ppStep(void)
     for (i = 0; i < ppuCount; i++)
         {
         /*
-        **  Advance to next PPU.
+        **  Advance to next PPU, time stamping the end of the previous
+        **  one's turn while latency tracking is on.
         */
         activePpu = ppu + i;
+        if (timed)
+            {
+            latencyPp(i);
+            }
 
         if (activePpu->exchangingCpu >= 0)
             {
@@ -534,12 +576,20 @@ void ppStep(void)
 
         if (!activePpu->busy)
             {
+            /*
+            **  A PP parked in a spin loop only checks the event it waits for.
+            */
+            if ((activePpu->park != PpParkNone) && ppParkStep())
+                {
+                continue;
+                }
+
             /*
             **  Extract next PPU instruction.
             */
             opCode = activePpu->mem[activePpu->regP];
  
-            if ((features & IsCyber180) != 0)
+            if (isCyber180)
                 {
                 opF = (opCode >> 6) & 01777;
                 }
@@ -566,6 +616,8 @@ void ppStep(void)
             traceSequenceNo += 1;
 #endif
 
+            metrics.ppInstructions[i] += 1;
+
             /*
             **  Increment register P.
             */
@@ -585,6 +637,8 @@ void ppStep(void)
             }
         else
             {
+            metrics.ppBusyPasses[i] += 1;
+
             /*
             **  Resume PPU instruction.
             */
@@ -618,6 +672,39 @@ void ppStep(void)
             }
 #endif
         }
+
+    if (timed)
+        {
+        latencyPp(-1);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Execute one instruction in each active PPU on Cyber 170
+**                  and earlier models.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void ppStep170(void)
+    {
+    ppStepModel(FALSE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Execute one instruction in each active PPU on Cyber 180
+**                  models.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void ppStep180(void)
+    {
+    ppStepModel(TRUE);
     }
 
 /*
@@ -670,6 +757,277 @@ static u32 ppSubtract18(u32 op1, u32 op2)
     return (acc18 & Mask18);
     }
 
+/*--------------------------------------------------------------------------
+**  Purpose:        Determine whether a block I/O instruction (IAM/OAM) may
+**                  transfer several words within one PP step.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        TRUE if block I/O is enabled and the device connected
+**                  to the active channel has declared that it tolerates
+**                  back-to-back word transfers, FALSE otherwise.
+**
+**------------------------------------------------------------------------*/
+static bool ppIsBlockIo(void)
+    {
+    return (ppBlockIo
+            && (activeChannel->ioDevice != NULL)
+            && activeChannel->ioDevice->blockIo);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Complete a conditional short jump (ZJN, NJN, PJN, MJN)
+**                  and look for a CM polling loop closed by it.
+**
+**  Parameters:     Name        Description.
+**                  taken       TRUE if the jump condition is met.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void ppJumpShort(bool taken)
+    {
+    PpWord jump;
+
+    if (!taken)
+        {
+        /*
+        **  Falling through a loop closing jump leaves the loop, so any
+        **  loop candidate is stale from here on.
+        */
+        activePpu->spinP = PpNoSpin;
+
+        return;
+        }
+
+    jump = (activePpu->regP - 1) & Mask12;
+    PpAddOffset(activePpu->regP, opD);
+
+    if (ppSpinPark && (opD >= 040))
+        {
+        ppSpinDetect(jump);
+        }
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Park the active PP in a channel jump to itself (AJM,
+**                  IJM, FJM or EJM) until the channel state changes.
+**
+**  Parameters:     Name        Description.
+**                  kind        PpParkActive or PpParkFull.
+**                  state       channel state which keeps the PP looping.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void ppParkOnChannel(u8 kind, bool state)
+    {
+    /*
+    **  PCI channel state comes from outside the emulator, so it must be
+    **  queried by executing the instruction.
+    */
+    if ((activeChannel->ioDevice != NULL) && (activeChannel->ioDevice->devType == DtPciChannel))
+        {
+        return;
+        }
+
+    activePpu->park        = kind;
+    activePpu->parkChannel = activeChannel->id;
+    activePpu->parkState   = state;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Check the event a parked PP waits for and unpark the
+**                  PP when it has occurred.
+**
+**  Parameters:     Name        Description.
+**
+**  Returns:        TRUE if this PP step has been consumed, FALSE if the
+**                  PP must execute its next instruction.
+**
+**------------------------------------------------------------------------*/
+static bool ppParkStep(void)
+    {
+    CpWord data;
+
+    switch (activePpu->park)
+        {
+    case PpParkActive:
+        if (channel[activePpu->parkChannel].active == activePpu->parkState)
+            {
+            return (TRUE);
+            }
+
+        /*
+        **  Re-execute the jump which now falls through.
+        */
+        break;
+
+    case PpParkFull:
+        /*
+        **  FJM and EJM drive the device on every iteration, so keep doing
+        **  that. When the state changes this check has been the final
+        **  execution of the jump, so continue after it.
+        */
+        activeChannel = channel + activePpu->parkChannel;
+        channelIo();
+        if (activeChannel->full == activePpu->parkState)
+            {
+            return (TRUE);
+            }
+
+        activePpu->park  = PpParkNone;
+        activePpu->spinP = PpNoSpin;
+        activePpu->regP  = (activePpu->regP + 2) & Mask12;
+
+        return (TRUE);
+
+    case PpParkCm:
+        cpuPpReadMem(activePpu->parkAddress, &data);
+        if (data == activePpu->parkData)
+            {
+            return (TRUE);
+            }
+
+        /*
+        **  The PP is parked at the top of the loop with the state it had
+        **  on every iteration, so simply resume there.
+        */
+        break;
+        }
+
+    activePpu->park  = PpParkNone;
+    activePpu->spinP = PpNoSpin;
+
+    return (FALSE);
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Look for a CM polling loop, i.e. a short straight line
+**                  loop which only reads one CM word with CRD and PP
+**                  memory, and park the PP when two consecutive
+**                  iterations have left it in the same state.
+**
+**                  The body cannot be left except through the closing
+**                  jump, and the only PP memory it writes is the CRD
+**                  destination. Once an iteration reads the same CM word
+**                  and ends with the same A register as the one before,
+**                  further iterations cannot change the PP state until
+**                  that CM word changes.
+**
+**  Parameters:     Name        Description.
+**                  jump        address of the loop closing jump.
+**
+**  Returns:        Nothing.
+**
+**------------------------------------------------------------------------*/
+static void ppSpinDetect(PpWord jump)
+    {
+    if (activePpu->spinP != jump)
+        {
+        /*
+        **  New candidate loop.
+        */
+        activePpu->spinP    = jump;
+        activePpu->spinPure = ppSpinIsPure(activePpu->regP, jump);
+        activePpu->spinHits = 0;
+        }
+    else if (!activePpu->spinPure)
+        {
+        return;
+        }
+    else if ((activePpu->spinA == activePpu->regA)
+             && (activePpu->parkAddress == activePpu->cmAddress)
+             && (activePpu->parkData == activePpu->cmData))
+        {
+        activePpu->spinHits += 1;
+        if (activePpu->spinHits >= PpSpinMinHits)
+            {
+            activePpu->park = PpParkCm;
+
+            return;
+            }
+        }
+    else
+        {
+        activePpu->spinHits = 0;
+        }
+
+    activePpu->spinA       = activePpu->regA;
+    activePpu->parkAddress = activePpu->cmAddress;
+    activePpu->parkData    = activePpu->cmData;
+    }
+
+/*--------------------------------------------------------------------------
+**  Purpose:        Check that a loop body is straight line code which
+**                  contains exactly one CRD and otherwise only reads PP
+**                  memory and operates on the A register.
+**
+**  Parameters:     Name        Description.
+**                  first       address of first instruction of the body.
+**                  jump        address of the loop closing jump.
+**
+**  Returns:        TRUE if the body has no side effects, FALSE otherwise.
+**
+**------------------------------------------------------------------------*/
+static bool ppSpinIsPure(PpWord first, PpWord jump)
+    {
+    PpWord address;
+    PpWord op;
+    int    crdCount = 0;
+
+    if ((first > jump) || ((jump - first) > PpSpinMaxBody))
+        {
+        return (FALSE);
+        }
+
+    for (address = first; address < jump; address++)
+        {
+        op = activePpu->mem[address] >> 6;
+        switch (op)
+            {
+        case 000:   // PSN
+        case 010:   // SHN
+        case 011:   // LMN
+        case 012:   // LPN
+        case 013:   // SCN
+        case 014:   // LDN
+        case 015:   // LCN
+        case 016:   // ADN
+        case 017:   // SBN
+        case 030:   // LDD
+        case 031:   // ADD
+        case 032:   // SBD
+        case 033:   // LMD
+        case 040:   // LDI
+        case 041:   // ADI
+        case 042:   // SBI
+        case 043:   // LMI
+            break;
+
+        case 020:   // LDC
+        case 021:   // ADC
+        case 022:   // LPC
+        case 023:   // LMC
+        case 050:   // LDM
+        case 051:   // ADM
+        case 052:   // SBM
+        case 053:   // LMM
+            address += 1;
+            break;
+
+        case 060:   // CRD
+            crdCount += 1;
+            break;
+
+        default:
+            return (FALSE);
+            }
+        }
+
+    return ((address == jump) && (crdCount == 1));
+    }
+
 /*--------------------------------------------------------------------------
 **  Purpose:        Functions to implement all opcodes
 **
@@ -706,34 +1064,22 @@ static void ppOpUJN(void)     // 03
 
 static void ppOpZJN(void)     // 04
     {
-    if (activePpu->regA == 0)
-        {
-        PpAddOffset(activePpu->regP, opD);
-        }
+    ppJumpShort(activePpu->regA == 0);
     }
 
 static void ppOpNJN(void)     // 05
     {
-    if (activePpu->regA != 0)
-        {
-        PpAddOffset(activePpu->regP, opD);
-        }
+    ppJumpShort(activePpu->regA != 0);
     }
 
 static void ppOpPJN(void)     // 06
     {
-    if (activePpu->regA < 0400000)
-        {
-        PpAddOffset(activePpu->regP, opD);
-        }
+    ppJumpShort(activePpu->regA < 0400000);
     }
 
 static void ppOpMJN(void)     // 07
     {
-    if (activePpu->regA > 0377777)
-        {
-        PpAddOffset(activePpu->regP, opD);
-        }
+    ppJumpShort(activePpu->regA > 0377777);
     }
 
 static void ppOpSHN(void)     // 10
@@ -895,7 +1241,7 @@ static void ppOpEXN(void)     // 26
             return;
             }
         doChangeMode = FALSE;
-        if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+        if ((activePpu->regA & ppRelocSign) != 0)
             {
             exchangeAddress = activePpu->regR + (activePpu->regA & Mask17);
             if ((features & HasRelocationRegShort) != 0)
@@ -927,7 +1273,7 @@ static void ppOpEXN(void)     // 26
             **  MXN.
             */
 
-            if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+            if ((activePpu->regA & ppRelocSign) != 0)
                 {
                 exchangeAddress = activePpu->regR + (activePpu->regA & Mask17);
                 if ((features & HasRelocationRegShort) != 0)
@@ -1135,7 +1481,7 @@ static void ppOpCRD(void)     // 60
     u32    address;
     CpWord data;
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -1144,6 +1490,8 @@ static void ppOpCRD(void)     // 60
         address = activePpu->regA & Mask18;
         }
     cpuPpReadMem(address, &data);
+    activePpu->cmAddress = address;
+    activePpu->cmData    = data;
     activePpu->mem[opD++ & Mask12] = (PpWord)((data >> 48) & Mask12);
     activePpu->mem[opD++ & Mask12] = (PpWord)((data >> 36) & Mask12);
     activePpu->mem[opD++ & Mask12] = (PpWord)((data >> 24) & Mask12);
@@ -1167,7 +1515,7 @@ static void ppOpCRM(void)     // 61
         activePpu->regP   = activePpu->mem[activePpu->regP] & Mask12;
         }
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -1221,7 +1569,7 @@ static void ppOpCWD(void)     // 62
 
     data |= activePpu->mem[opD & Mask12] & Mask12;
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -1270,7 +1618,7 @@ static void ppOpCWM(void)     // 63
     data |= activePpu->mem[activePpu->regP] & Mask12;
     PpIncrement(activePpu->regP);
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -1332,6 +1680,11 @@ static void ppOpAJM(void)     // 64
         channelCheckIfActive();
         if (activeChannel->active)
             {
+            if (ppSpinPark && (location == ((activePpu->regP - 2) & Mask12)))
+                {
+                ppParkOnChannel(PpParkActive, TRUE);
+                }
+
             activePpu->regP = location;
             }
         }
@@ -1368,6 +1721,11 @@ static void ppOpIJM(void)     // 65
         channelCheckIfActive();
         if (!activeChannel->active)
             {
+            if (ppSpinPark && (location == ((activePpu->regP - 2) & Mask12)))
+                {
+                ppParkOnChannel(PpParkActive, FALSE);
+                }
+
             activePpu->regP = location;
             }
         }
@@ -1395,6 +1753,11 @@ static void ppOpFJM(void)     // 66
         channelCheckIfFull();
         if (activeChannel->full)
             {
+            if (ppSpinPark && (location == ((activePpu->regP - 2) & Mask12)))
+                {
+                ppParkOnChannel(PpParkFull, TRUE);
+                }
+
             activePpu->regP = location;
             }
         }
@@ -1432,6 +1795,11 @@ static void ppOpEJM(void)     // 67
         channelCheckIfFull();
         if (!activeChannel->full)
             {
+            if (ppSpinPark && (location == ((activePpu->regP - 2) & Mask12)))
+                {
+                ppParkOnChannel(PpParkFull, FALSE);
+                }
+
             activePpu->regP = location;
             }
         }
@@ -1519,45 +1887,53 @@ static void ppOpIAM(void)     // 71
         activeChannel = channel + (activePpu->opD & 037);
         }
 
-    channelCheckIfActive();
-    if (!activeChannel->active)
+    do
         {
-        /*
-        **  Disconnect device except for hardwired devices.
-        */
-        if (!activeChannel->hardwired)
+        channelCheckIfActive();
+        if (!activeChannel->active)
             {
-            activeChannel->ioDevice = NULL;
-            }
+            /*
+            **  Disconnect device except for hardwired devices.
+            */
+            if (!activeChannel->hardwired)
+                {
+                activeChannel->ioDevice = NULL;
+                }
 
-        /*
-        **  Channel becomes empty (must not call channelSetEmpty(), otherwise we
-        **  get a spurious empty pulse).
-        */
-        activeChannel->full = FALSE;
+            /*
+            **  Channel becomes empty (must not call channelSetEmpty(), otherwise we
+            **  get a spurious empty pulse).
+            */
+            activeChannel->full = FALSE;
 
-        /*
-        **  Terminate transfer and set next location to zero.
-        */
-        activePpu->mem[activePpu->regP] = 0;
-        activePpu->regP = activePpu->mem[0];
-        PpIncrement(activePpu->regP);
-        activePpu->busy = FALSE;
+            /*
+            **  Terminate transfer and set next location to zero.
+            */
+            activePpu->mem[activePpu->regP] = 0;
+            activePpu->regP = activePpu->mem[0];
+            PpIncrement(activePpu->regP);
+            activePpu->busy = FALSE;
 
-        return;
-        }
+            return;
+            }
 
-    channelCheckIfFull();
-    if (!activeChannel->full)
-        {
-        /*
-        **  Handle possible input.
-        */
-        channelIo();
-        }
+        channelCheckIfFull();
+        if (!activeChannel->full)
+            {
+            /*
+            **  Handle possible input.
+            */
+            channelIo();
+            }
+
+        if (!activeChannel->full && (activeChannel->id != ChClock))
+            {
+            /*
+            **  No data available yet - try again on the next barrel pass.
+            */
+            return;
+            }
 
-    if (activeChannel->full || (activeChannel->id == ChClock))
-        {
         /*
         **  Handle input (note that the clock channel has always data pending,
         **  but appears full on some models, empty on others).
@@ -1596,7 +1972,7 @@ static void ppOpIAM(void)     // 71
             PpIncrement(activePpu->regP);
             activePpu->busy = FALSE;
             }
-        }
+        } while (activePpu->busy && ppIsBlockIo());
     }
 
 static void ppOpOAN(void)     // 72
@@ -1657,55 +2033,63 @@ static void ppOpOAM(void)     // 73
         activeChannel = channel + (activePpu->opD & 037);
         }
 
-    channelCheckIfActive();
-    if (!activeChannel->active)
+    do
         {
-        /*
-        **  Disconnect device except for hardwired devices.
-        */
-        if (!activeChannel->hardwired)
+        channelCheckIfActive();
+        if (!activeChannel->active)
             {
-            activeChannel->ioDevice = NULL;
-            }
-
-        /*
-        **  Channel becomes empty (must not call channelSetEmpty(), otherwise we
-        **  get a spurious empty pulse).
-        */
-        activeChannel->full = FALSE;
+            /*
+            **  Disconnect device except for hardwired devices.
+            */
+            if (!activeChannel->hardwired)
+                {
+                activeChannel->ioDevice = NULL;
+                }
 
-        /*
-        **  Terminate transfer.
-        */
-        activePpu->regP = activePpu->mem[0];
-        PpIncrement(activePpu->regP);
-        activePpu->busy = FALSE;
+            /*
+            **  Channel becomes empty (must not call channelSetEmpty(), otherwise we
+            **  get a spurious empty pulse).
+            */
+            activeChannel->full = FALSE;
 
-        return;
-        }
+            /*
+            **  Terminate transfer.
+            */
+            activePpu->regP = activePpu->mem[0];
+            PpIncrement(activePpu->regP);
+            activePpu->busy = FALSE;
 
-    channelCheckIfFull();
-    if (!activeChannel->full)
-        {
-        activeChannel->data = activePpu->mem[activePpu->regP] & Mask12;
-        activePpu->regP     = (activePpu->regP + 1) & Mask12;
-        activePpu->regA     = (activePpu->regA - 1) & Mask18;
-        channelOut();
-        channelSetFull();
+            return;
+            }
 
-        if (activePpu->regA == 0)
+        channelCheckIfFull();
+        if (!activeChannel->full)
             {
-            activePpu->regP = activePpu->mem[0];
-            PpIncrement(activePpu->regP);
-            activePpu->busy            = FALSE;
-            activeChannel->delayStatus = 0; // ensure last byte is written
+            activeChannel->data = activePpu->mem[activePpu->regP] & Mask12;
+            activePpu->regP     = (activePpu->regP + 1) & Mask12;
+            activePpu->regA     = (activePpu->regA - 1) & Mask18;
+            channelOut();
+            channelSetFull();
+
+            if (activePpu->regA == 0)
+                {
+                activePpu->regP = activePpu->mem[0];
+                PpIncrement(activePpu->regP);
+                activePpu->busy            = FALSE;
+                activeChannel->delayStatus = 0; // ensure last byte is written
+                }
             }
-        }
 
-    /*
-    **  Handle possible output.
-    */
-    channelIo();
+        /*
+        **  Handle possible output.
+        */
+        channelIo();
+
+        /*
+        **  In block mode, carry on only as long as the device keeps
+        **  accepting words.
+        */
+        } while (activePpu->busy && !activeChannel->full && ppIsBlockIo());
     }
 
 static void ppOpACN(void)     // 74
@@ -1857,7 +2241,7 @@ static void ppOpRDSL(void)    // 1000
            | (((CpWord)activePpu->mem[(opD + 1) & Mask12]) << 32)
            | (((CpWord)activePpu->mem[(opD + 2) & Mask12]) << 16)
            | ((CpWord)activePpu->mem[(opD + 3) & Mask12]);
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -1885,7 +2269,7 @@ static void ppOpRDCL(void)    // 1001
            | (((CpWord)activePpu->mem[(opD + 1) & Mask12]) << 32)
            | (((CpWord)activePpu->mem[(opD + 2) & Mask12]) << 16)
            | ((CpWord)activePpu->mem[(opD + 3) & Mask12]);
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -2076,7 +2460,7 @@ static void ppOpCRDL(void)    // 1060
     u32    address;
     CpWord data;
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -2107,7 +2491,7 @@ static void ppOpCRML(void)    // 1061
         activePpu->regP   = activePpu->mem[activePpu->regP] & Mask12;
         }
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -2155,7 +2539,7 @@ static void ppOpCWDL(void)    // 1062
 
     data |= activePpu->mem[opD & Mask12] & Mask16;
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -2196,7 +2580,7 @@ static void ppOpCWML(void)    // 1063
     data |= activePpu->mem[activePpu->regP] & Mask16;
     PpIncrement(activePpu->regP);
 
-    if (((activePpu->regA & Sign18) != 0) && ((features & HasRelocationReg) != 0))
+    if ((activePpu->regA & ppRelocSign) != 0)
         {
         address = activePpu->regR + (activePpu->regA & Mask17);
         }
@@ -58,6 +58,13 @@
 **  reasons to the contrary.
 */
 
+/*
+**  bench.c
+*/
+void benchInit(void);
+void benchStep(void);
+void benchTerminate(void);
+
 /*
 **  channel.c
 */
@@ -77,12 +84,18 @@ void channelSetFull(void);
 void channelSetEmpty(void);
 void channelStep(void);
 void channelDisplayContext();
+char *channelDeviceTypeName(u8 devType);
 
 /*
 **  cdcnet.c
 */
 void cdcnetShowStatus(void);
 
+/*
+**  charset.c
+*/
+void charsetTranslate(u8 *dst, const u8 *src, int len, const u8 *table);
+
 /*
 **  console.c
 */
@@ -102,8 +115,6 @@ bool cpuDdpTransfer(u32 ecsAddress, CpWord *data, bool writeToEcs);
 bool cpuEcsFlagRegister(u32 ecsAddress);
 u32  cpuGetP(u8 cpuNum);
 void cpuInit(char *model, u32 memory, u32 emBanks, ExtMemory emType);
-void cpuPpReadMem(u32 address, CpWord *data);
-void cpuPpWriteMem(u32 address, CpWord data);
 void cpuReleaseExchangeMutex(void);
 void cpuReleaseMemoryMutex(void);
 void cpuStep(CpuContext *activeCpu);
@@ -152,6 +163,8 @@ void dd6603ShowDiskStatus();
 void dd844Init_2(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 void dd844Init_4(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 void dd885Init_1(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
+void dd8xxCommitDisk(char *params);
+void dd8xxDiscardDisk(char *params);
 void dd8xxLoadDisk(char *params);
 void dd8xxUnloadDisk(char *params);
 void dd8xxShowDiskStatus();
@@ -178,6 +191,32 @@ void ddpInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 */
 void deadStart(void);
 
+/*
+**  devlog.c
+*/
+void         devLogBytes(DevLogModule *mp, u8 *bytes, int len);
+DevLogModule *devLogRegister(char *name);
+bool         devLogSetLevel(char *name, char *level);
+void         devLogShow(void);
+void         devLogTerminate(void);
+void         devLogText(DevLogModule *mp, char *format, ...);
+void         devLogWords(DevLogModule *mp, PpWord *words, int count);
+
+/*
+**  diskio.c
+*/
+void       diskIoClose(DiskIoUnit *up);
+bool       diskIoCommit(DiskIoUnit *up);
+bool       diskIoDiscard(DiskIoUnit *up);
+void       diskIoFlush(DiskIoUnit *up);
+bool       diskIoIsOverlay(DiskIoUnit *up);
+DiskIoUnit *diskIoOpen(FILE *fcb);
+DiskIoUnit *diskIoOpenOverlay(FILE *fcb, char *baseName, char *deltaName);
+void       diskIoPrefetch(DiskIoUnit *up, i64 pos, int len);
+int        diskIoRead(DiskIoUnit *up, i64 pos, void *buf, int len);
+void       diskIoTerminate(void);
+void       diskIoWrite(DiskIoUnit *up, i64 pos, void *buf, int len);
+
 /*
 **  dsa311.c
 */
@@ -222,6 +261,19 @@ int   initOpenOperatorSection(void);
 */
 void ilrInit(u8 registerSize);
 
+/*
+**  latency.c
+*/
+void latencyCycleEnd(void);
+void latencyEnable(bool on);
+void latencyEnter(void);
+void latencyLeave(int phase, u8 channelNo);
+void latencyPhase(int phase);
+void latencyPp(int ppNo);
+void latencyReset(void);
+void latencySetThreshold(u32 usec);
+void latencyShow(void);
+
 /*
 **  lp1612.c
 */
@@ -237,6 +289,19 @@ void lp512Init(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceParams);
 void lp3000RemovePaper(char *params);
 void lp3000ShowStatus();
 
+/*
+**  lpspool.c
+*/
+void    lpSpoolClose(LpSpool *sp);
+void    lpSpoolFlush(LpSpool *sp);
+LpSpool *lpSpoolOpen(char *fileName, LpRotateDone rotated, void *owner);
+void    lpSpoolPutc(LpSpool *sp, char ch);
+void    lpSpoolPuts(LpSpool *sp, char *str);
+void    lpSpoolReport(void);
+void    lpSpoolRotate(LpSpool *sp, char *newName, bool isGenerated);
+i64     lpSpoolSize(LpSpool *sp);
+void    lpSpoolTerminate(void);
+
 /*
 **  log.c
 */
@@ -262,6 +327,12 @@ void mchInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 */
 void mdiInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 
+/*
+**  metrics.c
+*/
+void metricsInit(void);
+void metricsShow(void);
+
 /*
 **  msufrend.c
 */
@@ -359,6 +430,7 @@ void niuShowStatus();
 void npuInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 int npuBipBufCount(void);
 bool npuBipIsBusy(void);
+int npuNetConnectionCount(void);
 void npuNetShowStatus();
 
 /*
@@ -366,8 +438,13 @@ void npuNetShowStatus();
 */
 void opCmdLoadCards(bool help, char *cmdParams);
 void opDisplay(char *msg);
+bool opExecute(char *cmd);
+bool opExpandKeys(char *cmdParams, char *keybuf, int size);
+char opGetKey(void);
 void opInit(void);
 bool opIsConsoleInput(void);
+bool opKeysPending(void);
+void opPutKey(char key);
 void opRequest(void);
 
 /*
@@ -385,7 +462,6 @@ void pciConsoleInit(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
 */
 void ppInit(u8 count);
 void ppTerminate(void);
-void ppStep(void);
 
 /*
 **  rtc.c
@@ -474,6 +550,9 @@ extern const u8            asciiToEbcdic[256];
 extern const int           asciiToPlatoString[256];
 extern const i8            asciiToPlato[128];
 extern const char          bcdToAscii[64];
+extern bool                benchActive;
+extern bool                benchFailed;
+extern char                benchScript[MaxFSPath];
 extern bool                bigEndian;
 extern bool                cc545Enabled;
 extern const char          cdcToAscii[64];
@@ -491,12 +570,15 @@ extern CpWord              *cpMem;
 extern CpuContext          *cpus;
 extern int                 cpuCount;
 extern u32                 cpuMaxMemory;
+extern void                (*cpuPpReadMem)(u32 address, CpWord *data);
+extern void                (*cpuPpWriteMem)(u32 address, CpWord data);
 extern bool                cpuStopped;
 extern u32                 cycles;
 extern u8                  deviceCount;
 extern DevDesc             deviceDesc[];
 extern char                displayName[];
 extern const u8            ebcdicToAscii[256];
+extern const u8            ebcdicToCdc[256];
 extern bool                emulationActive;
 extern const char          extBcdToAscii[64];
 extern u32                 extMaxMemory;
@@ -511,6 +593,11 @@ extern long                fontMedium;                      // Console
 extern long                fontSmall;                       // Console
 extern char                fontName[];                      // Console
 extern long                heightPX;                        // Console
+extern bool                latencyActive;
+extern char                lpSpoolPostCmd[];
+extern volatile bool       lpSpoolReportPending;
+extern Metrics             metrics;
+extern u16                 metricsPort;
 extern ModelType           modelType;
 extern u16                 mux6676TelnetConns;
 extern u16                 mux6676TelnetPort;
@@ -525,14 +612,17 @@ extern NpuSoftware         npuSw;
 extern u8                  npuSvmNpuNode;
 extern char                *npuSvmTermStates[];
 extern volatile bool       opActive;
-extern char                opKeyIn;
 extern long                opKeyInterval;
+extern long                opKeyWaitInterval;
 extern volatile bool       opPaused;
 extern char                persistDir[];
 extern u16                 platoConns;
 extern u16                 platoPort;
 extern const unsigned char platoStringToAscii[4][65];
+extern bool                ppBlockIo;
 extern char                ppKeyIn;
+extern bool                ppSpinPark;
+extern void                (*ppStep)(void);
 extern PpSlot              *ppu;
 extern u8                  ppuCount;
 extern u32                 ppuOsBoundary;
@@ -562,6 +652,7 @@ extern char networkInterfaceMgr[];
 extern char osType[];
 
 bool idleCheckBusy();
+bool idleDetectorAuto(CpuContext *ctx);  /* any OS, fingerprints the CPU idle loop */
 bool idleDetectorNone(CpuContext *ctx);
 bool idleDetectorCOS(CpuContext *ctx);   /* COS */
 bool idleDetectorMACE(CpuContext *ctx);  /* KRONOS1 or MACE, possibly SCOPE too) */
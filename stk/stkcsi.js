@@ -742,7 +742,6 @@ class StkCSI extends Program {
   }
 
   processDismountRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     if (request.length > 1) {
       const volId = request[1];
       let status = this.dismountVolume(client.driveKey, volId, true);
@@ -759,7 +758,6 @@ class StkCSI extends Program {
   }
 
   processLocateBlockRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     if (request.length < 2) {
       this.sendResponse(client, "400 Bad request");
       return;
@@ -850,7 +848,6 @@ class StkCSI extends Program {
   }
 
   processMountRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     if (request.length > 1) {
       const volId = request[1];
       this.mountVolume(client.driveKey, volId, status => {
@@ -868,12 +865,10 @@ class StkCSI extends Program {
   }
 
   processPingRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     this.sendResponse(client, "200 Pong");
   }
 
   processReadBkwRequest(client, request, doReturnData) {
-    client.data = Buffer.allocUnsafe(0);
     let volume = this.getVolumeForClient(client);
     if (volume === null) {
       this.sendResponse(client, "403 No tape mounted");
@@ -940,7 +935,6 @@ class StkCSI extends Program {
   }
 
   processReadBlockIdRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     let volume = this.getVolumeForClient(client);
     if (volume === null) {
       this.sendResponse(client, "403 No tape mounted");
@@ -952,7 +946,6 @@ class StkCSI extends Program {
   }
 
   processReadFwdRequest(client, request, doReturnData) {
-    client.data = Buffer.allocUnsafe(0);
     let volume = this.getVolumeForClient(client);
     if (volume === null) {
       this.sendResponse(client, "403 No tape mounted");
@@ -1011,7 +1004,6 @@ class StkCSI extends Program {
   }
 
   processRewindRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     let volume = this.getVolumeForClient(client);
     if (volume === null) {
       this.sendResponse(client, "403 No tape mounted");
@@ -1023,7 +1015,6 @@ class StkCSI extends Program {
   }
 
   processRegisterRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     if (request.length < 2) {
       this.sendResponse(client, "400 Bad request");
       return;
@@ -1037,33 +1028,33 @@ class StkCSI extends Program {
     }
     this.driveMap[driveKey] = {client: client};
     client.driveKey = driveKey;
-    this.sendResponse(client, `200 ${driveKey} registered`);
+    this.sendResponse(client, `200 ${driveKey} registered pipelined`);
     console.log(`${new Date().toLocaleString()} ${driveKey} registered by ${client.client.remoteAddress}`);
   }
 
   processWriteRequest(client, request, dataIndex) {
-    let volume = this.getVolumeForClient(client);
-    if (volume === null) {
-      this.sendResponse(client, "403 No tape mounted");
-      client.data = Buffer.allocUnsafe(0);
-      return;
-    }
     if (request.length < 2) {
       this.sendResponse(client, "400 Bad request");
       client.data = Buffer.allocUnsafe(0);
-      return;
+      return true;
     }
     let dataLength = parseInt(request[1]);
     if (isNaN(dataLength)) {
       this.sendResponse(client, "400 Bad request");
       client.data = Buffer.allocUnsafe(0);
-      return;
+      return true;
+    }
+    if (client.data.length - dataIndex < dataLength) return false;
+    let data = client.data.slice(dataIndex, dataIndex + dataLength);
+    client.data = client.data.slice(dataIndex + dataLength);
+    let volume = this.getVolumeForClient(client);
+    if (volume === null) {
+      this.sendResponse(client, "403 No tape mounted");
+      return true;
     }
-    if (client.data.length - dataIndex < dataLength) return;
     if (volume.writeEnabled !== true) {
       this.sendResponse(client, "502 Volume is read-only");
-      client.data = Buffer.allocUnsafe(0);
-      return;
+      return true;
     }
     let recordLength = new Uint8Array(4);
     recordLength[0] = dataLength & 0xff;
@@ -1072,28 +1063,26 @@ class StkCSI extends Program {
     recordLength[3] = (dataLength >> 24) & 0xff;
     if (fs.writeSync(volume.fd, recordLength, 0, 4, volume.position) !== 4) {
       this.sendResponse(client, "503 Failed to write record length");
-      client.data = Buffer.allocUnsafe(0);
-      return;
+      return true;
     }
     volume.position += 4;
-    let bytesWritten = fs.writeSync(volume.fd, client.data, dataIndex, dataLength, volume.position);
-    client.data = Buffer.allocUnsafe(0);
+    let bytesWritten = fs.writeSync(volume.fd, data, 0, dataLength, volume.position);
     if (bytesWritten !== dataLength) {
       this.sendResponse(client, "503 Failed to write record data");
-      return;
+      return true;
     }
     volume.position += dataLength;
     if (fs.writeSync(volume.fd, recordLength, 0, 4, volume.position) !== 4) {
       this.sendResponse(client, "503 Failed to write record length");
-      return;
+      return true;
     }
     volume.position += 4;
     volume.blockId += 1;
     this.sendResponse(client, "200 Ok");
+    return true;
   }
 
   processWriteTapeMarkRequest(client, request) {
-    client.data = Buffer.allocUnsafe(0);
     let volume = this.getVolumeForClient(client);
     if (volume === null) {
       this.sendResponse(client, "403 No tape mounted");
@@ -1118,6 +1107,10 @@ class StkCSI extends Program {
     this.debugLog(`StkCSI TCP ${client.client.remoteAddress}:${client.client.remotePort} => ${response}`);
   }
 
+  //
+  // Requests may be pipelined. Each complete request is processed in turn,
+  // and responses are sent in the order in which requests were received.
+  //
   handleTapeServerRequest(socket, data) {
     let idx = this.tapeServerClients.findIndex(client => {
       return client.client.remoteAddress === socket.remoteAddress && client.client.remotePort === socket.remotePort;
@@ -1125,57 +1118,55 @@ class StkCSI extends Program {
     if (idx !== -1) {
       let client = this.tapeServerClients[idx];
       client.data = Buffer.concat([client.data, data]);
-      idx = client.data.indexOf("\n");
-      if (idx !== -1) {
+      while ((idx = client.data.indexOf("\n")) !== -1) {
         let request = client.data.slice(0, idx).toString().trim();
         this.debugLog(`StkCSI TCP ${client.client.remoteAddress}:${client.client.remotePort} <= ${request}`);
         request = request.split(" ");
-        if (request.length > 0) {
-          switch (request[0]) {
-          case "DISMOUNT":
-            this.processDismountRequest(client, request);
-            break;
-          case "LOCATEBLOCK":
-            this.processLocateBlockRequest(client, request);
-            break;
-          case "MOUNT":
-            this.processMountRequest(client, request);
-            break;
-          case "PING":
-            this.processPingRequest(client, request);
-            break;
-          case "READBKW":
-            this.processReadBkwRequest(client, request, true);
-            break;
-          case "READBLOCKID":
-            this.processReadBlockIdRequest(client, request);
-            break;
-          case "READFWD":
-            this.processReadFwdRequest(client, request, true);
-            break;
-          case "REGISTER":
-            this.processRegisterRequest(client, request);
-            break;
-          case "REWIND":
-            this.processRewindRequest(client, request);
-            break;
-          case "SPACEBKW":
-            this.processReadBkwRequest(client, request, false);
-            break;
-          case "SPACEFWD":
-            this.processReadFwdRequest(client, request, false);
-            break;
-          case "WRITE":
-            this.processWriteRequest(client, request, idx + 1);
-            break;
-          case "WRITEMARK":
-            this.processWriteTapeMarkRequest(client, request);
-            break;
-          default:
-            this.sendResponse(client, `401 ${request[0]}?`);
-            client.data = Buffer.allocUnsafe(0);
-            break;
-          }
+        if (request[0] === "WRITE") {
+          if (this.processWriteRequest(client, request, idx + 1)) continue;
+          break;
+        }
+        client.data = client.data.slice(idx + 1);
+        switch (request[0]) {
+        case "DISMOUNT":
+          this.processDismountRequest(client, request);
+          break;
+        case "LOCATEBLOCK":
+          this.processLocateBlockRequest(client, request);
+          break;
+        case "MOUNT":
+          this.processMountRequest(client, request);
+          break;
+        case "PING":
+          this.processPingRequest(client, request);
+          break;
+        case "READBKW":
+          this.processReadBkwRequest(client, request, true);
+          break;
+        case "READBLOCKID":
+          this.processReadBlockIdRequest(client, request);
+          break;
+        case "READFWD":
+          this.processReadFwdRequest(client, request, true);
+          break;
+        case "REGISTER":
+          this.processRegisterRequest(client, request);
+          break;
+        case "REWIND":
+          this.processRewindRequest(client, request);
+          break;
+        case "SPACEBKW":
+          this.processReadBkwRequest(client, request, false);
+          break;
+        case "SPACEFWD":
+          this.processReadFwdRequest(client, request, false);
+          break;
+        case "WRITEMARK":
+          this.processWriteTapeMarkRequest(client, request);
+          break;
+        default:
+          this.sendResponse(client, `401 ${request[0]}?`);
+          break;
         }
       }
     }
@@ -126,6 +126,24 @@ typedef struct
     void (*init)(u8 eqNo, u8 unitNo, u8 channelNo, char *deviceName);
     } DevDesc;
 
+/*
+**  Asynchronous disk container I/O unit (private to diskio.c).
+*/
+typedef struct diskIoUnit DiskIoUnit;
+
+/*
+**  Line printer spool (private to lpspool.c) and the outcome of removing
+**  its paper, which is reported back to the printer emulation.
+*/
+typedef struct lpSpool LpSpool;
+
+typedef enum
+    {
+    LpRotateOk, LpRotateRenameFailed, LpRotatePostFailed
+    } LpRotateStatus;
+
+typedef void (*LpRotateDone)(void *owner, char *newName, bool isGenerated, LpRotateStatus status, int err);
+
 /*
 **  Filesystem Watcher Thread Context Block.
 **      20171110: SZoppi - Added Windows Support
@@ -169,6 +187,7 @@ typedef struct devSlot
     u8             devType;             /* attached device type */
     u8             eqNo;                /* equipment number */
     i8             selectedUnit;        /* selected unit */
+    bool           blockIo;             /* device tolerates multi-word IAM/OAM steps */
     } DevSlot;
 
 /*
@@ -212,6 +231,20 @@ typedef struct
     bool   isBelowOsBound;              /* whether checking is below/above OS bound register */
     u8     chWordIdx;                   /* index of next channel word in IAPM/OAPM instruction */
     u64    chWords;                     /* current bits assembled by IAPM/OAPM instruction */
+    /*
+     *  Spin loop parking
+     */
+    u8     park;                        /* event a parked PP is waiting for */
+    bool   parkState;                   /* channel state which keeps PP parked */
+    u8     parkChannel;                 /* channel watched by parked PP */
+    u32    parkAddress;                 /* CM address watched by parked PP */
+    CpWord parkData;                    /* CM word which keeps PP parked */
+    PpWord spinP;                       /* address of candidate loop closing jump */
+    bool   spinPure;                    /* candidate loop body has no side effects */
+    u8     spinHits;                    /* consecutive identical loop iterations */
+    u32    spinA;                       /* register A at last loop closing jump */
+    u32    cmAddress;                   /* CM address read by last CRD */
+    CpWord cmData;                      /* CM word read by last CRD */
     } PpSlot;
 
 /*
@@ -255,8 +288,50 @@ typedef struct
     bool          iwValid[MaxIwStack];
     u8            iwRank;
     volatile u32  idleCycles;           /* Counter for how many times we've seen the idle loop */
+
+    /*
+    **  Generic idle loop fingerprint.
+    */
+    u32           idleRa;               /* RA of loop being fingerprinted */
+    u32           idleFl;               /* FL of loop being fingerprinted */
+    u32           idleHits;             /* consecutive samples matching the fingerprint */
+    u8            idleSlots;            /* number of loop locations seen */
+    u32           idleWhere[MaxIdleSlots]; /* P and parcel offset of each location */
+    u32           idleHash[MaxIdleSlots];  /* register hash at each location */
+
+    u64           instructions;         /* instructions executed, for metrics */
     } CpuContext;
 
+/*
+**  Runtime performance counters (reported by metrics.c).
+*/
+typedef struct
+    {
+    u64 cycles;                         /* major emulation cycles */
+    u64 ppInstructions[MaxPps];         /* barrel passes in which the PP executed an instruction */
+    u64 ppBusyPasses[MaxPps];           /* barrel passes in which the PP continued a busy instruction */
+    u64 channelFunctions[MaxChannels];  /* function codes issued on each channel */
+    u64 diskReads;                      /* disk container reads */
+    u64 diskReadBytes;
+    u64 diskWrites;                     /* disk container writes */
+    u64 diskWriteBytes;
+    u64 tapeReads;                      /* tape blocks read */
+    u64 tapeReadBytes;
+    u64 tapeWrites;                     /* tape blocks written */
+    u64 tapeWriteBytes;
+    } Metrics;
+
+/*
+**  Device log module.
+*/
+typedef struct devLogModule
+    {
+    char         name[16];              /* module name, also names its log file */
+    volatile int level;                 /* DevLogOff .. DevLogDebug */
+    u32          lost;                  /* records lost on full ring buffers */
+    u8           id;                    /* index in module table */
+    } DevLogModule;
+
 /*
 **  Model specific feature set.
 */
@@ -36,7 +36,7 @@ function runTextConsole(machineId, url, port, refresh) {
 
   machine.setConnectListener(() => {
     cyberConsole.displayNotification(1, 128, 128, `Connected`);
-    machine.send(new Uint8Array([0x80, refresh, 0x81]));
+    machine.send(new Uint8Array([0x80, refresh, 0x82, 0x01, 0x81]));
   });
 
   machine.setDisconnectListener(() => {
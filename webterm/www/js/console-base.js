@@ -40,8 +40,16 @@ class CyberConsoleBase {
     this.CMD_SET_Y_HIGH = 0x83;
     this.CMD_SET_SCREEN = 0x84;
     this.CMD_SET_FONT_TYPE = 0x85;
+    this.CMD_OPTIONS_ACCEPTED = 0x86;
+    this.CMD_DELTA_FRAME = 0x87;
+    this.CMD_DELTA_COPY = 0x88;
+    this.CMD_DELTA_LITERAL = 0x89;
     this.CMD_END_OF_FRAME = 0xff;
     //
+    // Console stream options
+    //
+    this.OPT_DELTA = 0x01;
+    //
     // Console states
     //
     this.ST_TEXT = 0;
@@ -49,6 +57,10 @@ class CyberConsoleBase {
     this.ST_COLLECT_FONT = 2;
     this.ST_COLLECT_X = 3;
     this.ST_COLLECT_Y = 4;
+    this.ST_COLLECT_OPTIONS = 5;
+    this.ST_DELTA_OP = 6;
+    this.ST_DELTA_PARAMS = 7;
+    this.ST_DELTA_LITERAL = 8;
     //
     // Base Console emulation properties
     //
@@ -59,6 +71,15 @@ class CyberConsoleBase {
     this.xRatio = 1;
     this.yRatio = 1;
     //
+    // Delta frame decoding. The previous frame is the base from which
+    // the next delta frame is rebuilt.
+    //
+    this.prevFrame = new Uint8Array(0);
+    this.deltaFrame = [];
+    this.deltaOp = 0;
+    this.deltaParams = [];
+    this.deltaCount = 0;
+    //
     // Base font information
     //
     this.fontWidths = [2, 8, 16, 32];
@@ -102,6 +123,7 @@ class CyberConsoleBase {
     this.state = this.ST_TEXT;
     this.x = 0;
     this.y = 0;
+    this.prevFrame = new Uint8Array(0);
   }
 
   renderText(data) {
@@ -149,6 +171,13 @@ class CyberConsoleBase {
               case this.CMD_SET_FONT_TYPE:
                 this.state = this.ST_COLLECT_FONT;
                 break;
+              case this.CMD_OPTIONS_ACCEPTED:
+                this.state = this.ST_COLLECT_OPTIONS;
+                break;
+              case this.CMD_DELTA_FRAME:
+                this.deltaFrame = [];
+                this.state = this.ST_DELTA_OP;
+                break;
               case this.CMD_END_OF_FRAME:
                 this.updateScreen();
                 break;
@@ -179,6 +208,52 @@ class CyberConsoleBase {
           this.state = this.ST_TEXT;
           break;
 
+        case this.ST_COLLECT_OPTIONS:
+          this.prevFrame = new Uint8Array(0);
+          this.state = this.ST_TEXT;
+          break;
+
+        case this.ST_DELTA_OP:
+          if (b === this.CMD_DELTA_COPY || b === this.CMD_DELTA_LITERAL) {
+            this.deltaOp = b;
+            this.deltaParams = [];
+            this.state = this.ST_DELTA_PARAMS;
+          } else {
+            //
+            // End of delta frame: render the rebuilt frame as plain data
+            //
+            this.state = this.ST_TEXT;
+            if (b === this.CMD_END_OF_FRAME) {
+              this.prevFrame = Uint8Array.from(this.deltaFrame);
+              this.renderText(this.prevFrame);
+            }
+          }
+          break;
+
+        case this.ST_DELTA_PARAMS:
+          this.deltaParams.push(b);
+          if (this.deltaOp === this.CMD_DELTA_COPY) {
+            if (this.deltaParams.length === 4) {
+              let offset = (this.deltaParams[0] << 8) | this.deltaParams[1];
+              let limit = offset + ((this.deltaParams[2] << 8) | this.deltaParams[3]);
+              for (let j = offset; j < limit && j < this.prevFrame.length; j++) {
+                this.deltaFrame.push(this.prevFrame[j]);
+              }
+              this.state = this.ST_DELTA_OP;
+            }
+          } else if (this.deltaParams.length === 2) {
+            this.deltaCount = (this.deltaParams[0] << 8) | this.deltaParams[1];
+            this.state = this.deltaCount > 0 ? this.ST_DELTA_LITERAL : this.ST_DELTA_OP;
+          }
+          break;
+
+        case this.ST_DELTA_LITERAL:
+          this.deltaFrame.push(b);
+          if (--this.deltaCount < 1) {
+            this.state = this.ST_DELTA_OP;
+          }
+          break;
+
         default:
           // ignore byte
           break;